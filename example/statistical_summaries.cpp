@@ -23,8 +23,10 @@ int main() {
 	// prints column-wise summary;
 	df.summary();
 
-	// prints summary of column df["U"]
-	df["U"].summary<int, double>();
+	// summary of column df["U"]
+	column_summary<double> s = df["U"].summary<int, double>();
 	// first parameter(int): column type
 	// second parameter(double): type of the statistics variable
+	std::cout << s << std::endl;
+	std::cout << "Variance : " << s.variance() << std::endl;
 }
\ No newline at end of file
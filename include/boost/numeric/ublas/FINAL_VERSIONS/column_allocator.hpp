@@ -0,0 +1,381 @@
+//          Copyright(C) Rishabh Arora 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Cache line aligned allocation of the column buffers.
+// A column_array can also hold a buffer lent by a memory region (a memory mapped file) instead of
+// an allocated one, see adopt_array(): it holds the owner of the region instead of freeing the buffer.
+
+#ifndef _BOOST_UBLAS_DF_COLUMN_ALLOCATOR_
+#define _BOOST_UBLAS_DF_COLUMN_ALLOCATOR_
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <boost/align/aligned_alloc.hpp>
+#include <boost/numeric/ublas/storage.hpp>
+#include <boost/numeric/ublas/vector.hpp>
+
+namespace boost { namespace numeric { namespace ublas {
+
+	//! \brief Alignment of the column buffers, the size of a cache line.
+	const size_t column_alignment = 64;
+
+	/*! \brief Allocator of cache line aligned buffers.
+	 *  The allocated size is rounded up to a multiple of \c column_alignment, so a kernel
+	 *  may load a full vector register at the end of a buffer without leaving its cache line.
+	 */
+	template < class T >
+	class cache_aligned_allocator {
+	public:
+		typedef T value_type;
+		typedef T* pointer;
+		typedef const T* const_pointer;
+		typedef T& reference;
+		typedef const T& const_reference;
+		typedef size_t size_type;
+		typedef std::ptrdiff_t difference_type;
+
+		template < class U >
+		struct rebind {
+			typedef cache_aligned_allocator<U> other;
+		};
+
+		BOOST_UBLAS_INLINE
+		cache_aligned_allocator () {}
+
+		template < class U >
+		BOOST_UBLAS_INLINE
+		cache_aligned_allocator (const cache_aligned_allocator<U>&) {}
+
+		//! \brief Returns the number of bytes allocated for n elements.
+		static BOOST_UBLAS_INLINE
+		size_type padded_size (const size_type n) {
+			const size_type bytes = (n == 0 ? 1 : n) * sizeof(T);
+			return (bytes + column_alignment - 1) / column_alignment * column_alignment;
+		}
+
+		BOOST_UBLAS_INLINE
+		pointer allocate (const size_type n, const void* = 0) {
+			if (n > max_size()) {
+				throw std::bad_alloc();
+			}
+			void* p = boost::alignment::aligned_alloc (column_alignment, padded_size (n));
+			if (p == 0) {
+				throw std::bad_alloc();
+			}
+			return static_cast<pointer> (p);
+		}
+
+		BOOST_UBLAS_INLINE
+		void deallocate (pointer p, const size_type) {
+			boost::alignment::aligned_free (p);
+		}
+
+		BOOST_UBLAS_INLINE
+		size_type max_size () const {
+			return (std::numeric_limits<size_type>::max() - column_alignment) / sizeof(T);
+		}
+
+		template < class U, class... Args >
+		BOOST_UBLAS_INLINE
+		void construct (U* p, Args&&... args) {
+			::new ((void*) p) U (std::forward<Args> (args)...);
+		}
+
+		template < class U >
+		BOOST_UBLAS_INLINE
+		void destroy (U* p) {
+			p->~U();
+		}
+	};
+
+	template < class T, class U >
+	BOOST_UBLAS_INLINE
+	bool operator == (const cache_aligned_allocator<T>&, const cache_aligned_allocator<U>&) {
+		return true;
+	}
+
+	template < class T, class U >
+	BOOST_UBLAS_INLINE
+	bool operator != (const cache_aligned_allocator<T>&, const cache_aligned_allocator<U>&) {
+		return false;
+	}
+
+	/*! \brief Cache line aligned storage of a column, the array type of column_vector.
+	 *  It has the interface of \c unbounded_array. Its buffer is either allocated by a
+	 *  cache_aligned_allocator, or lent by a memory region (see adopt_array()): the array then
+	 *  holds the owner of the region, released with the buffer instead of freeing it.
+	 */
+	template < class T >
+	class column_array:
+		public storage_array < column_array<T> > {
+	public:
+		typedef cache_aligned_allocator<T> allocator_type;
+		typedef typename allocator_type::size_type size_type;
+		typedef typename allocator_type::difference_type difference_type;
+		typedef T value_type;
+		typedef const T& const_reference;
+		typedef T& reference;
+		typedef const T* const_pointer;
+		typedef T* pointer;
+		typedef const_pointer const_iterator;
+		typedef pointer iterator;
+		typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+		typedef std::reverse_iterator<iterator> reverse_iterator;
+
+		BOOST_UBLAS_INLINE
+		column_array ():
+			size_ (0), data_ (0) {}
+
+		explicit BOOST_UBLAS_INLINE
+		column_array (const size_type size):
+			size_ (size), data_ (allocate (size)) {
+			if (!std::is_trivially_default_constructible<T>::value) {
+				for(pointer d = data_; d != data_ + size_; ++d) {
+					::new ((void*) d) T ();
+				}
+			}
+		}
+
+		BOOST_UBLAS_INLINE
+		column_array (const size_type size, const value_type& init):
+			size_ (size), data_ (allocate (size)) {
+			std::uninitialized_fill (begin(), end(), init);
+		}
+
+		/*! \brief Array over the size elements at p, lent by owner: they are neither constructed nor copied.
+		 *  p is aligned on \c column_alignment and readable up to \c allocator_type::padded_size(size) bytes.
+		 */
+		BOOST_UBLAS_INLINE
+		column_array (pointer p, const size_type size, std::shared_ptr<const void> owner):
+			size_ (size), data_ (size == 0 ? 0 : p), owner_ (size == 0 ? nullptr : std::move (owner)) {
+			static_assert (std::is_trivially_default_constructible<T>::value && std::is_trivially_destructible<T>::value,
+				"the elements of a lent buffer are never constructed nor destroyed");
+		}
+
+		//! \brief Copies the elements of c into an allocated buffer, a lent buffer is not shared.
+		BOOST_UBLAS_INLINE
+		column_array (const column_array& c):
+			storage_array < column_array<T> > (),
+			size_ (c.size_), data_ (allocate (c.size_)) {
+			std::uninitialized_copy (c.begin(), c.end(), begin());
+		}
+
+		BOOST_UBLAS_INLINE
+		column_array (column_array&& c):
+			storage_array < column_array<T> > (),
+			size_ (c.size_), data_ (c.data_), owner_ (std::move (c.owner_)) {
+			c.size_ = 0;
+			c.data_ = 0;
+		}
+
+		BOOST_UBLAS_INLINE
+		~column_array () {
+			release (data_, size_);
+		}
+
+		//! \brief Copies the elements of c into a new allocated buffer, a lent buffer is released, never written.
+		BOOST_UBLAS_INLINE
+		column_array& operator = (const column_array& c) {
+			if (this != &c) {
+				column_array (c).swap (*this);
+			}
+			return *this;
+		}
+
+		BOOST_UBLAS_INLINE
+		column_array& operator = (column_array&& c) {
+			column_array (std::move (c)).swap (*this);
+			return *this;
+		}
+
+		//! \brief Resizes the array, moving a lent buffer to an allocated one if the size changes.
+		BOOST_UBLAS_INLINE
+		void resize (const size_type size) {
+			resize_internal (size, value_type (), false);
+		}
+
+		//! \brief Resizes the array, preserving its elements and setting the new ones to init.
+		BOOST_UBLAS_INLINE
+		void resize (const size_type size, const value_type init) {
+			resize_internal (size, init, true);
+		}
+
+		BOOST_UBLAS_INLINE
+		size_type max_size () const {
+			return allocator_type ().max_size();
+		}
+
+		BOOST_UBLAS_INLINE
+		bool empty () const {
+			return size_ == 0;
+		}
+
+		BOOST_UBLAS_INLINE
+		size_type size () const {
+			return size_;
+		}
+
+		//! \brief Returns \c true if the buffer is lent by a memory region (see adopt_array()).
+		BOOST_UBLAS_INLINE
+		bool lent () const {
+			return owner_ != nullptr;
+		}
+
+		BOOST_UBLAS_INLINE
+		const_reference operator [] (const size_type i) const {
+			BOOST_UBLAS_CHECK (i < size_, bad_index ());
+			return data_[i];
+		}
+
+		BOOST_UBLAS_INLINE
+		reference operator [] (const size_type i) {
+			BOOST_UBLAS_CHECK (i < size_, bad_index ());
+			return data_[i];
+		}
+
+		//! \brief Swaps the buffers, each with its owner.
+		BOOST_UBLAS_INLINE
+		void swap (column_array& a) {
+			if (this != &a) {
+				std::swap (size_, a.size_);
+				std::swap (data_, a.data_);
+				owner_.swap (a.owner_);
+			}
+		}
+
+		BOOST_UBLAS_INLINE
+		friend void swap (column_array& a1, column_array& a2) {
+			a1.swap (a2);
+		}
+
+		BOOST_UBLAS_INLINE
+		column_array& assign_temporary (column_array& a) {
+			swap (a);
+			return *this;
+		}
+
+		BOOST_UBLAS_INLINE
+		const_iterator begin () const {
+			return data_;
+		}
+
+		BOOST_UBLAS_INLINE
+		const_iterator cbegin () const {
+			return begin();
+		}
+
+		BOOST_UBLAS_INLINE
+		const_iterator end () const {
+			return data_ + size_;
+		}
+
+		BOOST_UBLAS_INLINE
+		const_iterator cend () const {
+			return end();
+		}
+
+		BOOST_UBLAS_INLINE
+		iterator begin () {
+			return data_;
+		}
+
+		BOOST_UBLAS_INLINE
+		iterator end () {
+			return data_ + size_;
+		}
+
+		BOOST_UBLAS_INLINE
+		const_reverse_iterator rbegin () const {
+			return const_reverse_iterator (end());
+		}
+
+		BOOST_UBLAS_INLINE
+		const_reverse_iterator rend () const {
+			return const_reverse_iterator (begin());
+		}
+
+		BOOST_UBLAS_INLINE
+		reverse_iterator rbegin () {
+			return reverse_iterator (end());
+		}
+
+		BOOST_UBLAS_INLINE
+		reverse_iterator rend () {
+			return reverse_iterator (begin());
+		}
+
+	private:
+		BOOST_UBLAS_INLINE
+		static pointer allocate (const size_type size) {
+			return size == 0 ? 0 : allocator_type ().allocate (size);
+		}
+
+		//! \brief Destroys and frees the size elements at p, or releases the owner if they are lent.
+		BOOST_UBLAS_INLINE
+		void release (pointer p, const size_type size) {
+			if (owner_ != nullptr) {
+				owner_.reset();
+				return;
+			}
+			if (size != 0) {
+				if (!std::is_trivially_destructible<T>::value) {
+					for(pointer d = p; d != p + size; ++d) {
+						d->~T();
+					}
+				}
+				allocator_type ().deallocate (p, size);
+			}
+		}
+
+		BOOST_UBLAS_INLINE
+		void resize_internal (const size_type size, const value_type init, const bool preserve) {
+			if (size == size_) {
+				return;
+			}
+			const pointer p = allocate (size);
+			const size_type kept = preserve ? std::min (size, size_) : 0;
+			std::uninitialized_copy (data_, data_ + kept, p);
+			if (preserve) {
+				std::uninitialized_fill (p + kept, p + size, init);
+			}
+			else if (!std::is_trivially_default_constructible<T>::value) {
+				for(pointer d = p; d != p + size; ++d) {
+					::new ((void*) d) T ();
+				}
+			}
+			release (data_, size_);
+			data_ = p;
+			size_ = size;
+		}
+
+		size_type size_;
+		pointer data_;
+		//! \brief Owner of the memory region lending the buffer, null if the buffer is allocated.
+		std::shared_ptr<const void> owner_;
+	};
+
+	//! \brief Vector type of a column of T, a ublas::vector over a column_array.
+	template < class T >
+	using column_vector = vector < T, column_array<T> >;
+
+	/*! \brief Returns a column_array over the n elements at p, without copying them, holding owner until
+	 *  the buffer is released. p is aligned on \c column_alignment and readable up to
+	 *  \c cache_aligned_allocator<T>::padded_size(n) bytes, owner keeps it valid (e.g. a mapped file).
+	 */
+	template < class T >
+	BOOST_UBLAS_INLINE
+	column_array<T> adopt_array (T* p, const size_t n, std::shared_ptr<const void> owner) {
+		return column_array<T> (p, n, std::move (owner));
+	}
+
+}}}
+
+#endif
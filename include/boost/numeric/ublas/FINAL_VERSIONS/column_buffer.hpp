@@ -0,0 +1,518 @@
+//          Copyright(C) Rishabh Arora 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Storage of the df_column data.
+// Every column refers to a single contiguous buffer, aligned and padded to a cache line (see column_allocator.hpp),
+// tagged with the index of its element type in INNER_TYPE.
+// Strings can also be stored Arrow-style (see string_column.hpp) or dictionary encoded (see dictionary_column.hpp),
+// and booleans bit-packed (bool_column, see df_bitmap.hpp), with the type tags following INNER_TYPE.
+// Buffers are shared between copies and copied on the first write (copy-on-write).
+// Requires INNER_TYPE to be defined (see df.hpp).
+
+#ifndef _BOOST_UBLAS_DF_COLUMN_BUFFER_
+#define _BOOST_UBLAS_DF_COLUMN_BUFFER_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <boost/preprocessor/seq/for_each_i.hpp>
+#include <boost/preprocessor/seq/size.hpp>
+#include <boost/variant/get.hpp>
+#include <boost/numeric/ublas/vector.hpp>
+#include "./column_allocator.hpp"
+#include "./df_bitmap.hpp"
+#include "./dictionary_column.hpp"
+#include "./string_column.hpp"
+
+namespace boost { namespace numeric { namespace ublas {
+
+	//! \brief Number of element types of a column stored in a column_vector (types of INNER_TYPE).
+	const short column_type_count = BOOST_PP_SEQ_SIZE(INNER_TYPE);
+
+	/*! \brief Storage type and type tag of a column of T.
+	 *  \c type_id is the 0 - based index of T in INNER_TYPE, as returned by \c df_column::type().
+	 *  The string columns are tagged \c column_type_count (string_column), \c column_type_count + 1 (large_string_column)
+	 *  and \c column_type_count + 2 (dictionary_column), the bit-packed booleans \c column_type_count + 3 (bool_column).
+	 *  \c reference and \c const_reference are the types of the elements read from a column
+	 *  (std::string_view for the string columns and bool for bool_column, which are read only).
+	 */
+	template < class T >
+	struct column_traits;
+
+#define DF_COLUMN_TRAITS(r, data, i, T) \
+	template <> \
+	struct column_traits < T > { \
+		typedef T value_type; \
+		typedef column_vector < T > storage_type; \
+		typedef value_type& reference; \
+		typedef const value_type& const_reference; \
+		static const short type_id = i; \
+	};
+
+	BOOST_PP_SEQ_FOR_EACH_I(DF_COLUMN_TRAITS, _, INNER_TYPE)
+
+#undef DF_COLUMN_TRAITS
+
+	template <>
+	struct column_traits < string_column > {
+		typedef std::string_view value_type;
+		typedef string_column storage_type;
+		typedef std::string_view reference;
+		typedef std::string_view const_reference;
+		static const short type_id = column_type_count;
+	};
+
+	template <>
+	struct column_traits < large_string_column > {
+		typedef std::string_view value_type;
+		typedef large_string_column storage_type;
+		typedef std::string_view reference;
+		typedef std::string_view const_reference;
+		static const short type_id = column_type_count + 1;
+	};
+
+	template <>
+	struct column_traits < dictionary_column > {
+		typedef std::string_view value_type;
+		typedef dictionary_column storage_type;
+		typedef std::string_view reference;
+		typedef std::string_view const_reference;
+		static const short type_id = column_type_count + 2;
+	};
+
+	template <>
+	struct column_traits < bool_column > {
+		typedef bool value_type;
+		typedef bool_column storage_type;
+		typedef bool reference;
+		typedef bool const_reference;
+		static const short type_id = column_type_count + 3;
+	};
+
+	/*! \brief Type of column of the storage S: T for a column_vector<T>, S itself for the other storages.
+	 *  column_traits < column_tag<S>::type >::storage_type is S.
+	 */
+	template < class S >
+	struct column_tag {
+		typedef S type;
+	};
+
+	template < class T >
+	struct column_tag < column_vector<T> > {
+		typedef T type;
+	};
+
+	/*! \brief Typed view over a contiguous buffer.
+	 *  Doesn't own the data, valid as long as the viewed buffer isn't resized or destroyed.
+	 */
+	template < class T >
+	class column_view {
+	public:
+		typedef T value_type;
+		typedef T* iterator;
+		typedef size_t size_type;
+
+		BOOST_UBLAS_INLINE
+		column_view ():
+			data_ (0),
+			size_ (0) {}
+
+		BOOST_UBLAS_INLINE
+		column_view (T* data, const size_t size):
+			data_ (data),
+			size_ (size) {}
+
+		//! \brief Returns the number of elements.
+		BOOST_UBLAS_INLINE
+		size_t size() const {
+			return size_;
+		}
+
+		//! \brief Returns the first element of the buffer.
+		BOOST_UBLAS_INLINE
+		T* data() const {
+			return data_;
+		}
+
+		BOOST_UBLAS_INLINE
+		T* begin() const {
+			return data_;
+		}
+
+		BOOST_UBLAS_INLINE
+		T* end() const {
+			return data_ + size_;
+		}
+
+		BOOST_UBLAS_INLINE
+		T& operator () (const size_t i) const {
+			return data_[i];
+		}
+
+		BOOST_UBLAS_INLINE
+		T& operator [] (const size_t i) const {
+			return data_[i];
+		}
+
+	private:
+		T* data_;
+		size_t size_;
+	};
+
+	//! \brief Type erased storage of a column.
+	class column_storage_base {
+	public:
+		BOOST_UBLAS_INLINE
+		virtual ~column_storage_base() {}
+
+		//! \brief Returns a deep copy of the storage.
+		virtual column_storage_base* clone() const = 0;
+
+		//! \brief Returns the number of elements.
+		virtual size_t size() const = 0;
+	};
+
+	//! \brief Storage of a column, holds an S (column_vector<T> ...).
+	template < class S >
+	class column_storage: public column_storage_base {
+	public:
+		BOOST_UBLAS_INLINE
+		column_storage () {}
+
+		BOOST_UBLAS_INLINE
+		explicit column_storage (const S& data):
+			data_ (data) {}
+
+		BOOST_UBLAS_INLINE
+		column_storage_base* clone() const {
+			return new column_storage (data_);
+		}
+
+		BOOST_UBLAS_INLINE
+		size_t size() const {
+			return data_.size();
+		}
+
+		BOOST_UBLAS_INLINE
+		S& data() {
+			return data_;
+		}
+
+		BOOST_UBLAS_INLINE
+		const S& data() const {
+			return data_;
+		}
+
+	private:
+		S data_;
+	};
+
+	/*! \brief Validity of the elements of a column: a bitmap with the valid elements set, and the number of nulls.
+	 *  A column without nulls has no bitmap, kernels test \c has_nulls() to take their fast path.
+	 *  The bitmap is shared between copies and copied on the first write, as the column storage.
+	 */
+	class column_validity {
+	public:
+		BOOST_UBLAS_INLINE
+		column_validity ():
+			null_count_ (0) {}
+
+		//! \brief Validity given by a bitmap, bits set for the valid elements.
+		BOOST_UBLAS_INLINE
+		explicit column_validity (bitmap&& bits):
+			null_count_ (bits.size() - bits.count()) {
+			if (null_count_ != 0) {
+				bits_ = std::make_shared<bitmap> (std::move (bits));
+			}
+		}
+
+		//! \brief Returns \c true if some elements are null.
+		BOOST_UBLAS_INLINE
+		bool has_nulls() const {
+			return null_count_ != 0;
+		}
+
+		//! \brief Returns the number of null elements.
+		BOOST_UBLAS_INLINE
+		size_t null_count() const {
+			return null_count_;
+		}
+
+		//! \brief Returns the bitmap, null if there is no null element.
+		BOOST_UBLAS_INLINE
+		const bitmap* bits() const {
+			return bits_.get();
+		}
+
+		//! \brief Returns \c false if the element i is null.
+		BOOST_UBLAS_INLINE
+		bool is_valid(const size_t i) const {
+			return !bits_ || bits_->test (i);
+		}
+
+		/*! \brief Marks the element i of a column of n elements as valid or null.
+		 *  The bitmap is created on the first null and dropped when the last null is cleared.
+		 */
+		BOOST_UBLAS_INLINE
+		void set_valid(const size_t i, const size_t n, const bool valid) {
+			if (valid == is_valid (i)) {
+				return;
+			}
+			if (!bits_) {
+				bits_ = std::make_shared<bitmap> (n, true);
+			}
+			else if (bits_.use_count() > 1) {
+				bits_ = std::make_shared<bitmap> (*bits_);
+			}
+			bits_->set (i, valid);
+			null_count_ = valid ? null_count_ - 1 : null_count_ + 1;
+			if (null_count_ == 0) {
+				bits_.reset();
+			}
+		}
+
+		//! \brief Marks all the elements as valid.
+		BOOST_UBLAS_INLINE
+		void clear() {
+			bits_.reset();
+			null_count_ = 0;
+		}
+
+		BOOST_UBLAS_INLINE
+		void swap(column_validity& v) {
+			bits_.swap (v.bits_);
+			std::swap (null_count_, v.null_count_);
+		}
+
+		//! \brief Returns \c true if both have the same null elements.
+		BOOST_UBLAS_INLINE
+		bool operator == (const column_validity& v) const {
+			return null_count_ == v.null_count_ && (bits_ == v.bits_ || *bits_ == *v.bits_);
+		}
+
+	private:
+		std::shared_ptr < bitmap > bits_;
+		size_t null_count_;
+	};
+
+	/*! \brief Validity of the result of an element-wise operation: valid where both a and b are valid.
+	 *  Without bitmap operation if one of them has no null.
+	 */
+	BOOST_UBLAS_INLINE
+	column_validity operator & (const column_validity& a, const column_validity& b) {
+		if (!a.has_nulls()) {
+			return b;
+		}
+		if (!b.has_nulls() || a.bits() == b.bits()) {
+			return a;
+		}
+		bitmap r (a.bits()->size());
+		bitmap_and (a.bits()->words(), b.bits()->words(), r.words(), r.word_count());
+		return column_validity (std::move (r));
+	}
+
+	/*! \brief Buffer of a df_column: a type tag and the storage of that type.
+	 *  The storage is created on first access, an empty buffer is a column of bool
+	 *  (same as the default constructed boost::variant it replaces).
+	 *
+	 *  Copies share the storage, which is reference counted. The non-const accessors
+	 *  copy a shared storage first, so writes are never seen by the other copies.
+	 *  The const accessors never copy: read through const references to keep the sharing.
+	 *  References obtained before the buffer is copied keep pointing to the shared storage.
+	 */
+	class column_buffer {
+	public:
+		BOOST_UBLAS_INLINE
+		column_buffer ():
+			type_ (0) {}
+
+		BOOST_UBLAS_INLINE
+		column_buffer (const column_buffer& b):
+			type_ (b.type_),
+			storage_ (b.storage_),
+			validity_ (b.validity_) {}
+
+		BOOST_UBLAS_INLINE
+		column_buffer (column_buffer&& b) noexcept:
+			type_ (b.type_),
+			storage_ (std::move (b.storage_)),
+			validity_ (std::move (b.validity_)) {
+			b.type_ = 0;
+			b.validity_.clear();
+		}
+
+		BOOST_UBLAS_INLINE
+		column_buffer& operator = (const column_buffer& b) {
+			type_ = b.type_;
+			storage_ = b.storage_;
+			validity_ = b.validity_;
+			return *this;
+		}
+
+		BOOST_UBLAS_INLINE
+		column_buffer& operator = (column_buffer&& b) noexcept {
+			swap (b);
+			return *this;
+		}
+
+		BOOST_UBLAS_INLINE
+		void swap (column_buffer& b) noexcept {
+			std::swap (type_, b.type_);
+			storage_.swap (b.storage_);
+			validity_.swap (b.validity_);
+		}
+
+		//! \brief Returns the type tag of the buffer, see column_traits.
+		BOOST_UBLAS_INLINE
+		short type() const {
+			return type_;
+		}
+
+		//! \brief Returns the number of elements.
+		BOOST_UBLAS_INLINE
+		size_t size() const {
+			return storage_ ? storage_->size() : 0;
+		}
+
+		/*! \brief Returns \c false if the storage is shared with another buffer.
+		 *  use_count() is a relaxed load: the fence orders the writes that follow after the last reads
+		 *  of the buffer that dropped the storage on another thread.
+		 */
+		BOOST_UBLAS_INLINE
+		bool unique() const {
+			if (storage_.use_count() > 1) {
+				return false;
+			}
+			std::atomic_thread_fence (std::memory_order_acquire);
+			return true;
+		}
+
+		//! \brief Returns the storage, shared with the copies of the buffer.
+		BOOST_UBLAS_INLINE
+		std::shared_ptr < const column_storage_base > storage() const {
+			return storage_;
+		}
+
+		//! \brief Gives the buffer its own copy of a shared storage.
+		BOOST_UBLAS_INLINE
+		void detach() {
+			if (!unique()) {
+				storage_.reset (storage_->clone());
+			}
+		}
+
+		//! \brief Returns \c true if the buffer holds a column of T.
+		template < class T >
+		BOOST_UBLAS_INLINE
+		bool holds() const {
+			return type_ == column_traits<T>::type_id;
+		}
+
+		//! \brief Returns the validity of the elements.
+		BOOST_UBLAS_INLINE
+		const column_validity& validity() const {
+			return validity_;
+		}
+
+		//! \brief Returns the validity of the elements, for writing.
+		BOOST_UBLAS_INLINE
+		column_validity& validity() {
+			return validity_;
+		}
+
+		/*! \brief Discards the content and makes the buffer an empty column of T.
+		 *  \return the new storage.
+		 */
+		template < class T >
+		BOOST_UBLAS_INLINE
+		typename column_traits<T>::storage_type& reset() {
+			typedef typename column_traits<T>::storage_type S;
+			column_storage<S>* s = new column_storage<S>;
+			storage_.reset (s);
+			validity_.clear();
+			type_ = column_traits<T>::type_id;
+			return s->data();
+		}
+
+		/*! \brief Returns the storage of the buffer, for writing.
+		 *  Throws boost::bad_get if the buffer doesn't hold a column of T.
+		 */
+		template < class T >
+		BOOST_UBLAS_INLINE
+		typename column_traits<T>::storage_type& get() {
+			typedef typename column_traits<T>::storage_type S;
+			if (!holds<T>()) {
+				throw boost::bad_get();
+			}
+			if (!storage_) {
+				return reset<T>();
+			}
+			detach();
+			return static_cast < column_storage<S>* > (storage_.get())->data();
+		}
+
+		/*! \brief Returns the storage of the buffer.
+		 *  Throws boost::bad_get if the buffer doesn't hold a column of T.
+		 */
+		template < class T >
+		BOOST_UBLAS_INLINE
+		const typename column_traits<T>::storage_type& get() const {
+			typedef typename column_traits<T>::storage_type S;
+			if (!holds<T>()) {
+				throw boost::bad_get();
+			}
+			if (!storage_) {
+				static const S empty;
+				return empty;
+			}
+			return static_cast < const column_storage<S>* > (storage_.get())->data();
+		}
+
+		//! \brief Returns a typed view over the elements.
+		template < class T >
+		BOOST_UBLAS_INLINE
+		column_view<T> view() {
+			typename column_traits<T>::storage_type& s = get<T>();
+			return column_view<T> (s.data().begin(), s.size());
+		}
+
+		//! \brief Returns a typed view over the elements.
+		template < class T >
+		BOOST_UBLAS_INLINE
+		column_view<const T> view() const {
+			const typename column_traits<T>::storage_type& s = get<T>();
+			return column_view<const T> (s.data().begin(), s.size());
+		}
+
+		//! \brief Calls the visitor with the storage of the buffer.
+		template < class V >
+		BOOST_UBLAS_INLINE
+		typename V::result_type apply_visitor (const V& visitor) const {
+#define DF_COLUMN_VISIT(r, data, i, T) case i: return visitor (get < T >());
+			switch (type_) {
+				BOOST_PP_SEQ_FOR_EACH_I(DF_COLUMN_VISIT, _, INNER_TYPE)
+				case column_traits<string_column>::type_id: return visitor (get<string_column>());
+				case column_traits<large_string_column>::type_id: return visitor (get<large_string_column>());
+				case column_traits<dictionary_column>::type_id: return visitor (get<dictionary_column>());
+				case column_traits<bool_column>::type_id: return visitor (get<bool_column>());
+			}
+#undef DF_COLUMN_VISIT
+			return visitor (get<bool>());
+		}
+
+	private:
+		//! \brief Type tag of the column.
+		short type_;
+		//! \brief Storage of the elements, shared between copies, null until first access.
+		std::shared_ptr < column_storage_base > storage_;
+		//! \brief Null elements, shared between copies.
+		column_validity validity_;
+	};
+
+}}}
+
+#endif
@@ -0,0 +1,143 @@
+//          Copyright(C) Rishabh Arora 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Index from the column headers of a data_frame to the positions of the columns,
+// also used from the values of a dictionary_column to their codes.
+
+#ifndef _BOOST_UBLAS_DF_COLUMN_INDEX_
+#define _BOOST_UBLAS_DF_COLUMN_INDEX_
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <boost/numeric/ublas/vector.hpp>
+
+namespace boost { namespace numeric { namespace ublas {
+
+	/*! \brief Open addressing hash table from column header to column position.
+	 *  Linear probing over a power of two number of slots, kept at most half full.
+	 *  The headers themselves are not stored: a slot holds the hash and the position,
+	 *  lookups compare against the headers of the data_frame, passed as \c keys
+	 *  (any container of strings with \c keys(i), a vector<std::string> or a string_column).
+	 */
+	class column_index {
+	public:
+		//! \brief Returned by \c find() for an unknown header.
+		static constexpr size_t npos = size_t(-1);
+
+		BOOST_UBLAS_INLINE
+		column_index ():
+			size_ (0) {}
+
+		//! \brief Returns the number of indexed headers.
+		BOOST_UBLAS_INLINE
+		size_t size() const {
+			return size_;
+		}
+
+		//! \brief Returns the position of header in keys, npos if it isn't indexed.
+		template < class K >
+		BOOST_UBLAS_INLINE
+		size_t find (const std::string_view header, const K& keys) const {
+			if (slots_.empty()) {
+				return npos;
+			}
+			const size_t h = hash (header);
+			const size_t mask = slots_.size() - 1;
+			for(size_t i = h & mask; slots_[i].position != npos; i = (i + 1) & mask) {
+				if (slots_[i].hash == h && keys (slots_[i].position) == header) {
+					return slots_[i].position;
+				}
+			}
+			return npos;
+		}
+
+		/*! \brief Indexes header at position.
+		 *  header must not be indexed already.
+		 */
+		BOOST_UBLAS_INLINE
+		void insert (const std::string_view header, const size_t position) {
+			if (2 * (size_ + 1) > slots_.size()) {
+				grow (slots_.empty() ? 16 : 2 * slots_.size());
+			}
+			place (hash (header), position);
+			++size_;
+		}
+
+		//! \brief Indexes the first n headers of keys, replacing the current content.
+		template < class K >
+		BOOST_UBLAS_INLINE
+		void rebuild (const K& keys, const size_t n) {
+			size_t capacity = 16;
+			while (capacity < 2 * n) {
+				capacity *= 2;
+			}
+			slots_.assign (capacity, slot());
+			size_ = 0;
+			for(size_t i = 0; i < n; ++i) {
+				insert (keys (i), i);
+			}
+		}
+
+		//! \brief Removes all the headers.
+		BOOST_UBLAS_INLINE
+		void clear () {
+			slots_.clear();
+			size_ = 0;
+		}
+
+		BOOST_UBLAS_INLINE
+		void swap (column_index& index) {
+			slots_.swap (index.slots_);
+			std::swap (size_, index.size_);
+		}
+
+	private:
+		struct slot {
+			slot ():
+				hash (0),
+				position (npos) {}
+			size_t hash;
+			size_t position;
+		};
+
+		//! \brief Slots of the table, empty if \c position == npos.
+		std::vector < slot > slots_;
+		//! \brief Number of used slots.
+		size_t size_;
+
+		static BOOST_UBLAS_INLINE
+		size_t hash (const std::string_view header) {
+			return std::hash < std::string_view > () (header);
+		}
+
+		BOOST_UBLAS_INLINE
+		void place (const size_t h, const size_t position) {
+			const size_t mask = slots_.size() - 1;
+			size_t i = h & mask;
+			while (slots_[i].position != npos) {
+				i = (i + 1) & mask;
+			}
+			slots_[i].hash = h;
+			slots_[i].position = position;
+		}
+
+		BOOST_UBLAS_INLINE
+		void grow (const size_t capacity) {
+			std::vector < slot > old (capacity);
+			old.swap (slots_);
+			for(size_t i = 0; i < old.size(); ++i) {
+				if (old[i].position != npos) {
+					place (old[i].hash, old[i].position);
+				}
+			}
+		}
+	};
+
+}}}
+
+#endif
@@ -71,4 +71,74 @@ struct column_header_mismatch : public std::exception {
    }
 };
 
+//! \brief thrown if the columns of an expression have different types.
+struct column_type_mismatch : public std::exception {
+   const char * what () const throw () {
+      return "column type mismatch in the expression";
+   }
+};
+
+//! \brief thrown if an operation is not defined for the type of a column.
+struct undefined_operation : public std::exception {
+   const char * what () const throw () {
+      return "operation not defined for the column type";
+   }
+};
+
+//! \brief thrown if the lower bound of a range is greater than its upper bound.
+struct inconsistent_bounds : public std::exception {
+   const char * what () const throw () {
+      return "lower bound greater than upper bound";
+   }
+};
+
+//! \brief thrown if a probability (quantile) is not in [0, 1].
+struct bad_probability : public std::exception {
+   const char * what () const throw () {
+      return "probability not in [0, 1]";
+   }
+};
+
+//! \brief thrown if a column_handle is used after columns were added to or erased from its data_frame.
+struct stale_column_handle : public std::exception {
+   const char * what () const throw () {
+      return "column handle used after a change of the data_frame columns";
+   }
+};
+
+//! \brief thrown if the characters of a string column don't fit in its offset type.
+struct offset_overflow : public std::exception {
+   const char * what () const throw () {
+      return "string column too large for its offset type";
+   }
+};
+
+//! \brief thrown if a file can't be opened or read.
+struct unreadable_file : public std::exception {
+   const char * what () const throw () {
+      return "file can't be opened or read";
+   }
+};
+
+//! \brief thrown if a file can't be created or written.
+struct unwritable_file : public std::exception {
+   const char * what () const throw () {
+      return "file can't be created or written";
+   }
+};
+
+//! \brief thrown if a file isn't in the format read, or is damaged.
+struct corrupt_file : public std::exception {
+   const char * what () const throw () {
+      return "file damaged or not in the expected format";
+   }
+};
+
+//! \brief thrown if a file uses a feature of its format that isn't supported.
+struct unsupported_file : public std::exception {
+   const char * what () const throw () {
+      return "file uses a feature that isn't supported";
+   }
+};
+
 #endif
\ No newline at end of file
@@ -10,16 +10,18 @@
  * 
  * - \link #boost::numeric::ublas::data_frame                    data_frame \endlink
  * - \link #boost::numeric::ublas::df_column            df_column \endlink
+ * - \link #boost::numeric::ublas::grouped_data_frame          grouped_data_frame \endlink
  * - \link #boost::numeric::ublas::data_frame_range                data_frame_range \endlink
  * - \link #boost::numeric::ublas::data_frame_slice               data_frame_slice \endlink
  * - \link #boost::numeric::ublas::data_frame_indirect            data_frame_indirect \endlink
+ * - \link #boost::numeric::ublas::data_frame_rows            data_frame_rows \endlink
  */
 
 #ifndef _BOOST_UBLAS_DATA_FRAME_
 #define _BOOST_UBLAS_DATA_FRAME_	
 
 #include <string>
-#include <map>
+#include <vector>
 #include <boost/variant.hpp>
 #include <boost/preprocessor/seq/elem.hpp>
 #include <boost/preprocessor/seq/for_each_product.hpp>
@@ -28,7 +30,18 @@
 #include <boost/lexical_cast.hpp>
 #include <boost/numeric/ublas/vector_proxy.hpp>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <iostream>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
 #include "./data_frame_exceptions.hpp"
+#include "./df_kernels.hpp"
+#include "./df_statistics.hpp"
 #include "./vector_proxy.cpp"
 
 // Basic allowed types for vectors
@@ -79,48 +92,89 @@ vector_slice
 // Variant of the inner types
 #define COLUMN_DATA_TYPES BOOST_PP_SEQ_ENUM(INNER_TYPE)
 
+#include "./column_buffer.hpp"
+#include "./column_index.hpp"
+#include "./group_table.hpp"
 
 namespace boost { namespace numeric { namespace ublas {
 	
-	// temporary vectors to be used by binary operators.
-	vector < bool > A0; vector < char > A1; vector < unsigned char > A2;
-	vector < short > A3; vector < unsigned short > A4; vector < int > A5; vector < unsigned int > A6;
-	vector < long > A7; vector < unsigned long > A8; vector < long long > A9; vector < unsigned long long > A10;
-	vector < float > A11; vector < double > A12; vector < long double > A13;
-	vector < std::string > A14; vector < std::string* > A15;
-	
 	class print_data_frame_column: public boost::static_visitor<void> {
 	public:
+		print_data_frame_column (const column_validity* validity = 0, std::ostream& out = std::cout): 
+			validity_ (validity), 
+			out_ (&out) {}
+
+		//! \brief Ends the line with '\n' rather than std::endl: the stream is flushed once, by the caller.
 		template < class T >
 		void operator () (const T& x_) const {
 			for(size_t i = 0; i < x_.size(); ++i) {
-				std::cout << x_ (i) << ' ';
+				if (validity_ != 0 && !validity_->is_valid(i)) {
+					*out_ << "NA" << ' ';
+				}
+				else {
+					*out_ << x_ (i) << ' ';
+				}
 			}
-			std::cout << std::endl;
+			*out_ << '\n';
 			return;
 		}
+
+	private:
+		//! \brief Null elements, printed as NA.
+		const column_validity* validity_;
+		std::ostream* out_;
+	};
+
+	//! \brief Order of a sort: ascending or descending.
+	enum class sort_order {
+		asc,
+		desc
+	};
+
+	//! \brief Sort key of data_frame::sort_by(): {"a", sort_order::desc}, ascending by default.
+	struct sort_key {
+		std::string column;
+		sort_order order = sort_order::asc;
 	};
 
 	//! Represents the column of a dataframe.
-	/*! Internally represented by boost::variant < COLUMN_TYPES > .
+	/*! Internally represented by a column_buffer: one contiguous, cache line aligned buffer and a type tag.
 	 *	Allowed types are: int, double, char, std::string...... (specified in INNER_TYPE).
 	 */
 	class df_column {
 	public:
 		//! \brief add 2 df_columns of same type.
-		friend df_column operator + (df_column& a, df_column& b);
+		friend df_column operator + (const df_column& a, const df_column& b);
 
 		//! \brief subtract 2 df_columns of same type.
-		friend df_column operator - (df_column& a, df_column& b);
+		friend df_column operator - (const df_column& a, const df_column& b);
 		
 		//! \brief add a constant value val to a column of same type.
-		template < class T > friend df_column operator + (df_column& a, const T& val);
+		template < class T > friend df_column operator + (const df_column& a, const T& val);
 		
 		//! \brief subtract a constant value val from a column of same type.
-		template < class T > friend df_column operator - (df_column& a, const T& val);
+		template < class T > friend df_column operator - (const df_column& a, const T& val);
 		
 		//! \brief multiply a constant value val to a column of same type.
-		template < class T > friend df_column operator * (df_column& a, const T& val);
+		template < class T > friend df_column operator * (const df_column& a, const T& val);
+
+		//! \brief divide a column by a constant value val.
+		template < class T > friend df_column operator / (const df_column& a, const T& val);
+
+		//! \brief write the sum of 2 df_columns of same type into out.
+		friend void column_add (const df_column& a, const df_column& b, df_column& out);
+
+		//! \brief write the difference of 2 df_columns of same type into out.
+		friend void column_subtract (const df_column& a, const df_column& b, df_column& out);
+
+		//! \brief write the bitwise and of 2 bool_columns into out.
+		friend void column_and (const df_column& a, const df_column& b, df_column& out);
+
+		//! \brief write the bitwise or of 2 bool_columns into out.
+		friend void column_or (const df_column& a, const df_column& b, df_column& out);
+
+		//! \brief write the bitwise xor of 2 bool_columns into out.
+		friend void column_xor (const df_column& a, const df_column& b, df_column& out);
 			
 		// ----------------------------
 		// Construction and Destruction
@@ -139,10 +193,11 @@ namespace boost { namespace numeric { namespace ublas {
 		 *  \param const lvalue reference to a vector of some type T.
 		 */ 
 		BOOST_UBLAS_INLINE
-		template < class T > 
-		df_column (const vector<T>& data) :
-			data_ (data), 
-			size_ (data.size()) {}
+		template < class T, class A > 
+		df_column (const vector<T, A>& data) :
+			size_ (0) {
+			assign (data);
+		}
 
 		/*! \brief Copy Constructor of df_column. 
 		 *	Copies the col into self.
@@ -150,28 +205,89 @@ namespace boost { namespace numeric { namespace ublas {
 		 */
 		BOOST_UBLAS_INLINE 
 		df_column (const df_column& col) :
-			data_ (col.data()), 
+			data_ (col.data_), 
 			size_ (col.size()) {}
 
 		/*! \brief Move Constructor of a df_column.
 		 *	Moves the vector into data_, T becomes the type of the column.
+		 *  O(1) for a column_vector<T>, vectors with another storage are copied.
 		 *  \param rvalue reference to a vector <T>, T: type of vector.
 		 */
 		BOOST_UBLAS_INLINE 
-		template < class T > 
-		df_column (const vector <T>&& data) {
-			data_ = std::move(data);
-			size_ = std::move(size_);
+		template < class T, class A > 
+		df_column (vector <T, A>&& data) :
+			size_ (0) {
+			assign (std::move(data));
 		} 
 
+		/*! \brief Constructor of df_column from a string column.
+		 *	Copies the strings, string_column (or large_string_column) becomes the type of the column.
+		 *  \param const lvalue reference to a string column.
+		 */
+		template < class O >
+		BOOST_UBLAS_INLINE
+		df_column (const basic_string_column<O>& data) :
+			size_ (0) {
+			assign_column (data);
+		}
+
+		/*! \brief Move Constructor of df_column from a string column, in O(1).
+		 *  \param rvalue reference to a string column.
+		 */
+		template < class O >
+		BOOST_UBLAS_INLINE
+		df_column (basic_string_column<O>&& data) :
+			size_ (0) {
+			take_column (data);
+		}
+
+		/*! \brief Constructor of df_column from a dictionary encoded column.
+		 *	dictionary_column becomes the type of the column, the dictionary is shared.
+		 *  \param const lvalue reference to a dictionary_column.
+		 */
+		BOOST_UBLAS_INLINE
+		df_column (const dictionary_column& data) :
+			size_ (0) {
+			assign_column (data);
+		}
+
+		/*! \brief Move Constructor of df_column from a dictionary encoded column, in O(1).
+		 *  \param rvalue reference to a dictionary_column.
+		 */
+		BOOST_UBLAS_INLINE
+		df_column (dictionary_column&& data) :
+			size_ (0) {
+			take_column (data);
+		}
+
+		/*! \brief Constructor of df_column from a bit-packed boolean column.
+		 *	bool_column becomes the type of the column.
+		 *  \param const lvalue reference to a bool_column.
+		 */
+		BOOST_UBLAS_INLINE
+		df_column (const bool_column& data) :
+			size_ (0) {
+			assign_column (data);
+		}
+
+		/*! \brief Move Constructor of df_column from a bit-packed boolean column, in O(1).
+		 *  \param rvalue reference to a bool_column.
+		 */
+		BOOST_UBLAS_INLINE
+		df_column (bool_column&& data) :
+			size_ (0) {
+			take_column (data);
+		}
+
 		/*! \brief Move Constructor of df_column. 
-		 *	Moves the col into self.
+		 *	Moves the col into self in O(1), col is left empty.
 		 *  \param rvalue reference to a df_column.
 		 */
 		BOOST_UBLAS_INLINE 
-		df_column (const df_column&& col) {
-			data_ = std::move(col.data());
-			size_ = std::move(col.size());
+		df_column (df_column&& col) noexcept :
+			data_ (std::move(col.data_)), 
+			size_ (col.size_) {
+			col.size_ = 0;
 		}
 
 		//! \brief Destructor of df_column. 
@@ -186,11 +302,10 @@ namespace boost { namespace numeric { namespace ublas {
 		 *	Copies the vector into data_, T becomes the type of the column.
 		 *  \param const lvalue reference to a vector <T>, T: type of vector.
 		 */  
-		template < class T >
+		template < class T, class A >
 		BOOST_UBLAS_INLINE 
-		df_column& operator = (const vector<T>& data) {
-			data_ = data;
-			size_ = data.size(); 
+		df_column& operator = (const vector<T, A>& data) {
+			assign (data);
 			return *this;
 		}
 
@@ -200,7 +315,7 @@ namespace boost { namespace numeric { namespace ublas {
 		 */ 
 		BOOST_UBLAS_INLINE
 		df_column& operator = (const df_column& col) {
-			data_  = col.data();
+			data_  = col.data_;
 			size_  = col.size();
 			return *this;
 		}
@@ -209,22 +324,65 @@ namespace boost { namespace numeric { namespace ublas {
 		 *	Moves the vector into data_, T becomes the type of the column.
 		 *  \param rvalue reference to a vector <T>, T: type of vector.
 		 */ 
-		template < class T >
+		template < class T, class A >
 		BOOST_UBLAS_INLINE 
-		df_column& operator = (const vector <T>&& data) {
-			data_ = std::move(data);
-			size_ = std::move(size_);
+		df_column& operator = (vector <T, A>&& data) {
+			assign (std::move(data));
+			return *this;
+		}
+
+		//! \brief Copy Assignment Operator of a df_column from a string column.
+		template < class O >
+		BOOST_UBLAS_INLINE
+		df_column& operator = (const basic_string_column<O>& data) {
+			assign_column (data);
+			return *this;
+		}
+
+		//! \brief Move Assignment Operator of a df_column from a string column, in O(1).
+		template < class O >
+		BOOST_UBLAS_INLINE
+		df_column& operator = (basic_string_column<O>&& data) {
+			take_column (data);
+			return *this;
+		}
+
+		//! \brief Copy Assignment Operator of a df_column from a dictionary encoded column.
+		BOOST_UBLAS_INLINE
+		df_column& operator = (const dictionary_column& data) {
+			assign_column (data);
+			return *this;
+		}
+
+		//! \brief Move Assignment Operator of a df_column from a dictionary encoded column, in O(1).
+		BOOST_UBLAS_INLINE
+		df_column& operator = (dictionary_column&& data) {
+			take_column (data);
+			return *this;
+		}
+
+		//! \brief Copy Assignment Operator of a df_column from a bit-packed boolean column.
+		BOOST_UBLAS_INLINE
+		df_column& operator = (const bool_column& data) {
+			assign_column (data);
+			return *this;
+		}
+
+		//! \brief Move Assignment Operator of a df_column from a bit-packed boolean column, in O(1).
+		BOOST_UBLAS_INLINE
+		df_column& operator = (bool_column&& data) {
+			take_column (data);
 			return *this;
 		}
 
 		/*! \brief Move Assignment operator of df_column. 
-		 *	Copies the col into self.
+		 *	Moves the col into self in O(1).
 		 *  \param rvalue reference to a df_column.
 		 */
 		BOOST_UBLAS_INLINE 
-		df_column& operator = (const df_column&& col) {
-			data_ = std::move(col.data());
-			size_ = std::move(col.size());
+		df_column& operator = (df_column&& col) noexcept {
+			data_.swap (col.data_);
+			std::swap (size_, col.size_);
 			return *this;
 		}	
 
@@ -234,51 +392,96 @@ namespace boost { namespace numeric { namespace ublas {
 
 		/*! \brief Addition to df_column.
 		 *	Adds x to self if the \c x.type() == \c self.type()  and \c x.size() == \c self.size().
-		 *  \param lvalue reference to a df_column.
+		 *  Computed in place, the buffer of self is reused.
+		 *  \param const lvalue reference to a df_column.
 		 */
 		BOOST_UBLAS_INLINE
-		df_column operator += (df_column& x) {
-			(*this) = (*this) + x;
+		df_column& operator += (const df_column& x) {
+			column_add (*this, x, *this);
 			return *this;
 		}
 
 		/*! \brief Subtraction from df_column.
 		 *	Subtracts x from self if the \c x.type() == \c self.type()  and \c x.size() == \c self.size().
-		 *  \param lvalue reference to a df_column.
+		 *  Computed in place, the buffer of self is reused.
+		 *  \param const lvalue reference to a df_column.
 		 */
 		BOOST_UBLAS_INLINE
-		df_column operator -= (df_column& x) {
-			return (*this) = (*this) - x;
+		df_column& operator -= (const df_column& x) {
+			column_subtract (*this, x, *this);
+			return *this;
 		}
 
 		/*! \brief Addition to df_column.
 		 *	Adds val to self if the \c x.type() == T.
+		 *  Computed in place, the buffer of self is reused.
 		 *  \param const lvalue reference to a value.
 		 */
-		BOOST_UBLAS_INLINE
 		template < class T > 
-		df_column operator += (const T& val) {
-			return (*this) = (*this) + val;
+		BOOST_UBLAS_INLINE
+		df_column& operator += (const T& val) {
+			column_add (*this, val, *this);
+			return *this;
 		}
 
 		/*! \brief Subtraction from df_column.
 		 *	Subtracts val from self if the \c x.type() == T.
+		 *  Computed in place, the buffer of self is reused.
 		 *  \param const lvalue reference to a value.
 		 */
-		BOOST_UBLAS_INLINE
 		template < class T > 
-		df_column operator -= (const T& val) {
-			return (*this) = (*this) - val;
+		BOOST_UBLAS_INLINE
+		df_column& operator -= (const T& val) {
+			column_subtract (*this, val, *this);
+			return *this;
 		}
 
 		/*! \brief Multiplication to df_column.
 		 *	Multiplies val to self if the \c x.type() == T.
+		 *  Computed in place, the buffer of self is reused.
 		 *  \param const lvalue reference to a value.
 		 */
+		template < class T > 
 		BOOST_UBLAS_INLINE
+		df_column& operator *= (const T& val) {
+			column_multiply (*this, val, *this);
+			return *this;
+		}
+
+		/*! \brief Division of df_column.
+		 *	Divides self by val if the \c x.type() == T.
+		 *  Computed in place, the buffer of self is reused.
+		 *  \param const lvalue reference to a value.
+		 */
 		template < class T > 
-		df_column operator *= (const T& val) {
-			return (*this) = (*this) * val;
+		BOOST_UBLAS_INLINE
+		df_column& operator /= (const T& val) {
+			column_divide (*this, val, *this);
+			return *this;
+		}
+
+		/*! \brief Bitwise and with a bool_column.
+		 *  Computed in place a word at a time, the buffer of self is reused.
+		 *  \param const lvalue reference to a df_column of type bool_column.
+		 */
+		BOOST_UBLAS_INLINE
+		df_column& operator &= (const df_column& x) {
+			column_and (*this, x, *this);
+			return *this;
+		}
+
+		//! \brief Bitwise or with a bool_column, computed in place.
+		BOOST_UBLAS_INLINE
+		df_column& operator |= (const df_column& x) {
+			column_or (*this, x, *this);
+			return *this;
+		}
+
+		//! \brief Bitwise xor with a bool_column, computed in place.
+		BOOST_UBLAS_INLINE
+		df_column& operator ^= (const df_column& x) {
+			column_xor (*this, x, *this);
+			return *this;
 		}
 
 		// ---------
@@ -291,10 +494,10 @@ namespace boost { namespace numeric { namespace ublas {
 			return size_;
 		}	
 
-		//! \brief Returns the 0 - based index of the type of column vector in boost::variant < COLUMN_TYPES >. 
+		//! \brief Returns the 0 - based index of the type of column vector in INNER_TYPE. 
 		BOOST_UBLAS_INLINE
 		const short type() const {
-			return data_.which();
+			return data_.type();
 		}
 		
 		// -----------------
@@ -303,1051 +506,3396 @@ namespace boost { namespace numeric { namespace ublas {
 
 		//! \brief Returns the data_ variable.
 		BOOST_UBLAS_INLINE
-		const boost::variant < COLUMN_TYPES > data() const {
+		const column_buffer& data() const {
 			return data_;
 		} 
 
-		/*! \brief Returns the df_column as vector<T>.
+		/*! \brief Returns the df_column as column_vector<T> (or as T for a string_column).
  		 *  T should be same as the type of the df_column.
  		 */
 		template < class T >
 		BOOST_UBLAS_INLINE 
-		vector<T>& get() {
-			return boost::get<vector<T>>(data_); 
+		typename column_traits<T>::storage_type& get() {
+			return data_.get<T>(); 
 		}
 
-		/*! \brief Returns the i-th element of df_column.
+		/*! \brief Returns the df_column as const column_vector<T> (or as const T for a string_column).
+ 		 *  T should be same as the type of the df_column.
+ 		 */
+		template < class T >
+		BOOST_UBLAS_INLINE 
+		const typename column_traits<T>::storage_type& get() const {
+			return data_.get<T>(); 
+		}
+
+		/*! \brief Returns a typed view over the buffer of the df_column.
+ 		 *  T should be same as the type of the df_column.
+ 		 */
+		template < class T >
+		BOOST_UBLAS_INLINE 
+		column_view<T> view() {
+			return data_.view<T>(); 
+		}
+
+		/*! \brief Returns a typed view over the buffer of the df_column.
  		 *  T should be same as the type of the df_column.
  		 */
+		template < class T >
+		BOOST_UBLAS_INLINE 
+		column_view<const T> view() const {
+			return data_.view<T>(); 
+		}
+
+		/*! \brief Hands the buffer of v over to the df_column, without copy.
+		 *  T becomes the type of the column, v is left empty.
+		 */
+		template < class T >
+		BOOST_UBLAS_INLINE 
+		void adopt(column_vector<T>& v) {
+			column_vector<T>& b = data_.reset<T>();
+			b.swap (v);
+			size_ = b.size();
+		}
+
+		//! \brief Hands the buffer of v over to the df_column, without copy.
+		template < class T >
+		BOOST_UBLAS_INLINE 
+		void adopt(column_vector<T>&& v) {
+			adopt (v);
+		}
+
+		/*! \brief Hands the buffer of the df_column over to v, without copy.
+		 *  T should be same as the type of the df_column, the column is left empty
+		 *  and the previous content of v is discarded.
+		 */
+		template < class T >
+		BOOST_UBLAS_INLINE 
+		void release(column_vector<T>& v) {
+			v.swap (data_.get<T>());
+			data_.reset<T>();
+			size_ = 0;
+		}
+
+		/*! \brief Makes the df_column a column of T of n elements without null and returns its storage.
+		 *  The buffer is reused if the column already is a column of T of size n,
+		 *  so a column can be used as the output of a kernel without reallocation.
+		 *  A buffer shared with other columns is replaced, never copied.
+		 */
+		template < class T >
+		BOOST_UBLAS_INLINE 
+		typename column_traits<T>::storage_type& resize(const size_t n) {
+			typename column_traits<T>::storage_type& v = (data_.holds<T>() && data_.unique()) ? data_.get<T>() : data_.reset<T>();
+			data_.validity().clear();
+			if (v.size() != n) {
+				v.resize(n, false);
+			}
+			size_ = n;
+			return v;
+		}
+
+		/*! \brief Returns the storage resize<T>() would replace, null if it would reuse it.
+		 *  A kernel whose input may be this column holds it until done: the input stays alive once the
+		 *  column has a new storage, and stays shared, so that the other columns sharing it don't write
+		 *  it in place meanwhile (see column_buffer::unique()).
+		 */
+		template < class T >
+		BOOST_UBLAS_INLINE
+		std::shared_ptr < const void > hold() const {
+			return (data_.holds<T>() && data_.unique()) ? nullptr : data_.storage();
+		}
+
+		//! \brief Applies a boost::static_visitor to the column vector.
+		template < class V >
+		BOOST_UBLAS_INLINE
+		typename V::result_type apply_visitor(const V& visitor) const {
+			return data_.apply_visitor (visitor);
+		}
+
+		/*! \brief Returns the i-th element of df_column.
+ 		 *  T should be same as the type of the df_column, a std::string_view for a string_column.
+ 		 */
+		template < class T > 
+		BOOST_UBLAS_INLINE
+		typename column_traits<T>::reference eval(const size_t& i) {
+			return data_.get<T>()(i);
+		}
+
+		/*! \brief Returns the i-th element of df_column.
+ 		 *  T should be same as the type of the df_column, a std::string_view for a string_column.
+ 		 */
 		template < class T > 
 		BOOST_UBLAS_INLINE
-		T& eval(const size_t& i) {
-			return boost::get<vector<T>>(data_)(i);
+		typename column_traits<T>::const_reference eval(const size_t& i) const {
+			return data_.get<T>()(i);
 		}
 
 		//! \brief Print the contents of df_column in a single line.
 		BOOST_UBLAS_INLINE
-		void print() {
-			boost::apply_visitor (print_data_frame_column{}, data_);
+		void print(std::ostream& out = std::cout) {
+			data_.apply_visitor (print_data_frame_column (&data_.validity(), out));
+			out.flush();
 		}
 		
 		// ---------------------
 		// Statistical Summaries
 		// ---------------------
 
-		//! \brief Returns the minimum element of the column vector. 
+		//! \brief Returns the minimum element of the column vector, nulls are skipped. 
 		template < class T1, class T2 > 
 		BOOST_UBLAS_INLINE 
-		T2 Min () {
-			T2 Minimum = get<T1> ()(0);
-			for(size_t i = 1; i < size_; ++i) {
-				if (get <T1> ()(i) < Minimum) {
-					Minimum = (T2)get<T1>()(i);
+		T2 Min () const {
+			T1 m = T1();
+			bool found = false;
+			for_each_valid_run <T1> ([&m, &found] (const T1* x, const size_t k) {
+				const T1 r = simd::reduce_min (x, k);
+				if (!found || r < m) {
+					m = r;
 				}
-			}	
-			return Minimum;
+				found = true;
+			});
+			return (T2) m;
 		}
 
-		//! \brief Returns the maximum element of the column vector.
+		//! \brief Returns the maximum element of the column vector, nulls are skipped.
 		template < class T1, class T2> 
 		BOOST_UBLAS_INLINE 
-		T2 Max () {
-			T2 Maximum = get<T1>()(0);
-			for(size_t i = 1; i < size_; ++i) {
-				if (get<T1>()(i) > Maximum) {
-					Maximum = (T2) get<T1>()(i);
+		T2 Max () const {
+			T1 m = T1();
+			bool found = false;
+			for_each_valid_run <T1> ([&m, &found] (const T1* x, const size_t k) {
+				const T1 r = simd::reduce_max (x, k);
+				if (!found || m < r) {
+					m = r;
 				}
-			}	
-			return Maximum;
+				found = true;
+			});
+			return (T2) m;
+		}
+
+		//! \brief Returns the sum of the column vector, accumulated in T2, nulls are skipped.
+		template < class T1, class T2 >
+		BOOST_UBLAS_INLINE
+		T2 Sum() const {
+			T2 sum = T2();
+			for_each_valid_run <T1> ([&sum] (const T1* x, const size_t k) {
+				sum += simd::reduce_sum <T2> (x, k);
+			});
+			return sum;
 		}
 
-		//! \brief Returns the mean of the column vector.
+		/*! \brief Returns the mean of the column vector, nulls are skipped.
+		 *  Terminates with undefined_operation if the column is empty or all null.
+		 */
 		template < class T1, class T2 >
 		BOOST_UBLAS_INLINE
-		T2 Mean() {
-			T2 sum = 0;
-			for(size_t i = 0; i < size_; ++i) {
-				sum += (T2) get<T1>()(i);
+		T2 Mean() const {
+			try {
+				const size_t n = size_ - null_count();
+				if (n == 0) {
+					throw undefined_operation();
+				}
+				return (T2) (Sum <T1, T2>() / n);
 			}
-			return (T2) (sum / size_);
+			catch (std::exception& e) {
+				std::terminate();
+			}
+		}
+
+		/*! \brief Returns the q-quantile of the column vector, 0 <= q <= 1.
+		 *  Linear interpolation between order statistics (R's default), found by selection in O(n)
+		 *  on a copy of the column. Nulls are skipped.
+		 */
+		template < class T1, class T2 >
+		BOOST_UBLAS_INLINE
+		T2 quantile(const double q) const {
+			return quantiles <T1, T2> (std::vector<double> (1, q))(0);
 		}
 
-		//! \brief Returns the median element of the column vector.
+		/*! \brief Returns the quantiles qs of the column vector, 0 <= qs(i) <= 1.
+		 *  All the quantiles share a single copy of the valid elements and one partitioning pass.
+		 */
 		template < class T1, class T2 >
 		BOOST_UBLAS_INLINE
-		T2 Median() {
-			vector<T1> v = get<T1>();
-			std::sort(v.begin(), v.end());
-			if (v.size() & 1) {
-				return (T2)v[v.size()/2];
+		vector<T2> quantiles(const std::vector<double>& qs) const {
+			try {
+				const size_t n = size_ - null_count();
+				if (n == 0) {
+					throw undefined_operation();
+				}
+				for(size_t i = 0; i < qs.size(); ++i) {
+					if (!(qs[i] >= 0 && qs[i] <= 1)) {
+						throw bad_probability();
+					}
+				}
+				unbounded_array<T1> x (n);
+				T1* out = x.begin();
+				for_each_valid_run <T1> ([&out] (const T1* v, const size_t k) {
+					out = std::copy (v, v + k, out);
+				});
+				std::vector<T2> q = select_quantiles <T2> (x.begin(), n, qs);
+				vector<T2> ret (q.size());
+				std::copy (q.begin(), q.end(), ret.begin());
+				return ret;
 			}
-			else {
-				return ((T2)(v[v.size()/2-1] + v[v.size()/2]) / 2);
+			catch (std::exception& e) {
+				std::terminate();
 			}
 		}
 
-		//! \brief Prints Minimum, Maximum, Mean, Median of a column vector.
+		//! \brief Returns the median element of the column vector, nulls are skipped.
+		template < class T1, class T2 >
+		BOOST_UBLAS_INLINE
+		T2 Median() const {
+			return quantile <T1, T2> (0.5);
+		}
+
+		/*! \brief Returns a t-digest of the column vector, for approximate quantiles in bounded memory.
+		 *  The column is read once and not copied, digests of several columns can be merged.
+		 *  Nulls are skipped.
+		 */
+		template < class T1 >
 		BOOST_UBLAS_INLINE
+		tdigest digest(const double compression = 100) const {
+			tdigest d (compression);
+			for_each_valid_run <T1> ([&d] (const T1* x, const size_t k) {
+				d.push (x, k);
+			});
+			return d;
+		}
+
+		/*! \brief Returns count, Minimum, Maximum, Sum, Mean and Variance of a column vector.
+		 *  Computed in a single pass over the data, nulls are skipped.
+		 *  T1: type of the column, T2: type of the statistics.
+		 */
 		template <class T1, class T2>
-		void summary() {
-			std::cout << "Min. : " << Min <T1, T2>()  << ", ";
-			std::cout << "Max. : " << Max <T1, T2>()  << ", ";
-			std::cout << "Mean : " << Mean <T1, T2>() << ", ";
-			std::cout << "Median : " << Median <T1, T2>() << "  ";
-			std::cout << std::endl;	 
+		BOOST_UBLAS_INLINE
+		column_summary<T2> summary() const {
+			column_summary<T2> s;
+			for_each_valid_run <T1> ([&s] (const T1* x, const size_t k) {
+				s.push (x, k);
+			});
+			return s;
+		}
+
+		// -------
+		// Sorting
+		// -------
+
+		/*! \brief Returns the permutation sorting the column: row argsort()(0) first ...
+		 *  Radix sort for the integer, floating point, bool and dictionary columns, always stable,
+		 *  comparison sort for the others, stable if \c stable is \c true. Nulls come last.
+		 */
+		BOOST_UBLAS_INLINE
+		std::vector < size_t > argsort(const sort_order order = sort_order::asc, const bool stable = false) const;
+
+		// --------------
+		// Missing Values
+		// --------------
+
+		//! \brief Returns the validity (null elements) of the column.
+		BOOST_UBLAS_INLINE
+		const column_validity& validity() const {
+			return data_.validity();
+		}
+
+		//! \brief Sets the validity (null elements) of the column, of the same size as the column.
+		BOOST_UBLAS_INLINE
+		void set_validity(const column_validity& v) {
+			try {
+				if (v.bits() != 0 && v.bits()->size() != size_) {
+					throw unequal_rows();
+				}
+				data_.validity() = v;
+			}
+			catch (std::exception& e) {
+				std::terminate();
+			}
+		}
+
+		//! \brief Returns the number of null elements.
+		BOOST_UBLAS_INLINE
+		size_t null_count() const {
+			return data_.validity().null_count();
+		}
+
+		//! \brief Returns \c true if some elements are null.
+		BOOST_UBLAS_INLINE
+		bool has_nulls() const {
+			return data_.validity().has_nulls();
+		}
+
+		//! \brief Returns \c true if the i-th element is null.
+		BOOST_UBLAS_INLINE
+		bool is_null(const size_t i) const {
+			return !data_.validity().is_valid (i);
+		}
+
+		//! \brief Makes the i-th element null (or valid again if \c null is \c false).
+		BOOST_UBLAS_INLINE
+		void set_null(const size_t i, const bool null = true) {
+			try {
+				if (i >= size_) {
+					throw bad_index();
+				}
+				data_.validity().set_valid (i, size_, !null);
+			}
+			catch (std::exception& e) {
+				std::terminate();
+			}
 		}
 
 	private:
 		//! \brief Stores the data in df_column. 
-		boost::variant < COLUMN_TYPES > data_;
+		column_buffer data_;
 		//! \brief Stores the size of the column vector.
 		size_t size_;
-	};			
-						
-	//! \brief Returns the negation of the column if exists. 
-	BOOST_UBLAS_INLINE
-	df_column operator - (df_column& a) {	
-		df_column X;
-		switch (a.type()) {
-			case 0: 
-				A0 = -a.get<bool>();
-				return X = A0;
-			case 3: 
-				A3 = -a.get<short>();
-				X = A3;
-				return X;
-			case 4: 
-				A4 = -a.get<unsigned short>();
-				X = A4;
-				return X;
-			case 5: 
-				A5 = -a.get<int>();
-				X = A5;
-				return X;
-			case 6: 
-				A6 = -a.get<unsigned int>();
-				X = A6;
-				return X;
-			case 7: 
-				A7 = -a.get<long>();
-				X = A7;
-				return X;
-			case 8: 
-				A8 = -a.get<unsigned long>();
-				X = A8;
-				return X;
-			case 9: 
-				A9 = -a.get<long long>();
-				X = A9;
-				return X;
-			case 10: 
-				A10 = -a.get<unsigned long long>();
-				X = A10;
-				return X;
-			case 11: 
-				A11 = -a.get<float>();
-				X = A11;
-				return X;
-			case 12: 
-				A12 = -a.get<double>();
-				X = A12;
-				return X;
-			case 13: 
-				A13 = -a.get<long double>();
-				X = A13;
-				return X;
+
+		/*! \brief Calls fn(x, k) on the runs of valid elements of the column.
+		 *  A single call on the whole buffer if the column has no null.
+		 */
+		template < class T, class F >
+		BOOST_UBLAS_INLINE
+		void for_each_valid_run (F fn) const {
+			const T* x = get<T>().data().begin();
+			for_each_set_run (data_.validity().bits(), size_, [x, &fn] (const size_t i, const size_t k) {
+				fn (x + i, k);
+			});
 		}
-	}
 
-	//! \brief Returns a df_column as sum of 2 df_columns.
-	BOOST_UBLAS_INLINE
-	df_column operator + (df_column& a, df_column& b) {	
-		df_column X;
-		switch (a.type()) {
-			case 0: 
-				A0 = a.get<bool>() + b.get<bool>();
-				X = A0;
-				return X;
-			case 3: 
-				A3 = a.get<short>() + b.get<short>();
-				X = A3;
-				return X;
-			case 4: 
-				A4 = a.get<unsigned short>() + b.get<unsigned short>();
-				X = A4;
-				return X;
-			case 5: 
-				A5 = a.get<int>() + b.get<int>();
-				X = A5;
-				return X;
-			case 6: 
-				A6 = a.get<unsigned int>() + b.get<unsigned int>();
-				X = A6;
-				return X;
-			case 7: 
-				A7 = a.get<long>() + b.get<long>();
-				X = A7;
-				return X;
-			case 8: 
-				A8 = a.get<unsigned long>() + b.get<unsigned long>();
-				X = A8;
-				return X;
-			case 9: 
-				A9 = a.get<long long>() + b.get<long long>();
-				X = A9;
-				return X;
-			case 10: 
-				A10 = a.get<unsigned long long>() + b.get<unsigned long long>();
-				X = A10;
-				return X;
-			case 11: 
-				A11 = a.get<float>() + b.get<float>();
-				X = A11;
-				return X;
-			case 12: 
-				A12 = a.get<double>() + b.get<double>();
-				X = A12;
-				return X;
-			case 13: 
-				A13 = a.get<long double>() + b.get<long double>();
-				X = A13;
-				return X;
+		//! \brief Copies the vector into a buffer of the same type.
+		template < class T, class A >
+		BOOST_UBLAS_INLINE
+		void assign (const vector<T, A>& data) {
+			column_vector<T>& v = resize<T> (data.size());
+			std::copy (data.begin(), data.end(), v.begin());
 		}
-	}
 
-	//! \brief Returns a df_column as difference of 2 df_columns.
-	BOOST_UBLAS_INLINE
-	df_column operator - (df_column& a, df_column& b) {	
-		df_column X;
-		switch (a.type()) {
-			case 0: 
-				A0 = a.get<bool>() - b.get<bool>();
-				X = A0;
-				return X;
-			case 3: 
-				A3 = a.get<short>() - b.get<short>();
-				X = A3;
-				return X;
-			case 4: 
-				A4 = a.get<unsigned short>() - b.get<unsigned short>();
-				X = A4;
-				return X;
-			case 5: 
-				A5 = a.get<int>() - b.get<int>();
-				X = A5;
-				return X;
-			case 6: 
-				A6 = a.get<unsigned int>() - b.get<unsigned int>();
-				X = A6;
-				return X;
-			case 7: 
-				A7 = a.get<long>() - b.get<long>();
-				X = A7;
-				return X;
-			case 8: 
-				A8 = a.get<unsigned long>() - b.get<unsigned long>();
-				X = A8;
-				return X;
-			case 9: 
-				A9 = a.get<long long>() - b.get<long long>();
-				X = A9;
-				return X;
-			case 10: 
-				A10 = a.get<unsigned long long>() - b.get<unsigned long long>();
-				X = A10;
-				return X;
-			case 11: 
-				A11 = a.get<float>() - b.get<float>();
-				X = A11;
-				return X;
-			case 12: 
-				A12 = a.get<double>() - b.get<double>();
-				X = A12;
-				return X;
-			case 13: 
-				A13 = a.get<long double>() - b.get<long double>();
-				X = A13;
-				return X;
+		//! \brief Moves the vector into the buffer, copies it if its storage is not a column_array.
+		template < class T, class A >
+		BOOST_UBLAS_INLINE
+		void assign (vector<T, A>&& data) {
+			if constexpr (std::is_same < A, column_array<T> >::value) {
+				adopt (data);
+			}
+			else {
+				assign (data);
+			}
 		}
-	}
 
-	//! \brief Returns a df_column as sum of a df_column and a constant value.
-	BOOST_UBLAS_INLINE
-	template < class T > 
-	df_column operator + (df_column& a, const T& val) {
-		df_column X;
-		for(size_t i = 0; i < a.size(); ++i) {
-			switch (a.type()) {
-				case 0: 
-					if (i == 0) {
-						A0.resize(a.size());
-					}
-					A0(i) = a.get<bool>()(i) + val;
-					if (i == a.size()-1) {
-						X = A0;
-						A0.resize(0);
-						return X;
-					}
-				break;
-				case 3:
-					if (i == 0) {
-						A3.resize(a.size());
-					} 
-					A3(i) = a.get<short>()(i) + val;
-					if (i == a.size()-1) {
-						X = A3;
-						A3.resize(0);
-						return X;
-					}
-				break;
-				case 4: 
-					if (i == 0) {
-						A4.resize(a.size());
-					}
-					A4(i) = a.get<unsigned short>()(i) + val;
-					if (i == a.size()-1) {
-						X = A4;
-						A4.resize(0);
-						return X;
-					}
-				break;
-				case 5: 
-					if (i == 0) {
-						A5.resize(a.size());
-					}
-					A5(i) = a.get<int>()(i) + val;
-					if (i == a.size()-1) {
-						X = A5;
-						A5.resize(0);
-						return X;
-					}
-				break;
-				case 6:
-					if (i == 0) {
-						A6.resize(a.size());
-					} 
-					A6(i) = a.get<unsigned int>()(i) + val;
-					if (i == a.size()-1) {
-						X = A6;
-						A6.resize(0);
-						return X;
-					}
-				break;
-				case 7:
-					if (i == 0) {
-						A7.resize(a.size());
-					} 
-					A7(i) = a.get<long>()(i) + val;
-					if (i == a.size()-1) {
-						X = A7;
-						A7.resize(0);
-						return X;
-					}
-				break;
-				case 8: 
-					if (i == 0) {
-						A8.resize(a.size());
-					}
-					A8(i) = a.get<unsigned long>()(i) + val;
-					if (i == a.size()-1) {
-						X = A8;
-						A8.resize(0);
-						return X;
-					}
-				break;
-				case 9:
-					if (i == 0) {
-						A9.resize(a.size());
-					} 
-					A9(i) = a.get<long long>()(i) + val;
-					if (i == a.size()-1) {
-						X = A9;
-						A9.resize(0);
-						return X;
-					}
-				break;
-				case 10:
-					if (i == 0) {
-						A10.resize(a.size());
-					} 
-					A10(i) = a.get<unsigned long long>()(i) + val;
-					if (i == a.size()-1) {
-						X = A10;
-						A10.resize(0);
-						return X;
-					}
-				break;
-				case 11:
-					if (i == 0) {
-						A11.resize(a.size());
-					} 
-					A11(i) = a.get<float>()(i) + val;
-					if (i == a.size()-1) {
-						X = A11;
-						A11.resize(0);
-						return X;
-					}
-				break;
-				case 12:
-					if (i == 0) {
-						A12.resize(a.size());
-					} 
-					A12(i) = a.get<double>()(i) + val;
-					if (i == a.size()-1) {
-						X = A12;
-						A12.resize(0);
-						return X;
-					}
-				break;
-				case 13:
-					if (i == 0) {
-						A13.resize(a.size());
-					} 
-					A13(i) = a.get<long double>()(i) + val;
-					if (i == a.size()-1) {
-						X = A13;
-						A13.resize(0);
-						return X;
-					}
-				break;
+		//! \brief Copies a string or dictionary column into a buffer of its type.
+		template < class S >
+		BOOST_UBLAS_INLINE
+		void assign_column (const S& data) {
+			data_.reset < S >() = data;
+			size_ = data.size();
+		}
+
+		//! \brief Moves a string or dictionary column into a buffer of its type, data is left empty.
+		template < class S >
+		BOOST_UBLAS_INLINE
+		void take_column (S& data) {
+			S& c = data_.reset < S >();
+			c.swap (data);
+			size_ = c.size();
+		}
+	};			
+						
+	// ----------------
+	// Column Visitors
+	// ----------------
+
+	/*! \brief Writes F(x) into a df_column.
+	 *  F is a ublas scalar unary functor (scalar_negate ...).
+	 */
+	template < template < class > class F >
+	class column_unary_visitor: public boost::static_visitor<void> {
+	public:
+		BOOST_UBLAS_INLINE
+		column_unary_visitor (df_column& out): 
+			out_ (out) {}
+
+		template < class T >
+		BOOST_UBLAS_INLINE
+		typename std::enable_if < is_numeric_column<T>::value >::type
+		operator () (const column_vector<T>& x) const {
+			const size_t n = x.size();
+			const std::shared_ptr < const void > keep = out_.hold<T>();
+			column_vector<T>& out = out_.resize<T>(n);
+			kernel::apply_unary < F<T> > (x.data().begin(), out.data().begin(), n);
+		}
+
+		//! \brief Columns of non numeric types (std::string, string_column ...).
+		template < class C >
+		BOOST_UBLAS_INLINE
+		void operator () (const C&) const {
+			throw undefined_operation();
+		}
+
+	private:
+		df_column& out_;
+	};
+
+	/*! \brief Writes F(x, y) into a df_column, x and y being columns of same type.
+	 *  F is a ublas scalar binary functor (scalar_plus, scalar_minus ...).
+	 */
+	template < template < class, class > class F >
+	class column_binary_visitor: public boost::static_visitor<void> {
+	public:
+		BOOST_UBLAS_INLINE
+		column_binary_visitor (const df_column& y, df_column& out): 
+			y_ (y), 
+			out_ (out) {}
+
+		template < class T >
+		BOOST_UBLAS_INLINE
+		typename std::enable_if < is_numeric_column<T>::value >::type
+		operator () (const column_vector<T>& x) const {
+			const size_t n = x.size();
+			const std::shared_ptr < const void > keep = out_.hold<T>();
+			const column_vector<T>& y = y_.get<T>();
+			column_vector<T>& out = out_.resize<T>(n);
+			kernel::apply_binary < F<T, T> > (x.data().begin(), y.data().begin(), out.data().begin(), n);
+		}
+
+		//! \brief Columns of non numeric types (std::string, string_column ...).
+		template < class C >
+		BOOST_UBLAS_INLINE
+		void operator () (const C&) const {
+			throw undefined_operation();
+		}
+
+	private:
+		const df_column& y_;
+		df_column& out_;
+	};
+
+	/*! \brief Writes F(x, val) into a df_column, val being a constant value.
+	 *  F is a ublas scalar binary functor (scalar_plus, scalar_multiplies ...).
+	 */
+	template < template < class, class > class F, class S >
+	class column_scalar_visitor: public boost::static_visitor<void> {
+	public:
+		BOOST_UBLAS_INLINE
+		column_scalar_visitor (const S& val, df_column& out): 
+			val_ (val), 
+			out_ (out) {}
+
+		template < class T >
+		BOOST_UBLAS_INLINE
+		typename std::enable_if < is_numeric_column<T>::value >::type
+		operator () (const column_vector<T>& x) const {
+			const size_t n = x.size();
+			const std::shared_ptr < const void > keep = out_.hold<T>();
+			column_vector<T>& out = out_.resize<T>(n);
+			kernel::apply_scalar < F<T, S> > (x.data().begin(), val_, out.data().begin(), n);
+		}
+
+		//! \brief Columns of non numeric types (std::string, string_column ...).
+		template < class C >
+		BOOST_UBLAS_INLINE
+		void operator () (const C&) const {
+			throw undefined_operation();
+		}
+
+	private:
+		const S& val_;
+		df_column& out_;
+	};
+
+	//! \brief Writes x clamped to [lo, hi] into a df_column.
+	template < class S >
+	class column_clamp_visitor: public boost::static_visitor<void> {
+	public:
+		BOOST_UBLAS_INLINE
+		column_clamp_visitor (const S& lo, const S& hi, df_column& out): 
+			lo_ (lo), 
+			hi_ (hi), 
+			out_ (out) {}
+
+		template < class T >
+		BOOST_UBLAS_INLINE
+		typename std::enable_if < is_numeric_column<T>::value >::type
+		operator () (const column_vector<T>& x) const {
+			const size_t n = x.size();
+			const std::shared_ptr < const void > keep = out_.hold<T>();
+			column_vector<T>& out = out_.resize<T>(n);
+			kernel::clamp_scalar (x.data().begin(), lo_, hi_, out.data().begin(), n);
+		}
+
+		//! \brief Columns of non numeric types (std::string, string_column ...).
+		template < class C >
+		BOOST_UBLAS_INLINE
+		void operator () (const C&) const {
+			throw undefined_operation();
+		}
+
+	private:
+		const S& lo_;
+		const S& hi_;
+		df_column& out_;
+	};
+
+	/*! \brief Writes the mask Op(x, val) into a df_column of bool_column.
+	 *  Op is a simd comparison (simd::less ...), val a constant value.
+	 */
+	template < class Op, class S >
+	class column_compare_scalar_visitor: public boost::static_visitor<void> {
+	public:
+		BOOST_UBLAS_INLINE
+		column_compare_scalar_visitor (const S& val, df_column& out): 
+			val_ (val), 
+			out_ (out) {}
+
+		//! \brief Arithmetic columns: vector kernel if T holds val exactly.
+		template < class T >
+		BOOST_UBLAS_INLINE
+		typename std::enable_if < std::is_arithmetic<T>::value && std::is_arithmetic<S>::value >::type
+		operator () (const column_vector<T>& x) const {
+			const size_t n = x.size();
+			const std::shared_ptr < const void > keep = out_.hold<bool_column>();
+			bool_column& out = out_.resize<bool_column>(n);
+			T v;
+			if (kernel::exact_cast (val_, v)) {
+				simd::compare_scalar < Op > (x.data().begin(), v, out.words(), n);
+			}
+			else {
+				// val out of the range of T or fractional: compare exactly in long double
+				const long double w = static_cast<long double> (val_);
+				const T* p = x.data().begin();
+				kernel::pack_bits (n, out.words(), [p, w] (const size_t i) { return Op::apply (static_cast<long double> (p[i]), w); });
+			}
+		}
+
+		//! \brief Dictionary columns: Op is evaluated once per distinct string, then looked up by code.
+		BOOST_UBLAS_INLINE
+		void operator () (const dictionary_column& x) const {
+			if constexpr (simd::is_comparable < Op, std::string_view, S >::value) {
+				const string_column& d = x.dictionary();
+				std::vector < unsigned char > r (d.size());
+				for(size_t c = 0; c < d.size(); ++c) {
+					r[c] = Op::apply (d(c), val_);
+				}
+				const std::shared_ptr < const void > keep = out_.hold<bool_column>();
+				bool_column& out = out_.resize<bool_column>(x.size());
+				x.with_codes ([&r, &out] (const auto* codes, const size_t n) {
+					kernel::pack_bits (n, out.words(), [&r, codes] (const size_t i) { return r[codes[i]]; });
+				});
+			}
+			else {
+				throw undefined_operation();
+			}
+		}
+
+		//! \brief Other columns (strings ...), element by element.
+		template < class C >
+		BOOST_UBLAS_INLINE
+		void operator () (const C& x) const {
+			if constexpr (simd::is_comparable < Op, typename C::value_type, S >::value) {
+				const std::shared_ptr < const void > keep = out_.hold<bool_column>();
+				bool_column& out = out_.resize<bool_column>(x.size());
+				kernel::pack_bits (x.size(), out.words(), [&x, this] (const size_t i) { return Op::apply (x(i), val_); });
+			}
+			else {
+				throw undefined_operation();
+			}
+		}
+
+	private:
+		const S& val_;
+		df_column& out_;
+	};
+
+	/*! \brief Writes the mask Op(x, y) into a df_column of bool_column, x and y being columns of same type.
+	 *  Op is a simd comparison (simd::less ...).
+	 */
+	template < class Op >
+	class column_compare_visitor: public boost::static_visitor<void> {
+	public:
+		BOOST_UBLAS_INLINE
+		column_compare_visitor (const df_column& y, df_column& out): 
+			y_ (y), 
+			out_ (out) {}
+
+		template < class T >
+		BOOST_UBLAS_INLINE
+		typename std::enable_if < std::is_arithmetic<T>::value >::type
+		operator () (const column_vector<T>& x) const {
+			const size_t n = x.size();
+			const column_vector<T>& y = y_.get<T>();
+			const std::shared_ptr < const void > keep = out_.hold<bool_column>();
+			bool_column& out = out_.resize<bool_column>(n);
+			simd::compare < Op > (x.data().begin(), y.data().begin(), out.words(), n);
+		}
+
+		//! \brief Dictionary columns: equality on the codes, translated once if the dictionaries differ.
+		BOOST_UBLAS_INLINE
+		void operator () (const dictionary_column& x) const {
+			const dictionary_column& y = y_.get<dictionary_column>();
+			if constexpr (simd::is_equality<Op>::value) {
+				const std::vector < dictionary_column::code_type > r = y.recode (x);
+				const std::shared_ptr < const void > keep = out_.hold<bool_column>();
+				bool_column& out = out_.resize<bool_column>(x.size());
+				kernel::pack_bits (x.size(), out.words(), [&] (const size_t i) { return Op::apply (x.code(i), r[y.code(i)]); });
+			}
+			else {
+				const std::shared_ptr < const void > keep = out_.hold<bool_column>();
+				bool_column& out = out_.resize<bool_column>(x.size());
+				kernel::pack_bits (x.size(), out.words(), [&x, &y] (const size_t i) { return Op::apply (x(i), y(i)); });
+			}
+		}
+
+		//! \brief Other columns (strings ...), element by element.
+		template < class C >
+		BOOST_UBLAS_INLINE
+		void operator () (const C& x) const {
+			typedef typename C::value_type V;
+			if constexpr (simd::is_comparable < Op, V, V >::value) {
+				const C& y = y_.get < typename column_tag<C>::type >();
+				const std::shared_ptr < const void > keep = out_.hold<bool_column>();
+				bool_column& out = out_.resize<bool_column>(x.size());
+				kernel::pack_bits (x.size(), out.words(), [&x, &y] (const size_t i) { return Op::apply (x(i), y(i)); });
+			}
+			else {
+				throw undefined_operation();
+			}
+		}
+
+	private:
+		const df_column& y_;
+		df_column& out_;
+	};
+
+	//! \brief Writes the elements of x at the positions sel(0) ... sel(n-1) into a df_column of the same type.
+	class column_select_visitor: public boost::static_visitor<void> {
+	public:
+		BOOST_UBLAS_INLINE
+		column_select_visitor (const size_t* sel, const size_t n, df_column& out): 
+			sel_ (sel), 
+			n_ (n), 
+			out_ (out) {}
+
+		template < class T >
+		BOOST_UBLAS_INLINE
+		void operator () (const column_vector<T>& x) const {
+			column_vector<T>& out = out_.resize<T>(n_);
+			const T* p = x.data().begin();
+			T* q = out.data().begin();
+			for(size_t k = 0; k < n_; ++k) {
+				q[k] = p[sel_[k]];
+			}
+		}
+
+		//! \brief string, dictionary and bool columns.
+		template < class C >
+		BOOST_UBLAS_INLINE
+		void operator () (const C& x) const {
+			out_ = x.select (sel_, n_);
+		}
+
+	private:
+		const size_t* sel_;
+		size_t n_;
+		df_column& out_;
+	};
+
+	/*! \brief Sorts the n rows perm(0) ... perm(n-1) by the values of a column, none of them null.
+	 *  Radix sort on order preserving keys (kernel::radix_key) when the column has them,
+	 *  the keys of a dictionary column being the ranks of its codes; comparison sort otherwise.
+	 */
+	class column_sort_visitor: public boost::static_visitor<void> {
+	public:
+		BOOST_UBLAS_INLINE
+		column_sort_visitor (size_t* perm, const size_t n, const sort_order order, const bool stable): 
+			perm_ (perm), 
+			n_ (n), 
+			descending_ (order == sort_order::desc), 
+			stable_ (stable) {}
+
+		template < class T >
+		BOOST_UBLAS_INLINE
+		void operator () (const column_vector<T>& x) const {
+			const T* p = x.data().begin();
+			if constexpr (kernel::radix_key<T>::value) {
+				radix ([p] (const size_t i) { return kernel::radix_key<T>::apply (p[i]); });
+			}
+			else {
+				compare ([p] (const size_t i) -> const T& { return p[i]; });
+			}
+		}
+
+		BOOST_UBLAS_INLINE
+		void operator () (const dictionary_column& x) const {
+			const std::vector < dictionary_column::code_type > rank = x.ranks();
+			radix ([&x, &rank] (const size_t i) { return rank[x.code (i)]; });
+		}
+
+		BOOST_UBLAS_INLINE
+		void operator () (const bool_column& x) const {
+			radix ([&x] (const size_t i) { return std::uint8_t (x(i)); });
+		}
+
+		//! \brief string columns.
+		template < class C >
+		BOOST_UBLAS_INLINE
+		void operator () (const C& x) const {
+			compare ([&x] (const size_t i) { return x(i); });
+		}
+
+	private:
+		size_t* perm_;
+		size_t n_;
+		bool descending_;
+		bool stable_;
+
+		//! \brief Radix sort on the keys key(i), complemented for a descending order.
+		template < class F >
+		BOOST_UBLAS_INLINE
+		void radix (F key) const {
+			typedef typename std::decay < decltype (key (0)) >::type K;
+			const K flip = descending_ ? K (~K (0)) : K (0);
+			std::vector < K > keys (n_);
+			for(size_t j = 0; j < n_; ++j) {
+				keys[j] = K (key (perm_[j]) ^ flip);
+			}
+			kernel::radix_sort (keys.data(), perm_, n_);
+		}
+
+		//! \brief Comparison sort on the values value(i).
+		template < class F >
+		BOOST_UBLAS_INLINE
+		void compare (F value) const {
+			const auto less = [&value] (const size_t a, const size_t b) { return value (a) < value (b); };
+			const auto greater = [&value] (const size_t a, const size_t b) { return value (b) < value (a); };
+			if (descending_) {
+				stable_ ? std::stable_sort (perm_, perm_ + n_, greater) : std::sort (perm_, perm_ + n_, greater);
+			}
+			else {
+				stable_ ? std::stable_sort (perm_, perm_ + n_, less) : std::sort (perm_, perm_ + n_, less);
 			}
 		}
+	};
+
+	/*! \brief Sorts the n rows perm(0) ... perm(n-1) by the values of x, the null ones last.
+	 *  The rows of equal values keep their order if the sort is stable (always for the radix sorts).
+	 */
+	BOOST_UBLAS_INLINE
+	void sort_rows (const df_column& x, size_t* perm, const size_t n, const sort_order order, const bool stable) {
+		size_t m = n;
+		if (x.has_nulls()) {
+			m = std::stable_partition (perm, perm + n, [&x] (const size_t i) { return !x.is_null (i); }) - perm;
+		}
+		x.apply_visitor (column_sort_visitor (perm, m, order, stable));
 	}
 
-	//! \brief Returns a df_column as sum of a df_column and a constant value.
 	BOOST_UBLAS_INLINE
-	template < class T > 
-	df_column operator + (const T& val, df_column& a) {
-		return a + val;
+	std::vector < size_t > df_column::argsort(const sort_order order, const bool stable) const {
+		std::vector < size_t > perm (size_);
+		for(size_t i = 0; i < size_; ++i) {
+			perm[i] = i;
+		}
+		sort_rows (*this, perm.data(), size_, order, stable);
+		return perm;
 	}
 
-	//! \brief Returns a df_column as difference of a df_column and a constant value.
+	// ------------------------
+	// Column Kernel Operations
+	// ------------------------
+
+	// An element of the result is null if an element it is computed from is null.
+	// The values are computed on all the elements, null or not, the validity is set apart,
+	// so the kernels run the same on columns with and without nulls.
+
+	/*! \brief Writes the negation of \c a into \c out.
+	 *  \c out is resized (and retyped) only if needed, \c out may be \c a itself.
+	 */
 	BOOST_UBLAS_INLINE
-	template < class T > 
-	df_column operator - (df_column& a, const T& val) {
-		return a + (-val);
+	void column_negate (const df_column& a, df_column& out) {
+		try {
+			const column_validity v = a.validity();
+			a.apply_visitor (column_unary_visitor < scalar_negate > (out));
+			out.set_validity (v);
+		}
+		catch (std::exception& e) {
+			std::terminate();
+		}
 	}
 
-	//! \brief Returns a df_column as product of a df_column and a constant value.
-	BOOST_UBLAS_INLINE	
-	template < class T > 
-	df_column operator * (df_column& a, const T& val) {
-		df_column X;
-		switch (a.type()) {
-			case 0: 
-				A0 = a.get<bool>() * val;
-				X = A0;
-				return X;
-			case 3: 
-				A3 = a.get<short>() * val;
-				X = A3;
-				return X;
-			case 4: 
-				A4 = a.get<unsigned short>() * val;
-				X = A4;
-				return X;
-			case 5: 
-				A5 = a.get<int>() * val;
-				X = A5;
-				return X;
-			case 6: 
-				A6 = a.get<unsigned int>() * val;
-				X = A6;
-				return X;
-			case 7: 
-				A7 = a.get<long>() * val;
-				X = A7;
-				return X;
-			case 8: 
-				A8 = a.get<unsigned long>() * val;
-				X = A8;
-				return X;
-			case 9: 
-				A9 = a.get<long long>() * val;
-				X = A9;
-				return X;
-			case 10: 
-				A10 = a.get<unsigned long long>() * val;
-				X = A10;
-				return X;
-			case 11: 
-				A11 = a.get<float>() * val;
-				X = A11;
-				return X;
-			case 12: 
-				A12 = a.get<double>() * val;
-				X = A12;
-				return X;
-			case 13: 
-				A13 = a.get<long double>() * val;
-				X = A13;
-				return X;
+	/*! \brief Writes the sum of 2 df_columns of same type into \c out.
+	 *  \c out is resized (and retyped) only if needed, \c out may be \c a or \c b.
+	 */
+	BOOST_UBLAS_INLINE
+	void column_add (const df_column& a, const df_column& b, df_column& out) {
+		try {
+			if (a.type() != b.type()) {
+				throw column_type_mismatch();
+			}
+			else if (a.size() != b.size()) {
+				throw unequal_rows();
+			}
+			const column_validity v = a.validity() & b.validity();
+			a.apply_visitor (column_binary_visitor < scalar_plus > (b, out));
+			out.set_validity (v);
+		}
+		catch (std::exception& e) {
+			std::terminate();
 		}
 	}
 
-	//! \brief Returns a df_column as product of a df_column and a constant value.
+	/*! \brief Writes the difference of 2 df_columns of same type into \c out.
+	 *  \c out is resized (and retyped) only if needed, \c out may be \c a or \c b.
+	 */
 	BOOST_UBLAS_INLINE
-	template < class T > 
-	df_column operator * (const T& val, df_column& a) {
-		return a * val;
+	void column_subtract (const df_column& a, const df_column& b, df_column& out) {
+		try {
+			if (a.type() != b.type()) {
+				throw column_type_mismatch();
+			}
+			else if (a.size() != b.size()) {
+				throw unequal_rows();
+			}
+			const column_validity v = a.validity() & b.validity();
+			a.apply_visitor (column_binary_visitor < scalar_minus > (b, out));
+			out.set_validity (v);
+		}
+		catch (std::exception& e) {
+			std::terminate();
+		}
 	}
 
-	//! \brief Returns \c true if \c y.size() == \c x.size() and \c y.get<T> == \c x.get<T>() else \c false
+	//! \brief Writes the sum of a df_column and a constant value into \c out.
+	template < class T >
 	BOOST_UBLAS_INLINE
-	bool operator == (df_column& y, df_column& x) {
-		if (y.type() != x.type()) {
-			return false;
+	void column_add (const df_column& a, const T& val, df_column& out) {
+		try {
+			const column_validity v = a.validity();
+			a.apply_visitor (column_scalar_visitor < scalar_plus, T > (val, out));
+			out.set_validity (v);
 		}
-		else if(y.size() != x.size()) {
-			return false;
+		catch (std::exception& e) {
+			std::terminate();
 		}
-		for(size_t i = 0; i < x.size(); ++i) {
-			switch (y.type()) {
-				case 0: if((y.get<bool>()(i) != x.get<bool>()(i)) ) {
-					return false;
-				}
-				break;
-				case 1: if((y.get<char>()(i) != x.get<char>()(i)) ) {
-					return false;
-				}
-				break;
-				case 2: if((y.get<unsigned char>()(i) != x.get<unsigned char>()(i)) ) {
-					return false;
-				}
-				break;
-				case 3: if((y.get<short>()(i) != x.get<short>()(i)) ) {
-					return false;
-				}
-				break;
-				case 4: if((y.get<unsigned short>()(i) != x.get<unsigned short>()(i)) ) {
-					return false;
-				}
-				break;
-				case 5: if((y.get<int>()(i) != x.get<int>()(i)) ) {
+	}
+
+	//! \brief Writes the difference of a df_column and a constant value into \c out.
+	template < class T >
+	BOOST_UBLAS_INLINE
+	void column_subtract (const df_column& a, const T& val, df_column& out) {
+		try {
+			const column_validity v = a.validity();
+			a.apply_visitor (column_scalar_visitor < scalar_minus, T > (val, out));
+			out.set_validity (v);
+		}
+		catch (std::exception& e) {
+			std::terminate();
+		}
+	}
+
+	//! \brief Writes the product of a df_column and a constant value into \c out.
+	template < class T >
+	BOOST_UBLAS_INLINE
+	void column_multiply (const df_column& a, const T& val, df_column& out) {
+		try {
+			const column_validity v = a.validity();
+			a.apply_visitor (column_scalar_visitor < scalar_multiplies, T > (val, out));
+			out.set_validity (v);
+		}
+		catch (std::exception& e) {
+			std::terminate();
+		}
+	}
+
+	//! \brief Writes the quotient of a df_column and a constant value into \c out.
+	template < class T >
+	BOOST_UBLAS_INLINE
+	void column_divide (const df_column& a, const T& val, df_column& out) {
+		try {
+			const column_validity v = a.validity();
+			a.apply_visitor (column_scalar_visitor < scalar_divides, T > (val, out));
+			out.set_validity (v);
+		}
+		catch (std::exception& e) {
+			std::terminate();
+		}
+	}
+
+	//! \brief Writes the element-wise minimum of a df_column and a constant value into \c out.
+	template < class T >
+	BOOST_UBLAS_INLINE
+	void column_min (const df_column& a, const T& val, df_column& out) {
+		try {
+			const column_validity v = a.validity();
+			a.apply_visitor (column_scalar_visitor < scalar_min, T > (val, out));
+			out.set_validity (v);
+		}
+		catch (std::exception& e) {
+			std::terminate();
+		}
+	}
+
+	//! \brief Writes the element-wise maximum of a df_column and a constant value into \c out.
+	template < class T >
+	BOOST_UBLAS_INLINE
+	void column_max (const df_column& a, const T& val, df_column& out) {
+		try {
+			const column_validity v = a.validity();
+			a.apply_visitor (column_scalar_visitor < scalar_max, T > (val, out));
+			out.set_validity (v);
+		}
+		catch (std::exception& e) {
+			std::terminate();
+		}
+	}
+
+	//! \brief Writes a df_column clamped to [lo, hi] into \c out.
+	template < class T >
+	BOOST_UBLAS_INLINE
+	void column_clamp (const df_column& a, const T& lo, const T& hi, df_column& out) {
+		try {
+			if (hi < lo) {
+				throw inconsistent_bounds();
+			}
+			const column_validity v = a.validity();
+			a.apply_visitor (column_clamp_visitor < T > (lo, hi, out));
+			out.set_validity (v);
+		}
+		catch (std::exception& e) {
+			std::terminate();
+		}
+	}
+
+	/*! \brief Writes the mask Op(a, val) into \c out, a bool_column.
+	 *  Op is a simd comparison: simd::less, less_equal, greater, greater_equal, equal_to or not_equal_to.
+	 *  Numeric columns are compared in their own type through the SIMD kernels when it holds val exactly,
+	 *  dictionary columns evaluate Op once per distinct string.
+	 *  \c out may be \c a.
+	 */
+	template < class Op, class T >
+	BOOST_UBLAS_INLINE
+	void column_compare (const df_column& a, const T& val, df_column& out) {
+		try {
+			const column_validity v = a.validity();
+			a.apply_visitor (column_compare_scalar_visitor < Op, T > (val, out));
+			out.set_validity (v);
+		}
+		catch (std::exception& e) {
+			std::terminate();
+		}
+	}
+
+	/*! \brief Writes the mask Op(a, b) into \c out, a bool_column, a and b being df_columns of same type.
+	 *  \c out may be \c a or \c b.
+	 */
+	template < class Op >
+	BOOST_UBLAS_INLINE
+	void column_compare (const df_column& a, const df_column& b, df_column& out) {
+		try {
+			if (a.type() != b.type()) {
+				throw column_type_mismatch();
+			}
+			else if (a.size() != b.size()) {
+				throw unequal_rows();
+			}
+			const column_validity v = a.validity() & b.validity();
+			a.apply_visitor (column_compare_visitor < Op > (b, out));
+			out.set_validity (v);
+		}
+		catch (std::exception& e) {
+			std::terminate();
+		}
+	}
+
+	/*! \brief Writes the elements of a at the positions sel(0) ... sel(n-1) into \c out, with their nulls.
+	 *  \c out must not be \c a.
+	 */
+	BOOST_UBLAS_INLINE
+	void column_select (const df_column& a, const size_t* sel, const size_t n, df_column& out) {
+		try {
+			a.apply_visitor (column_select_visitor (sel, n, out));
+			if (a.has_nulls()) {
+				out.set_validity (column_validity (a.validity().bits()->select (sel, n)));
+			}
+		}
+		catch (std::exception& e) {
+			std::terminate();
+		}
+	}
+
+	/*! \brief Writes Op(a, b) into \c out, Op being a bitwise simd operation and a, b bool_columns of same size.
+	 *  Runs on whole words, 64 elements per operation (and 512 per AVX-512 instruction).
+	 */
+	template < class Op >
+	BOOST_UBLAS_INLINE
+	void column_bitwise (const df_column& a, const df_column& b, df_column& out) {
+		if (a.type() != column_traits<bool_column>::type_id) {
+			throw undefined_operation();
+		}
+		else if (a.type() != b.type()) {
+			throw column_type_mismatch();
+		}
+		else if (a.size() != b.size()) {
+			throw unequal_rows();
+		}
+		const column_validity v = a.validity() & b.validity();
+		const bool_column& x = a.get<bool_column>();
+		const bool_column& y = b.get<bool_column>();
+		const std::shared_ptr < const void > keep = out.hold<bool_column>();
+		bool_column& r = out.resize<bool_column>(a.size());
+		simd::transform < Op > (x.words(), y.words(), r.words(), x.word_count());
+		out.set_validity (v);
+	}
+
+	/*! \brief Writes the bitwise and of 2 bool_columns into \c out.
+	 *  \c out is resized (and retyped) only if needed, \c out may be \c a or \c b.
+	 */
+	BOOST_UBLAS_INLINE
+	void column_and (const df_column& a, const df_column& b, df_column& out) {
+		try {
+			column_bitwise < simd::bit_and > (a, b, out);
+		}
+		catch (std::exception& e) {
+			std::terminate();
+		}
+	}
+
+	/*! \brief Writes the bitwise or of 2 bool_columns into \c out.
+	 *  \c out is resized (and retyped) only if needed, \c out may be \c a or \c b.
+	 */
+	BOOST_UBLAS_INLINE
+	void column_or (const df_column& a, const df_column& b, df_column& out) {
+		try {
+			column_bitwise < simd::bit_or > (a, b, out);
+		}
+		catch (std::exception& e) {
+			std::terminate();
+		}
+	}
+
+	/*! \brief Writes the bitwise xor of 2 bool_columns into \c out.
+	 *  \c out is resized (and retyped) only if needed, \c out may be \c a or \c b.
+	 */
+	BOOST_UBLAS_INLINE
+	void column_xor (const df_column& a, const df_column& b, df_column& out) {
+		try {
+			column_bitwise < simd::bit_xor > (a, b, out);
+		}
+		catch (std::exception& e) {
+			std::terminate();
+		}
+	}
+
+	/*! \brief Writes the bitwise not of a bool_column into \c out.
+	 *  \c out is resized (and retyped) only if needed, \c out may be \c a.
+	 */
+	BOOST_UBLAS_INLINE
+	void column_not (const df_column& a, df_column& out) {
+		try {
+			if (a.type() != column_traits<bool_column>::type_id) {
+				throw undefined_operation();
+			}
+			const column_validity v = a.validity();
+			const bool_column& x = a.get<bool_column>();
+			const std::shared_ptr < const void > keep = out.hold<bool_column>();
+			bool_column& r = out.resize<bool_column>(a.size());
+			simd::transform < simd::bit_not > (x.words(), r.words(), x.word_count());
+			r.clear_tail();
+			out.set_validity (v);
+		}
+		catch (std::exception& e) {
+			std::terminate();
+		}
+	}
+
+	// ----------------
+	// Column Operators
+	// ----------------
+
+	//! \brief Returns the negation of the column if exists. 
+	BOOST_UBLAS_INLINE
+	df_column operator - (const df_column& a) {	
+		df_column X;
+		column_negate (a, X);
+		return X;
+	}
+
+	//! \brief Returns a df_column as sum of 2 df_columns.
+	BOOST_UBLAS_INLINE
+	df_column operator + (const df_column& a, const df_column& b) {	
+		df_column X;
+		column_add (a, b, X);
+		return X;
+	}
+
+	//! \brief Returns a df_column as difference of 2 df_columns.
+	BOOST_UBLAS_INLINE
+	df_column operator - (const df_column& a, const df_column& b) {	
+		df_column X;
+		column_subtract (a, b, X);
+		return X;
+	}
+
+	//! \brief Returns a df_column as sum of a df_column and a constant value.
+	template < class T > 
+	BOOST_UBLAS_INLINE
+	df_column operator + (const df_column& a, const T& val) {
+		df_column X;
+		column_add (a, val, X);
+		return X;
+	}
+
+	//! \brief Returns a df_column as sum of a df_column and a constant value.
+	template < class T > 
+	BOOST_UBLAS_INLINE
+	df_column operator + (const T& val, const df_column& a) {
+		return a + val;
+	}
+
+	//! \brief Returns a df_column as difference of a df_column and a constant value.
+	template < class T > 
+	BOOST_UBLAS_INLINE
+	df_column operator - (const df_column& a, const T& val) {
+		df_column X;
+		column_subtract (a, val, X);
+		return X;
+	}
+
+	//! \brief Returns a df_column as product of a df_column and a constant value.
+	template < class T > 
+	BOOST_UBLAS_INLINE	
+	df_column operator * (const df_column& a, const T& val) {
+		df_column X;
+		column_multiply (a, val, X);
+		return X;
+	}
+
+	//! \brief Returns a df_column as product of a df_column and a constant value.
+	template < class T > 
+	BOOST_UBLAS_INLINE
+	df_column operator * (const T& val, const df_column& a) {
+		return a * val;
+	}
+
+	//! \brief Returns a df_column as quotient of a df_column and a constant value.
+	template < class T > 
+	BOOST_UBLAS_INLINE	
+	df_column operator / (const df_column& a, const T& val) {
+		df_column X;
+		column_divide (a, val, X);
+		return X;
+	}
+
+	//! \brief Returns the element-wise minimum of a df_column and a constant value (as R's pmin).
+	template < class T > 
+	BOOST_UBLAS_INLINE	
+	df_column pmin (const df_column& a, const T& val) {
+		df_column X;
+		column_min (a, val, X);
+		return X;
+	}
+
+	//! \brief Returns the element-wise maximum of a df_column and a constant value (as R's pmax).
+	template < class T > 
+	BOOST_UBLAS_INLINE	
+	df_column pmax (const df_column& a, const T& val) {
+		df_column X;
+		column_max (a, val, X);
+		return X;
+	}
+
+	//! \brief Returns a df_column with every element clamped to [lo, hi].
+	template < class T > 
+	BOOST_UBLAS_INLINE	
+	df_column clamp (const df_column& a, const T& lo, const T& hi) {
+		df_column X;
+		column_clamp (a, lo, hi, X);
+		return X;
+	}
+
+	//! \brief Returns the bitwise and of 2 bool_columns.
+	BOOST_UBLAS_INLINE
+	df_column operator & (const df_column& a, const df_column& b) {
+		df_column X;
+		column_and (a, b, X);
+		return X;
+	}
+
+	//! \brief Returns the bitwise or of 2 bool_columns.
+	BOOST_UBLAS_INLINE
+	df_column operator | (const df_column& a, const df_column& b) {
+		df_column X;
+		column_or (a, b, X);
+		return X;
+	}
+
+	//! \brief Returns the bitwise xor of 2 bool_columns.
+	BOOST_UBLAS_INLINE
+	df_column operator ^ (const df_column& a, const df_column& b) {
+		df_column X;
+		column_xor (a, b, X);
+		return X;
+	}
+
+	//! \brief Returns the bitwise not of a bool_column.
+	BOOST_UBLAS_INLINE
+	df_column operator ~ (const df_column& a) {
+		df_column X;
+		column_not (a, X);
+		return X;
+	}
+
+	// ------------------
+	// Column Comparisons
+	// ------------------
+	// Element-wise, the result is a mask: a df_column of bool_column, null where an operand is null.
+	// == and != between two columns compare them as a whole, equal() and not_equal() element-wise.
+
+	//! \brief \c true for the types of the scalars a column is compared with: numbers and strings.
+	template < class T >
+	struct is_comparison_scalar: std::integral_constant < bool,
+		std::is_arithmetic<T>::value || std::is_convertible < const T&, std::string_view >::value > {};
+
+	//! \brief Returns the mask a(i) < val.
+	template < class T >
+	BOOST_UBLAS_INLINE
+	typename std::enable_if < is_comparison_scalar<T>::value, df_column >::type operator < (const df_column& a, const T& val) {
+		df_column X;
+		column_compare < simd::less > (a, val, X);
+		return X;
+	}
+
+	//! \brief Returns the mask a(i) <= val.
+	template < class T >
+	BOOST_UBLAS_INLINE
+	typename std::enable_if < is_comparison_scalar<T>::value, df_column >::type operator <= (const df_column& a, const T& val) {
+		df_column X;
+		column_compare < simd::less_equal > (a, val, X);
+		return X;
+	}
+
+	//! \brief Returns the mask a(i) > val.
+	template < class T >
+	BOOST_UBLAS_INLINE
+	typename std::enable_if < is_comparison_scalar<T>::value, df_column >::type operator > (const df_column& a, const T& val) {
+		df_column X;
+		column_compare < simd::greater > (a, val, X);
+		return X;
+	}
+
+	//! \brief Returns the mask a(i) >= val.
+	template < class T >
+	BOOST_UBLAS_INLINE
+	typename std::enable_if < is_comparison_scalar<T>::value, df_column >::type operator >= (const df_column& a, const T& val) {
+		df_column X;
+		column_compare < simd::greater_equal > (a, val, X);
+		return X;
+	}
+
+	//! \brief Returns the mask a(i) == val.
+	template < class T >
+	BOOST_UBLAS_INLINE
+	typename std::enable_if < is_comparison_scalar<T>::value, df_column >::type operator == (const df_column& a, const T& val) {
+		df_column X;
+		column_compare < simd::equal_to > (a, val, X);
+		return X;
+	}
+
+	//! \brief Returns the mask a(i) != val.
+	template < class T >
+	BOOST_UBLAS_INLINE
+	typename std::enable_if < is_comparison_scalar<T>::value, df_column >::type operator != (const df_column& a, const T& val) {
+		df_column X;
+		column_compare < simd::not_equal_to > (a, val, X);
+		return X;
+	}
+
+	//! \brief Returns the mask val < a(i).
+	template < class T >
+	BOOST_UBLAS_INLINE
+	typename std::enable_if < is_comparison_scalar<T>::value, df_column >::type operator < (const T& val, const df_column& a) {
+		return a > val;
+	}
+
+	//! \brief Returns the mask val <= a(i).
+	template < class T >
+	BOOST_UBLAS_INLINE
+	typename std::enable_if < is_comparison_scalar<T>::value, df_column >::type operator <= (const T& val, const df_column& a) {
+		return a >= val;
+	}
+
+	//! \brief Returns the mask val > a(i).
+	template < class T >
+	BOOST_UBLAS_INLINE
+	typename std::enable_if < is_comparison_scalar<T>::value, df_column >::type operator > (const T& val, const df_column& a) {
+		return a < val;
+	}
+
+	//! \brief Returns the mask val >= a(i).
+	template < class T >
+	BOOST_UBLAS_INLINE
+	typename std::enable_if < is_comparison_scalar<T>::value, df_column >::type operator >= (const T& val, const df_column& a) {
+		return a <= val;
+	}
+
+	//! \brief Returns the mask val == a(i).
+	template < class T >
+	BOOST_UBLAS_INLINE
+	typename std::enable_if < is_comparison_scalar<T>::value, df_column >::type operator == (const T& val, const df_column& a) {
+		return a == val;
+	}
+
+	//! \brief Returns the mask val != a(i).
+	template < class T >
+	BOOST_UBLAS_INLINE
+	typename std::enable_if < is_comparison_scalar<T>::value, df_column >::type operator != (const T& val, const df_column& a) {
+		return a != val;
+	}
+
+	//! \brief Returns the mask a(i) < b(i).
+	BOOST_UBLAS_INLINE
+	df_column operator < (const df_column& a, const df_column& b) {
+		df_column X;
+		column_compare < simd::less > (a, b, X);
+		return X;
+	}
+
+	//! \brief Returns the mask a(i) <= b(i).
+	BOOST_UBLAS_INLINE
+	df_column operator <= (const df_column& a, const df_column& b) {
+		df_column X;
+		column_compare < simd::less_equal > (a, b, X);
+		return X;
+	}
+
+	//! \brief Returns the mask a(i) > b(i).
+	BOOST_UBLAS_INLINE
+	df_column operator > (const df_column& a, const df_column& b) {
+		df_column X;
+		column_compare < simd::greater > (a, b, X);
+		return X;
+	}
+
+	//! \brief Returns the mask a(i) >= b(i).
+	BOOST_UBLAS_INLINE
+	df_column operator >= (const df_column& a, const df_column& b) {
+		df_column X;
+		column_compare < simd::greater_equal > (a, b, X);
+		return X;
+	}
+
+	//! \brief Returns the mask a(i) == b(i).
+	BOOST_UBLAS_INLINE
+	df_column equal (const df_column& a, const df_column& b) {
+		df_column X;
+		column_compare < simd::equal_to > (a, b, X);
+		return X;
+	}
+
+	//! \brief Returns the mask a(i) != b(i).
+	BOOST_UBLAS_INLINE
+	df_column not_equal (const df_column& a, const df_column& b) {
+		df_column X;
+		column_compare < simd::not_equal_to > (a, b, X);
+		return X;
+	}
+
+	//! \brief Returns \c true if \c y.size() == \c x.size(), both have the same nulls and \c y.get<T> == \c x.get<T>() on the other elements else \c false
+	BOOST_UBLAS_INLINE
+	bool operator == (const df_column& y, const df_column& x) {
+		if (y.type() != x.type()) {
+			return false;
+		}
+		else if(y.size() != x.size()) {
+			return false;
+		}
+		else if(!(y.validity() == x.validity())) {
+			return false;
+		}
+		const bool nulls = x.has_nulls();
+		if (x.type() == column_traits<bool_column>::type_id && !nulls) {
+			// compared a word at a time
+			return x.get<bool_column>() == y.get<bool_column>();
+		}
+		if (x.type() == column_traits<dictionary_column>::type_id) {
+			// compared on the codes, those of y translated once if the dictionaries differ
+			const dictionary_column& a = x.get<dictionary_column>();
+			const dictionary_column& b = y.get<dictionary_column>();
+			if (!nulls) {
+				return a == b;
+			}
+			const std::vector < dictionary_column::code_type > r = b.recode (a);
+			for(size_t i = 0; i < x.size(); ++i) {
+				if (!x.is_null(i) && r[b.code(i)] != a.code(i)) {
+					return false;
+				}
+			}
+			return true;
+		}
+		for(size_t i = 0; i < x.size(); ++i) {
+			// null elements are equal, whatever the values in the buffers
+			if (nulls && x.is_null(i)) {
+				continue;
+			}
+			switch (y.type()) {
+				case 0: if((y.get<bool>()(i) != x.get<bool>()(i)) ) {
+					return false;
+				}
+				break;
+				case 1: if((y.get<char>()(i) != x.get<char>()(i)) ) {
+					return false;
+				}
+				break;
+				case 2: if((y.get<unsigned char>()(i) != x.get<unsigned char>()(i)) ) {
+					return false;
+				}
+				break;
+				case 3: if((y.get<short>()(i) != x.get<short>()(i)) ) {
+					return false;
+				}
+				break;
+				case 4: if((y.get<unsigned short>()(i) != x.get<unsigned short>()(i)) ) {
+					return false;
+				}
+				break;
+				case 5: if((y.get<int>()(i) != x.get<int>()(i)) ) {
+					return false;
+				}
+				break;
+				case 6: if((y.get<unsigned int>()(i) != x.get<unsigned int>()(i)) ) {
+					return false;
+				}
+				break;
+				case 7: if((y.get<long>()(i) != x.get<long>()(i)) ) {
+					return false;
+				}
+				break;
+				case 8: if((y.get<unsigned long>()(i) != x.get<unsigned long>()(i)) ) {
+					return false;
+				}
+				break;
+				case 9: if((y.get<long long>()(i) != x.get<long long>()(i)) ) {
 					return false;
 				}
-				break;
-				case 6: if((y.get<unsigned int>()(i) != x.get<unsigned int>()(i)) ) {
-					return false;
+				break;
+				case 10: if((y.get<unsigned long long>()(i) != x.get<unsigned long long>()(i)) ) {
+					return false;
+				}
+				break;
+				case 11: if((y.get<float>()(i) != x.get<float>()(i)) ) {
+					return false;
+				}
+				break;
+				case 12: if((y.get<double>()(i) != x.get<double>()(i)) ) {
+					return false;
+				}
+				break;
+				case 13: if((y.get<long double>()(i) != x.get<long double>()(i)) ) {
+					return false;
+				}
+				break;
+				case 14: if((y.get<std::string>()(i) != x.get<std::string>()(i)) ) {
+					return false;
+				}
+				break;
+				case 15: if((y.get<std::string*>()(i) != x.get<std::string*>()(i)) ) {
+					return false;
+				}
+				break;
+				case 16: if(!x.get<string_column>().equals(i, y.get<string_column>()(i))) {
+					return false;
+				}
+				break;
+				case 17: if(!x.get<large_string_column>().equals(i, y.get<large_string_column>()(i))) {
+					return false;
+				}
+				break;
+				case 19: if((y.get<bool_column>()(i) != x.get<bool_column>()(i)) ) {
+					return false;
+				}
+				break;
+			}
+		}
+		return true;
+	}
+
+	//! \brief Returns \c false if \c y.size() == \c x.size() and \c y.get<T> == \c x.get<T>() else \c true
+	BOOST_UBLAS_INLINE
+	bool operator != (const df_column& y, const df_column& x) {
+		return !(x == y);
+	}
+
+
+	BOOST_UBLAS_INLINE
+	void remove (vector<std::string>& v, size_t idx) {
+	    for (size_t i = idx; i < v.size() - 1; i++) {
+	        v(i) = v(i + 1);
+	    }
+	    v.resize(v.size() - 1);
+	    return;
+	}
+
+	/*! \brief Resolved column of a data_frame.
+	 *  Obtained from \c data_frame::handle(), gives the column without looking up its header.
+	 *  Remains valid until columns are added to or erased from the data_frame, and is stale in any other data_frame.
+	 */
+	class column_handle {
+	public:
+		friend class data_frame;
+
+		BOOST_UBLAS_INLINE
+		column_handle ():
+			index_ (column_index::npos),
+			generation_ (0) {}
+
+		//! \brief Returns the position of the column in the data_frame.
+		BOOST_UBLAS_INLINE
+		size_t index() const {
+			return index_;
+		}
+
+		//! \brief Returns the layout generation of the data_frame the handle was resolved in.
+		BOOST_UBLAS_INLINE
+		size_t generation() const {
+			return generation_;
+		}
+
+	private:
+		BOOST_UBLAS_INLINE
+		column_handle (const size_t index, const size_t generation):
+			index_ (index),
+			generation_ (generation) {}
+
+		size_t index_;
+		size_t generation_;
+	};
+
+	/*! \brief Cursor over the rows of a data_frame.
+	 *  Gives const references into the column buffers, allocates nothing and copies no cell.
+	 *  Valid until columns are added to or erased from the data_frame.
+	 */
+	class row_cursor {
+	public:
+		BOOST_UBLAS_INLINE
+		row_cursor (const df_column* columns, const size_t ncol, const size_t row, const size_t generation):
+			columns_ (columns),
+			ncol_ (ncol),
+			row_ (row),
+			generation_ (generation) {}
+
+		//! \brief Returns the index of the current row.
+		BOOST_UBLAS_INLINE
+		size_t row() const {
+			return row_;
+		}
+
+		//! \brief Moves to the next row.
+		BOOST_UBLAS_INLINE
+		row_cursor& operator ++ () {
+			++row_;
+			return *this;
+		}
+
+		//! \brief Moves to the row \c row.
+		BOOST_UBLAS_INLINE
+		row_cursor& seek (const size_t row) {
+			row_ = row;
+			return *this;
+		}
+
+		/*! \brief Returns the cell of the current row in the column i.
+		 *  T should be same as the type of the column.
+		 */
+		template < class T >
+		BOOST_UBLAS_INLINE
+		typename column_traits<T>::const_reference get (const size_t i) const {
+			try {
+				if (i >= ncol_) {
+					throw bad_index();
+				}
+				return columns_[i].eval<T>(row_);
+			}
+			catch (std::exception& e) {
+				std::terminate();
+			}
+		}
+
+		//! \brief Returns \c true if the cell of the current row in the column i is null.
+		BOOST_UBLAS_INLINE
+		bool is_null (const size_t i) const {
+			try {
+				if (i >= ncol_) {
+					throw bad_index();
+				}
+				return columns_[i].is_null(row_);
+			}
+			catch (std::exception& e) {
+				std::terminate();
+			}
+		}
+
+		/*! \brief Returns the cell of the current row in the column of a handle.
+		 *  T should be same as the type of the column.
+		 */
+		template < class T >
+		BOOST_UBLAS_INLINE
+		typename column_traits<T>::const_reference get (const column_handle& h) const {
+			try {
+				if (h.generation() != generation_) {
+					throw stale_column_handle();
+				}
+				return get<T> (h.index());
+			}
+			catch (std::exception& e) {
+				std::terminate();
+			}
+		}
+
+	private:
+		const df_column* columns_;
+		size_t ncol_;
+		size_t row_;
+		size_t generation_;
+	};
+
+	class grouped_data_frame;
+	class hash_join;
+
+	//! \brief Selections of the rows of the row views: range [begin, end), slice and list of indices.
+	typedef basic_range < size_t, std::ptrdiff_t > row_range_type;
+	typedef basic_slice < size_t, std::ptrdiff_t > row_slice_type;
+	typedef indirect_array <> row_indirect_type;
+
+	template < class A > class data_frame_rows;
+	typedef data_frame_rows < row_range_type > data_frame_row_range;
+	typedef data_frame_rows < row_slice_type > data_frame_row_slice;
+	typedef data_frame_rows < row_indirect_type > data_frame_row_indirect;
+
+	//! \brief Kinds of data_frame::join().
+	enum class join_type {
+		inner,	//!< the pairs of rows with equal keys
+		left,	//!< the pairs of rows with equal keys, and the left rows without match, the right columns null
+		semi,	//!< the left rows with a match, left columns only
+		anti	//!< the left rows without match, left columns only
+	};
+
+	//! Represents a dataframe.
+	/*! Internally represented as a positional vector < df_column >, a vector < string> to store the headers
+	 *  and a hash index from header to position.
+	 *	Allowed types are: int, double, char, std::string...... (specified in INNER_TYPE).
+	 */
+	class data_frame {
+	public:
+		
+		friend class grouped_data_frame;
+		friend class hash_join;
+		friend data_frame operator + (data_frame& a, data_frame& b);
+		friend data_frame operator - (data_frame& a, data_frame& b);
+		template < class T > friend data_frame operator + (data_frame& a, const T& val);
+		template < class T > friend data_frame operator - (data_frame& a, const T& val);
+		template < class T > friend data_frame operator * (data_frame& a, const T& val);
+		 
+		// construction and destruction
+		
+		/*! \brief Constructor of data_frame.
+		 *  By default \c nrow() == 0 and ncol() == 0.
+		 *  type of the columns is unset.
+		 */ 
+		BOOST_UBLAS_INLINE 
+		data_frame () :
+			ncol_ (0),
+			nrow_ (0),
+			generation_ (next_generation()) {}
+
+		/*! \brief Constructor of data_frame.
+		 *  Each column is copied once.
+		 *  \param: const lvalue reference to headers(vector<std::string>).
+		 *  \param: const lvalue reference to data(vector<df_column>).
+		 */ 
+		BOOST_UBLAS_INLINE 
+		data_frame (const vector<std::string>& headers, const vector<df_column>& data) :
+			data_frame (headers, vector<df_column> (data)) {}
+
+		/*! \brief Constructor of data_frame.
+		 *  The columns are moved into the data_frame, data is left with empty columns.
+		 *  \param: const lvalue reference to headers(vector<std::string>).
+		 *  \param: rvalue reference to data(vector<df_column>).
+		 */ 
+		BOOST_UBLAS_INLINE 
+		data_frame (const vector<std::string>& headers, vector<df_column>&& data) :
+			generation_ (next_generation()) {
+			try {
+				// exception for unequal headers and columns
+				if (headers.size() != data.size()) {
+					throw inconsistent_arguments();
+				}
+
+				ncol_ = headers.size();
+				nrow_ = (ncol_ > 0) ? data(0).size() : 0; 
+
+				// exception for unequal no. of rows in data_frame columns
+				for(size_t i = 1; i < ncol_; ++i) {
+					if (data (i).size() != nrow_) {
+						throw differing_rows();
+					}
+				}	
+
+				// initialise the data_ members
+				column_headers_ = headers;	
+				data_.reserve(ncol_);
+				
+				for(size_t i = 0; i < ncol_; ++i) {
+					// if a column_name already exists throw an error
+					if ( (i != 0) && index_.find(headers(i), column_headers_) != column_index::npos)  {
+						throw same_header();
+					}	
+					index_.insert(headers(i), i);
+					data_.push_back(std::move(data(i)));
+				}
+
+			}
+			catch (std::exception &e) {
+				std::terminate();
+			}
+		}
+
+		//! \brief Copy Constructor of data_frame.
+		BOOST_UBLAS_INLINE 
+		data_frame (const data_frame& df) :
+			data_ (df.data_),
+			index_ (df.index_),
+			ncol_ (df.ncol_),
+			nrow_ (df.nrow_),
+			generation_ (next_generation()),
+			column_headers_ (df.column_headers_) {}
+
+		//! \brief Move Constructor of data_frame, O(1) in the number of rows, df is left empty.
+		BOOST_UBLAS_INLINE 
+		data_frame (data_frame&& df) noexcept :
+			data_ (std::move(df.data_)),
+			ncol_ (df.ncol_),
+			nrow_ (df.nrow_),
+			generation_ (next_generation()) {
+			index_.swap (df.index_);
+			column_headers_.swap (df.column_headers_);
+			df.ncol_ = df.nrow_ = 0;
+			df.generation_ = next_generation();
+		}
+
+		//! Destructor of data_frame.
+		BOOST_UBLAS_INLINE
+		~data_frame() {}
+
+		//! \brief Copy Assignment operator of data_frame.
+		BOOST_UBLAS_INLINE 
+		data_frame& operator = (const data_frame& df) {
+			if (this != &df) {
+				data_frame tmp (df);
+				swap (tmp);
+			}
+			return *this;
+		}
+
+		//! \brief Move Assignment operator of data_frame.
+		BOOST_UBLAS_INLINE 
+		data_frame& operator = (data_frame&& df) noexcept {
+			swap (df);
+			return *this;
+		}
+
+		//! \brief Swaps the content of two data_frames in O(1), invalidates the handles of both.
+		BOOST_UBLAS_INLINE 
+		void swap (data_frame& df) noexcept {
+			data_.swap (df.data_);
+			index_.swap (df.index_);
+			std::swap (ncol_, df.ncol_);
+			std::swap (nrow_, df.nrow_);
+			column_headers_.swap (df.column_headers_);
+			generation_ = next_generation();
+			df.generation_ = next_generation();
+		}
+
+		// ---------------- 
+		// column accessors 
+		// ---------------- 
+
+		/*! \brief Access operator of data_frame.
+		 *  creates the column (with the given header) if doesn't exist. 
+		 *  Creating a column invalidates the references to the other columns.
+		 *  \param column_header to be accessed.
+		 *  \return Requested df_column.
+		 */ 
+		BOOST_UBLAS_INLINE 
+		df_column& operator[](const std::string& header) {
+			// given column name already exists
+			// return the particular column
+			const size_t i = index_.find(header, column_headers_);
+			if(i != column_index::npos) {
+				return data_ [i];
+			}
+			// create the column (will be furthur used by = operator in df_column)
+			return append(header);
+		}
+		
+		/*! \brief Access operator of data_frame.
+		 *  creates the column (if index is valid and non-existent) if doesn't exist. 
+		 *  valid-index == \c ncol()
+		 *  \param column-index to be accessed.
+		 *  \return Requested df_column.
+		 */ 
+		BOOST_UBLAS_INLINE 
+		df_column& operator[] (const size_t& i) {
+			try {
+				// given column name already exists
+				// return the particular column
+				if(i < ncol_) {
+					return data_ [i];
+				}
+				else if(i > ncol_) {
+					throw holes();
+				} 
+				// custom name if no name is set by default
+				return append(default_name(ncol_));
+			}
+			catch(std::exception &e) {
+				std::terminate();
+			}
+		}
+		
+		/*! \brief Read-only access operator of data_frame.
+		 *  Reading through it keeps the column buffers shared with the copies of the data_frame.
+		 *  \param column_header to be accessed.
+		 *  \return Requested df_column.
+		 */ 
+		BOOST_UBLAS_INLINE 
+		const df_column& operator[](const std::string& header) const {
+			return data_ [find(header)];
+		}
+
+		/*! \brief Read-only access operator of data_frame.
+		 *  \param column-index to be accessed.
+		 *  \return Requested df_column.
+		 */ 
+		BOOST_UBLAS_INLINE 
+		const df_column& operator[] (const size_t& i) const {
+			try {
+				if (i >= ncol_) {
+					throw bad_index();
+				}
+				return data_ [i];
+			}
+			catch(std::exception& e) {
+				std::terminate();
+			}
+		}
+
+		/*! \brief Resolves a column header once, for repeated accesses.
+		 *  \param column_header to be resolved.
+		 *  \return handle of the column, valid until columns are added or erased.
+		 */ 
+		BOOST_UBLAS_INLINE 
+		column_handle handle(const std::string& header) const {
+			return column_handle (find(header), generation_);
+		}
+
+		/*! \brief Access operator of data_frame through a resolved column.
+		 *  \param handle of the column, from \c handle().
+		 *  \return Requested df_column.
+		 */ 
+		BOOST_UBLAS_INLINE 
+		df_column& operator[] (const column_handle& h) {
+			return data_ [check(h)];
+		}
+
+		/*! \brief Read-only access operator of data_frame through a resolved column.
+		 *  \param handle of the column, from \c handle().
+		 *  \return Requested df_column.
+		 */ 
+		BOOST_UBLAS_INLINE 
+		const df_column& operator[] (const column_handle& h) const {
+			return data_ [check(h)];
+		}
+
+		/*! \brief Access operator of data_frame. 
+		 *  \param column_header to be accessed.
+		 *  \param T(template parameter): type of the column data. 
+		 *  \return column_vector<T> version of the column.	
+		 */ 
+		template < class T > 
+		BOOST_UBLAS_INLINE
+		column_vector<T>& column (const std::string& header) {
+			return data_[find(header)].get<T>();
+		}
+
+		/*! \brief Access operator of data_frame. 
+		 *  \param column index to be accessed.
+		 *  \param T(template parameter): type of the column data. 
+		 *  \return column_vector<T> version of the column.	
+		 */ 
+		template < class T > 
+		BOOST_UBLAS_INLINE
+		column_vector<T>& column(const size_t& i) {
+			return data_[i].get<T>();
+		}
+
+		//! \brief Returns the layout generation, renewed whenever columns are added or erased, unique in the program.
+		BOOST_UBLAS_INLINE
+		size_t generation() const {
+			return generation_;
+		}
+
+		// ------------- 
+		// row accessors 
+		// ------------- 
+
+		/*! brief Row Access operator of data_frame.
+		 *  \param row index to be accessed.
+		 *  Returns the row as vector < int, double ...... >, the cells of the string columns as std::string.
+		 */
+		vector < boost::variant < COLUMN_DATA_TYPES > > operator () (const size_t row) {
+			vector < boost::variant < COLUMN_DATA_TYPES > > ret(ncol_);
+			for(size_t i = 0; i < ncol_; ++i) {
+				// read through a const reference, shared buffers are not copied
+				const df_column& col = data_ [i];
+				switch(col.type()) {
+					case 0: 	
+						ret(i) = col.eval<bool>(row);
+						break;
+					case 1: 
+						ret(i) = col.eval<char>(row);
+						break;
+					case 2: 
+						ret(i) = col.eval<unsigned char>(row);
+						break;
+					case 3: 
+						ret(i) = col.eval<short>(row);
+						break;
+					case 4: 
+						ret(i) = col.eval<unsigned short>(row);
+						break;
+					case 5: 
+						ret(i) = col.eval<int>(row);
+						break;
+					case 6: 
+						ret(i) = col.eval<unsigned int>(row);
+						break;
+					case 7: 
+						ret(i) = col.eval<long>(row);
+						break;
+					case 8: 
+						ret(i) = col.eval<unsigned long>(row);
+						break;
+					case 9: 
+						ret(i) = col.eval<long long>(row);
+						break;
+					case 10: 
+						ret(i) = col.eval<unsigned long long>(row);
+						break;
+					case 11: 
+						ret(i) = col.eval<float>(row);
+						break;
+					case 12: 
+						ret(i) = col.eval<double>(row);
+						break;
+					case 13: 
+						ret(i) = col.eval<long double>(row);
+						break;
+					case 14: 
+						ret(i) = col.eval<std::string>(row);
+						break;
+					case 15: 
+						ret(i) = col.eval<std::string*>(row);
+						break;
+					case 16: 
+						ret(i) = std::string (col.eval<string_column>(row));
+						break;
+					case 17: 
+						ret(i) = std::string (col.eval<large_string_column>(row));
+						break;
+					case 18: 
+						ret(i) = std::string (col.eval<dictionary_column>(row));
+						break;
+					case 19: 
+						ret(i) = col.eval<bool_column>(row);
+						break;
+				} 
+			}
+			return ret;
+		} 
+
+		/*! \brief Returns a cursor on the row \c row.
+		 *  Faster than operator () (row): no allocation, no copy of the cells.
+		 */
+		BOOST_UBLAS_INLINE
+		row_cursor cursor (const size_t row = 0) const {
+			return row_cursor (data_.data(), ncol_, row, generation_);
+		}
+
+		/*! \brief Calls fn(x1, x2 ...) on every row, x1, x2 ... being const references to the cells of the columns cols.
+		 *  Ts... are the types of the columns, checked once before the loop.
+		 *  Example: df.for_each_row < int, double > ({"a", "b"}, [](const int& a, const double& b) { ... });
+		 */
+		template < class... Ts, class F >
+		BOOST_UBLAS_INLINE
+		void for_each_row (const std::array < std::string, sizeof...(Ts) >& cols, F fn) const {
+			for_each_row < Ts... > (positions (cols), fn);
+		}
+
+		//! \brief Calls fn(x1, x2 ...) on every row, for the columns at the positions cols.
+		template < class... Ts, class F >
+		BOOST_UBLAS_INLINE
+		void for_each_row (const std::array < size_t, sizeof...(Ts) >& cols, F fn) const {
+			const std::tuple < column_view<const Ts>... > v = views < Ts... > (cols, std::index_sequence_for < Ts... > ());
+			const size_t n = std::get<0> (v).size();
+			std::apply ([n, &fn] (const column_view<const Ts>&... x) {
+				for(size_t i = 0; i < n; ++i) {
+					fn (x[i]...);
 				}
-				break;
-				case 7: if((y.get<long>()(i) != x.get<long>()(i)) ) {
-					return false;
+			}, v);
+		}
+
+		/*! \brief Calls fn(x1, x2 ...) on blocks of at most \c batch rows,
+		 *  x1, x2 ... being column_views on the blocks of the columns cols.
+		 *  Ts... are the types of the columns, checked once before the loop.
+		 */
+		template < class... Ts, class F >
+		BOOST_UBLAS_INLINE
+		void for_each_batch (const std::array < std::string, sizeof...(Ts) >& cols, const size_t batch, F fn) const {
+			for_each_batch < Ts... > (positions (cols), batch, fn);
+		}
+
+		//! \brief Calls fn(x1, x2 ...) on blocks of at most \c batch rows, for the columns at the positions cols.
+		template < class... Ts, class F >
+		BOOST_UBLAS_INLINE
+		void for_each_batch (const std::array < size_t, sizeof...(Ts) >& cols, const size_t batch, F fn) const {
+			try {
+				if (batch == 0) {
+					throw bad_size();
 				}
-				break;
-				case 8: if((y.get<unsigned long>()(i) != x.get<unsigned long>()(i)) ) {
-					return false;
+			}
+			catch (std::exception& e) {
+				std::terminate();
+			}
+			const std::tuple < column_view<const Ts>... > v = views < Ts... > (cols, std::index_sequence_for < Ts... > ());
+			const size_t n = std::get<0> (v).size();
+			std::apply ([n, batch, &fn] (const column_view<const Ts>&... x) {
+				for(size_t i = 0; i < n; i += batch) {
+					const size_t m = std::min (batch, n - i);
+					fn (column_view<const Ts> (x.data() + i, m)...);
 				}
-				break;
-				case 9: if((y.get<long long>()(i) != x.get<long long>()(i)) ) {
-					return false;
+			}, v);
+		}
+
+		// --------- 
+		// filtering 
+		// --------- 
+
+		/*! \brief Returns the rows where mask is \c true, mask being a df_column of bool_column
+		 *  (usually the result of a comparison: df.filter ((df["a"] > 3) & (df["b"] == "x"))).
+		 *  Null elements of the mask count as \c false.
+		 */
+		BOOST_UBLAS_INLINE
+		data_frame filter (const df_column& mask) const {
+			try {
+				if (mask.type() != column_traits<bool_column>::type_id) {
+					throw column_type_mismatch();
 				}
-				break;
-				case 10: if((y.get<unsigned long long>()(i) != x.get<unsigned long long>()(i)) ) {
-					return false;
+			}
+			catch (std::exception& e) {
+				std::terminate();
+			}
+			const bool_column& m = mask.get<bool_column>();
+			if (mask.has_nulls()) {
+				return filter (m & *mask.validity().bits());
+			}
+			return filter (m);
+		}
+
+		/*! \brief Returns the rows i where mask(i) is \c true.
+		 *  The positions of the set bits are extracted once, then every column is gathered in one pass.
+		 */
+		BOOST_UBLAS_INLINE
+		data_frame filter (const bool_column& mask) const {
+			try {
+				if (mask.size() != nrow_) {
+					throw unequal_rows();
 				}
-				break;
-				case 11: if((y.get<float>()(i) != x.get<float>()(i)) ) {
-					return false;
+			}
+			catch (std::exception& e) {
+				std::terminate();
+			}
+			const std::vector < size_t > sel = set_positions (mask);
+			return take (sel);
+		}
+
+		//! \brief Returns the rows rows(0), rows(1) ... with their nulls, gathering each column once.
+		BOOST_UBLAS_INLINE
+		data_frame take (const std::vector < size_t >& rows) const {
+			try {
+				for(const size_t r: rows) {
+					if (r >= nrow_) {
+						throw bad_index();
+					}
 				}
-				break;
-				case 12: if((y.get<double>()(i) != x.get<double>()(i)) ) {
-					return false;
+			}
+			catch (std::exception& e) {
+				std::terminate();
+			}
+			vector < df_column > cols (ncol_);
+			for(size_t i = 0; i < ncol_; ++i) {
+				column_select (data_[i], rows.data(), rows.size(), cols(i));
+			}
+			return data_frame (column_headers_, std::move (cols));
+		}
+
+		// --------- 
+		// row views 
+		// --------- 
+
+		//! \brief Returns a view on the rows [begin, end), without copy.
+		BOOST_UBLAS_INLINE
+		data_frame_row_range rows (const size_t begin, const size_t end) const;
+
+		//! \brief Returns a view on the rows start, start + stride ... (size rows), without copy.
+		BOOST_UBLAS_INLINE
+		data_frame_row_slice rows (const size_t start, const std::ptrdiff_t stride, const size_t size) const;
+
+		/*! \brief Returns a view on the rows indices(0), indices(1) ..., without copy of the columns.
+		 *  Example: train / test split on a shuffled permutation of the rows.
+		 */
+		BOOST_UBLAS_INLINE
+		data_frame_row_indirect rows (const std::vector < size_t >& indices) const;
+
+		//! \brief Returns a view on the first n rows.
+		BOOST_UBLAS_INLINE
+		data_frame_row_range head (const size_t n = 5) const;
+
+		//! \brief Returns a view on the last n rows.
+		BOOST_UBLAS_INLINE
+		data_frame_row_range tail (const size_t n = 5) const;
+
+		// ------- 
+		// sorting 
+		// ------- 
+
+		/*! \brief Returns the permutation sorting the rows by the columns keys: by keys(0), then keys(1) ...
+		 *  df.argsort ({{"a", sort_order::asc}, {"b", sort_order::desc}}).
+		 *  One stable sort per key, from the last key to the first. Nulls come last.
+		 *  \param stable: \c true to keep the order of the rows of equal keys in the comparison sorts.
+		 */
+		BOOST_UBLAS_INLINE
+		std::vector < size_t > argsort (const std::vector < sort_key >& keys, const bool stable = false) const {
+			std::vector < size_t > perm (nrow_);
+			for(size_t i = 0; i < nrow_; ++i) {
+				perm[i] = i;
+			}
+			for(size_t k = keys.size(); k-- > 0; ) {
+				// only the first pass may be unstable, the next ones keep its order within equal keys
+				sort_rows (data_[find (keys[k].column)], perm.data(), nrow_, keys[k].order, stable || k + 1 < keys.size());
+			}
+			return perm;
+		}
+
+		//! \brief Returns the data_frame sorted by the columns keys, one gather per column.
+		BOOST_UBLAS_INLINE
+		data_frame sort_by (const std::vector < sort_key >& keys, const bool stable = false) const {
+			return take (argsort (keys, stable));
+		}
+
+		// -------- 
+		// grouping 
+		// -------- 
+
+		/*! \brief Groups the rows by the values of the columns keys, to aggregate the other columns:
+		 *  df.group_by ({"k1", "k2"}).agg ({{"x", aggregation::sum}, {"y", aggregation::mean}}).
+		 *  The result refers to the data_frame, which must outlive it.
+		 */
+		BOOST_UBLAS_INLINE
+		grouped_data_frame group_by (const std::vector < std::string >& keys) const;
+
+		// ------- 
+		// joining 
+		// ------- 
+
+		/*! \brief Returns the join of the data_frame (left) with right on the columns keys, present in both.
+		 *  The rows are in the order of the left rows, the columns are the left ones, then for inner and left
+		 *  joins the right ones but the keys ("_right" is appended to the headers already taken, until free).
+		 *  Put the smaller data_frame on the right: it is the one indexed in a hash table.
+		 *  \param threads: number of threads of the probe, 0 for std::thread::hardware_concurrency().
+		 */
+		BOOST_UBLAS_INLINE
+		data_frame join (const data_frame& right, const std::vector < std::string >& keys, 
+			const join_type how = join_type::inner, const size_t threads = 0) const;
+
+		//! \brief Returns the join of the data_frame with right, on left_keys(i) == right_keys(i).
+		BOOST_UBLAS_INLINE
+		data_frame join (const data_frame& right, const std::vector < std::string >& left_keys, const std::vector < std::string >& right_keys, 
+			const join_type how = join_type::inner, const size_t threads = 0) const;
+
+		// ------------ 
+		// erase column 
+		// ------------ 
+
+		/*! \brief erase_column operator of data_frame.
+		 *  erase the column(\c i) and restructure the data_frame.  
+		 *  \param column index to be erased.
+		 */ 
+		BOOST_UBLAS_INLINE 
+		void erase_column(const size_t i) {
+			try {
+				if ( (i >= column_headers_.size()) || (i < 0)) {
+					throw bad_index();
 				}
-				break;
-				case 13: if((y.get<long double>()(i) != x.get<long double>()(i)) ) {
-					return false;
+				/// \i is valid so delete the column[$i]
+				data_.erase(data_.begin() + i);
+				remove(column_headers_, i);
+				--ncol_;
+				index_.rebuild(column_headers_, ncol_);
+				generation_ = next_generation();
+			}
+			catch(std::exception &e){
+				std::terminate();
+			}
+		}
+		
+		/*! \brief erase_column operator of data_frame.
+		 *  erase the column(\c header) and restructure the data_frame.  
+		 *  \param column header to be accessed.
+		 */ 
+		BOOST_UBLAS_INLINE 
+		void erase_column(const std::string& header) {
+			try {
+				const size_t i = index_.find(header, column_headers_);
+				if (i == column_index::npos) {
+					throw undefined_column_header();
 				}
-				break;
-				case 14: if((y.get<std::string>()(i) != x.get<std::string>()(i)) ) {
-					return false;
+				// name is valid so delete the column[$name]
+				erase_column(i);
+			}
+			catch(std::exception &e) {
+				std::terminate();
+			}
+		}
+
+		// ---------- 
+		// add column 
+		// ---------- 
+
+		/*! \brief add_column operator of data_frame.
+		 *  adds column at the end of the data_frame columns.  
+		 *  \param column header
+		 *  \param const lvalue reference to the column data in the form of df_column. 
+		 */ 		
+		BOOST_UBLAS_INLINE
+		data_frame& add_column(const std::string& header, const df_column& col) {
+			return add_column (header, df_column (col));
+		}
+
+		/*! \brief add_column operator of data_frame.
+		 *  adds column at the end of the data_frame columns, the column is moved into the data_frame.  
+		 *  \param column header
+		 *  \param rvalue reference to the column data in the form of df_column. 
+		 */ 		
+		BOOST_UBLAS_INLINE
+		data_frame& add_column(const std::string& header, df_column&& col) {
+			try {
+				if (index_.find(header, column_headers_) != column_index::npos) {
+					throw same_header(); 
 				}
-				break;
-				case 15: if((y.get<std::string*>()(i) != x.get<std::string*>()(i)) ) {
-					return false;
+				append(header) = std::move(col);
+				return *this;
+			}
+			catch (std::exception& e) {
+				std::terminate();
+			}
+		}
+
+		/*! \brief prints the data in the data_frame.
+		 *  Print Format: [column header]: data(0) data(1) .......  
+		 */ 		
+		BOOST_UBLAS_INLINE 
+		void print(std::ostream& out = std::cout) {
+			for(size_t i = 0; i < ncol_; ++i) {
+				out << "[" << column_headers_(i) << "]" << ": ";
+				data_ [i].apply_visitor (print_data_frame_column (&data_ [i].validity(), out));
+			}
+			out.flush();
+		}
+											
+		// -----------------
+		// Storage Accessors
+		// -----------------
+
+		//! \brief Returns the headers of data_frame as vector<std::string>.
+		BOOST_UBLAS_INLINE
+		vector<std::string>& headers() {
+			return column_headers_;
+		}
+
+		//! \brief Returns the headers of data_frame as vector<std::string>.
+		BOOST_UBLAS_INLINE
+		const vector<std::string>& headers() const {
+			return column_headers_;
+		}
+
+		// ------------------------
+		// Random Access Containers
+		// ------------------------
+
+		//! \brief Returns the no. of columns in data_frame.
+		BOOST_UBLAS_INLINE
+		const size_t ncol() const {
+			return ncol_;
+		}
+
+		//! \brief Returns the no. of rows in data_frame.
+		BOOST_UBLAS_INLINE
+		const size_t nrow() const {
+			return nrow_;
+		}
+
+		//! \brief Returns the column header at i-th index.
+		BOOST_UBLAS_INLINE
+		const std::string colname(const size_t& i) {
+			return column_headers_(i);
+		}
+
+		// ---------------------
+		// Statistical Summaries
+		// ---------------------
+
+		/*! \brief prints the column statistics in the data_frame.
+		 *  Print Format: [column header]: Min. : .., Max. : .., Mean : .., Std. Dev. : .., Count : ..
+		 *  Doesn't calculate statistics of non numerical types.
+		 */ 
+		BOOST_UBLAS_INLINE
+		void summary() {
+			for(size_t i = 0; i < ncol_; ++i) {
+				std::cout << "[" << column_headers_(i) << "]" << ": ";
+				const df_column& col = data_[i];
+				switch(col.type()) {
+					case 0: 	
+						std::cout << col.summary <bool, long double >() << std::endl; break;
+					case 3: 
+						std::cout << col.summary <short, long double >() << std::endl; break;
+					case 4: 
+						std::cout << col.summary <unsigned short, long double >() << std::endl; break;
+					case 5: 
+						std::cout << col.summary <int, long double >() << std::endl; break;
+					case 6: 
+						std::cout << col.summary <unsigned int, long double >() << std::endl; break;
+					case 7: 
+						std::cout << col.summary <long, long double >() << std::endl; break;
+					case 8: 
+						std::cout << col.summary <unsigned long, long double >() << std::endl; break;
+					case 9: 
+						std::cout << col.summary <long long, long double >() << std::endl; break;
+					case 10: 
+						std::cout << col.summary <unsigned long long, long double >() << std::endl; break;
+					case 11: 
+						std::cout << col.summary <float, long double >() << std::endl; break;
+					case 12: 
+						std::cout << col.summary <double, long double >() << std::endl; break;
+					case 13: 
+						std::cout << col.summary <long double, long double >() << std::endl; break;
+					default: 
+						std::cout << "Statistical Summaries not defined" << std::endl;
 				}
-				break;
 			}
 		}
-		return true;
-	}
 
-	//! \brief Returns \c false if \c y.size() == \c x.size() and \c y.get<T> == \c x.get<T>() else \c true
-	BOOST_UBLAS_INLINE
-	bool operator != (df_column& y, df_column& x) {
-		return !(x == y);
-	}
+		//! \brief Adds another data_frame to self.
+		BOOST_UBLAS_INLINE
+		data_frame operator += (data_frame& df_) {
+			return (*this) = (*this) + df_;
+		}
 
+		//! \brief Subtracts another data_frame from self.
+		BOOST_UBLAS_INLINE
+		data_frame operator -= (data_frame& df_) {
+			return (*this) = (*this) - df_;
+		}
 
-	BOOST_UBLAS_INLINE
-	void remove (vector<std::string>& v, size_t idx) {
-	    for (size_t i = idx; i < v.size() - 1; i++) {
-	        v(i) = v(i + 1);
-	    }
-	    v.resize(v.size() - 1);
-	    return;
-	}
+		//! \brief Adds a constant value to self.
+		BOOST_UBLAS_INLINE
+		template < class T > 
+		data_frame operator += (const T& val) {
+			return (*this) = (*this) + val;
+		}
 
-	//! Represents a dataframe.
-	/*! Internally represented as map < string, df_column > and a vector < string> to store the headers.
-	 *	Allowed types are: int, double, char, std::string...... (specified in INNER_TYPE).
-	 */
-	class data_frame {
-	public:
-		
-		friend data_frame operator + (data_frame& a, data_frame& b);
-		friend data_frame operator - (data_frame& a, data_frame& b);
-		template < class T > friend data_frame operator + (data_frame& a, const T& val);
-		template < class T > friend data_frame operator - (data_frame& a, const T& val);
-		template < class T > friend data_frame operator * (data_frame& a, const T& val);
-		 
-		// construction and destruction
+		//! \brief Subtracts constant value from self.
+		BOOST_UBLAS_INLINE
+		template < class T > 
+		data_frame operator -= (const T& val) {
+			return (*this) = (*this) - val;
+		}
+
+		//! \brief Multiplies constant value to self.
+		BOOST_UBLAS_INLINE
+		template < class T > 
+		data_frame operator *= (const T& val) {
+			return (*this) = (*this) * val;
+		}
 		
-		/*! \brief Constructor of data_frame.
-		 *  By default \c nrow() == 0 and ncol() == 0.
-		 *  type of the columns is unset.
-		 */ 
+		/*! \brief Update the column header of a column.
+		 *	\param std::string to be updated, std::string updated to.
+		 */
 		BOOST_UBLAS_INLINE 
-		data_frame () :
-			ncol_ (0),
-			nrow_ (0) {}
+		void set_col_header(const std::string& a, const std::string& b) {
+			try {
+				const size_t i = index_.find(a, column_headers_);
+				if (i == column_index::npos) {
+					throw column_header_mismatch();
+				}
+				set_col_header(i, b);
+			}
+			catch (std::exception& e) {
+				std::terminate();
+			}
+		}
 
-		/*! \brief Constructor of data_frame.
-		 *  \param: const lvalue reference to headers(vector<std::string>).
-		 *  \param: const lvalue reference to data(vector<df_column>).
-		 */ 
+		/*! \brief Update the column header of a column.
+		 *	\param index of the column to be updated, std::string updated to.
+		 */
 		BOOST_UBLAS_INLINE 
-		data_frame (const vector<std::string>& headers, const vector<df_column>& data) {
+		void set_col_header(const size_t col, const std::string& b) {
 			try {
-				// exception for unequal headers and columns
-				if (headers.size() != data.size()) {
-					throw inconsistent_arguments();
+				if (col >= ncol_) {
+					throw bad_index();
+				}
+				if (column_headers_(col) == b) {
+					return;
+				}
+				if (index_.find(b, column_headers_) != column_index::npos) {
+					throw same_header();
 				}
+				column_headers_(col) = b;
+				index_.rebuild(column_headers_, ncol_);
+			}
+			catch (std::exception& e) {
+				std::terminate();
+			}
+		}
 
-				ncol_ = headers.size();
-				nrow_ = (ncol_ > 0) ? data(0).size() : 0; 
+	private:
+		//! \brief Stores the columns, in the order of the headers.
+		std::vector < df_column > data_;
+		//! \brief Position of the columns by header.
+		column_index index_;
+		//! \brief Stores sizes.
+		size_t ncol_, nrow_;
+		//! \brief Layout generation, see column_handle.
+		size_t generation_;
+		//! \brief Stores column headers.
+		vector < std::string> column_headers_;
 
-				// exception for unequal no. of rows in data_frame columns
-				for(size_t i = 1; i < ncol_; ++i) {
-					if (data (i).size() != nrow_) {
-						throw differing_rows();
-					}
-				}	
+		/*! \brief Returns a layout generation never returned before, in any data_frame:
+		 *  a handle resolved in a data_frame is stale in every other one.
+		 */
+		static BOOST_UBLAS_INLINE
+		size_t next_generation() {
+			static std::atomic < size_t > last (0);
+			return last.fetch_add (1, std::memory_order_relaxed) + 1;
+		}
 
-				// initialise the data_ members
-				column_headers_ = headers;	
-				
-				for(size_t i = 0; i < ncol_; ++i) {
-					// if a column_name already exists throw an error
-					if ( (i != 0) && (data_.find(headers(i))) != data_.end())  {
-						throw same_header();
-					}	
-					data_.insert({headers(i), data(i)});
+		//! \brief Returns the position of the column header, terminates if it doesn't exist.
+		BOOST_UBLAS_INLINE
+		size_t find(const std::string& header) const {
+			try {
+				const size_t i = index_.find(header, column_headers_);
+				if (i == column_index::npos) {
+					throw undefined_column_header();
 				}
-
+				return i;
 			}
-			catch (std::exception &e) {
+			catch(std::exception& e) {
 				std::terminate();
 			}
 		}
 
-		//! Destructor of data_frame.
+		//! \brief Returns the position of the column of a handle, terminates if the handle is stale.
 		BOOST_UBLAS_INLINE
-		~data_frame() {}
+		size_t check(const column_handle& h) const {
+			try {
+				if (h.generation_ != generation_ || h.index_ >= ncol_) {
+					throw stale_column_handle();
+				}
+				return h.index_;
+			}
+			catch(std::exception& e) {
+				std::terminate();
+			}
+		}
 
-		// ---------------- 
-		// column accessors 
-		// ---------------- 
+		//! \brief Returns the positions of the column headers.
+		template < size_t N >
+		BOOST_UBLAS_INLINE
+		std::array < size_t, N > positions(const std::array < std::string, N >& headers) const {
+			std::array < size_t, N > ret;
+			for(size_t k = 0; k < N; ++k) {
+				ret[k] = find(headers[k]);
+			}
+			return ret;
+		}
 
-		/*! \brief Access operator of data_frame.
-		 *  creates the column (with the given header) if doesn't exist. 
-		 *  \param column_header to be accessed.
-		 *  \return Requested df_column.
-		 */ 
-		BOOST_UBLAS_INLINE 
-		df_column& operator[](const std::string& header) {
-			// given column name already exists
-			// return the particular column
-			if(data_.find(header) != data_.end()) {
-				return data_ [header];
+		//! \brief Returns views on the columns at the positions cols, checking their types and sizes.
+		template < class... Ts, size_t... I >
+		BOOST_UBLAS_INLINE
+		std::tuple < column_view<const Ts>... > views(const std::array < size_t, sizeof...(Ts) >& cols, std::index_sequence < I... >) const {
+			static_assert (sizeof...(Ts) > 0, "at least one column is needed");
+			try {
+				for(size_t k = 0; k < cols.size(); ++k) {
+					if (cols[k] >= ncol_) {
+						throw bad_index();
+					}
+					if (data_[cols[k]].size() != data_[cols[0]].size()) {
+						throw differing_rows();
+					}
+				}
+				const bool types[] = { data_[cols[I]].data().template holds<Ts>()... };
+				for(size_t k = 0; k < cols.size(); ++k) {
+					if (!types[k]) {
+						throw column_type_mismatch();
+					}
+				}
 			}
-			// create the column (will be furthur used by = operator in df_column)
+			catch (std::exception& e) {
+				std::terminate();
+			}
+			return std::tuple < column_view<const Ts>... > (data_[cols[I]].template view<Ts>()...);
+		}
+
+		//! \brief Adds an empty column at the end of the data_frame and returns it.
+		BOOST_UBLAS_INLINE
+		df_column& append(const std::string& header) {
 			column_headers_.resize(ncol_ + 1);
 			column_headers_(ncol_) = header;
+			index_.insert(header, ncol_);
+			data_.emplace_back();
 			++ncol_;
-			return data_ [header];
+			generation_ = next_generation();
+			return data_.back();
 		}
 		
-		/*! \brief Access operator of data_frame.
-		 *  creates the column (if index is valid and non-existent) if doesn't exist. 
-		 *  valid-index == \c ncol()
-		 *  \param column-index to be accessed.
-		 *  \return Requested df_column.
-		 */ 
-		BOOST_UBLAS_INLINE 
-		df_column& operator[] (const size_t& i) {
-			try {
-				// given column name already exists
-				// return the particular column
-				if(i < ncol_) {
-					return data_ [column_headers_ (i)];
+		//! \brief Returns the default column name.
+		//! used when the column name is not set by the user.s
+		BOOST_UBLAS_INLINE
+		std::string default_name(size_t i) {
+			return ("Col-" + boost::lexical_cast<std::string>(i));
+		}
+	};
+
+
+	
+	// --------
+	// Group By
+	// --------
+
+	//! \brief Aggregations computed by grouped_data_frame::agg().
+	enum class aggregation {
+		count,		//!< number of non null values, unsigned long
+		sum,		//!< sum of the values, exact long long (unsigned long long) for the (unsigned) integers, else double, 0 for a group without values
+		mean,		//!< mean of the values, double
+		min,		//!< smallest value, in the type of the column
+		max,		//!< largest value, in the type of the column
+		variance,	//!< sample variance, double, null for a group of less than 2 values
+		stddev		//!< sample standard deviation, double, null for a group of less than 2 values
+	};
+
+	//! \brief Returns the suffix of the header of the column of an aggregation: "sum", "mean" ...
+	BOOST_UBLAS_INLINE
+	const char* aggregation_name (const aggregation a) {
+		switch (a) {
+			case aggregation::count: return "count";
+			case aggregation::sum: return "sum";
+			case aggregation::mean: return "mean";
+			case aggregation::min: return "min";
+			case aggregation::max: return "max";
+			case aggregation::variance: return "variance";
+			case aggregation::stddev: return "stddev";
+		}
+		return "";
+	}
+
+	//! \brief Aggregation of a column: {"x", aggregation::sum}, written to the column "x_sum".
+	struct column_aggregate {
+		std::string column;
+		aggregation function;
+	};
+
+	//! \brief Mixes the hashes of the elements first ... last - 1 of a column into h(0) ... h(last - first - 1).
+	class column_hash_visitor: public boost::static_visitor<void> {
+	public:
+		BOOST_UBLAS_INLINE
+		column_hash_visitor (const size_t first, const size_t last, std::uint64_t* h): 
+			first_ (first), 
+			last_ (last), 
+			h_ (h) {}
+
+		template < class T >
+		BOOST_UBLAS_INLINE
+		void operator () (const column_vector<T>& x) const {
+			const T* p = x.data().begin();
+			for(size_t i = first_; i < last_; ++i) {
+				h_[i - first_] = kernel::hash_combine (h_[i - first_], std::hash<T> () (p[i]));
+			}
+		}
+
+		/*! \brief Dictionary columns hash each distinct string once, then look the hashes up by code.
+		 *  The hashes are those of the strings, so they match across dictionaries and string columns.
+		 */
+		BOOST_UBLAS_INLINE
+		void operator () (const dictionary_column& x) const {
+			const string_column& d = x.dictionary();
+			std::vector < size_t > dh (d.size());
+			for(size_t c = 0; c < d.size(); ++c) {
+				dh[c] = d.hash (c);
+			}
+			x.with_codes ([this, &dh] (const auto* codes, const size_t) {
+				for(size_t i = first_; i < last_; ++i) {
+					h_[i - first_] = kernel::hash_combine (h_[i - first_], dh[codes[i]]);
 				}
-				else if(i > ncol_) {
-					throw holes();
-				} 
-				// custom name if no name is set by default
-				column_headers_.resize(ncol_ + 1);
-				column_headers_(ncol_) = default_name(ncol_); 
-				++ncol_;
-				return data_ [column_headers_(i)];
+			});
+		}
+
+		//! \brief string and bool columns.
+		template < class C >
+		BOOST_UBLAS_INLINE
+		void operator () (const C& x) const {
+			for(size_t i = first_; i < last_; ++i) {
+				h_[i - first_] = kernel::hash_combine (h_[i - first_], std::hash < typename C::value_type > () (x(i)));
+			}
+		}
+
+	private:
+		size_t first_;
+		size_t last_;
+		std::uint64_t* h_;
+	};
+
+	//! \brief Returns \c true if the element r1 of a column x equals the element r2 of y, a column of the same type.
+	class row_equal_visitor: public boost::static_visitor<bool> {
+	public:
+		BOOST_UBLAS_INLINE
+		row_equal_visitor (const df_column& y, const size_t r1, const size_t r2): 
+			y_ (y), 
+			r1_ (r1), 
+			r2_ (r2) {}
+
+		template < class T >
+		BOOST_UBLAS_INLINE
+		bool operator () (const column_vector<T>& x) const {
+			return x.data().begin()[r1_] == y_.get<T>().data().begin()[r2_];
+		}
+
+		//! \brief Codes are compared if the dictionary is shared, strings otherwise.
+		BOOST_UBLAS_INLINE
+		bool operator () (const dictionary_column& x) const {
+			const dictionary_column& y = y_.get<dictionary_column>();
+			if (&x.dictionary() == &y.dictionary()) {
+				return x.code (r1_) == y.code (r2_);
+			}
+			return x(r1_) == y(r2_);
+		}
+
+		template < class C >
+		BOOST_UBLAS_INLINE
+		bool operator () (const C& x) const {
+			return x(r1_) == y_.get < typename column_tag<C>::type >()(r2_);
+		}
+
+	private:
+		const df_column& y_;
+		size_t r1_;
+		size_t r2_;
+	};
+
+	//! \brief Writes the hashes of the keys of the rows first ... last - 1 into h(0) ... h(last - first - 1).
+	BOOST_UBLAS_INLINE
+	void hash_rows (const std::vector < const df_column* >& keys, const size_t first, const size_t last, std::uint64_t* h) {
+		std::fill (h, h + (last - first), 0);
+		for(const df_column* k: keys) {
+			k->apply_visitor (column_hash_visitor (first, last, h));
+		}
+		for(size_t i = 0; i < last - first; ++i) {
+			h[i] = kernel::hash_finalize (h[i]);
+		}
+	}
+
+	/*! \brief Sets valid(i) to \c false for the rows with a null key.
+	 *  Returns \c false, leaving valid unchanged, if no key has nulls.
+	 */
+	BOOST_UBLAS_INLINE
+	bool valid_rows (const std::vector < const df_column* >& keys, bitmap& valid) {
+		bool nulls = false;
+		for(const df_column* k: keys) {
+			if (k->has_nulls()) {
+				valid = nulls ? (valid & *k->validity().bits()) : *k->validity().bits();
+				nulls = true;
 			}
-			catch(std::exception &e) {
-				std::terminate();
+		}
+		return nulls;
+	}
+
+	//! \brief Returns \c true if the keys x of row r1 equal the keys y of row r2, column by column.
+	BOOST_UBLAS_INLINE
+	bool equal_rows (const std::vector < const df_column* >& x, const size_t r1, const std::vector < const df_column* >& y, const size_t r2) {
+		for(size_t k = 0; k < x.size(); ++k) {
+			if (!x[k]->apply_visitor (row_equal_visitor (*y[k], r1, r2))) {
+				return false;
 			}
 		}
-		
-		/*! \brief Access operator of data_frame. 
-		 *  \param column_header to be accessed.
-		 *  \param T(template parameter): type of the column data. 
-		 *  \return vector<T> version of the column.	
-		 */ 
-		template < class T > 
+		return true;
+	}
+
+	/*! \brief Returns the number of threads to process n rows, each one handling at least min_rows rows.
+	 *  \param threads: requested number of threads, 0 for std::thread::hardware_concurrency().
+	 */
+	BOOST_UBLAS_INLINE
+	size_t worker_threads (const size_t n, size_t threads, const size_t min_rows = 1 << 15) {
+		if (threads == 0) {
+			threads = std::max < size_t > (1, std::thread::hardware_concurrency());
+		}
+		return std::min (threads, std::max < size_t > (1, n / min_rows));
+	}
+
+	/*! \brief Runs fn(t, first, last) on threads blocks of consecutive rows of [0, n), in parallel,
+	 *  block t being run by the calling thread if t == 0.
+	 */
+	template < class F >
+	BOOST_UBLAS_INLINE
+	void parallel_blocks (const size_t n, const size_t threads, F fn) {
+		std::vector < std::thread > pool;
+		for(size_t t = 1; t < threads; ++t) {
+			pool.emplace_back ([&fn, n, t, threads] () { fn (t, n * t / threads, n * (t + 1) / threads); });
+		}
+		fn (0, 0, n / threads);
+		for(std::thread& th: pool) {
+			th.join();
+		}
+	}
+
+	/*! \brief Accumulator of the values of a group: their summary, and the exact min, max and sum of
+	 *  the integers, which the long double of the summary rounds when it is not wider than a double.
+	 */
+	struct group_accumulator {
+		column_summary<long double> values;
+		//! \brief Min and max of the signed integers.
+		long long smin = 0;
+		long long smax = 0;
+		//! \brief Min and max of the unsigned integers and bool.
+		unsigned long long umin = 0;
+		unsigned long long umax = 0;
+		//! \brief Sum of the integers, modulo 2^64.
+		unsigned long long isum = 0;
+
+		template < class T >
 		BOOST_UBLAS_INLINE
-		vector<T>& column (const std::string& header) {
-			try {
-				if (data_.find(header) == data_.end()) {
-					throw undefined_column_header();
+		void push (const T x) {
+			if constexpr (std::is_integral<T>::value) {
+				if constexpr (std::is_signed<T>::value) {
+					smin = (values.count == 0 || x < smin) ? x : smin;
+					smax = (values.count == 0 || smax < x) ? x : smax;
 				}
-				return data_[header].get<T>();
-			}
-			catch(std::exception& e) {
-				std::terminate();
+				else {
+					umin = (values.count == 0 || x < umin) ? x : umin;
+					umax = (values.count == 0 || umax < x) ? x : umax;
+				}
+				isum += static_cast<unsigned long long> (x);
 			}
+			values.push (x);
 		}
 
-		/*! \brief Access operator of data_frame. 
-		 *  \param column index to be accessed.
-		 *  \param T(template parameter): type of the column data. 
-		 *  \return vector<T> version of the column.	
-		 */ 
-		template < class T > 
 		BOOST_UBLAS_INLINE
-		vector<T>& column(const size_t& i) {
-			return data_[column_headers_ (i)].get<T>();
+		void merge (const group_accumulator& other) {
+			if (other.values.count == 0) {
+				return;
+			}
+			if (values.count == 0) {
+				*this = other;
+				return;
+			}
+			smin = std::min (smin, other.smin);
+			smax = std::max (smax, other.smax);
+			umin = std::min (umin, other.umin);
+			umax = std::max (umax, other.umax);
+			isum += other.isum;
+			values.merge (other.values);
 		}
+	};
 
-		// ------------- 
-		// row accessors 
-		// ------------- 
+	/*! \brief Adds the elements first ... last - 1 of a column to the summaries of their groups,
+	 *  group(i - first) being the group of row i, group_table::npos to skip the row.
+	 *  Null elements are skipped. Without \c values only the counts are updated,
+	 *  which is the only aggregation of the non numeric columns.
+	 */
+	class group_summary_visitor: public boost::static_visitor<void> {
+	public:
+		BOOST_UBLAS_INLINE
+		group_summary_visitor (const size_t* group, const size_t first, const size_t last, const bitmap* valid, group_accumulator* acc, const bool values): 
+			group_ (group), 
+			first_ (first), 
+			last_ (last), 
+			valid_ (valid), 
+			acc_ (acc), 
+			values_ (values) {}
 
-		/*! brief Row Access operator of data_frame.
-		 *  \param row index to be accessed.
-		 *  Returns the row as vector < int, double ...... >.
-		 */
-		vector < boost::variant < COLUMN_DATA_TYPES > > operator () (const size_t row) {
-			vector < boost::variant < COLUMN_DATA_TYPES > > ret(ncol_);
-			for(size_t i = 0; i < ncol_; ++i) {
-				switch((*this)[i].type()) {
-					case 0: 	
-						ret(i) = (*this)[i].eval<bool>(row);
-						break;
-					case 1: 
-						ret(i) = (*this)[i].eval<char>(row);
-						break;
-					case 2: 
-						ret(i) = (*this)[i].eval<unsigned char>(row);
-						break;
-					case 3: 
-						ret(i) = (*this)[i].eval<short>(row);
-						break;
-					case 4: 
-						ret(i) = (*this)[i].eval<unsigned short>(row);
-						break;
-					case 5: 
-						ret(i) = (*this)[i].eval<int>(row);
-						break;
-					case 6: 
-						ret(i) = (*this)[i].eval<unsigned int>(row);
-						break;
-					case 7: 
-						ret(i) = (*this)[i].eval<long>(row);
-						break;
-					case 8: 
-						ret(i) = (*this)[i].eval<unsigned long>(row);
-						break;
-					case 9: 
-						ret(i) = (*this)[i].eval<long long>(row);
-						break;
-					case 10: 
-						ret(i) = (*this)[i].eval<unsigned long long>(row);
-						break;
-					case 11: 
-						ret(i) = (*this)[i].eval<float>(row);
-						break;
-					case 12: 
-						ret(i) = (*this)[i].eval<double>(row);
-						break;
-					case 13: 
-						ret(i) = (*this)[i].eval<long double>(row);
-						break;
-					case 14: 
-						ret(i) = (*this)[i].eval<std::string>(row);
-						break;
-					case 15: 
-						ret(i) = (*this)[i].eval<std::string*>(row);
-						break;
-				} 
+		template < class T >
+		BOOST_UBLAS_INLINE
+		typename std::enable_if < is_numeric_column<T>::value >::type
+		operator () (const column_vector<T>& x) const {
+			if (!values_) {
+				count();
+				return;
 			}
-			return ret;
-		} 
-
-		// ------------ 
-		// erase column 
-		// ------------ 
-
-		/*! \brief erase_column operator of data_frame.
-		 *  erase the column(\c i) and restructure the data_frame.  
-		 *  \param column index to be erased.
-		 */ 
-		BOOST_UBLAS_INLINE 
-		void erase_column(const size_t i) {
-			try {
-				if ( (i >= column_headers_.size()) || (i < 0)) {
-					throw bad_index();
+			const T* p = x.data().begin();
+			for(size_t i = first_; i < last_; ++i) {
+				const size_t g = group_[i - first_];
+				if (g != group_table::npos && (valid_ == 0 || (*valid_)(i))) {
+					acc_[g].push (p[i]);
 				}
-				/// \i is valid so delete the column[$i]
-				data_.erase(column_headers_[i]);
-				remove(column_headers_, i);
-				--ncol_;
 			}
-			catch(std::exception &e){
-				std::terminate();
+		}
+
+		template < class C >
+		BOOST_UBLAS_INLINE
+		void operator () (const C&) const {
+			if (values_) {
+				throw undefined_operation();
 			}
+			count();
 		}
-		
-		/*! \brief erase_column operator of data_frame.
-		 *  erase the column(\c header) and restructure the data_frame.  
-		 *  \param column header to be accessed.
-		 */ 
-		BOOST_UBLAS_INLINE 
-		void erase_column(const std::string& header) {
-			try {
-				if (data_.find(header) == data_.end()) {
-					throw undefined_column_header();
-				}
-				// name is valid so delete the column[$name]
-				data_.erase(header);
-				for(size_t i = 0; i < column_headers_.size(); i++) {
-					if (header == column_headers_(i)) {
-						remove(column_headers_, i);
-						break;
-					}
+
+	private:
+		const size_t* group_;
+		size_t first_;
+		size_t last_;
+		const bitmap* valid_;
+		group_accumulator* acc_;
+		bool values_;
+
+		BOOST_UBLAS_INLINE
+		void count () const {
+			for(size_t i = first_; i < last_; ++i) {
+				const size_t g = group_[i - first_];
+				if (g != group_table::npos && (valid_ == 0 || (*valid_)(i))) {
+					++acc_[g].values.count;
 				}
-				--ncol_;
-			}
-			catch(std::exception &e) {
-				std::terminate();
 			}
 		}
+	};
 
-		// ---------- 
-		// add column 
-		// ---------- 
+	/*! \brief Writes an aggregation of the accumulators of the groups of a column into out: the count as
+	 *  unsigned long, min and max in the type of the column, the sum of integers as long long (unsigned long long
+	 *  for the unsigned integers and bool), the other aggregations as double. A group with too few values for the
+	 *  aggregation (none, or one for variance and stddev) is null, but for the count and the sum.
+	 */
+	class group_write_visitor: public boost::static_visitor<void> {
+	public:
+		BOOST_UBLAS_INLINE
+		group_write_visitor (const std::vector < group_accumulator >& acc, const aggregation f, df_column& out):
+			acc_ (acc),
+			f_ (f),
+			out_ (out) {}
 
-		/*! \brief add_column operator of data_frame.
-		 *  adds column at the end of the data_frame columns.  
-		 *  \param column header
-		 *  \param const lvalue reference to the column data in the form of df_column. 
-		 */ 		
+		template < class T >
 		BOOST_UBLAS_INLINE
-		data_frame& add_column(const std::string& header, const df_column& col) {
-			try {
-				for(size_t i = 0; i < ncol_; ++i) {
-					if (column_headers_(i) == header) {
-						same_header(); 
+		typename std::enable_if < is_numeric_column<T>::value >::type
+		operator () (const column_vector<T>&) const {
+			const size_t n = acc_.size();
+			if (f_ == aggregation::count) {
+				count();
+				return;
+			}
+			if (f_ == aggregation::min || f_ == aggregation::max) {
+				column_vector<T>& x = out_.resize<T>(n);
+				for(size_t g = 0; g < n; ++g) {
+					x(g) = extreme<T> (acc_[g], f_ == aggregation::min);
+				}
+			}
+			else if constexpr (std::is_integral<T>::value) {
+				if (f_ == aggregation::sum) {
+					typedef typename std::conditional < std::is_signed<T>::value, long long, unsigned long long >::type S;
+					column_vector<S>& x = out_.resize<S>(n);
+					for(size_t g = 0; g < n; ++g) {
+						x(g) = static_cast<S> (acc_[g].isum);
 					}
+					return;
 				}
-				column_headers_.resize(ncol_ + 1);
-				column_headers_ (ncol_) = header;
-				++ncol_;
-				data_ [header] = col;
-				return *this;
+				statistics();
 			}
-			catch (std::exception& e) {
-				std::terminate();
+			else {
+				statistics();
 			}
-		}
-
-		/*! \brief prints the data in the data_frame.
-		 *  Print Format: [column header]: data(0) data(1) .......  
-		 */ 		
-		BOOST_UBLAS_INLINE 
-		void print() {
-			for(size_t i = 0; i < ncol_; ++i) {
-				std::cout << "[" << column_headers_(i) << "]" << ": ";
-				data_ [column_headers_(i)].print();
+			const size_t least = (f_ == aggregation::sum) ? 0 : 
+				(f_ == aggregation::variance || f_ == aggregation::stddev) ? 2 : 1;
+			for(size_t g = 0; g < n; ++g) {
+				if (acc_[g].values.count < least) {
+					out_.set_null (g);
+				}
 			}
 		}
-											
-		// -----------------
-		// Storage Accessors
-		// -----------------
 
-		//! \brief Returns the headers of data_frame as vector<std::string>.
+		//! \brief Only the count of the non numeric columns is accumulated.
+		template < class C >
 		BOOST_UBLAS_INLINE
-		vector<std::string>& headers() {
-			return column_headers_;
+		void operator () (const C&) const {
+			count();
 		}
 
-		// ------------------------
-		// Random Access Containers
-		// ------------------------
+	private:
+		const std::vector < group_accumulator >& acc_;
+		aggregation f_;
+		df_column& out_;
 
-		//! \brief Returns the no. of columns in data_frame.
 		BOOST_UBLAS_INLINE
-		const size_t ncol() const {
-			return ncol_;
+		void count () const {
+			column_vector<unsigned long>& x = out_.resize<unsigned long>(acc_.size());
+			for(size_t g = 0; g < acc_.size(); ++g) {
+				x(g) = acc_[g].values.count;
+			}
 		}
 
-		//! \brief Returns the no. of rows in data_frame.
+		//! \brief Writes the sums of the floating point values, the means, the variances or the standard deviations.
 		BOOST_UBLAS_INLINE
-		const size_t nrow() const {
-			return nrow_;
+		void statistics () const {
+			column_vector<double>& x = out_.resize<double>(acc_.size());
+			for(size_t g = 0; g < acc_.size(); ++g) {
+				const column_summary<long double>& s = acc_[g].values;
+				switch (f_) {
+					case aggregation::sum: x(g) = s.sum; break;
+					case aggregation::mean: x(g) = s.mean; break;
+					case aggregation::variance: x(g) = s.variance(); break;
+					case aggregation::stddev: x(g) = s.stddev(); break;
+					default: break;
+				}
+			}
 		}
 
-		//! \brief Returns the column header at i-th index.
+		//! \brief Returns the min (or the max) of the values of type T of a.
+		template < class T >
 		BOOST_UBLAS_INLINE
-		const std::string colname(const size_t& i) {
-			return column_headers_(i);
+		static T extreme (const group_accumulator& a, const bool min) {
+			if constexpr (std::is_integral<T>::value && std::is_signed<T>::value) {
+				return static_cast<T> (min ? a.smin : a.smax);
+			}
+			else if constexpr (std::is_integral<T>::value) {
+				return static_cast<T> (min ? a.umin : a.umax);
+			}
+			else {
+				return static_cast<T> (min ? a.values.min : a.values.max);
+			}
 		}
+	};
 
-		// ---------------------
-		// Statistical Summaries
-		// ---------------------
+	/*! \brief Rows of a data_frame grouped by the values of key columns, returned by data_frame::group_by().
+	 *  Groups are found by hashing the key columns in place, rows are never materialized.
+	 *  The rows are split between threads, each one builds a partial group_table and partial
+	 *  column_summary accumulators for its rows, the partial results are then merged (Chan's formula).
+	 *  Rows with a null key are dropped. Groups are in the order of their first row.
+	 */
+	class grouped_data_frame {
+	public:
+		BOOST_UBLAS_INLINE
+		grouped_data_frame (const data_frame& df, std::vector < size_t >&& keys): 
+			df_ (df), 
+			keys_ (std::move (keys)) {}
 
-		/*! \brief prints the column statistics in the data_frame.
-		 *  Print Format: [column header]: data(0) data(1) .......  
-		 *  Doesn't calculate statistics of non numerical types.
-		 */ 
+		//! \brief Returns the positions of the key columns.
 		BOOST_UBLAS_INLINE
-		void summary() {
-			for(size_t i = 0; i < ncol_; ++i) {
-				std::cout << "[" << column_headers_(i) << "]" << ": ";
-				 switch(data_[column_headers_(i)].type()) {
-					case 0: 	
-						data_[column_headers_(i)].summary <bool, long double >(); break;
-					case 3: 
-						data_[column_headers_(i)].summary <short, long double >(); break;
-					case 4: 
-						data_[column_headers_(i)].summary <unsigned short, long double >(); break;
-					case 5: 
-						data_[column_headers_(i)].summary <int, long double >(); break;
-					case 6: 
-						data_[column_headers_(i)].summary <unsigned int, long double >(); break;
-					case 7: 
-						data_[column_headers_(i)].summary <long, long double >(); break;
-					case 8: 
-						data_[column_headers_(i)].summary <unsigned long, long double >(); break;
-					case 9: 
-						data_[column_headers_(i)].summary <long long, long double >(); break;
-					case 10: 
-						data_[column_headers_(i)].summary <unsigned long long, long double >(); break;
-					case 11: 
-						data_[column_headers_(i)].summary <float, long double >(); break;
-					case 12: 
-						data_[column_headers_(i)].summary <double, long double >(); break;
-					case 13: 
-						data_[column_headers_(i)].summary <long double, long double >(); break;
-					default: 
-						std::cout << "Statistical Summaries not defined" << std::endl;
+		const std::vector < size_t >& keys () const {
+			return keys_;
+		}
+
+		/*! \brief Returns a data_frame with one row per group: the key columns, then one column
+		 *  per aggregation, named after the column and the aggregation ("x_sum" ...).
+		 *  \param threads: number of threads, 0 for std::thread::hardware_concurrency().
+		 */
+		BOOST_UBLAS_INLINE
+		data_frame agg (const std::vector < column_aggregate >& aggs, size_t threads = 0) const {
+			const size_t n = df_.nrow_;
+			// each aggregated column is read once, whatever the number of its aggregations
+			std::vector < size_t > cols;
+			std::vector < char > values;
+			std::vector < size_t > acc_of (aggs.size());
+			for(size_t a = 0; a < aggs.size(); ++a) {
+				const size_t c = df_.find (aggs[a].column);
+				const size_t k = std::find (cols.begin(), cols.end(), c) - cols.begin();
+				if (k == cols.size()) {
+					cols.push_back (c);
+					values.push_back (0);
+				}
+				values[k] |= (aggs[a].function != aggregation::count);
+				acc_of[a] = k;
+			}
+
+			threads = worker_threads (n, threads);
+			std::vector < const df_column* > keys (keys_.size());
+			for(size_t k = 0; k < keys_.size(); ++k) {
+				keys[k] = &df_.data_[keys_[k]];
+			}
+			bitmap valid;
+			const bitmap* v = valid_rows (keys, valid) ? &valid : 0;
+			std::vector < partial > parts (threads);
+			parallel_blocks (n, threads, [&] (const size_t t, const size_t first, const size_t last) {
+				build (parts[t], keys, v, first, last, cols, values);
+			});
+
+			// merge the partial tables, in row order
+			group_table table;
+			table.reserve (parts[0].table.size());
+			std::vector < std::vector < group_accumulator > > acc (cols.size());
+			for(const partial& p: parts) {
+				for(size_t g = 0; g < p.table.size(); ++g) {
+					const size_t G = table.insert (p.table.hash (g), p.table.row (g), [&keys] (const size_t r1, const size_t r2) {
+						return equal_rows (keys, r1, keys, r2);
+					});
+					for(size_t c = 0; c < cols.size(); ++c) {
+						if (G == acc[c].size()) {
+							acc[c].push_back (p.acc[c][g]);
+						}
+						else {
+							acc[c][G].merge (p.acc[c][g]);
+						}
+					}
+				}
+			}
+
+			const size_t ngroups = table.size();
+			const size_t nkeys = keys_.size();
+			vector < std::string > headers (nkeys + aggs.size());
+			vector < df_column > out (nkeys + aggs.size());
+			for(size_t k = 0; k < nkeys; ++k) {
+				headers(k) = df_.column_headers_(keys_[k]);
+				column_select (df_.data_[keys_[k]], table.rows().data(), ngroups, out(k));
+			}
+			for(size_t a = 0; a < aggs.size(); ++a) {
+				headers(nkeys + a) = aggs[a].column + "_" + aggregation_name (aggs[a].function);
+				df_.data_[cols[acc_of[a]]].apply_visitor (group_write_visitor (acc[acc_of[a]], aggs[a].function, out(nkeys + a)));
+			}
+			return data_frame (headers, std::move (out));
+		}
+
+	private:
+		const data_frame& df_;
+		std::vector < size_t > keys_;
+
+		//! \brief Groups and accumulators of a block of rows.
+		struct partial {
+			group_table table;
+			//! \brief Summaries by aggregated column, then by group.
+			std::vector < std::vector < group_accumulator > > acc;
+		};
+
+		/*! \brief Groups the rows first ... last - 1 into p and accumulates the columns cols.
+		 *  valid is null, or the rows without null key.
+		 */
+		BOOST_UBLAS_INLINE
+		void build (partial& p, const std::vector < const df_column* >& keys, const bitmap* valid, const size_t first, const size_t last, 
+			const std::vector < size_t >& cols, const std::vector < char >& values) const {
+			try {
+				const size_t m = last - first;
+				std::vector < std::uint64_t > h (m);
+				hash_rows (keys, first, last, h.data());
+				std::vector < size_t > group (m);
+				const auto equal = [&keys] (const size_t r1, const size_t r2) { return equal_rows (keys, r1, keys, r2); };
+				for(size_t i = first; i < last; ++i) {
+					group[i - first] = (valid != 0 && !(*valid)(i)) ? group_table::npos : p.table.insert (h[i - first], i, equal);
 				}
+				p.acc.resize (cols.size());
+				for(size_t c = 0; c < cols.size(); ++c) {
+					const df_column& x = df_.data_[cols[c]];
+					p.acc[c].assign (p.table.size(), group_accumulator());
+					x.apply_visitor (group_summary_visitor (group.data(), first, last, 
+						x.has_nulls() ? x.validity().bits() : 0, p.acc[c].data(), values[c] != 0));
+				}
+			}
+			catch (std::exception& e) {
+				std::terminate();
 			}
 		}
+	};
 
-		//! \brief Adds another data_frame to self.
-		BOOST_UBLAS_INLINE
-		data_frame operator += (data_frame& df_) {
-			return (*this) = (*this) + df_;
+	BOOST_UBLAS_INLINE
+	grouped_data_frame data_frame::group_by (const std::vector < std::string >& keys) const {
+		std::vector < size_t > k (keys.size());
+		for(size_t i = 0; i < keys.size(); ++i) {
+			k[i] = find (keys[i]);
 		}
+		return grouped_data_frame (*this, std::move (k));
+	}
 
-		//! \brief Subtracts another data_frame from self.
+	//! \brief Writes a column of n default elements of the type of x into out.
+	class column_default_visitor: public boost::static_visitor<void> {
+	public:
 		BOOST_UBLAS_INLINE
-		data_frame operator -= (data_frame& df_) {
-			return (*this) = (*this) - df_;
-		}
+		column_default_visitor (const size_t n, df_column& out): 
+			n_ (n), 
+			out_ (out) {}
 
-		//! \brief Adds a constant value to self.
+		template < class T >
 		BOOST_UBLAS_INLINE
-		template < class T > 
-		data_frame operator += (const T& val) {
-			return (*this) = (*this) + val;
+		void operator () (const column_vector<T>&) const {
+			column_vector<T>& out = out_.resize<T>(n_);
+			std::fill (out.data().begin(), out.data().end(), T ());
 		}
 
-		//! \brief Subtracts constant value from self.
+		//! \brief string, dictionary and bool columns.
+		template < class C >
 		BOOST_UBLAS_INLINE
-		template < class T > 
-		data_frame operator -= (const T& val) {
-			return (*this) = (*this) - val;
+		void operator () (const C&) const {
+			C c;
+			for(size_t i = 0; i < n_; ++i) {
+				c.push_back (typename C::value_type ());
+			}
+			out_ = std::move (c);
 		}
 
-		//! \brief Multiplies constant value to self.
+	private:
+		size_t n_;
+		df_column& out_;
+	};
+
+	/*! \brief Writes the default element of T over the rows k of out, a column of T, for which keep(k) is \c false.
+	 *  The visited column gives T. The rows of the other columns are left as they are, to be made null.
+	 */
+	class column_default_rows_visitor: public boost::static_visitor<void> {
+	public:
 		BOOST_UBLAS_INLINE
-		template < class T > 
-		data_frame operator *= (const T& val) {
-			return (*this) = (*this) * val;
+		column_default_rows_visitor (const bitmap& keep, df_column& out): 
+			keep_ (keep), 
+			out_ (out) {}
+
+		template < class T >
+		BOOST_UBLAS_INLINE
+		void operator () (const column_vector<T>&) const {
+			T* q = out_.get<T>().data().begin();
+			for(size_t k = 0; k < keep_.size(); ++k) {
+				if (!keep_(k)) {
+					q[k] = T ();
+				}
+			}
 		}
-		
-		/*! \brief Update the column header of a column.
-		 *	\param std::string to be updated, std::string updated to.
-		 */
-		BOOST_UBLAS_INLINE 
-		void set_col_header(const std::string& a, const std::string& b) {
+
+		template < class C >
+		BOOST_UBLAS_INLINE
+		void operator () (const C&) const {}
+
+	private:
+		const bitmap& keep_;
+		df_column& out_;
+	};
+
+	/*! \brief Hash join of two data_frames, from data_frame::join().
+	 *  The distinct keys of the right data_frame (build side) go into a group_table and the rows of
+	 *  each key are listed contiguously. The rows of the left data_frame (probe side) are split between
+	 *  threads, each one looking its keys up and writing the pairs of matching row indices.
+	 *  The columns are then gathered once, from these indices.
+	 *  Null keys never match.
+	 */
+	class hash_join {
+	public:
+		BOOST_UBLAS_INLINE
+		hash_join (const data_frame& left, const data_frame& right, const std::vector < size_t >& left_keys, const std::vector < size_t >& right_keys): 
+			left_ (left), 
+			right_ (right), 
+			right_key_ (right.ncol_, false) {
 			try {
-				if (data_.find(a) == data_.end()) {
-					throw column_header_mismatch();
+				if (left_keys.size() != right_keys.size()) {
+					throw inconsistent_arguments();
 				}
-				for(size_t i = 0; i < column_headers_.size(); ++i) {
-					if (column_headers_ (i) == a) {
-						column_headers_(i) = b;
-						break;
+				for(size_t k = 0; k < left_keys.size(); ++k) {
+					lkeys_.push_back (&left.data_[left_keys[k]]);
+					rkeys_.push_back (&right.data_[right_keys[k]]);
+					if (lkeys_[k]->type() != rkeys_[k]->type()) {
+						throw column_type_mismatch();
 					}
+					right_key_[right_keys[k]] = true;
 				}
-				data_[b] = data_[a];
-				data_.erase(a);
 			}
 			catch (std::exception& e) {
 				std::terminate();
 			}
+			build();
 		}
 
-		/*! \brief Update the column header of a column.
-		 *	\param index of the column to be updated, std::string updated to.
+		/*! \brief Returns the joined data_frame, its rows in the order of the left rows.
+		 *  \param threads: number of threads of the probe, 0 for std::thread::hardware_concurrency().
 		 */
-		BOOST_UBLAS_INLINE 
-		void set_col_header(const size_t col, const std::string& b) {
-			data_[b] = data_[column_headers_(col)];
-			data_.erase(column_headers_(col));
-			column_headers_(col) = b;
+		BOOST_UBLAS_INLINE
+		data_frame operator () (const join_type how, size_t threads) const {
+			const size_t n = left_.nrow_;
+			threads = worker_threads (n, threads);
+			bitmap valid;
+			const bitmap* v = valid_rows (lkeys_, valid) ? &valid : 0;
+			std::vector < std::vector < size_t > > lparts (threads), rparts (threads);
+			parallel_blocks (n, threads, [&] (const size_t t, const size_t first, const size_t last) {
+				probe (how, v, first, last, lparts[t], rparts[t]);
+			});
+			std::vector < size_t > lsel, rsel;
+			for(size_t t = 0; t < threads; ++t) {
+				lsel.insert (lsel.end(), lparts[t].begin(), lparts[t].end());
+				rsel.insert (rsel.end(), rparts[t].begin(), rparts[t].end());
+			}
+			const size_t m = lsel.size();
+
+			std::vector < std::string > headers;
+			std::vector < df_column > cols;
+			cols.reserve (left_.ncol_ + right_.ncol_);
+			for(size_t c = 0; c < left_.ncol_; ++c) {
+				headers.push_back (left_.column_headers_(c));
+				cols.push_back (df_column());
+				column_select (left_.data_[c], lsel.data(), m, cols.back());
+			}
+			if (how == join_type::inner || how == join_type::left) {
+				std::unordered_set < std::string > taken (headers.begin(), headers.end());
+				// left rows without match: gather row 0, reset numbers to their default and make it null
+				bitmap matched (m, true);
+				bool unmatched = false;
+				for(size_t k = 0; k < m; ++k) {
+					if (rsel[k] == group_table::npos) {
+						rsel[k] = 0;
+						matched.set (k, false);
+						unmatched = true;
+					}
+				}
+				for(size_t c = 0; c < right_.ncol_; ++c) {
+					if (right_key_[c]) {
+						continue;
+					}
+					std::string h = right_.column_headers_(c);
+					while (!taken.insert (h).second) {
+						h += "_right";
+					}
+					headers.push_back (h);
+					cols.push_back (df_column());
+					df_column& out = cols.back();
+					if (right_.nrow_ == 0) {
+						right_.data_[c].apply_visitor (column_default_visitor (m, out));
+					}
+					else {
+						column_select (right_.data_[c], rsel.data(), m, out);
+					}
+					if (unmatched) {
+						right_.data_[c].apply_visitor (column_default_rows_visitor (matched, out));
+						bitmap bits = matched;
+						if (out.has_nulls()) {
+							bits &= *out.validity().bits();
+						}
+						out.set_validity (column_validity (std::move (bits)));
+					}
+				}
+			}
+			vector < std::string > h (headers.size());
+			vector < df_column > data (cols.size());
+			for(size_t c = 0; c < cols.size(); ++c) {
+				h(c) = headers[c];
+				data(c) = std::move (cols[c]);
+			}
+			return data_frame (h, std::move (data));
 		}
 
 	private:
-		//! \brief Stores data.
-		std::map < std::string, df_column > data_;
-		//! \brief Stores sizes.
-		size_t ncol_, nrow_;
-		//! \brief Stores column headers.
-		vector < std::string> column_headers_;
-		
-		//! \brief Returns the default column name.
-		//! used when the column name is not set by the user.s
+		const data_frame& left_;
+		const data_frame& right_;
+		std::vector < const df_column* > lkeys_;
+		std::vector < const df_column* > rkeys_;
+		//! \brief \c true for the key columns of right, not repeated in the result.
+		std::vector < char > right_key_;
+		//! \brief Distinct keys of right.
+		group_table table_;
+		//! \brief Rows of right of key g: rows_(start_(g)) ... rows_(start_(g + 1) - 1), in increasing order.
+		std::vector < size_t > start_;
+		std::vector < size_t > rows_;
+
+		//! \brief Indexes the rows of right by key (counting sort of the rows by group).
 		BOOST_UBLAS_INLINE
-		std::string default_name(size_t i) {
-			return ("Col-" + boost::lexical_cast<std::string>(i));
+		void build () {
+			const size_t n = right_.nrow_;
+			std::vector < std::uint64_t > h (n);
+			hash_rows (rkeys_, 0, n, h.data());
+			bitmap valid;
+			const bool nulls = valid_rows (rkeys_, valid);
+			std::vector < size_t > group (n);
+			const auto equal = [this] (const size_t r1, const size_t r2) { return equal_rows (rkeys_, r1, rkeys_, r2); };
+			for(size_t i = 0; i < n; ++i) {
+				group[i] = (nulls && !valid(i)) ? group_table::npos : table_.insert (h[i], i, equal);
+			}
+			const size_t ngroups = table_.size();
+			start_.assign (ngroups + 1, 0);
+			for(size_t i = 0; i < n; ++i) {
+				if (group[i] != group_table::npos) {
+					++start_[group[i] + 1];
+				}
+			}
+			for(size_t g = 0; g < ngroups; ++g) {
+				start_[g + 1] += start_[g];
+			}
+			rows_.resize (start_[ngroups]);
+			std::vector < size_t > next (start_.begin(), start_.end() - 1);
+			for(size_t i = 0; i < n; ++i) {
+				if (group[i] != group_table::npos) {
+					rows_[next[group[i]]++] = i;
+				}
+			}
+		}
+
+		/*! \brief Writes the pairs of matching rows of the left rows first ... last - 1 into lsel and rsel,
+		 *  rsel(k) being group_table::npos for the unmatched rows of a left join, and left alone for semi and anti joins.
+		 */
+		BOOST_UBLAS_INLINE
+		void probe (const join_type how, const bitmap* valid, const size_t first, const size_t last, std::vector < size_t >& lsel, std::vector < size_t >& rsel) const {
+			std::vector < std::uint64_t > h (last - first);
+			hash_rows (lkeys_, first, last, h.data());
+			for(size_t i = first; i < last; ++i) {
+				size_t g = group_table::npos;
+				if (valid == 0 || (*valid)(i)) {
+					g = table_.find (h[i - first], [this, i] (const size_t r) { return equal_rows (lkeys_, i, rkeys_, r); });
+				}
+				switch (how) {
+					case join_type::inner:
+					case join_type::left:
+						if (g != group_table::npos) {
+							for(size_t k = start_[g]; k < start_[g + 1]; ++k) {
+								lsel.push_back (i);
+								rsel.push_back (rows_[k]);
+							}
+						}
+						else if (how == join_type::left) {
+							lsel.push_back (i);
+							rsel.push_back (group_table::npos);
+						}
+						break;
+					case join_type::semi:
+						if (g != group_table::npos) {
+							lsel.push_back (i);
+						}
+						break;
+					case join_type::anti:
+						if (g == group_table::npos) {
+							lsel.push_back (i);
+						}
+						break;
+				}
+			}
 		}
 	};
 
+	BOOST_UBLAS_INLINE
+	data_frame data_frame::join (const data_frame& right, const std::vector < std::string >& keys, const join_type how, const size_t threads) const {
+		return join (right, keys, keys, how, threads);
+	}
+
+	BOOST_UBLAS_INLINE
+	data_frame data_frame::join (const data_frame& right, const std::vector < std::string >& left_keys, const std::vector < std::string >& right_keys, 
+		const join_type how, const size_t threads) const {
+		std::vector < size_t > l (left_keys.size()), r (right_keys.size());
+		for(size_t i = 0; i < left_keys.size(); ++i) {
+			l[i] = find (left_keys[i]);
+		}
+		for(size_t i = 0; i < right_keys.size(); ++i) {
+			r[i] = right.find (right_keys[i]);
+		}
+		return hash_join (*this, right, l, r) (how, threads);
+	}
 
-	
 	//! \brief Returns the negation of the data_frame if exists. 
 	data_frame operator - (data_frame& a) {
 		vector<std::string> header(a.ncol());
@@ -1356,7 +3904,7 @@ namespace boost { namespace numeric { namespace ublas {
 			header(i) = a.colname(i);
 			col(i) = - a[i];
 		}
-		return data_frame(header, col);
+		return data_frame(header, std::move(col));
 	}
 	
 	//! \brief Returns a data_frame as sum of 2 data_frames.
@@ -1377,7 +3925,7 @@ namespace boost { namespace numeric { namespace ublas {
 				header(i) = a.colname(i);
 				col(i) = a[i] + b[i];
 			}
-			return data_frame(header, col);
+			return data_frame(header, std::move(col));
 		}
 		catch (std::exception& e) {
 			std::terminate();
@@ -1402,7 +3950,7 @@ namespace boost { namespace numeric { namespace ublas {
 				header(i) = a.colname(i);
 				col(i) = a[i] - b[i];
 			}
-			return data_frame(header, col);
+			return data_frame(header, std::move(col));
 		}
 		catch (std::exception& e) {
 			std::terminate();
@@ -1418,7 +3966,7 @@ namespace boost { namespace numeric { namespace ublas {
 			header(i) = a.colname(i);
 			col(i) = a[i] + val;
 		}
-		return data_frame(header, col);
+		return data_frame(header, std::move(col));
 	}
 
 	//! \brief Returns a data_frame as sum of a data_frame and a constant value.
@@ -1442,7 +3990,7 @@ namespace boost { namespace numeric { namespace ublas {
 			header(i) = a.colname(i);
 			col(i) = a[i] * val;
 		}
-		return data_frame(header, col);
+		return data_frame(header, std::move(col));
 	}
 
 	//! \brief Returns a data_frame as product of a data_frame and a constant value.
@@ -1479,6 +4027,88 @@ namespace boost { namespace numeric { namespace ublas {
 	// dataframe proxies
 	// -----------------
 
+	/*! \brief Columns of a data_frame resolved once from their headers, for the column proxies.
+	 *	The pointers to the df_columns are cached with the layout generation of the data_frame,
+	 *	they are resolved again from the headers only after columns were added or erased.
+	 */
+	class resolved_columns {
+	public:
+		BOOST_UBLAS_INLINE
+		resolved_columns (): 
+			df_ (0), 
+			generation_ (0), 
+			threads_ (0) {}
+
+		//! \brief Resolves the columns headers(0), headers(1) ... of df.
+		template < class H >
+		BOOST_UBLAS_INLINE
+		resolved_columns (data_frame* df, const H& headers): 
+			df_ (df), 
+			threads_ (0) {
+			resolve (headers);
+		}
+
+		//! \brief Returns the column i, headers being the headers the columns were resolved from.
+		template < class H >
+		BOOST_UBLAS_INLINE
+		df_column& get (const size_t i, const H& headers) {
+			if (generation_ != df_->generation()) {
+				resolve (headers);
+			}
+			return *columns_[i];
+		}
+
+		/*! \brief Calls fn(column) on every column, on several threads (one block of columns each)
+		 *	when the columns hold enough elements.
+		 */
+		template < class H, class F >
+		BOOST_UBLAS_INLINE
+		void for_each (const H& headers, F fn) {
+			if (generation_ != df_->generation()) {
+				resolve (headers);
+			}
+			size_t elements = 0;
+			for(const df_column* c: columns_) {
+				elements += c->size();
+			}
+			const size_t threads = std::min (worker_threads (elements, threads_), columns_.size());
+			if (threads <= 1) {
+				for(df_column* c: columns_) {
+					fn (*c);
+				}
+				return;
+			}
+			parallel_blocks (columns_.size(), threads, [this, &fn] (const size_t, const size_t first, const size_t last) {
+				for(size_t i = first; i < last; ++i) {
+					fn (*columns_[i]);
+				}
+			});
+		}
+
+		//! \brief Sets the maximum number of threads of \c for_each(), 0 for std::thread::hardware_concurrency().
+		BOOST_UBLAS_INLINE
+		void set_threads (const size_t threads) {
+			threads_ = threads;
+		}
+
+	private:
+		data_frame* df_;
+		std::vector < df_column* > columns_;
+		//! \brief Layout generation of the data_frame when the columns were resolved.
+		size_t generation_;
+		size_t threads_;
+
+		template < class H >
+		BOOST_UBLAS_INLINE
+		void resolve (const H& headers) {
+			columns_.resize (headers.size());
+			for(size_t i = 0; i < headers.size(); ++i) {
+				columns_[i] = &(*df_)[df_->handle (headers(i))];
+			}
+			generation_ = df_->generation();
+		}
+	};
+
 	/*! \brief Represents data_frame column range class
 	 *	Builds a range on columns of another data_frame.
 	 *	allows access and modifications operations
@@ -1499,7 +4129,8 @@ namespace boost { namespace numeric { namespace ublas {
 		 */
 		BOOST_UBLAS_INLINE
 		data_frame_range (data_frame* df, const range_type& range): 
-			column_headers_(df->headers(), range) {
+			column_headers_(df->headers(), range), 
+			columns_ (df, column_headers_) {
 				df_ = df;
 		}
 
@@ -1513,9 +4144,9 @@ namespace boost { namespace numeric { namespace ublas {
 			vector<ublas::df_column> v2(column_headers_.size());
 			for(size_t i = 0; i < column_headers_.size(); ++i) {
 				v1(i) = column_headers_(i);
-				v2(i) = (*df_)[v1(i)];
+				v2(i) = columns_.get (i, column_headers_);
 			}
-			return data_frame(v1, v2);
+			return data_frame(v1, std::move(v2));
 		} 
 
 		/*! \brief Access operator of data_frame_range.
@@ -1524,7 +4155,7 @@ namespace boost { namespace numeric { namespace ublas {
 		 */
 		BOOST_UBLAS_INLINE
 		df_column& operator [] (const size_t& i) {
-			return (*df_)[column_headers_[i]];
+			return columns_.get (i, column_headers_);
 		}
 		
 		//! \brief Returns the size of the range (number of elements in the range).
@@ -1536,9 +4167,9 @@ namespace boost { namespace numeric { namespace ublas {
 		//! \brief Prints the range similar to a data_frame.
 		BOOST_UBLAS_INLINE
 		void print() {
-			for(auto header: column_headers_) {
-				std::cout << "[" << header << "]: ";
-				(*df_)[header].print();
+			for(size_t i = 0; i < column_headers_.size(); ++i) {
+				std::cout << "[" << column_headers_(i) << "]: ";
+				columns_.get (i, column_headers_).print();
 			}
 			return;
 		}
@@ -1546,31 +4177,33 @@ namespace boost { namespace numeric { namespace ublas {
 		//! \brief Adds all the values in range by \c val.
 		template < class T >
 		BOOST_UBLAS_INLINE
-		data_frame_range operator += (const T& val) {
-			for(auto header: column_headers_) {
-				(*df_)[header] += val;
-			}
+		data_frame_range& operator += (const T& val) {
+			columns_.for_each (column_headers_, [&val] (df_column& c) { c += val; });
 			return (*this);
 		}
 
 		//! \brief Subtracts \c val from all the values in range.
 		template < class T >
 		BOOST_UBLAS_INLINE
-		data_frame_range operator -= (const T& val) {
-			for(auto header: column_headers_) {
-				(*df_)[header] -= val;
-			}
-			return (*this);		
+		data_frame_range& operator -= (const T& val) {
+			columns_.for_each (column_headers_, [&val] (df_column& c) { c -= val; });
+			return (*this);
 		}
 
 		//! \brief Multiplies all the values in range by \c val.
 		template < class T >
 		BOOST_UBLAS_INLINE
-		data_frame_range operator *= (const T& val) {
-			for(auto header: column_headers_) {
-				(*df_)[header] *= val;
-			}
-			return (*this);			
+		data_frame_range& operator *= (const T& val) {
+			columns_.for_each (column_headers_, [&val] (df_column& c) { c *= val; });
+			return (*this);
+		}
+
+		/*! \brief Sets the maximum number of threads of the operators +=, -= and *=, which update the columns
+		 *	in place, several columns at a time. 0 (default) for std::thread::hardware_concurrency().
+		 */
+		BOOST_UBLAS_INLINE
+		void set_threads (const size_t threads) {
+			columns_.set_threads (threads);
 		}
 
 	private:
@@ -1578,6 +4211,8 @@ namespace boost { namespace numeric { namespace ublas {
 		data_frame *df_;
 		//! \brief Range over the column of data_frame.
 		vector_range < vector <std::string> > column_headers_;
+		//! \brief Columns of the headers, resolved once.
+		resolved_columns columns_;
 	};
 
 	/*! \brief Represents data_frame column slice class
@@ -1600,7 +4235,8 @@ namespace boost { namespace numeric { namespace ublas {
 		 */
 		BOOST_UBLAS_INLINE
 		data_frame_slice (data_frame* df, const slice_type& slice): 
-			column_headers_(df->headers(), slice) {
+			column_headers_(df->headers(), slice), 
+			columns_ (df, column_headers_) {
 				df_ = df;
 		}
 
@@ -1614,9 +4250,9 @@ namespace boost { namespace numeric { namespace ublas {
 			vector<ublas::df_column> v2(column_headers_.size());
 			for(size_t i = 0; i < column_headers_.size(); ++i) {
 				v1(i) = column_headers_(i);
-				v2(i) = (*df_)[v1(i)];
+				v2(i) = columns_.get (i, column_headers_);
 			}
-			return data_frame(v1, v2);
+			return data_frame(v1, std::move(v2));
 		} 
 
 		/*! \brief Access operator of data_frame_slice.
@@ -1625,7 +4261,7 @@ namespace boost { namespace numeric { namespace ublas {
 		 */
 		BOOST_UBLAS_INLINE
 		df_column& operator [] (const size_t& i) {
-			return (*df_)[column_headers_[i]];
+			return columns_.get (i, column_headers_);
 		}
 
 	
@@ -1638,9 +4274,9 @@ namespace boost { namespace numeric { namespace ublas {
 		//! \brief Prints the slice similar to a data_frame.
 		BOOST_UBLAS_INLINE
 		void print() {
-			for(auto header: column_headers_) {
-				std::cout << "[" << header << "]: ";
-				(*df_)[header].print();
+			for(size_t i = 0; i < column_headers_.size(); ++i) {
+				std::cout << "[" << column_headers_(i) << "]: ";
+				columns_.get (i, column_headers_).print();
 			}
 			return;
 		}
@@ -1648,37 +4284,41 @@ namespace boost { namespace numeric { namespace ublas {
 		//! \brief Adds all the values in slice by \c val.
 		template < class T >
 		BOOST_UBLAS_INLINE
-		data_frame_slice operator += (const T& val) {
-			for(auto header: column_headers_) {
-				(*df_)[header] += val;
-			}
+		data_frame_slice& operator += (const T& val) {
+			columns_.for_each (column_headers_, [&val] (df_column& c) { c += val; });
 			return (*this);
 		}
 
 		//! \brief Subtracts \c val from all the values in slice.
 		template < class T >
 		BOOST_UBLAS_INLINE
-		data_frame_slice operator -= (const T& val) {
-			for(auto header: column_headers_) {
-				(*df_)[header] -= val;
-			}
+		data_frame_slice& operator -= (const T& val) {
+			columns_.for_each (column_headers_, [&val] (df_column& c) { c -= val; });
 			return (*this);
 		}
 
 		//! \brief Multiplies all the values in slice by \c val.
 		template < class T >
 		BOOST_UBLAS_INLINE
-		data_frame_slice operator *= (const T& val) {
-			for(auto header: column_headers_) {
-				(*df_)[header] *= val;
-			}
+		data_frame_slice& operator *= (const T& val) {
+			columns_.for_each (column_headers_, [&val] (df_column& c) { c *= val; });
 			return (*this);
 		}
+		/*! \brief Sets the maximum number of threads of the operators +=, -= and *=, which update the columns
+		 *	in place, several columns at a time. 0 (default) for std::thread::hardware_concurrency().
+		 */
+		BOOST_UBLAS_INLINE
+		void set_threads (const size_t threads) {
+			columns_.set_threads (threads);
+		}
+
 	private:
 		//! \brief Represents the base data_frame.
 		data_frame *df_;
 		//! \brief Slice over the column of data_frame.
 		vector_slice < vector <std::string> > column_headers_;
+		//! \brief Columns of the headers, resolved once.
+		resolved_columns columns_;
 	};
 
 	/*! \brief Represents data_frame column indirect class
@@ -1698,7 +4338,8 @@ namespace boost { namespace numeric { namespace ublas {
 		 */
 		BOOST_UBLAS_INLINE
 		data_frame_indirect(data_frame* df, const indirect_array<> ia):
-		 	column_headers_(df->headers(), ia){
+		 	column_headers_(df->headers(), ia), 
+			columns_ (df, column_headers_) {
 		 	df_ = df;
 		} 
 
@@ -1709,9 +4350,9 @@ namespace boost { namespace numeric { namespace ublas {
 			vector<df_column> v2(column_headers_.size());
 			for(size_t i = 0; i < column_headers_.size(); ++i) {
 				v1(i) = column_headers_(i);
-				v2(i) = (*df_)[v1(i)];
+				v2(i) = columns_.get (i, column_headers_);
 			}
-			return data_frame(v1, v2);
+			return data_frame(v1, std::move(v2));
 		} 
 
 		//! \brief: destructor of data_frame_indirect.
@@ -1723,7 +4364,7 @@ namespace boost { namespace numeric { namespace ublas {
 		 */
 		BOOST_UBLAS_INLINE
 		df_column& operator [] (const size_t& i) {
-			return (*df_)[column_headers_[i]];
+			return columns_.get (i, column_headers_);
 		}
 	
 		//! \brief Returns the size of the indirect_data_frame (number of elements in the indirect data_frame).
@@ -1735,9 +4376,9 @@ namespace boost { namespace numeric { namespace ublas {
 		//! \brief Prints the data_frame_indirect similar to a data_frame.
 		BOOST_UBLAS_INLINE
 		void print() {
-			for(auto header: column_headers_) {
-				std::cout << "[" << header << "]: ";
-				(*df_)[header].print();
+			for(size_t i = 0; i < column_headers_.size(); ++i) {
+				std::cout << "[" << column_headers_(i) << "]: ";
+				columns_.get (i, column_headers_).print();
 			}
 			return;
 		}
@@ -1745,39 +4386,254 @@ namespace boost { namespace numeric { namespace ublas {
 		//! \brief Adds all the values in data_frame_indirect by \c val.
 		template < class T >
 		BOOST_UBLAS_INLINE
-		data_frame_indirect operator += (const T& val) {
-			for(auto header: column_headers_) {
-				(*df_)[header] += val;
-			}
+		data_frame_indirect& operator += (const T& val) {
+			columns_.for_each (column_headers_, [&val] (df_column& c) { c += val; });
 			return (*this);
 		}
 
 		//! \brief Subtracts \c val from all the values in data_frame_indirect.
 		template < class T >
 		BOOST_UBLAS_INLINE
-		data_frame_indirect operator -= (const T& val) {
-			for(auto header: column_headers_) {
-				(*df_)[header] -= val;
-			}
-			return (*this);			
+		data_frame_indirect& operator -= (const T& val) {
+			columns_.for_each (column_headers_, [&val] (df_column& c) { c -= val; });
+			return (*this);
 		}
 
 		//! \brief Multiplies all the values in data_frame_indirect by \c val.
 		template < class T >
 		BOOST_UBLAS_INLINE
-		data_frame_indirect operator *= (const T& val) {
-			for(auto header: column_headers_) {
-				(*df_)[header] *= val;
-			}
+		data_frame_indirect& operator *= (const T& val) {
+			columns_.for_each (column_headers_, [&val] (df_column& c) { c *= val; });
 			return (*this);
 		}
 
+		/*! \brief Sets the maximum number of threads of the operators +=, -= and *=, which update the columns
+		 *	in place, several columns at a time. 0 (default) for std::thread::hardware_concurrency().
+		 */
+		BOOST_UBLAS_INLINE
+		void set_threads (const size_t threads) {
+			columns_.set_threads (threads);
+		}
+
 	private: 
 		//! \brief Represents the base data_frame.
 		data_frame *df_;
 		//! \brief vector_indirect over the column of data_frame.
 		vector_indirect < vector < std::string> > column_headers_;
+		//! \brief Columns of the headers, resolved once.
+		resolved_columns columns_;
+	};
+
+	// ---------
+	// row views
+	// ---------
+
+	//! \brief ublas proxy over a column_vector for the row selections of the row views.
+	template < class A >
+	struct row_proxy;
+
+	template <>
+	struct row_proxy < row_range_type > {
+		template < class V >
+		struct apply {
+			typedef vector_range < V > type;
+		};
+	};
+
+	template <>
+	struct row_proxy < row_slice_type > {
+		template < class V >
+		struct apply {
+			typedef vector_slice < V > type;
+		};
+	};
+
+	template <>
+	struct row_proxy < row_indirect_type > {
+		template < class V >
+		struct apply {
+			typedef vector_indirect < V, row_indirect_type > type;
+		};
+	};
+
+	/*! \brief Represents a view on a subset of the rows of a data_frame, in every column.
+	 *	A is the selection of the rows: a range [begin, end) (data_frame_row_range), a slice 
+	 *	(data_frame_row_slice) or a list of indices (data_frame_row_indirect), as for the ublas vector proxies.
+	 *	Nothing is copied: the columns are read in the base data_frame through ublas vector proxies,
+	 *	on which the ublas kernels run directly. The view is valid as long as the data_frame isn't modified.
+	 */
+	template < class A >
+	class data_frame_rows {
+	public:
+		typedef A selection_type;
+
+		/*! \brief constructor of data_frame_rows.
+		 *	\param base data_frame.
+		 *	\param selection of the rows of the base data_frame, terminates if a row is out of range.
+		 */
+		BOOST_UBLAS_INLINE
+		data_frame_rows (const data_frame& df, const A& rows): 
+			df_ (&df), 
+			rows_ (rows) {
+			try {
+				const size_t n = rows_.size();
+				if constexpr (std::is_same < A, row_indirect_type >::value) {
+					for(size_t k = 0; k < n; ++k) {
+						if (rows_(k) >= df.nrow()) {
+							throw bad_index();
+						}
+					}
+				}
+				else if (n != 0 && (rows_(0) >= df.nrow() || rows_(n - 1) >= df.nrow())) {
+					throw bad_index();
+				}
+			}
+			catch (std::exception& e) {
+				std::terminate();
+			}
+		}
+
+		//! \brief Returns the number of rows of the view.
+		BOOST_UBLAS_INLINE
+		size_t nrow() const {
+			return rows_.size();
+		}
+
+		//! \brief Returns the number of columns.
+		BOOST_UBLAS_INLINE
+		size_t ncol() const {
+			return df_->ncol();
+		}
+
+		//! \brief Returns the row of the base data_frame of the row k of the view.
+		BOOST_UBLAS_INLINE
+		size_t row(const size_t k) const {
+			return rows_(k);
+		}
+
+		//! \brief Returns the selection of the rows.
+		BOOST_UBLAS_INLINE
+		const A& rows() const {
+			return rows_;
+		}
+
+		//! \brief Returns the base data_frame.
+		BOOST_UBLAS_INLINE
+		const data_frame& base() const {
+			return *df_;
+		}
+
+		/*! \brief Returns the rows of the view of a column of T, as a ublas vector proxy.
+		 *  Example: ublas::sum (df.head (10).column <double> ("x")).
+		 */
+		template < class T >
+		BOOST_UBLAS_INLINE
+		typename row_proxy<A>::template apply < const column_vector<T> >::type column(const std::string& header) const {
+			return typename row_proxy<A>::template apply < const column_vector<T> >::type ((*df_)[header].template get<T>(), rows_);
+		}
+
+		//! \brief Returns the rows of the view of the column at position i.
+		template < class T >
+		BOOST_UBLAS_INLINE
+		typename row_proxy<A>::template apply < const column_vector<T> >::type column(const size_t i) const {
+			return typename row_proxy<A>::template apply < const column_vector<T> >::type ((*df_)[i].template get<T>(), rows_);
+		}
+
+		/*! \brief Resolves the header of a column once, for eval() and is_null() in a loop over the rows,
+		 *  which then index the column by position.
+		 */
+		BOOST_UBLAS_INLINE
+		column_handle handle(const std::string& header) const {
+			return df_->handle (header);
+		}
+
+		/*! \brief Returns the element of the row k of the view of the column of h.
+		 *  T should be the type of the column, a std::string_view for a string or dictionary column.
+		 */
+		template < class T >
+		BOOST_UBLAS_INLINE
+		typename column_traits<T>::const_reference eval(const column_handle& h, const size_t k) const {
+			return (*df_)[h].template eval<T>(rows_(k));
+		}
+
+		//! \brief Returns \c true if the element of the row k of the view of the column of h is null.
+		BOOST_UBLAS_INLINE
+		bool is_null(const column_handle& h, const size_t k) const {
+			return (*df_)[h].is_null (rows_(k));
+		}
+
+		/*! \brief Returns count, Minimum, Maximum, Sum, Mean and Variance of the rows of the view of a column.
+		 *  Nulls are skipped. A range is read by runs of valid elements through the SIMD kernels.
+		 *  T1: type of the column, T2: type of the statistics.
+		 */
+		template < class T1, class T2 >
+		BOOST_UBLAS_INLINE
+		column_summary<T2> summary(const std::string& header) const {
+			const df_column& c = (*df_)[header];
+			const T1* x = c.template get<T1>().data().begin();
+			column_summary<T2> s;
+			if constexpr (std::is_same < A, row_range_type >::value) {
+				for_each_set_run (c.validity().bits(), rows_.start(), rows_.start() + rows_.size(), [x, &s] (const size_t i, const size_t k) {
+					s.push (x + i, k);
+				});
+			}
+			else {
+				for(size_t k = 0; k < rows_.size(); ++k) {
+					const size_t r = rows_(k);
+					if (!c.is_null (r)) {
+						s.push (x[r]);
+					}
+				}
+			}
+			return s;
+		}
+
+		//! \brief Returns a new data_frame containing a copy of the rows of the view.
+		BOOST_UBLAS_INLINE
+		data_frame DataFrame () const {
+			std::vector < size_t > r (rows_.size());
+			for(size_t k = 0; k < r.size(); ++k) {
+				r[k] = rows_(k);
+			}
+			return df_->take (r);
+		}
+
+	private:
+		//! \brief Represents the base data_frame.
+		const data_frame* df_;
+		//! \brief Rows of the base data_frame in the view.
+		A rows_;
 	};
+
+	BOOST_UBLAS_INLINE
+	data_frame_row_range data_frame::rows (const size_t begin, const size_t end) const {
+		return data_frame_row_range (*this, row_range_type (begin, end));
+	}
+
+	BOOST_UBLAS_INLINE
+	data_frame_row_slice data_frame::rows (const size_t start, const std::ptrdiff_t stride, const size_t size) const {
+		return data_frame_row_slice (*this, row_slice_type (start, stride, size));
+	}
+
+	BOOST_UBLAS_INLINE
+	data_frame_row_indirect data_frame::rows (const std::vector < size_t >& indices) const {
+		row_indirect_type ia (indices.size());
+		for(size_t k = 0; k < indices.size(); ++k) {
+			ia(k) = indices[k];
+		}
+		return data_frame_row_indirect (*this, ia);
+	}
+
+	BOOST_UBLAS_INLINE
+	data_frame_row_range data_frame::head (const size_t n) const {
+		return rows (0, std::min (n, nrow_));
+	}
+
+	BOOST_UBLAS_INLINE
+	data_frame_row_range data_frame::tail (const size_t n) const {
+		return rows (nrow_ - std::min (n, nrow_), nrow_);
+	}
+
 }}}
 
 #endif
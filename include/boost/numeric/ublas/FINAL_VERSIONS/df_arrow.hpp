@@ -0,0 +1,1143 @@
+//          Copyright(C) Rishabh Arora 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Reading and writing of data_frames as Arrow IPC files (Feather v2) and streams, without an Arrow library.
+// A stream is a sequence of messages: u32 0xFFFFFFFF, i32 length of the metadata, the metadata (a FlatBuffer
+// Message, see flat_buffer.hpp) padded to 8 bytes, then the body holding the buffers of the arrays.
+// The schema comes first, then the dictionaries and the record batches, then 0xFFFFFFFF 0x00000000.
+// A file is "ARROW1\0\0", a stream, a FlatBuffer Footer indexing the messages, its i32 length and "ARROW1".
+//
+// Columns and Arrow types:
+//   integers of INNER_TYPE        Int (bit width 8 * sizeof(T), signed as T), read as char, short, int, long long
+//                                 or their unsigned types
+//   float, double                 FloatingPoint (SINGLE, DOUBLE)
+//   string_column, std::string    Utf8 (LargeUtf8 past 2 GB), Binary is read as Utf8
+//   large_string_column           LargeUtf8, LargeBinary is read as LargeUtf8
+//   dictionary_column             Utf8 dictionary with unsigned indices of code_width() bytes
+//   bool_column, bool             Bool (bit-packed), read as bool_column
+// The nulls are the validity bitmaps of the arrays. long double, std::string* and the Arrow types not listed
+// (nested, temporal, decimal...) terminate with undefined_operation when written, unsupported_file when read.
+//
+// The file is mapped copy on write. When it holds a single record batch, the buffers of the numbers, of the
+// booleans and the validity bitmaps aligned on column_alignment are adopted by the columns without a copy
+// (see adopt_array()), as in open_mapped(). The other buffers are copied and concatenated across batches.
+// The writer pads the metadata of the messages so that their bodies, and so the buffers, are aligned.
+
+#ifndef _BOOST_UBLAS_DF_ARROW_
+#define _BOOST_UBLAS_DF_ARROW_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <set>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+#include "./df.hpp"
+#include "./flat_buffer.hpp"
+#include "./mapped_file.hpp"
+
+namespace boost { namespace numeric { namespace ublas {
+
+	//! \brief Arrow IPC layouts: a file (Feather v2), indexed by a footer, or a stream.
+	enum class arrow_format {
+		file,
+		stream
+	};
+
+	//! \brief Tags of the Arrow types read and written (union Type of Schema.fbs).
+	enum class arrow_type : std::uint8_t {
+		none = 0,
+		integer = 2,
+		floating_point = 3,
+		binary = 4,
+		utf8 = 5,
+		boolean = 6,
+		large_binary = 19,
+		large_utf8 = 20
+	};
+
+	//! \brief Tags of the headers of the Arrow messages (union MessageHeader of Message.fbs).
+	enum class arrow_message : std::uint8_t {
+		none = 0,
+		schema = 1,
+		dictionary_batch = 2,
+		record_batch = 3
+	};
+
+	//! \brief Magic number of the Arrow files.
+	constexpr char arrow_magic[6] = {'A', 'R', 'R', 'O', 'W', '1'};
+	//! \brief Marker before the length of the metadata of a message.
+	constexpr std::uint32_t arrow_continuation = 0xFFFFFFFF;
+	//! \brief Metadata version written (V5).
+	constexpr std::int16_t arrow_metadata_version = 4;
+	//! \brief Alignment of the buffers written in the bodies of the messages.
+	constexpr size_t arrow_alignment = 64;
+
+	//! \brief Struct FieldNode of Message.fbs: length and null count of an array.
+	struct arrow_field_node {
+		std::int64_t length;
+		std::int64_t null_count;
+	};
+
+	//! \brief Struct Buffer of Schema.fbs: offset in the body and length of a buffer.
+	struct arrow_body_buffer {
+		std::int64_t offset;
+		std::int64_t length;
+	};
+
+	//! \brief Struct Block of File.fbs: offset of a message in the file, length of its metadata and body.
+	struct arrow_block {
+		std::int64_t offset;
+		std::int32_t metadata_length;
+		std::int32_t padding;
+		std::int64_t body_length;
+	};
+
+	//! \brief Returns the Endianness of the host, as in Schema.fbs (0 little, 1 big).
+	BOOST_UBLAS_INLINE
+	std::int16_t arrow_endianness () {
+		const std::uint16_t one = 1;
+		char first;
+		std::memcpy (&first, &one, 1);
+		return (first == 1) ? 0 : 1;
+	}
+
+	//! \brief Buffer of a column written to the body of a record batch.
+	struct arrow_buffer {
+		const void* data;
+		size_t size;
+	};
+
+	//! \brief Arrow type of a column and the buffers of its values, written by arrow_writer.
+	struct arrow_column {
+		arrow_type type = arrow_type::none;
+		//! \brief Bit width and signedness of an Int.
+		std::int32_t bit_width = 0;
+		bool is_signed = false;
+		//! \brief Precision of a FloatingPoint.
+		std::int16_t precision = 0;
+		//! \brief Column of a dictionary encoded array, 0 for the others.
+		const dictionary_column* dictionary = 0;
+		//! \brief Buffers following the validity bitmap.
+		std::vector < arrow_buffer > buffers;
+	};
+
+	/*! \brief Describes a column as an Arrow array.
+	 *  The buffers are those of the column when the layouts match, else they are
+	 *  built in \c scratch (bool and std::string columns, offsets widened to 64 bits).
+	 */
+	class arrow_column_visitor : public boost::static_visitor<void> {
+	public:
+		BOOST_UBLAS_INLINE
+		arrow_column_visitor (arrow_column& out, std::deque < std::vector < char > >& scratch):
+			out_ (&out),
+			scratch_ (&scratch) {}
+
+		template < class T >
+		BOOST_UBLAS_INLINE
+		void operator () (const column_vector<T>& x) const {
+			if constexpr (std::is_same<T, bool>::value) {
+				std::vector < char > bits ((x.size() + 7) / 8, 0);
+				for(size_t i = 0; i < x.size(); ++i) {
+					bits[i / 8] |= char (x(i) ? 1 << (i % 8) : 0);
+				}
+				out_->type = arrow_type::boolean;
+				buffer (std::move (bits));
+			}
+			else if constexpr (std::is_integral<T>::value) {
+				out_->type = arrow_type::integer;
+				out_->bit_width = 8 * sizeof(T);
+				out_->is_signed = std::is_signed<T>::value;
+				out_->buffers.push_back (arrow_buffer {x.data().begin(), x.size() * sizeof(T)});
+			}
+			else if constexpr (std::is_same<T, float>::value || std::is_same<T, double>::value) {
+				out_->type = arrow_type::floating_point;
+				out_->precision = (sizeof(T) == 4) ? 1 : 2;
+				out_->buffers.push_back (arrow_buffer {x.data().begin(), x.size() * sizeof(T)});
+			}
+			else if constexpr (std::is_same<T, std::string>::value) {
+				size_t bytes = 0;
+				for(size_t i = 0; i < x.size(); ++i) {
+					bytes += x(i).size();
+				}
+				if (bytes <= size_t (std::numeric_limits<std::int32_t>::max())) {
+					strings < std::int32_t > (x, bytes);
+				}
+				else {
+					strings < std::int64_t > (x, bytes);
+				}
+			}
+			else {
+				// long double and pointers have no Arrow type
+				try {
+					throw undefined_operation();
+				}
+				catch (std::exception& e) {
+					std::terminate();
+				}
+			}
+		}
+
+		template < class O >
+		BOOST_UBLAS_INLINE
+		void operator () (const basic_string_column<O>& x) const {
+			if (sizeof(O) == 4 && x.byte_size() <= size_t (std::numeric_limits<std::int32_t>::max())) {
+				out_->type = arrow_type::utf8;
+				out_->buffers.push_back (arrow_buffer {x.offsets(), (x.size() + 1) * sizeof(O)});
+			}
+			else if (sizeof(O) == 8) {
+				out_->type = arrow_type::large_utf8;
+				out_->buffers.push_back (arrow_buffer {x.offsets(), (x.size() + 1) * sizeof(O)});
+			}
+			else {
+				std::vector < char > offsets ((x.size() + 1) * sizeof(std::int64_t));
+				for(size_t i = 0; i <= x.size(); ++i) {
+					const std::int64_t o = x.offsets()[i];
+					std::memcpy (offsets.data() + i * sizeof(o), &o, sizeof(o));
+				}
+				out_->type = arrow_type::large_utf8;
+				buffer (std::move (offsets));
+			}
+			out_->buffers.push_back (arrow_buffer {x.bytes(), x.byte_size()});
+		}
+
+		BOOST_UBLAS_INLINE
+		void operator () (const dictionary_column& x) const {
+			if (x.dictionary().byte_size() > size_t (std::numeric_limits<std::int32_t>::max())) {
+				// the dictionary is written as Utf8
+				try {
+					throw undefined_operation();
+				}
+				catch (std::exception& e) {
+					std::terminate();
+				}
+			}
+			out_->type = arrow_type::utf8;
+			out_->dictionary = &x;
+			x.with_codes ([this] (const auto* codes, const size_t n) {
+				out_->buffers.push_back (arrow_buffer {codes, n * sizeof(*codes)});
+			});
+		}
+
+		BOOST_UBLAS_INLINE
+		void operator () (const bool_column& x) const {
+			out_->type = arrow_type::boolean;
+			out_->buffers.push_back (arrow_buffer {x.words(), (x.size() + 7) / 8});
+		}
+
+	private:
+		arrow_column* out_;
+		std::deque < std::vector < char > >* scratch_;
+
+		//! \brief Adds a buffer built for the column.
+		BOOST_UBLAS_INLINE
+		void buffer (std::vector < char >&& b) const {
+			scratch_->push_back (std::move (b));
+			out_->buffers.push_back (arrow_buffer {scratch_->back().data(), scratch_->back().size()});
+		}
+
+		//! \brief Adds the offsets (of type O) and the characters of x.
+		template < class O, class V >
+		BOOST_UBLAS_INLINE
+		void strings (const V& x, const size_t bytes) const {
+			std::vector < char > offsets ((x.size() + 1) * sizeof(O));
+			std::vector < char > chars;
+			chars.reserve (bytes);
+			O o = 0;
+			std::memcpy (offsets.data(), &o, sizeof(o));
+			for(size_t i = 0; i < x.size(); ++i) {
+				chars.insert (chars.end(), x(i).begin(), x(i).end());
+				o = O (chars.size());
+				std::memcpy (offsets.data() + (i + 1) * sizeof(o), &o, sizeof(o));
+			}
+			out_->type = (sizeof(O) == 4) ? arrow_type::utf8 : arrow_type::large_utf8;
+			buffer (std::move (offsets));
+			buffer (std::move (chars));
+		}
+	};
+
+	/*! \brief Writes a data_frame as an Arrow IPC file or stream: the schema, a dictionary batch
+	 *  per dictionary_column and a single record batch holding all the rows.
+	 *  The buffers are written straight from the columns, each padded to arrow_alignment bytes.
+	 */
+	class arrow_writer {
+	public:
+		BOOST_UBLAS_INLINE
+		arrow_writer (const data_frame& df, const arrow_format format):
+			df_ (df),
+			format_ (format),
+			pos_ (0) {}
+
+		BOOST_UBLAS_INLINE
+		void write (std::ostream& out) {
+			const size_t ncol = df_.ncol();
+			columns_.assign (ncol, arrow_column());
+			for(size_t k = 0; k < ncol; ++k) {
+				df_[k].apply_visitor (arrow_column_visitor (columns_[k], scratch_));
+			}
+			if (format_ == arrow_format::file) {
+				const char start[8] = {'A', 'R', 'R', 'O', 'W', '1', 0, 0};
+				out.write (start, sizeof(start));
+				pos_ = sizeof(start);
+			}
+			message (out, arrow_message::schema, std::vector < arrow_buffer > (), [this] (flat_builder& b) {
+				return schema (b);
+			});
+			for(size_t k = 0; k < ncol; ++k) {
+				if (columns_[k].dictionary != 0) {
+					dictionary_batch (out, k);
+				}
+			}
+			record_batch (out);
+			const std::uint32_t end[2] = {arrow_continuation, 0};
+			out.write (reinterpret_cast<const char*> (end), sizeof(end));
+			if (format_ == arrow_format::file) {
+				footer (out);
+			}
+			out.flush();
+		}
+
+	private:
+		const data_frame& df_;
+		const arrow_format format_;
+		//! \brief Position in the output.
+		size_t pos_;
+		std::vector < arrow_column > columns_;
+		std::deque < std::vector < char > > scratch_;
+		std::vector < arrow_block > dictionaries_;
+		std::vector < arrow_block > record_batches_;
+
+		//! \brief Writes the table Schema, returns its position.
+		BOOST_UBLAS_INLINE
+		size_t schema (flat_builder& b) const {
+			const std::vector < size_t > s = b.table ({flat_scalar < std::int16_t > (0, arrow_endianness()), flat_offset (1)});
+			const size_t fields = b.offsets (columns_.size());
+			b.link (s[1], fields);
+			for(size_t k = 0; k < columns_.size(); ++k) {
+				b.link (flat_builder::element (fields, k), field (b, k));
+			}
+			return s.back();
+		}
+
+		//! \brief Writes the table Field of column k, returns its position.
+		BOOST_UBLAS_INLINE
+		size_t field (flat_builder& b, const size_t k) const {
+			const arrow_column& c = columns_[k];
+			const std::uint8_t type = static_cast<std::uint8_t> (c.type);
+			const std::vector < size_t > f = (c.dictionary != 0)
+				? b.table ({flat_offset (0), flat_scalar < std::uint8_t > (1, 1), flat_scalar < std::uint8_t > (2, type), flat_offset (3), flat_offset (4), flat_offset (5)})
+				: b.table ({flat_offset (0), flat_scalar < std::uint8_t > (1, 1), flat_scalar < std::uint8_t > (2, type), flat_offset (3), flat_offset (5)});
+			b.link (f[0], b.string (df_.headers()(k)));
+			switch (c.type) {
+				case arrow_type::integer:
+					b.link (f[3], integer (b, c.bit_width, c.is_signed));
+					break;
+				case arrow_type::floating_point:
+					b.link (f[3], b.table ({flat_scalar < std::int16_t > (0, c.precision)}).back());
+					break;
+				default:
+					b.link (f[3], b.table ({}).back());
+			}
+			if (c.dictionary != 0) {
+				const std::vector < size_t > d = b.table ({flat_scalar < std::int64_t > (0, std::int64_t (k)), flat_offset (1)});
+				b.link (d[1], integer (b, std::int32_t (8 * c.dictionary->code_width()), false));
+				b.link (f[4], d.back());
+			}
+			b.link (f[5], b.offsets (0));
+			return f.back();
+		}
+
+		//! \brief Writes a table Int, returns its position.
+		BOOST_UBLAS_INLINE
+		static size_t integer (flat_builder& b, const std::int32_t bit_width, const bool is_signed) {
+			return b.table ({flat_scalar < std::int32_t > (0, bit_width), flat_scalar < std::uint8_t > (1, is_signed ? 1 : 0)}).back();
+		}
+
+		//! \brief Writes a table RecordBatch of length rows, returns its position.
+		BOOST_UBLAS_INLINE
+		static size_t batch (flat_builder& b, const size_t length, const std::vector < arrow_field_node >& nodes, const std::vector < arrow_buffer >& body) {
+			std::vector < arrow_body_buffer > buffers;
+			std::int64_t offset = 0;
+			for(const arrow_buffer& x : body) {
+				buffers.push_back (arrow_body_buffer {offset, std::int64_t (x.size)});
+				offset += padded (x.size);
+			}
+			const std::vector < size_t > r = b.table ({flat_scalar < std::int64_t > (0, std::int64_t (length)), flat_offset (1), flat_offset (2)});
+			b.link (r[1], b.structs (nodes.data(), nodes.size(), sizeof(arrow_field_node)));
+			b.link (r[2], b.structs (buffers.data(), buffers.size(), sizeof(arrow_body_buffer)));
+			return r.back();
+		}
+
+		//! \brief Writes the dictionary of column k, its id being k.
+		BOOST_UBLAS_INLINE
+		void dictionary_batch (std::ostream& out, const size_t k) {
+			const string_column& d = columns_[k].dictionary->dictionary();
+			const std::vector < arrow_field_node > nodes = {arrow_field_node {std::int64_t (d.size()), 0}};
+			const std::vector < arrow_buffer > body = {arrow_buffer {0, 0}, arrow_buffer {d.offsets(), (d.size() + 1) * sizeof(string_column::offset_type)}, arrow_buffer {d.bytes(), d.byte_size()}};
+			dictionaries_.push_back (message (out, arrow_message::dictionary_batch, body, [k, &d, &nodes, &body] (flat_builder& b) {
+				const std::vector < size_t > t = b.table ({flat_scalar < std::int64_t > (0, std::int64_t (k)), flat_offset (1)});
+				b.link (t[1], batch (b, d.size(), nodes, body));
+				return t.back();
+			}));
+		}
+
+		//! \brief Writes the rows of the data_frame as a single record batch.
+		BOOST_UBLAS_INLINE
+		void record_batch (std::ostream& out) {
+			std::vector < arrow_field_node > nodes;
+			std::vector < arrow_buffer > body;
+			for(size_t k = 0; k < columns_.size(); ++k) {
+				const df_column& c = df_[k];
+				nodes.push_back (arrow_field_node {std::int64_t (c.size()), std::int64_t (c.null_count())});
+				if (c.has_nulls()) {
+					body.push_back (arrow_buffer {c.validity().bits()->words(), (c.size() + 7) / 8});
+				}
+				else {
+					body.push_back (arrow_buffer {0, 0});
+				}
+				body.insert (body.end(), columns_[k].buffers.begin(), columns_[k].buffers.end());
+			}
+			const size_t n = df_.nrow();
+			record_batches_.push_back (message (out, arrow_message::record_batch, body, [n, &nodes, &body] (flat_builder& b) {
+				return batch (b, n, nodes, body);
+			}));
+		}
+
+		/*! \brief Writes a message, header(b) writing its header table and returning its position.
+		 *  Returns the block of the message, for the footer.
+		 */
+		template < class H >
+		BOOST_UBLAS_INLINE
+		arrow_block message (std::ostream& out, const arrow_message type, const std::vector < arrow_buffer >& body, H header) {
+			std::int64_t body_length = 0;
+			for(const arrow_buffer& x : body) {
+				body_length += padded (x.size);
+			}
+			flat_builder b;
+			const std::vector < size_t > m = b.table ({flat_scalar < std::int16_t > (0, arrow_metadata_version),
+				flat_scalar < std::uint8_t > (1, static_cast<std::uint8_t> (type)), flat_offset (2), flat_scalar < std::int64_t > (3, body_length)});
+			b.link (m[2], header (b));
+			const std::vector < char >& metadata = b.finish (m.back());
+			// the metadata is padded so that the body starts on arrow_alignment, and the buffers can be adopted
+			const size_t padding = (arrow_alignment - (pos_ + 2 * sizeof(std::uint32_t) + metadata.size()) % arrow_alignment) % arrow_alignment;
+			const std::uint32_t prefix[2] = {arrow_continuation, std::uint32_t (metadata.size() + padding)};
+			const char zeros[arrow_alignment] = {};
+			out.write (reinterpret_cast<const char*> (prefix), sizeof(prefix));
+			out.write (metadata.data(), metadata.size());
+			out.write (zeros, padding);
+			for(const arrow_buffer& x : body) {
+				out.write (static_cast<const char*> (x.data), x.size);
+				out.write (zeros, padded (x.size) - x.size);
+			}
+			const arrow_block block = {std::int64_t (pos_), std::int32_t (sizeof(prefix) + metadata.size() + padding), 0, body_length};
+			pos_ += sizeof(prefix) + metadata.size() + padding + body_length;
+			return block;
+		}
+
+		//! \brief Writes the footer of a file.
+		BOOST_UBLAS_INLINE
+		void footer (std::ostream& out) const {
+			flat_builder b;
+			const std::vector < size_t > f = b.table ({flat_scalar < std::int16_t > (0, arrow_metadata_version), flat_offset (1), flat_offset (2), flat_offset (3)});
+			b.link (f[1], schema (b));
+			b.link (f[2], b.structs (dictionaries_.data(), dictionaries_.size(), sizeof(arrow_block)));
+			b.link (f[3], b.structs (record_batches_.data(), record_batches_.size(), sizeof(arrow_block)));
+			const std::vector < char >& metadata = b.finish (f.back());
+			const std::int32_t length = std::int32_t (metadata.size());
+			out.write (metadata.data(), metadata.size());
+			out.write (reinterpret_cast<const char*> (&length), sizeof(length));
+			out.write (arrow_magic, sizeof(arrow_magic));
+		}
+
+		//! \brief Returns n rounded up to arrow_alignment.
+		BOOST_UBLAS_INLINE
+		static size_t padded (const size_t n) {
+			return (n + arrow_alignment - 1) / arrow_alignment * arrow_alignment;
+		}
+	};
+
+	/*! \brief Reads an Arrow IPC file or stream into a data_frame, see the top of df_arrow.hpp.
+	 *  Every offset and length is checked against the file, a damaged file terminating with corrupt_file.
+	 */
+	class arrow_reader {
+	public:
+		BOOST_UBLAS_INLINE
+		explicit arrow_reader (const std::string& path):
+			file_ (std::make_shared<mapped_file> (path, true)),
+			data_ (file_->data()),
+			size_ (file_->size()),
+			schema_ (false) {}
+
+		BOOST_UBLAS_INLINE
+		data_frame read () {
+			try {
+				if (size_ >= 2 * sizeof(arrow_magic) + 6 && std::memcmp (data_, arrow_magic, sizeof(arrow_magic)) == 0) {
+					read_file();
+				}
+				else {
+					read_stream();
+				}
+				if (!schema_) {
+					throw corrupt_file();
+				}
+				return assemble();
+			}
+			catch (std::exception& e) {
+				std::terminate();
+			}
+		}
+
+	private:
+		//! \brief Field of the schema.
+		struct field_info {
+			std::string name;
+			arrow_type type;
+			std::int32_t bit_width;
+			bool is_signed;
+			std::int16_t precision;
+			bool dictionary;
+			std::int64_t dictionary_id;
+			std::int32_t index_width;
+			bool index_signed;
+		};
+
+		//! \brief Array of a field in a record batch: its length, null count and buffers (validity first).
+		struct array_info {
+			size_t length;
+			size_t null_count;
+			const char* buffers[3];
+			size_t sizes[3];
+			//! \brief Dictionary of a dictionary encoded array.
+			std::shared_ptr < const string_column > dictionary;
+		};
+
+		//! \brief Message: metadata and body.
+		struct message_info {
+			flat_table message;
+			const char* body;
+			size_t body_length;
+			size_t next;
+		};
+
+		std::shared_ptr < mapped_file > file_;
+		const char* data_;
+		size_t size_;
+		bool schema_;
+		std::vector < field_info > fields_;
+		//! \brief Arrays of the record batches, by batch and field.
+		std::vector < std::vector < array_info > > batches_;
+		std::map < std::int64_t, std::shared_ptr < const string_column > > dictionaries_;
+		//! \brief Columns adopting their values and their validity bitmap.
+		std::vector < bool > lent_values_;
+		std::vector < bool > lent_validity_;
+
+		BOOST_UBLAS_INLINE
+		void read_file () {
+			const size_t tail = sizeof(std::int32_t) + sizeof(arrow_magic);
+			if (std::memcmp (data_ + size_ - sizeof(arrow_magic), arrow_magic, sizeof(arrow_magic)) != 0) {
+				throw corrupt_file();
+			}
+			const std::int32_t length = flat_table::read < std::int32_t > (data_, size_, size_ - tail);
+			if (length < 0 || size_t (length) > size_ - tail - 8) {
+				throw corrupt_file();
+			}
+			const flat_table footer = flat_table::root (data_ + size_ - tail - length, length);
+			read_schema (footer.table (1));
+			const flat_vector dictionaries = footer.vector (2, sizeof(arrow_block));
+			for(size_t i = 0; i < dictionaries.size(); ++i) {
+				handle (block (dictionaries, i), arrow_message::dictionary_batch);
+			}
+			const flat_vector batches = footer.vector (3, sizeof(arrow_block));
+			for(size_t i = 0; i < batches.size(); ++i) {
+				handle (block (batches, i), arrow_message::record_batch);
+			}
+		}
+
+		BOOST_UBLAS_INLINE
+		void read_stream () {
+			for(size_t pos = 0; pos < size_;) {
+				const message_info m = message (pos);
+				if (!m.message.valid()) {
+					break;
+				}
+				handle (m, static_cast<arrow_message> (m.message.scalar < std::uint8_t > (1, 0)));
+				pos = m.next;
+			}
+		}
+
+		//! \brief Returns the message of the ith Block of blocks.
+		BOOST_UBLAS_INLINE
+		message_info block (const flat_vector& blocks, const size_t i) const {
+			const std::int64_t offset = blocks.get < std::int64_t > (i);
+			if (offset < 0 || std::uint64_t (offset) >= size_) {
+				throw corrupt_file();
+			}
+			return message (size_t (offset));
+		}
+
+		//! \brief Returns the message at pos, invalid at the end of the stream.
+		BOOST_UBLAS_INLINE
+		message_info message (size_t pos) const {
+			message_info m = {flat_table(), 0, 0, size_};
+			std::uint32_t length = flat_table::read < std::uint32_t > (data_, size_, pos);
+			pos += sizeof(length);
+			if (length == arrow_continuation) {
+				length = flat_table::read < std::uint32_t > (data_, size_, pos);
+				pos += sizeof(length);
+			}
+			if (length == 0) {
+				return m;
+			}
+			if (length > size_ - pos) {
+				throw corrupt_file();
+			}
+			m.message = flat_table::root (data_ + pos, length);
+			const std::int64_t body_length = m.message.scalar < std::int64_t > (3, 0);
+			pos += length;
+			if (body_length < 0 || std::uint64_t (body_length) > size_ - pos) {
+				throw corrupt_file();
+			}
+			m.body = data_ + pos;
+			m.body_length = size_t (body_length);
+			m.next = pos + m.body_length;
+			return m;
+		}
+
+		//! \brief Reads a message of header type.
+		BOOST_UBLAS_INLINE
+		void handle (const message_info& m, const arrow_message type) {
+			if (m.message.scalar < std::uint8_t > (1, 0) != static_cast<std::uint8_t> (type)) {
+				throw corrupt_file();
+			}
+			const flat_table header = m.message.table (2);
+			switch (type) {
+				case arrow_message::schema:
+					if (!schema_) {
+						read_schema (header);
+					}
+					break;
+				case arrow_message::dictionary_batch:
+					read_dictionary (header, m);
+					break;
+				case arrow_message::record_batch:
+					read_batch (header, m);
+					break;
+				default:
+					throw unsupported_file();
+			}
+		}
+
+		BOOST_UBLAS_INLINE
+		void read_schema (const flat_table& s) {
+			if (!s.valid()) {
+				throw corrupt_file();
+			}
+			if (s.scalar < std::int16_t > (0, 0) != arrow_endianness()) {
+				throw unsupported_file();
+			}
+			const flat_vector fields = s.vector (1, sizeof(std::uint32_t));
+			for(size_t i = 0; i < fields.size(); ++i) {
+				const flat_table f = fields.table (i);
+				field_info x = {std::string (f.string (0)), static_cast<arrow_type> (f.scalar < std::uint8_t > (2, 0)), 0, false, 0, false, 0, 32, true};
+				const flat_table type = f.table (3);
+				if (f.vector (5, sizeof(std::uint32_t)).size() != 0) {
+					throw unsupported_file();
+				}
+				switch (x.type) {
+					case arrow_type::integer:
+						x.bit_width = type.scalar < std::int32_t > (0, 0);
+						x.is_signed = type.scalar < std::uint8_t > (1, 0) != 0;
+						if (x.bit_width != 8 && x.bit_width != 16 && x.bit_width != 32 && x.bit_width != 64) {
+							throw unsupported_file();
+						}
+						break;
+					case arrow_type::floating_point:
+						x.precision = type.scalar < std::int16_t > (0, 0);
+						if (x.precision != 1 && x.precision != 2) {
+							throw unsupported_file();
+						}
+						break;
+					case arrow_type::binary:
+					case arrow_type::utf8:
+					case arrow_type::large_binary:
+					case arrow_type::large_utf8:
+					case arrow_type::boolean:
+						break;
+					default:
+						throw unsupported_file();
+				}
+				const flat_table d = f.table (4);
+				if (d.valid()) {
+					x.dictionary = true;
+					x.dictionary_id = d.scalar < std::int64_t > (0, 0);
+					const flat_table index = d.table (1);
+					if (index.valid()) {
+						x.index_width = index.scalar < std::int32_t > (0, 0);
+						x.index_signed = index.scalar < std::uint8_t > (1, 0) != 0;
+					}
+					if (!strings (x) || (x.index_width != 8 && x.index_width != 16 && x.index_width != 32 && x.index_width != 64)) {
+						throw unsupported_file();
+					}
+				}
+				fields_.push_back (x);
+			}
+			schema_ = true;
+		}
+
+		//! \brief Returns \c true if the values of f are strings.
+		BOOST_UBLAS_INLINE
+		static bool strings (const field_info& f) {
+			return f.type == arrow_type::binary || f.type == arrow_type::utf8 || f.type == arrow_type::large_binary || f.type == arrow_type::large_utf8;
+		}
+
+		//! \brief Returns \c true if the strings of f have 64 bit offsets.
+		BOOST_UBLAS_INLINE
+		static bool large (const field_info& f) {
+			return f.type == arrow_type::large_binary || f.type == arrow_type::large_utf8;
+		}
+
+		//! \brief Returns the number of bytes of the values (or indices) of f.
+		BOOST_UBLAS_INLINE
+		static size_t value_size (const field_info& f) {
+			return f.dictionary ? f.index_width / 8 : (f.type == arrow_type::integer) ? f.bit_width / 8 : (f.precision == 1) ? 4 : 8;
+		}
+
+		/*! \brief Reads the array of f in a record batch of the message m, from the node and buffers
+		 *  at the positions node and buffer, moved past them. Checks the buffers are long enough.
+		 */
+		BOOST_UBLAS_INLINE
+		array_info array (const field_info& f, const flat_vector& nodes, size_t& node, const flat_vector& buffers, size_t& buffer, const message_info& m, const size_t length) const {
+			const std::int64_t n = nodes.get < std::int64_t > (node);
+			const std::int64_t nulls = nodes.get < std::int64_t > (node, sizeof(std::int64_t));
+			++node;
+			if (n < 0 || size_t (n) != length || nulls < 0 || nulls > n) {
+				throw corrupt_file();
+			}
+			array_info a = {length, size_t (nulls), {0, 0, 0}, {0, 0, 0}, 0};
+			const size_t count = (strings (f) && !f.dictionary) ? 3 : 2;
+			for(size_t i = 0; i < count; ++i, ++buffer) {
+				const std::int64_t offset = buffers.get < std::int64_t > (buffer);
+				const std::int64_t size = buffers.get < std::int64_t > (buffer, sizeof(std::int64_t));
+				if (offset < 0 || size < 0 || std::uint64_t (offset) > m.body_length || std::uint64_t (size) > m.body_length - offset) {
+					throw corrupt_file();
+				}
+				a.buffers[i] = m.body + offset;
+				a.sizes[i] = size_t (size);
+			}
+			const size_t bits = (length + 7) / 8;
+			if ((a.null_count != 0 && a.sizes[0] < bits)
+				|| (f.type == arrow_type::boolean && !f.dictionary && a.sizes[1] < bits)
+				|| (strings (f) && !f.dictionary && a.sizes[1] < (length + 1) * (large (f) ? 8 : 4))
+				|| (!strings (f) && f.type != arrow_type::boolean && a.sizes[1] / value_size (f) < length)
+				|| (f.dictionary && a.sizes[1] / value_size (f) < length)) {
+				throw corrupt_file();
+			}
+			return a;
+		}
+
+		BOOST_UBLAS_INLINE
+		void read_batch (const flat_table& r, const message_info& m) {
+			if (!r.valid() || !schema_) {
+				throw corrupt_file();
+			}
+			if (r.has (3)) {
+				// compressed bodies
+				throw unsupported_file();
+			}
+			const std::int64_t length = r.scalar < std::int64_t > (0, 0);
+			if (length < 0) {
+				throw corrupt_file();
+			}
+			const flat_vector nodes = r.vector (1, sizeof(arrow_field_node));
+			const flat_vector buffers = r.vector (2, sizeof(arrow_body_buffer));
+			size_t node = 0;
+			size_t buffer = 0;
+			std::vector < array_info > arrays;
+			for(const field_info& f : fields_) {
+				arrays.push_back (array (f, nodes, node, buffers, buffer, m, size_t (length)));
+				if (f.dictionary) {
+					const auto d = dictionaries_.find (f.dictionary_id);
+					if (d == dictionaries_.end()) {
+						throw corrupt_file();
+					}
+					arrays.back().dictionary = d->second;
+				}
+			}
+			batches_.push_back (std::move (arrays));
+		}
+
+		//! \brief Reads a dictionary, replacing the one of the same id or appended to it if a delta.
+		BOOST_UBLAS_INLINE
+		void read_dictionary (const flat_table& t, const message_info& m) {
+			if (!t.valid() || !schema_) {
+				throw corrupt_file();
+			}
+			const std::int64_t id = t.scalar < std::int64_t > (0, 0);
+			const flat_table r = t.table (1);
+			if (!r.valid()) {
+				throw corrupt_file();
+			}
+			if (r.has (3)) {
+				throw unsupported_file();
+			}
+			const field_info* f = 0;
+			for(const field_info& x : fields_) {
+				if (x.dictionary && x.dictionary_id == id) {
+					f = &x;
+				}
+			}
+			const std::int64_t length = r.scalar < std::int64_t > (0, 0);
+			if (f == 0 || length < 0) {
+				throw corrupt_file();
+			}
+			field_info values = *f;
+			values.dictionary = false;
+			size_t node = 0;
+			size_t buffer = 0;
+			const array_info a = array (values, r.vector (1, sizeof(arrow_field_node)), node, r.vector (2, sizeof(arrow_body_buffer)), buffer, m, size_t (length));
+			auto d = std::make_shared<string_column>();
+			const auto previous = dictionaries_.find (id);
+			if (t.scalar < std::uint8_t > (2, 0) != 0 && previous != dictionaries_.end()) {
+				*d = *previous->second;
+			}
+			if (large (values)) {
+				append_strings < std::int64_t > (a, *d);
+			}
+			else {
+				append_strings < std::int32_t > (a, *d);
+			}
+			dictionaries_[id] = d;
+		}
+
+		//! \brief Appends the strings of a, of offsets of type O, to s.
+		template < class O, class S >
+		BOOST_UBLAS_INLINE
+		static void append_strings (const array_info& a, S& s) {
+			O first;
+			std::memcpy (&first, a.buffers[1], sizeof(O));
+			O previous = first;
+			if (first < 0) {
+				throw corrupt_file();
+			}
+			for(size_t i = 0; i < a.length; ++i) {
+				O o;
+				std::memcpy (&o, a.buffers[1] + (i + 1) * sizeof(O), sizeof(O));
+				if (o < previous || std::uint64_t (o) > a.sizes[2]) {
+					throw corrupt_file();
+				}
+				s.push_back (std::string_view (a.buffers[2] + previous, size_t (o - previous)));
+				previous = o;
+			}
+		}
+
+		/*! \brief Returns \c true if the bytes at p can be adopted as a buffer of a column (see adopt_array()):
+		 *  aligned on \c column_alignment and readable up to their padded size inside the mapping.
+		 */
+		BOOST_UBLAS_INLINE
+		bool lendable (const char* p, const size_t bytes) const {
+			return reinterpret_cast<std::uintptr_t> (p) % column_alignment == 0
+				&& cache_aligned_allocator<char>::padded_size (bytes) <= size_t (data_ + size_ - p);
+		}
+
+		//! \brief Returns \c true if the n bits of the size bytes at p can be adopted as a bitmap: lendable, whole words and 0 past n.
+		BOOST_UBLAS_INLINE
+		bool lendable_bits (const char* p, const size_t size, const size_t n) const {
+			const size_t words = bitmap::nwords (n);
+			if (words * sizeof(bitmap::word_type) > size || !lendable (p, words * sizeof(bitmap::word_type))) {
+				return false;
+			}
+			bitmap::word_type last;
+			std::memcpy (&last, p + (words - 1) * sizeof(last), sizeof(last));
+			return n % bitmap::word_bits == 0 || (last >> (n % bitmap::word_bits)) == 0;
+		}
+
+		//! \brief Decides which buffers the columns adopt.
+		BOOST_UBLAS_INLINE
+		void plan () {
+			lent_values_.assign (fields_.size(), false);
+			lent_validity_.assign (fields_.size(), false);
+			if (batches_.size() != 1 || batches_[0].empty() || batches_[0][0].length == 0) {
+				return;
+			}
+			std::set < const char* > lent;
+			for(size_t k = 0; k < fields_.size(); ++k) {
+				const field_info& f = fields_[k];
+				const array_info& a = batches_[0][k];
+				if (!f.dictionary && (f.type == arrow_type::integer || f.type == arrow_type::floating_point)) {
+					lent_values_[k] = lendable (a.buffers[1], a.length * value_size (f));
+				}
+				else if (!f.dictionary && f.type == arrow_type::boolean) {
+					lent_values_[k] = lendable_bits (a.buffers[1], a.sizes[1], a.length);
+				}
+				lent_validity_[k] = a.null_count != 0 && lendable_bits (a.buffers[0], a.sizes[0], a.length);
+				// a buffer shared by two arrays is copied for the second, so that they are written apart
+				lent_values_[k] = lent_values_[k] && lent.insert (a.buffers[1]).second;
+				lent_validity_[k] = lent_validity_[k] && lent.insert (a.buffers[0]).second;
+			}
+		}
+
+		BOOST_UBLAS_INLINE
+		data_frame assemble () {
+			plan();
+			vector < std::string > headers (fields_.size());
+			vector < df_column > cols (fields_.size());
+			for(size_t k = 0; k < fields_.size(); ++k) {
+				headers(k) = fields_[k].name;
+				cols(k) = column (k);
+			}
+			return data_frame (headers, std::move (cols));
+		}
+
+		//! \brief Returns the number of rows.
+		BOOST_UBLAS_INLINE
+		size_t rows () const {
+			size_t n = 0;
+			for(const std::vector < array_info >& b : batches_) {
+				n += b.empty() ? 0 : b[0].length;
+			}
+			return n;
+		}
+
+		//! \brief Returns the column of field k.
+		BOOST_UBLAS_INLINE
+		df_column column (const size_t k) {
+			const field_info& f = fields_[k];
+			df_column col;
+			if (f.dictionary) {
+				col = df_column (dictionary (k));
+			}
+			else {
+				switch (f.type) {
+					case arrow_type::integer: col = integers (k); break;
+					case arrow_type::floating_point: col = (f.precision == 1) ? numbers < float > (k) : numbers < double > (k); break;
+					case arrow_type::boolean: col = df_column (booleans (k)); break;
+					case arrow_type::large_binary:
+					case arrow_type::large_utf8: col = df_column (string_array < std::int64_t, large_string_column > (k)); break;
+					default: col = df_column (string_array < std::int32_t, string_column > (k));
+				}
+			}
+			size_t nulls = 0;
+			for(const std::vector < array_info >& b : batches_) {
+				nulls += b[k].null_count;
+			}
+			if (nulls != 0) {
+				column_validity validity (lent_validity_[k] ? bitmap (adopt_array (bitmap_words (batches_[0][k].buffers[0]), bitmap::nwords (rows()), file_), rows())
+					: bits (k, 0));
+				if (validity.null_count() != nulls) {
+					throw corrupt_file();
+				}
+				col.set_validity (std::move (validity));
+			}
+			return col;
+		}
+
+		BOOST_UBLAS_INLINE
+		static bitmap::word_type* bitmap_words (const char* p) {
+			return reinterpret_cast<bitmap::word_type*> (const_cast<char*> (p));
+		}
+
+		BOOST_UBLAS_INLINE
+		df_column integers (const size_t k) {
+			const field_info& f = fields_[k];
+			switch (f.bit_width) {
+				case 8: return f.is_signed ? numbers < char > (k) : numbers < unsigned char > (k);
+				case 16: return f.is_signed ? numbers < short > (k) : numbers < unsigned short > (k);
+				case 32: return f.is_signed ? numbers < int > (k) : numbers < unsigned int > (k);
+			}
+			return f.is_signed ? numbers < long long > (k) : numbers < unsigned long long > (k);
+		}
+
+		//! \brief Returns the numbers of field k, adopting their buffer or concatenating the batches.
+		template < class T >
+		BOOST_UBLAS_INLINE
+		df_column numbers (const size_t k) {
+			column_vector<T> v;
+			if (lent_values_[k]) {
+				T* p = reinterpret_cast<T*> (const_cast<char*> (batches_[0][k].buffers[1]));
+				column_array<T> a = adopt_array (p, batches_[0][k].length, file_);
+				v.data().swap (a);
+			}
+			else {
+				v.resize (rows(), false);
+				size_t row = 0;
+				for(const std::vector < array_info >& b : batches_) {
+					std::memcpy (v.data().begin() + row, b[k].buffers[1], b[k].length * sizeof(T));
+					row += b[k].length;
+				}
+			}
+			return df_column (std::move (v));
+		}
+
+		//! \brief Returns the bits of the buffer i (validity 0, values 1) of field k, all set for the arrays without nulls if i == 0.
+		BOOST_UBLAS_INLINE
+		bitmap bits (const size_t k, const size_t i) const {
+			bitmap out (rows(), i == 0);
+			std::vector < bitmap::word_type > words;
+			size_t row = 0;
+			for(const std::vector < array_info >& b : batches_) {
+				const array_info& a = b[k];
+				if (i != 0 || a.null_count != 0) {
+					words.assign (bitmap::nwords (a.length), 0);
+					std::memcpy (words.data(), a.buffers[i], (a.length + 7) / 8);
+					copy_bits (words.data(), a.length, out.words(), row);
+				}
+				row += a.length;
+			}
+			return out;
+		}
+
+		BOOST_UBLAS_INLINE
+		bool_column booleans (const size_t k) {
+			if (lent_values_[k]) {
+				return bitmap (adopt_array (bitmap_words (batches_[0][k].buffers[1]), bitmap::nwords (rows()), file_), rows());
+			}
+			return bits (k, 1);
+		}
+
+		//! \brief Returns the strings of field k, of offsets O, copied into a column S.
+		template < class O, class S >
+		BOOST_UBLAS_INLINE
+		S string_array (const size_t k) const {
+			S s;
+			for(const std::vector < array_info >& b : batches_) {
+				append_strings < O > (b[k], s);
+			}
+			return s;
+		}
+
+		//! \brief Returns the index at row i of the array a of field f, checked against the size of its dictionary.
+		BOOST_UBLAS_INLINE
+		static size_t index (const field_info& f, const array_info& a, const size_t i) {
+			const char* p = a.buffers[1] + i * (f.index_width / 8);
+			std::int64_t x = 0;
+			switch (f.index_width) {
+				case 8: x = f.index_signed ? std::int64_t (*reinterpret_cast<const std::int8_t*> (p)) : std::int64_t (*reinterpret_cast<const std::uint8_t*> (p)); break;
+				case 16: x = f.index_signed ? std::int64_t (load < std::int16_t > (p)) : std::int64_t (load < std::uint16_t > (p)); break;
+				case 32: x = f.index_signed ? std::int64_t (load < std::int32_t > (p)) : std::int64_t (load < std::uint32_t > (p)); break;
+				default: x = load < std::int64_t > (p);
+			}
+			if (x < 0 || std::uint64_t (x) >= a.dictionary->size()) {
+				throw corrupt_file();
+			}
+			return size_t (x);
+		}
+
+		template < class T >
+		BOOST_UBLAS_INLINE
+		static T load (const char* p) {
+			T x;
+			std::memcpy (&x, p, sizeof(T));
+			return x;
+		}
+
+		//! \brief Returns \c true if row i of a is null.
+		BOOST_UBLAS_INLINE
+		static bool null (const array_info& a, const size_t i) {
+			return a.null_count != 0 && ((a.buffers[0][i / 8] >> (i % 8)) & 1) == 0;
+		}
+
+		/*! \brief Returns the dictionary_column of field k, its null rows coded 0.
+		 *  The dictionary and the indices are taken as they are when all the batches share a dictionary
+		 *  without duplicates, else the strings are appended one at a time.
+		 */
+		BOOST_UBLAS_INLINE
+		dictionary_column dictionary (const size_t k) const {
+			const field_info& f = fields_[k];
+			std::shared_ptr < const string_column > d = batches_.empty() ? std::make_shared<string_column>() : batches_[0][k].dictionary;
+			bool shared = true;
+			for(const std::vector < array_info >& b : batches_) {
+				shared = shared && b[k].dictionary == d;
+			}
+			std::unordered_set < std::string_view > distinct;
+			for(size_t c = 0; shared && c < d->size(); ++c) {
+				shared = distinct.insert ((*d)(c)).second;
+			}
+			if (!shared) {
+				dictionary_column x;
+				x.reserve (rows());
+				for(const std::vector < array_info >& b : batches_) {
+					for(size_t i = 0; i < b[k].length; ++i) {
+						x.push_back (null (b[k], i) ? std::string_view() : (*b[k].dictionary)(index (f, b[k], i)));
+					}
+				}
+				return x;
+			}
+			std::vector < std::uint32_t > codes (rows(), 0);
+			size_t row = 0;
+			for(const std::vector < array_info >& b : batches_) {
+				for(size_t i = 0; i < b[k].length; ++i, ++row) {
+					codes[row] = null (b[k], i) ? 0 : std::uint32_t (index (f, b[k], i));
+				}
+			}
+			if (d->size() == 0 && !codes.empty()) {
+				// only nulls, coded 0
+				string_column empty;
+				empty.push_back (std::string_view());
+				return narrow < std::uint8_t > (empty, codes);
+			}
+			if (d->size() <= 0x100) {
+				return narrow < std::uint8_t > (*d, codes);
+			}
+			if (d->size() <= 0x10000) {
+				return narrow < std::uint16_t > (*d, codes);
+			}
+			return dictionary_column (*d, codes.data(), codes.size());
+		}
+
+		template < class T >
+		BOOST_UBLAS_INLINE
+		static dictionary_column narrow (const string_column& d, const std::vector < std::uint32_t >& codes) {
+			const std::vector < T > c (codes.begin(), codes.end());
+			return dictionary_column (d, c.data(), c.size());
+		}
+	};
+
+	/*! \brief Writes df to out as an Arrow IPC file (Feather v2) or stream, see the top of df_arrow.hpp.
+	 *  Terminates with undefined_operation on a column of long double or std::string*.
+	 */
+	BOOST_UBLAS_INLINE
+	void write_arrow (const data_frame& df, std::ostream& out, const arrow_format format = arrow_format::file) {
+		arrow_writer (df, format).write (out);
+	}
+
+	//! \brief Writes df to the file at path as an Arrow IPC file or stream, see write_arrow(df, out, format).
+	BOOST_UBLAS_INLINE
+	void write_arrow (const data_frame& df, const std::string& path, const arrow_format format = arrow_format::file) {
+		std::ofstream out (path, std::ios::binary | std::ios::trunc);
+		try {
+			if (!out) {
+				throw unwritable_file();
+			}
+			write_arrow (df, static_cast<std::ostream&> (out), format);
+			if (!out) {
+				throw unwritable_file();
+			}
+		}
+		catch (std::exception& e) {
+			std::terminate();
+		}
+	}
+
+	/*! \brief Reads the Arrow IPC file (Feather v2) or stream at path.
+	 *  The buffers of a single record batch are adopted by the columns when their layout matches,
+	 *  the file being mapped copy on write as by open_mapped().
+	 */
+	BOOST_UBLAS_INLINE
+	data_frame read_arrow (const std::string& path) {
+		return arrow_reader (path).read();
+	}
+
+}}}
+
+#endif
@@ -0,0 +1,371 @@
+//          Copyright(C) Rishabh Arora 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Packed bitmaps, one bit per row, used for the validity of the column elements
+// and as bit-packed boolean columns (bool_column), the result of the column comparisons.
+// Bit i is bit (i % 64) of the word i / 64, as the validity bitmaps of Apache Arrow.
+// The bitwise operations work a word (and with SIMD a vector of words) at a time.
+
+#ifndef _BOOST_UBLAS_DF_BITMAP_
+#define _BOOST_UBLAS_DF_BITMAP_
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "./column_allocator.hpp"
+#include "./df_simd.hpp"
+
+namespace boost { namespace numeric { namespace ublas {
+
+	/*! \brief Packed bitmap of a fixed number of bits.
+	 *  Words are cache line aligned, the bits past \c size() in the last word are always 0,
+	 *  so counts and comparisons can work on whole words.
+	 */
+	class bitmap {
+	public:
+		typedef std::uint64_t word_type;
+		typedef bool value_type;
+		typedef bool const_reference;
+		typedef size_t size_type;
+
+		//! \brief Number of bits in a word.
+		static constexpr size_t word_bits = 64;
+
+		BOOST_UBLAS_INLINE
+		bitmap ():
+			size_ (0) {}
+
+		//! \brief Bitmap of n bits, all set to value.
+		BOOST_UBLAS_INLINE
+		explicit bitmap (const size_t n, const bool value = false):
+			words_ (nwords (n)),
+			size_ (n) {
+			fill (value);
+		}
+
+		//! \brief Bitmap of the n bits held by words, the bits past n being 0.
+		BOOST_UBLAS_INLINE
+		bitmap (column_array < word_type >&& words, const size_t n):
+			words_ (std::move (words)),
+			size_ (n) {}
+
+		//! \brief Returns the number of bits.
+		BOOST_UBLAS_INLINE
+		size_t size() const {
+			return size_;
+		}
+
+		//! \brief Returns the number of words holding the bits.
+		BOOST_UBLAS_INLINE
+		size_t word_count() const {
+			return nwords (size_);
+		}
+
+		//! \brief Returns the number of words holding n bits.
+		static BOOST_UBLAS_INLINE
+		size_t nwords (const size_t n) {
+			return (n + word_bits - 1) / word_bits;
+		}
+
+		BOOST_UBLAS_INLINE
+		word_type* words() {
+			return words_.begin();
+		}
+
+		BOOST_UBLAS_INLINE
+		const word_type* words() const {
+			return words_.begin();
+		}
+
+		//! \brief Returns the bit i.
+		BOOST_UBLAS_INLINE
+		bool test (const size_t i) const {
+			return (words_[i / word_bits] >> (i % word_bits)) & 1;
+		}
+
+		//! \brief Returns the bit i.
+		BOOST_UBLAS_INLINE
+		bool operator () (const size_t i) const {
+			return test (i);
+		}
+
+		//! \brief Returns the bit i.
+		BOOST_UBLAS_INLINE
+		bool operator [] (const size_t i) const {
+			return test (i);
+		}
+
+		//! \brief Sets the bit i to value.
+		BOOST_UBLAS_INLINE
+		void set (const size_t i, const bool value = true) {
+			const word_type m = word_type(1) << (i % word_bits);
+			if (value) {
+				words_[i / word_bits] |= m;
+			}
+			else {
+				words_[i / word_bits] &= ~m;
+			}
+		}
+
+		//! \brief Sets all the bits to value.
+		BOOST_UBLAS_INLINE
+		void fill (const bool value) {
+			std::fill (words_.begin(), words_.begin() + nwords (size_), value ? ~word_type(0) : word_type(0));
+			clear_tail();
+		}
+
+		//! \brief Resizes to n bits, the new bits are set to value.
+		BOOST_UBLAS_INLINE
+		void resize (const size_t n, const bool value = false) {
+			const size_t old = size_;
+			words_.resize (nwords (n), word_type(0));
+			size_ = n;
+			if (value && n > old) {
+				if (old % word_bits != 0) {
+					words_[old / word_bits] |= ~word_type(0) << (old % word_bits);
+				}
+				std::fill (words_.begin() + nwords (old), words_.end(), ~word_type(0));
+			}
+			clear_tail();
+		}
+
+		/*! \brief Appends a bit.
+		 *  The words grow geometrically, amortized O(1).
+		 */
+		BOOST_UBLAS_INLINE
+		void push_back (const bool value) {
+			if (size_ == words_.size() * word_bits) {
+				column_array < word_type > w (std::max (size_t(1), 2 * words_.size()), word_type(0));
+				std::copy (words_.begin(), words_.end(), w.begin());
+				words_.swap (w);
+			}
+			++size_;
+			set (size_ - 1, value);
+		}
+
+		//! \brief Returns the number of set bits.
+		BOOST_UBLAS_INLINE
+		size_t count() const {
+			return simd::reduce_popcount (words_.begin(), nwords (size_));
+		}
+
+		//! \brief Returns \c true if some bit is set.
+		BOOST_UBLAS_INLINE
+		bool any() const {
+			return find_next (0, true) != size_;
+		}
+
+		//! \brief Returns \c true if all the bits are set.
+		BOOST_UBLAS_INLINE
+		bool all() const {
+			return find_next (0, false) == size_;
+		}
+
+		//! \brief Flips all the bits.
+		BOOST_UBLAS_INLINE
+		void flip () {
+			simd::transform < simd::bit_not > (words(), words(), nwords (size_));
+			clear_tail();
+		}
+
+		//! \brief this = this & b, b of the same size.
+		BOOST_UBLAS_INLINE
+		bitmap& operator &= (const bitmap& b) {
+			simd::transform < simd::bit_and > (words(), b.words(), words(), nwords (size_));
+			return *this;
+		}
+
+		//! \brief this = this | b, b of the same size.
+		BOOST_UBLAS_INLINE
+		bitmap& operator |= (const bitmap& b) {
+			simd::transform < simd::bit_or > (words(), b.words(), words(), nwords (size_));
+			return *this;
+		}
+
+		//! \brief this = this ^ b, b of the same size.
+		BOOST_UBLAS_INLINE
+		bitmap& operator ^= (const bitmap& b) {
+			simd::transform < simd::bit_xor > (words(), b.words(), words(), nwords (size_));
+			return *this;
+		}
+
+		//! \brief Returns the bits at the positions sel(0) ... sel(n-1).
+		BOOST_UBLAS_INLINE
+		bitmap select (const size_t* sel, const size_t n) const {
+			bitmap r (n);
+			for(size_t k = 0; k < n; ++k) {
+				if (test (sel[k])) {
+					r.set (k);
+				}
+			}
+			return r;
+		}
+
+		BOOST_UBLAS_INLINE
+		void swap (bitmap& b) {
+			words_.swap (b.words_);
+			std::swap (size_, b.size_);
+		}
+
+		/*! \brief Returns the index of the first bit equal to value at or after i, \c size() if there is none.
+		 *  Skips whole words of the other value.
+		 */
+		BOOST_UBLAS_INLINE
+		size_t find_next (size_t i, const bool value) const {
+			if (i >= size_) {
+				return size_;
+			}
+			const word_type flip = value ? word_type(0) : ~word_type(0);
+			size_t k = i / word_bits;
+			word_type w = (words_[k] ^ flip) & (~word_type(0) << (i % word_bits));
+			while (w == 0) {
+				if (++k == nwords (size_)) {
+					return size_;
+				}
+				w = words_[k] ^ flip;
+			}
+			return std::min (k * word_bits + __builtin_ctzll (w), size_);
+		}
+
+		BOOST_UBLAS_INLINE
+		bool operator == (const bitmap& b) const {
+			return size_ == b.size_ && std::equal (words_.begin(), words_.begin() + nwords (size_), b.words_.begin());
+		}
+
+		BOOST_UBLAS_INLINE
+		bool operator != (const bitmap& b) const {
+			return !(*this == b);
+		}
+
+		//! \brief Clears the bits past \c size() in the last word.
+		BOOST_UBLAS_INLINE
+		void clear_tail () {
+			if (size_ % word_bits != 0) {
+				words_[size_ / word_bits] &= ~(~word_type(0) << (size_ % word_bits));
+			}
+		}
+
+	private:
+		//! \brief At least nwords(size_) words, more after push_back, the unused ones are 0.
+		column_array < word_type > words_;
+		size_t size_;
+	};
+
+	//! \brief Bit-packed boolean column, 1 bit per element.
+	typedef bitmap bool_column;
+
+	//! \brief out = x & y, on n words.
+	BOOST_UBLAS_INLINE
+	void bitmap_and (const bitmap::word_type* x, const bitmap::word_type* y, bitmap::word_type* out, const size_t n) {
+		simd::transform < simd::bit_and > (x, y, out, n);
+	}
+
+	//! \brief out = x | y, on n words.
+	BOOST_UBLAS_INLINE
+	void bitmap_or (const bitmap::word_type* x, const bitmap::word_type* y, bitmap::word_type* out, const size_t n) {
+		simd::transform < simd::bit_or > (x, y, out, n);
+	}
+
+	//! \brief out = x ^ y, on n words.
+	BOOST_UBLAS_INLINE
+	void bitmap_xor (const bitmap::word_type* x, const bitmap::word_type* y, bitmap::word_type* out, const size_t n) {
+		simd::transform < simd::bit_xor > (x, y, out, n);
+	}
+
+	/*! \brief Copies the bits [0, n) of x to the bits [at, at + n) of out, the other bits of out are unchanged.
+	 *  A word of x at a time, shifted across at most two words of out.
+	 */
+	BOOST_UBLAS_INLINE
+	void copy_bits (const bitmap::word_type* x, const size_t n, bitmap::word_type* out, const size_t at) {
+		typedef bitmap::word_type word_type;
+		const size_t s = at % bitmap::word_bits;
+		word_type* o = out + at / bitmap::word_bits;
+		for(size_t k = 0; k * bitmap::word_bits < n; ++k) {
+			const size_t m = std::min (bitmap::word_bits, n - k * bitmap::word_bits);
+			const word_type keep = (m == bitmap::word_bits) ? ~word_type(0) : ~(~word_type(0) << m);
+			const word_type w = x[k] & keep;
+			o[k] = (o[k] & ~(keep << s)) | (w << s);
+			if (s != 0 && s + m > bitmap::word_bits) {
+				o[k + 1] = (o[k + 1] & ~(keep >> (bitmap::word_bits - s))) | (w >> (bitmap::word_bits - s));
+			}
+		}
+	}
+
+	/*! \brief Returns the positions of the set bits of b, in increasing order (a selection vector).
+	 *  A word at a time: empty words are skipped, the set bits of a word are found by counting trailing zeros.
+	 */
+	BOOST_UBLAS_INLINE
+	std::vector < size_t > set_positions (const bitmap& b) {
+		std::vector < size_t > sel (b.count());
+		const bitmap::word_type* w = b.words();
+		size_t k = 0;
+		for(size_t i = 0; i < b.word_count(); ++i) {
+			for(bitmap::word_type x = w[i]; x != 0; x &= x - 1) {
+				sel[k++] = i * bitmap::word_bits + __builtin_ctzll (x);
+			}
+		}
+		return sel;
+	}
+
+	BOOST_UBLAS_INLINE
+	bitmap operator & (const bitmap& x, const bitmap& y) {
+		bitmap r (x.size());
+		bitmap_and (x.words(), y.words(), r.words(), bitmap::nwords (x.size()));
+		return r;
+	}
+
+	BOOST_UBLAS_INLINE
+	bitmap operator | (const bitmap& x, const bitmap& y) {
+		bitmap r (x.size());
+		bitmap_or (x.words(), y.words(), r.words(), bitmap::nwords (x.size()));
+		return r;
+	}
+
+	BOOST_UBLAS_INLINE
+	bitmap operator ^ (const bitmap& x, const bitmap& y) {
+		bitmap r (x.size());
+		bitmap_xor (x.words(), y.words(), r.words(), bitmap::nwords (x.size()));
+		return r;
+	}
+
+	BOOST_UBLAS_INLINE
+	bitmap operator ~ (const bitmap& x) {
+		bitmap r (x);
+		r.flip();
+		return r;
+	}
+
+	/*! \brief Calls fn(begin, length) for every maximal run of set bits of b in [first, last).
+	 *  A null bitmap counts as all set: fn(first, last - first) is called once.
+	 */
+	template < class F >
+	BOOST_UBLAS_INLINE
+	void for_each_set_run (const bitmap* b, const size_t first, const size_t last, F fn) {
+		if (b == 0) {
+			if (last > first) {
+				fn (first, last - first);
+			}
+			return;
+		}
+		size_t i = b->find_next (first, true);
+		while (i < last) {
+			const size_t j = std::min (b->find_next (i, false), last);
+			fn (i, j - i);
+			i = b->find_next (j, true);
+		}
+	}
+
+	//! \brief Calls fn(begin, length) for every maximal run of set bits of b in [0, n).
+	template < class F >
+	BOOST_UBLAS_INLINE
+	void for_each_set_run (const bitmap* b, const size_t n, F fn) {
+		for_each_set_run (b, 0, n, fn);
+	}
+
+}}}
+
+#endif
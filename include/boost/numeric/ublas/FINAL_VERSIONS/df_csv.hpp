@@ -0,0 +1,1032 @@
+//          Copyright(C) Rishabh Arora 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Reading and writing of data_frames as delimited text (CSV, TSV...).
+// The file is memory mapped and split into one chunk per thread at line ends outside quotes,
+// the state of the tokenizer at each split point being found by running every block of bytes
+// in parallel from all the states, then chaining the blocks.
+// Every thread finds the delimiters, quotes and line ends of its chunk with simd::match_bytes
+// and converts the fields with std::from_chars into buffers of its own, which are then
+// copied into the columns in parallel.
+// The types of the columns are inferred from the first rows and widened if a later field
+// doesn't fit, the widened columns being parsed again.
+// Writing formats blocks of rows in parallel, a column at a time with std::to_chars,
+// into buffers reused from block to block and written to the stream in order.
+
+#ifndef _BOOST_UBLAS_DF_CSV_
+#define _BOOST_UBLAS_DF_CSV_
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+#include "./df.hpp"
+#include "./mapped_file.hpp"
+
+namespace boost { namespace numeric { namespace ublas {
+
+	//! \brief Options of read_csv and write_csv.
+	struct csv_options {
+		//! \brief Separator of the fields, ',' for CSV, '\t' for TSV.
+		char delimiter = ',';
+		//! \brief Quote of the fields holding delimiters or line ends, doubled inside a quoted field.
+		char quote = '"';
+		//! \brief \c true if the first line holds the column headers, else the columns are named "0", "1", ...
+		bool header = true;
+		//! \brief Unquoted fields read as nulls, nulls are written as the first one.
+		std::vector < std::string > null_values = {"", "NA"};
+		//! \brief Number of rows the types of the columns are inferred from.
+		size_t sample_rows = 1000;
+		//! \brief \c true to store the string columns as dictionary_columns.
+		bool dictionary_strings = false;
+		//! \brief Number of threads, 0 for std::thread::hardware_concurrency().
+		size_t threads = 0;
+		//! \brief Minimum number of bytes read by a thread.
+		size_t min_chunk_bytes = 1 << 20;
+		//! \brief Number of rows written by a thread at a time.
+		size_t block_rows = 1 << 16;
+	};
+
+	/*! \brief Types of the columns read from text, in the order they are tried.
+	 *  boolean (true, false), integer (long long), real (double), string (string_column),
+	 *  none being the type of a column of nulls.
+	 */
+	enum class csv_type {
+		none,
+		boolean,
+		integer,
+		real,
+		string
+	};
+
+	//! \brief Returns the narrowest type holding the values of types a and b.
+	BOOST_UBLAS_INLINE
+	csv_type csv_join (const csv_type a, const csv_type b) {
+		if (a == b || b == csv_type::none) {
+			return a;
+		}
+		if (a == csv_type::none) {
+			return b;
+		}
+		if ((a == csv_type::integer && b == csv_type::real) || (a == csv_type::real && b == csv_type::integer)) {
+			return csv_type::real;
+		}
+		return csv_type::string;
+	}
+
+	//! \brief Field of a record, the bytes [begin, end) without the quotes.
+	struct csv_field {
+		const char* begin;
+		const char* end;
+		//! \brief \c true if the field is quoted.
+		bool quoted;
+		//! \brief \c true if the field holds doubled quotes.
+		bool escaped;
+
+		BOOST_UBLAS_INLINE
+		std::string_view view () const {
+			return std::string_view (begin, end - begin);
+		}
+	};
+
+	//! \brief Reads a boolean (true, True, TRUE, false...) from f, returns \c false if it isn't one.
+	BOOST_UBLAS_INLINE
+	bool csv_parse (const csv_field& f, bool& v) {
+		const std::string_view s = f.view();
+		if (s == "true" || s == "True" || s == "TRUE") {
+			v = true;
+			return true;
+		}
+		if (s == "false" || s == "False" || s == "FALSE") {
+			v = false;
+			return true;
+		}
+		return false;
+	}
+
+	//! \brief Reads a number from the whole of f, with std::from_chars, returns \c false if it isn't one.
+	template < class T >
+	BOOST_UBLAS_INLINE
+	bool csv_parse (const csv_field& f, T& v) {
+		const char* b = f.begin;
+		if (b != f.end && *b == '+') {
+			++b;
+			if (b != f.end && *b == '-') {
+				return false;
+			}
+		}
+		const std::from_chars_result r = std::from_chars (b, f.end, v);
+		return b != f.end && r.ec == std::errc() && r.ptr == f.end;
+	}
+
+	//! \brief Returns the narrowest type of the field f, not null.
+	BOOST_UBLAS_INLINE
+	csv_type csv_classify (const csv_field& f) {
+		if (f.escaped) {
+			return csv_type::string;
+		}
+		bool b;
+		long long i;
+		double d;
+		if (csv_parse (f, b)) {
+			return csv_type::boolean;
+		}
+		if (csv_parse (f, i)) {
+			return csv_type::integer;
+		}
+		if (csv_parse (f, d)) {
+			return csv_type::real;
+		}
+		return csv_type::string;
+	}
+
+	/*! \brief Finds the bytes a, b and c in [begin, end).
+	 *  The bytes are matched a block of 4096 at a time by simd::match_bytes into bitmasks,
+	 *  the positions are then read off the bitmasks: the other bytes are only looked at by the vector compares.
+	 */
+	class csv_scanner {
+	public:
+		BOOST_UBLAS_INLINE
+		csv_scanner (const char* begin, const char* end, const char a, const char b, const char c):
+			end_ (end),
+			block_ (begin),
+			block_end_ (begin),
+			a_ (a),
+			b_ (b),
+			c_ (c) {}
+
+		//! \brief Returns the first position of a, b or c in [p, end), end if there is none.
+		BOOST_UBLAS_INLINE
+		const char* next (const char* p) {
+			while (p < end_) {
+				if (p < block_ || p >= block_end_) {
+					load (p);
+				}
+				const size_t i = p - block_;
+				size_t k = i / 64;
+				std::uint64_t w = masks_[k] & (~std::uint64_t(0) << (i % 64));
+				const size_t words = (block_end_ - block_ + 63) / 64;
+				for(;;) {
+					if (w != 0) {
+						return block_ + 64 * k + __builtin_ctzll (w);
+					}
+					if (++k == words) {
+						break;
+					}
+					w = masks_[k];
+				}
+				p = block_end_;
+			}
+			return end_;
+		}
+
+	private:
+		static constexpr size_t block_size = 4096;
+
+		const char* end_;
+		//! \brief Bytes [block_, block_end_) are matched in masks_.
+		const char* block_;
+		const char* block_end_;
+		char a_, b_, c_;
+		std::uint64_t masks_ [block_size / 64];
+
+		BOOST_UBLAS_INLINE
+		void load (const char* p) {
+			block_ = p;
+			block_end_ = p + std::min < size_t > (block_size, end_ - p);
+			simd::match_bytes (p, a_, b_, c_, masks_, block_end_ - p);
+		}
+	};
+
+	/*! \brief Splits the records of [begin, end) into fields.
+	 *  A record ends at a line end ('\n' or "\r\n") outside quotes, empty lines are skipped.
+	 *  A quoted field ends at a quote not followed by another one, the bytes between the closing
+	 *  quote and the next delimiter are dropped. A quote inside an unquoted field is an ordinary byte.
+	 */
+	class csv_tokenizer {
+	public:
+		BOOST_UBLAS_INLINE
+		csv_tokenizer (const char* begin, const char* end, const char delimiter, const char quote):
+			scanner_ (begin, end, delimiter, quote, '\n'),
+			end_ (end),
+			quote_ (quote) {}
+
+		//! \brief Returns the start of the first record at or after p, end if there is none.
+		BOOST_UBLAS_INLINE
+		const char* skip_empty (const char* p) const {
+			for(;;) {
+				if (p != end_ && *p == '\n') {
+					++p;
+				}
+				else if (p != end_ && *p == '\r' && p + 1 != end_ && p[1] == '\n') {
+					p += 2;
+				}
+				else {
+					return p;
+				}
+			}
+		}
+
+		/*! \brief Calls fn(k, field) for the fields k = 0, 1 ... of the record starting at p.
+		 *  \return the start of the next line.
+		 */
+		template < class F >
+		BOOST_UBLAS_INLINE
+		const char* record (const char* p, F fn) {
+			for(size_t k = 0;; ++k) {
+				csv_field f;
+				f.quoted = p != end_ && *p == quote_;
+				f.escaped = false;
+				const char* q;
+				if (f.quoted) {
+					f.begin = p + 1;
+					const char* e = scanner_.next (f.begin);
+					while (e != end_) {
+						if (*e == quote_) {
+							if (e + 1 == end_ || e[1] != quote_) {
+								break;
+							}
+							f.escaped = true;
+							e = scanner_.next (e + 2);
+						}
+						else {
+							e = scanner_.next (e + 1);
+						}
+					}
+					f.end = e;
+					q = (e == end_) ? end_ : next_separator (e + 1);
+				}
+				else {
+					f.begin = p;
+					q = next_separator (p);
+					f.end = q;
+					if (f.end != f.begin && f.end[-1] == '\r' && (q == end_ || *q == '\n')) {
+						--f.end;
+					}
+				}
+				fn (k, f);
+				if (q == end_) {
+					return end_;
+				}
+				if (*q == '\n') {
+					return q + 1;
+				}
+				p = q + 1;
+			}
+		}
+
+	private:
+		csv_scanner scanner_;
+		const char* end_;
+		char quote_;
+
+		//! \brief Returns the first delimiter or line end in [p, end), end if there is none.
+		BOOST_UBLAS_INLINE
+		const char* next_separator (const char* p) {
+			const char* q = scanner_.next (p);
+			while (q != end_ && *q == quote_) {
+				q = scanner_.next (q + 1);
+			}
+			return q;
+		}
+	};
+
+	//! \brief Appends the bytes of f to out, the doubled quotes being unescaped.
+	BOOST_UBLAS_INLINE
+	void csv_unescape (const csv_field& f, const char quote, std::vector < char >& out) {
+		if (!f.escaped) {
+			out.insert (out.end(), f.begin, f.end);
+			return;
+		}
+		for(const char* p = f.begin; p != f.end; ++p) {
+			out.push_back (*p);
+			if (*p == quote && p + 1 != f.end && p[1] == quote) {
+				++p;
+			}
+		}
+	}
+
+	/*! \brief Values of a column read by one thread.
+	 *  Fields which don't fit the type of the column widen \c needed(), the type the column
+	 *  has to be read again with.
+	 */
+	class csv_column_builder {
+	public:
+		BOOST_UBLAS_INLINE
+		csv_column_builder (const csv_type type, const csv_options& options):
+			type_ (type),
+			needed_ (type),
+			options_ (&options),
+			size_ (0),
+			nulls_ (0) {}
+
+		BOOST_UBLAS_INLINE
+		void append (const csv_field& f) {
+			if (!f.quoted && is_null (f.view())) {
+				append_null();
+				return;
+			}
+			bool ok = true;
+			switch (type_) {
+				case csv_type::boolean: {
+					bool v = false;
+					ok = !f.escaped && csv_parse (f, v);
+					bools_.push_back (v);
+					break;
+				}
+				case csv_type::integer: {
+					long long v = 0;
+					ok = !f.escaped && csv_parse (f, v);
+					ints_.push_back (v);
+					break;
+				}
+				case csv_type::real: {
+					double v = 0;
+					ok = !f.escaped && csv_parse (f, v);
+					reals_.push_back (v);
+					break;
+				}
+				default:
+					csv_unescape (f, options_->quote, bytes_);
+					ends_.push_back (bytes_.size());
+			}
+			if (!ok) {
+				needed_ = csv_join (needed_, csv_classify (f));
+			}
+			push_validity (true);
+		}
+
+		BOOST_UBLAS_INLINE
+		void append_null () {
+			switch (type_) {
+				case csv_type::boolean:
+					bools_.push_back (false);
+					break;
+				case csv_type::integer:
+					ints_.push_back (0);
+					break;
+				case csv_type::real:
+					reals_.push_back (0);
+					break;
+				default:
+					ends_.push_back (bytes_.size());
+			}
+			push_validity (false);
+		}
+
+		//! \brief Returns the number of values.
+		BOOST_UBLAS_INLINE
+		size_t size () const {
+			return size_;
+		}
+
+		//! \brief Returns the type holding all the fields appended.
+		BOOST_UBLAS_INLINE
+		csv_type needed () const {
+			return needed_;
+		}
+
+		BOOST_UBLAS_INLINE
+		size_t null_count () const {
+			return nulls_;
+		}
+
+		//! \brief Returns the validity of the values, empty if there is no null.
+		BOOST_UBLAS_INLINE
+		const bitmap& validity () const {
+			return valid_;
+		}
+
+		BOOST_UBLAS_INLINE
+		const bitmap& bools () const {
+			return bools_;
+		}
+
+		BOOST_UBLAS_INLINE
+		const std::vector < long long >& ints () const {
+			return ints_;
+		}
+
+		BOOST_UBLAS_INLINE
+		const std::vector < double >& reals () const {
+			return reals_;
+		}
+
+		//! \brief Returns the characters of the strings.
+		BOOST_UBLAS_INLINE
+		const std::vector < char >& bytes () const {
+			return bytes_;
+		}
+
+		//! \brief Returns the end of each string in \c bytes().
+		BOOST_UBLAS_INLINE
+		const std::vector < size_t >& ends () const {
+			return ends_;
+		}
+
+	private:
+		csv_type type_;
+		csv_type needed_;
+		const csv_options* options_;
+		size_t size_;
+		size_t nulls_;
+		//! \brief Validity of the values, kept from the first null on.
+		bitmap valid_;
+		bitmap bools_;
+		std::vector < long long > ints_;
+		std::vector < double > reals_;
+		std::vector < char > bytes_;
+		std::vector < size_t > ends_;
+
+		BOOST_UBLAS_INLINE
+		bool is_null (const std::string_view s) const {
+			for(const std::string& n: options_->null_values) {
+				if (s == n) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		BOOST_UBLAS_INLINE
+		void push_validity (const bool valid) {
+			if (!valid) {
+				if (nulls_ == 0) {
+					valid_.resize (size_, true);
+				}
+				++nulls_;
+			}
+			if (nulls_ != 0) {
+				valid_.push_back (valid);
+			}
+			++size_;
+		}
+	};
+
+	/*! \brief Reads a data_frame from the delimited text in [data, data + size).
+	 *  See the top of the file for the algorithm.
+	 */
+	class csv_reader {
+	public:
+		BOOST_UBLAS_INLINE
+		csv_reader (const char* data, const size_t size, const csv_options& options):
+			begin_ (data),
+			end_ (data + size),
+			options_ (options) {}
+
+		BOOST_UBLAS_INLINE
+		data_frame read () {
+			if (end_ - begin_ >= 3 && std::memcmp (begin_, "\xEF\xBB\xBF", 3) == 0) {
+				begin_ += 3;
+			}
+			std::vector < std::string > names;
+			{
+				csv_tokenizer tk (begin_, end_, options_.delimiter, options_.quote);
+				const char* p = tk.skip_empty (begin_);
+				if (p == end_) {
+					return data_frame();
+				}
+				const char* next = tk.record (p, [this, &names] (const size_t k, const csv_field& f) {
+					std::vector < char > s;
+					csv_unescape (f, options_.quote, s);
+					names.push_back (options_.header ? std::string (s.begin(), s.end()) : std::to_string (k));
+				});
+				if (options_.header) {
+					begin_ = next;
+				}
+			}
+			const size_t ncol = names.size();
+			types_ = infer_types (ncol);
+			split();
+			const size_t chunks = starts_.size() - 1;
+			builders_.assign (chunks, std::vector < csv_column_builder > ());
+			rows_.assign (chunks, 0);
+			std::vector < char > active (ncol, 1);
+			for(;;) {
+				parse (active);
+				bool widened = false;
+				for(size_t k = 0; k < ncol; ++k) {
+					csv_type t = types_[k];
+					for(size_t c = 0; c < chunks; ++c) {
+						t = csv_join (t, builders_[c][k].needed());
+					}
+					active[k] = (t != types_[k]);
+					widened = widened || active[k];
+					types_[k] = t;
+				}
+				if (!widened) {
+					break;
+				}
+			}
+			vector < std::string > headers (ncol);
+			vector < df_column > cols (ncol);
+			for(size_t k = 0; k < ncol; ++k) {
+				headers(k) = names[k];
+				cols(k) = column (k);
+			}
+			return data_frame (headers, std::move (cols));
+		}
+
+	private:
+		const char* begin_;
+		const char* end_;
+		const csv_options& options_;
+		std::vector < csv_type > types_;
+		//! \brief Chunk c holds the bytes [starts_[c], starts_[c + 1]).
+		std::vector < const char* > starts_;
+		//! \brief Columns read from each chunk.
+		std::vector < std::vector < csv_column_builder > > builders_;
+		//! \brief Number of rows of each chunk.
+		std::vector < size_t > rows_;
+
+		//! \brief Returns the types of the fields of the first sample_rows records, real for a column of nulls.
+		BOOST_UBLAS_INLINE
+		std::vector < csv_type > infer_types (const size_t ncol) const {
+			std::vector < csv_type > types (ncol, csv_type::none);
+			csv_tokenizer tk (begin_, end_, options_.delimiter, options_.quote);
+			const char* p = tk.skip_empty (begin_);
+			for(size_t r = 0; r < options_.sample_rows && p != end_; ++r) {
+				p = tk.skip_empty (tk.record (p, [this, &types] (const size_t k, const csv_field& f) {
+					if (k < types.size() && (f.quoted || std::find (options_.null_values.begin(), options_.null_values.end(), f.view()) == options_.null_values.end())) {
+						types[k] = csv_join (types[k], csv_classify (f));
+					}
+				}));
+			}
+			for(csv_type& t: types) {
+				if (t == csv_type::none) {
+					t = csv_type::real;
+				}
+			}
+			return types;
+		}
+
+		/*! \brief States of a csv_tokenizer between 2 bytes: at the start of a field, in an unquoted field,
+		 *  in a quoted field, after a quote in a quoted field (doubled or closing), after a closing quote.
+		 */
+		enum csv_state {
+			field_start,
+			unquoted,
+			quoted,
+			quote_seen,
+			closed,
+			csv_states
+		};
+
+		typedef std::array < std::uint8_t, csv_states > state_map;
+
+		/*! \brief Returns the state after a byte of kind c (0 other, 1 quote, 2 delimiter or line end) in state s.
+		 *  As in csv_tokenizer, a quote opens a field only at its start and is an ordinary byte anywhere
+		 *  else outside quotes, the bytes after a closing quote are dropped up to the next separator.
+		 */
+		BOOST_UBLAS_INLINE
+		static std::uint8_t transition (const std::uint8_t s, const int c) {
+			static const std::uint8_t table [3][csv_states] = {
+				{unquoted, unquoted, quoted, closed, closed},
+				{quoted, unquoted, quote_seen, quoted, closed},
+				{field_start, field_start, quoted, field_start, field_start}
+			};
+			return table[c][s];
+		}
+
+		/*! \brief Runs the bytes [p, end) from the states in, calling stop(q) at each line end q,
+		 *  which returns \c true to end the run there. Between 2 separators or quotes the first byte
+		 *  decides the state, the others leave it unchanged.
+		 *  \return the end of the run.
+		 */
+		template < class F >
+		BOOST_UBLAS_INLINE
+		const char* run (const char* p, const char* end, state_map& in, F stop) const {
+			csv_scanner scanner (p, end, options_.quote, options_.delimiter, '\n');
+			for(const char* q = scanner.next (p);; q = scanner.next (p)) {
+				if (q != p) {
+					for(std::uint8_t& s : in) {
+						s = transition (s, 0);
+					}
+				}
+				if (q == end) {
+					return end;
+				}
+				const int c = (*q == options_.quote) ? 1 : 2;
+				for(std::uint8_t& s : in) {
+					s = transition (s, c);
+				}
+				p = q + 1;
+				if (*q == '\n' && stop (q)) {
+					return p;
+				}
+			}
+		}
+
+		/*! \brief Splits [begin_, end_) into one chunk per thread, at the first line end outside quotes
+		 *  after each split point. Every block between 2 split points is run in parallel from all the
+		 *  states, which chained from the start give the state at each split point.
+		 */
+		BOOST_UBLAS_INLINE
+		void split () {
+			const size_t n = end_ - begin_;
+			const size_t threads = worker_threads (n, options_.threads, std::max < size_t > (1, options_.min_chunk_bytes));
+			starts_.assign (threads + 1, end_);
+			starts_[0] = begin_;
+			if (threads == 1) {
+				return;
+			}
+			std::vector < state_map > maps (threads);
+			parallel_blocks (n, threads, [this, &maps] (const size_t t, const size_t first, const size_t last) {
+				state_map& m = maps[t];
+				for(std::uint8_t s = 0; s < csv_states; ++s) {
+					m[s] = s;
+				}
+				run (begin_ + first, begin_ + last, m, [] (const char*) { return false; });
+			});
+			std::uint8_t state = field_start;
+			for(size_t t = 1; t < threads; ++t) {
+				state = maps[t - 1][state];
+				state_map m;
+				m.fill (state);
+				const char* p = run (begin_ + n * t / threads, end_, m, [&m] (const char*) { return m[0] == field_start; });
+				starts_[t] = std::max (starts_[t - 1], p);
+			}
+		}
+
+		//! \brief Reads the active columns of every chunk, in parallel.
+		BOOST_UBLAS_INLINE
+		void parse (const std::vector < char >& active) {
+			const size_t chunks = starts_.size() - 1;
+			const size_t ncol = types_.size();
+			for(size_t c = 0; c < chunks; ++c) {
+				builders_[c].resize (ncol, csv_column_builder (csv_type::none, options_));
+				for(size_t k = 0; k < ncol; ++k) {
+					if (active[k]) {
+						builders_[c][k] = csv_column_builder (types_[k], options_);
+					}
+				}
+			}
+			parallel_blocks (chunks, chunks, [this, &active, ncol] (const size_t, const size_t first, const size_t last) {
+				for(size_t c = first; c < last; ++c) {
+					std::vector < csv_column_builder >& cols = builders_[c];
+					csv_tokenizer tk (starts_[c], starts_[c + 1], options_.delimiter, options_.quote);
+					size_t rows = 0;
+					for(const char* p = tk.skip_empty (starts_[c]); p != starts_[c + 1]; p = tk.skip_empty (p)) {
+						size_t fields = 0;
+						p = tk.record (p, [&cols, &active, &fields, ncol] (const size_t k, const csv_field& f) {
+							if (k < ncol && active[k]) {
+								cols[k].append (f);
+							}
+							fields = k + 1;
+						});
+						for(size_t k = fields; k < ncol; ++k) {
+							if (active[k]) {
+								cols[k].append_null();
+							}
+						}
+						++rows;
+					}
+					rows_[c] = rows;
+				}
+			});
+		}
+
+		//! \brief Returns the column k, built from the values of the chunks, which are released.
+		BOOST_UBLAS_INLINE
+		df_column column (const size_t k) {
+			const size_t chunks = starts_.size() - 1;
+			std::vector < size_t > row0 (chunks + 1, 0);
+			for(size_t c = 0; c < chunks; ++c) {
+				row0[c + 1] = row0[c] + rows_[c];
+			}
+			const size_t n = row0[chunks];
+			df_column col;
+			switch (types_[k]) {
+				case csv_type::boolean: {
+					bool_column b (n);
+					for(size_t c = 0; c < chunks; ++c) {
+						copy_bits (builders_[c][k].bools().words(), rows_[c], b.words(), row0[c]);
+					}
+					col = df_column (std::move (b));
+					break;
+				}
+				case csv_type::integer:
+					col = df_column (numbers < long long > (k, row0, &csv_column_builder::ints));
+					break;
+				case csv_type::real:
+					col = df_column (numbers < double > (k, row0, &csv_column_builder::reals));
+					break;
+				default: {
+					size_t bytes = 0;
+					for(size_t c = 0; c < chunks; ++c) {
+						bytes += builders_[c][k].bytes().size();
+					}
+					if (bytes > std::numeric_limits < std::uint32_t >::max()) {
+						col = strings < large_string_column > (k, row0);
+					}
+					else {
+						col = strings < string_column > (k, row0);
+					}
+				}
+			}
+			bool nulls = false;
+			for(size_t c = 0; c < chunks; ++c) {
+				nulls = nulls || builders_[c][k].null_count() != 0;
+			}
+			if (nulls) {
+				bitmap valid (n, true);
+				for(size_t c = 0; c < chunks; ++c) {
+					if (builders_[c][k].null_count() != 0) {
+						copy_bits (builders_[c][k].validity().words(), rows_[c], valid.words(), row0[c]);
+					}
+				}
+				col.set_validity (column_validity (std::move (valid)));
+			}
+			for(size_t c = 0; c < chunks; ++c) {
+				builders_[c][k] = csv_column_builder (csv_type::none, options_);
+			}
+			return col;
+		}
+
+		//! \brief Returns the numbers of column k, copied from the chunks in parallel.
+		template < class T, class V >
+		BOOST_UBLAS_INLINE
+		column_vector < T > numbers (const size_t k, const std::vector < size_t >& row0, V values) {
+			const size_t chunks = starts_.size() - 1;
+			column_vector < T > v (row0[chunks]);
+			T* out = v.data().begin();
+			parallel_blocks (chunks, chunks, [this, k, &row0, values, out] (const size_t, const size_t first, const size_t last) {
+				for(size_t c = first; c < last; ++c) {
+					const std::vector < T >& x = (builders_[c][k].*values)();
+					std::copy (x.begin(), x.end(), out + row0[c]);
+				}
+			});
+			return v;
+		}
+
+		//! \brief Returns the string column k (of type S), copied from the chunks in parallel.
+		template < class S >
+		BOOST_UBLAS_INLINE
+		df_column strings (const size_t k, const std::vector < size_t >& row0) {
+			typedef typename S::offset_type offset_type;
+			const size_t chunks = starts_.size() - 1;
+			std::vector < size_t > byte0 (chunks + 1, 0);
+			for(size_t c = 0; c < chunks; ++c) {
+				byte0[c + 1] = byte0[c] + builders_[c][k].bytes().size();
+			}
+			S s;
+			s.offset_buffer().resize (row0[chunks] + 1);
+			s.byte_buffer().resize (byte0[chunks]);
+			offset_type* offsets = s.offset_buffer().data();
+			char* bytes = s.byte_buffer().data();
+			offsets[0] = 0;
+			parallel_blocks (chunks, chunks, [this, k, &row0, &byte0, offsets, bytes] (const size_t, const size_t first, const size_t last) {
+				for(size_t c = first; c < last; ++c) {
+					const csv_column_builder& b = builders_[c][k];
+					std::copy (b.bytes().begin(), b.bytes().end(), bytes + byte0[c]);
+					for(size_t i = 0; i < b.ends().size(); ++i) {
+						offsets[row0[c] + i + 1] = static_cast<offset_type> (byte0[c] + b.ends()[i]);
+					}
+				}
+			});
+			if (options_.dictionary_strings) {
+				return df_column (dictionary_column (s));
+			}
+			return df_column (std::move (s));
+		}
+	};
+
+	//! \brief Appends s to out, quoted if it holds a delimiter, a quote or a line end, or is a null value.
+	BOOST_UBLAS_INLINE
+	void csv_format_string (const std::string_view s, const csv_options& options, std::vector < char >& out) {
+		bool quoted = false;
+		for(const char c: s) {
+			if (c == options.delimiter || c == options.quote || c == '\n' || c == '\r') {
+				quoted = true;
+				break;
+			}
+		}
+		for(size_t k = 0; k < options.null_values.size() && !quoted; ++k) {
+			quoted = (s == options.null_values[k]);
+		}
+		if (!quoted) {
+			out.insert (out.end(), s.begin(), s.end());
+			return;
+		}
+		out.push_back (options.quote);
+		for(const char c: s) {
+			out.push_back (c);
+			if (c == options.quote) {
+				out.push_back (c);
+			}
+		}
+		out.push_back (options.quote);
+	}
+
+	/*! \brief Appends the text of v to out: numbers with std::to_chars (the shortest text read back
+	 *  as the same value for floating point types), booleans as true / false, characters and strings as strings.
+	 */
+	template < class T >
+	BOOST_UBLAS_INLINE
+	void csv_format (const T& v, const csv_options& options, std::vector < char >& out) {
+		if constexpr (std::is_same < T, bool >::value) {
+			const std::string_view s = v ? "true" : "false";
+			out.insert (out.end(), s.begin(), s.end());
+		}
+		else if constexpr (std::is_same < T, char >::value || std::is_same < T, unsigned char >::value) {
+			const char c = static_cast<char> (v);
+			csv_format_string (std::string_view (&c, 1), options, out);
+		}
+		else if constexpr (std::is_arithmetic < T >::value) {
+			char buffer [64];
+			const std::to_chars_result r = std::to_chars (buffer, buffer + sizeof(buffer), v);
+			out.insert (out.end(), buffer, r.ptr);
+		}
+		else if constexpr (std::is_same < T, std::string* >::value) {
+			if (v != 0) {
+				csv_format_string (*v, options, out);
+			}
+		}
+		else {
+			csv_format_string (std::string_view (v), options, out);
+		}
+	}
+
+	//! \brief Text of the elements of a block of rows of a column, element i being [ends[i-1], ends[i]) of bytes.
+	struct csv_text {
+		std::vector < char > bytes;
+		std::vector < size_t > ends;
+
+		BOOST_UBLAS_INLINE
+		void clear () {
+			bytes.clear();
+			ends.clear();
+		}
+	};
+
+	//! \brief Appends the text of the elements first ... last - 1 of a column to a csv_text.
+	class csv_format_visitor: public boost::static_visitor<void> {
+	public:
+		BOOST_UBLAS_INLINE
+		csv_format_visitor (const column_validity& validity, const size_t first, const size_t last, const csv_options& options, csv_text& out): 
+			validity_ (&validity), 
+			first_ (first), 
+			last_ (last), 
+			options_ (&options), 
+			out_ (&out) {}
+
+		template < class C >
+		BOOST_UBLAS_INLINE
+		void operator () (const C& x) const {
+			const std::string_view null = options_->null_values.empty() ? std::string_view() : std::string_view (options_->null_values.front());
+			for(size_t i = first_; i < last_; ++i) {
+				if (validity_->is_valid (i)) {
+					csv_format (x(i), *options_, out_->bytes);
+				}
+				else {
+					out_->bytes.insert (out_->bytes.end(), null.begin(), null.end());
+				}
+				out_->ends.push_back (out_->bytes.size());
+			}
+		}
+
+	private:
+		const column_validity* validity_;
+		size_t first_;
+		size_t last_;
+		const csv_options* options_;
+		csv_text* out_;
+	};
+
+	/*! \brief Writes a data_frame as delimited text.
+	 *  The rows are written a batch of \c threads * \c block_rows rows at a time: each thread formats
+	 *  a block of rows column by column, then interleaves the columns into its output buffer,
+	 *  and the buffers are written in order with one call to std::ostream::write each.
+	 */
+	class csv_writer {
+	public:
+		BOOST_UBLAS_INLINE
+		csv_writer (const data_frame& df, const csv_options& options):
+			df_ (df),
+			options_ (options) {}
+
+		BOOST_UBLAS_INLINE
+		void write (std::ostream& out) {
+			const size_t ncol = df_.ncol();
+			if (options_.header) {
+				std::vector < char > line;
+				for(size_t k = 0; k < ncol; ++k) {
+					if (k != 0) {
+						line.push_back (options_.delimiter);
+					}
+					csv_format_string (df_.headers()(k), options_, line);
+				}
+				line.push_back ('\n');
+				out.write (line.data(), line.size());
+			}
+			const size_t n = df_.nrow();
+			const size_t block = std::max < size_t > (1, options_.block_rows);
+			const size_t threads = worker_threads (n, options_.threads, block);
+			texts_.assign (threads, std::vector < csv_text > (ncol));
+			buffers_.assign (threads, std::vector < char > ());
+			for(size_t first = 0; first < n; first += threads * block) {
+				const size_t rows = std::min (n - first, threads * block);
+				parallel_blocks (rows, threads, [this, first] (const size_t t, const size_t begin, const size_t end) {
+					format (t, first + begin, first + end);
+				});
+				for(size_t t = 0; t < threads; ++t) {
+					out.write (buffers_[t].data(), buffers_[t].size());
+				}
+			}
+			out.flush();
+		}
+
+	private:
+		const data_frame& df_;
+		const csv_options& options_;
+		//! \brief Text of the columns of the block of each thread.
+		std::vector < std::vector < csv_text > > texts_;
+		//! \brief Rows of the block of each thread.
+		std::vector < std::vector < char > > buffers_;
+
+		//! \brief Writes the rows first ... last - 1 into buffers_[t].
+		BOOST_UBLAS_INLINE
+		void format (const size_t t, const size_t first, const size_t last) {
+			std::vector < csv_text >& texts = texts_[t];
+			std::vector < char >& buffer = buffers_[t];
+			size_t bytes = 0;
+			for(size_t k = 0; k < texts.size(); ++k) {
+				texts[k].clear();
+				const df_column& c = df_[k];
+				c.apply_visitor (csv_format_visitor (c.validity(), first, last, options_, texts[k]));
+				bytes += texts[k].bytes.size();
+			}
+			buffer.clear();
+			buffer.reserve (bytes + (last - first) * texts.size());
+			for(size_t i = 0; i < last - first; ++i) {
+				for(size_t k = 0; k < texts.size(); ++k) {
+					const csv_text& x = texts[k];
+					const size_t b = (i == 0) ? 0 : x.ends[i - 1];
+					buffer.insert (buffer.end(), x.bytes.begin() + b, x.bytes.begin() + x.ends[i]);
+					buffer.push_back ((k + 1 == texts.size()) ? '\n' : options_.delimiter);
+				}
+			}
+		}
+	};
+
+	/*! \brief Returns the data_frame of the delimited text (CSV, TSV...) text.
+	 *  The columns are bool_column, long long, double or string (string_column, dictionary_column
+	 *  with \c options.dictionary_strings), the fields in \c options.null_values are nulls.
+	 */
+	BOOST_UBLAS_INLINE
+	data_frame parse_csv (const std::string_view text, const csv_options& options = csv_options()) {
+		return csv_reader (text.data(), text.size(), options).read();
+	}
+
+	/*! \brief Returns the data_frame of the delimited text (CSV, TSV...) file at path, memory mapped.
+	 *  See parse_csv().
+	 */
+	BOOST_UBLAS_INLINE
+	data_frame read_csv (const std::string& path, const csv_options& options = csv_options()) {
+		// the whole text is tokenized: prefetched at once
+		mapped_file f (path, false, true);
+		return parse_csv (std::string_view (f.data(), f.size()), options);
+	}
+
+	/*! \brief Writes df to out as delimited text (CSV, TSV...), with the headers if \c options.header.
+	 *  Fields holding delimiters, quotes or line ends, and strings equal to a null value, are quoted,
+	 *  nulls are written as \c options.null_values.front(): parse_csv() reads the text back.
+	 */
+	BOOST_UBLAS_INLINE
+	void write_csv (const data_frame& df, std::ostream& out, const csv_options& options = csv_options()) {
+		csv_writer (df, options).write (out);
+	}
+
+	//! \brief Writes df to the file at path as delimited text, see write_csv(df, out, options).
+	BOOST_UBLAS_INLINE
+	void write_csv (const data_frame& df, const std::string& path, const csv_options& options = csv_options()) {
+		std::ofstream out (path, std::ios::binary | std::ios::trunc);
+		try {
+			if (!out) {
+				throw unwritable_file();
+			}
+			write_csv (df, static_cast<std::ostream&> (out), options);
+			if (!out) {
+				throw unwritable_file();
+			}
+		}
+		catch (std::exception& e) {
+			std::terminate();
+		}
+	}
+
+}}}
+
+#endif
@@ -0,0 +1,523 @@
+//          Copyright(C) Rishabh Arora 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Native binary file of a data_frame, opened memory mapped without copying the columns.
+//
+// Layout, the integers being in the byte order of the writer (checked by the reader):
+//   header   "uBLASDF1", u32 0x01020304, u32 version, u64 rows, u64 columns, then for each column
+//            u16 type (df_column::type()), u16 element size, u32 length of the name, name;
+//            zero padded to a multiple of 64 bytes
+//   blocks   the buffers of the columns, each at a multiple of 64 bytes and zero padded to one
+//   footer   for each column u64 null count, u32 code width (dictionary_column), u32 number of blocks,
+//            then the u64 offset and u64 size of each block
+//   trailer  u64 offset of the footer, "uBLASDF1"
+//
+// Blocks of a column, by type:
+//   INNER_TYPE numbers   the elements (element size sizeof(T))
+//   std::string          u64 offsets (rows + 1), characters (element size 8)
+//   string_column        offsets (rows + 1), characters (element size sizeof(offset_type))
+//   dictionary_column    u32 offsets of the dictionary (cardinality + 1), its characters, the codes (element size 4)
+//   bool_column          words of the bitmap
+// followed by the words of the validity bitmap if the column has nulls.
+//
+// open_mapped() maps the file copy on write and adopts the blocks of the numbers, of the bool_columns
+// and of the validity bitmaps as the buffers of the columns (see adopt_array()): they are paged in on
+// first access, never copied, and writing to them never modifies the file. The mapping is released
+// with the last of these buffers. The strings and dictionaries are copied into their columns.
+// A block of bools holding a byte other than 0 or 1 terminates with corrupt_file before being adopted.
+
+#ifndef _BOOST_UBLAS_DF_FILE_
+#define _BOOST_UBLAS_DF_FILE_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "./df.hpp"
+#include "./mapped_file.hpp"
+
+namespace boost { namespace numeric { namespace ublas {
+
+	//! \brief Magic number at the start and at the end of a data_frame file.
+	constexpr char frame_file_magic[8] = {'u', 'B', 'L', 'A', 'S', 'D', 'F', '1'};
+	//! \brief Version of the layout of the data_frame files.
+	constexpr std::uint32_t frame_file_version = 1;
+	//! \brief Byte order mark of the data_frame files.
+	constexpr std::uint32_t frame_file_byte_order = 0x01020304;
+
+	//! \brief Buffer of a column written to a data_frame file.
+	struct frame_block {
+		const void* data;
+		size_t size;
+	};
+
+	/*! \brief Lists the blocks of a column in a data_frame file (see the top of the file).
+	 *  The offsets of the std::string columns, built for the occasion, are kept in \c scratch.
+	 */
+	class frame_block_visitor : public boost::static_visitor<void> {
+	public:
+		BOOST_UBLAS_INLINE
+		frame_block_visitor (std::vector < frame_block >& blocks, std::deque < std::vector < char > >& scratch, std::uint16_t& element_size, std::uint32_t& code_width):
+			blocks_ (&blocks),
+			scratch_ (&scratch),
+			element_size_ (&element_size),
+			code_width_ (&code_width) {}
+
+		template < class T >
+		BOOST_UBLAS_INLINE
+		void operator () (const column_vector<T>& x) const {
+			if constexpr (std::is_arithmetic<T>::value) {
+				*element_size_ = sizeof(T);
+				blocks_->push_back (frame_block {x.data().begin(), x.size() * sizeof(T)});
+			}
+			else if constexpr (std::is_same<T, std::string>::value) {
+				*element_size_ = sizeof(std::uint64_t);
+				std::vector < char > offsets ((x.size() + 1) * sizeof(std::uint64_t));
+				std::vector < char > bytes;
+				std::uint64_t o = 0;
+				std::memcpy (offsets.data(), &o, sizeof(o));
+				for(size_t i = 0; i < x.size(); ++i) {
+					bytes.insert (bytes.end(), x(i).begin(), x(i).end());
+					o = bytes.size();
+					std::memcpy (offsets.data() + (i + 1) * sizeof(o), &o, sizeof(o));
+				}
+				scratch_->push_back (std::move (offsets));
+				scratch_->push_back (std::move (bytes));
+				blocks_->push_back (frame_block {scratch_->end()[-2].data(), scratch_->end()[-2].size()});
+				blocks_->push_back (frame_block {scratch_->back().data(), scratch_->back().size()});
+			}
+			else {
+				// pointers can't be written to a file
+				try {
+					throw undefined_operation();
+				}
+				catch (std::exception& e) {
+					std::terminate();
+				}
+			}
+		}
+
+		template < class O >
+		BOOST_UBLAS_INLINE
+		void operator () (const basic_string_column<O>& x) const {
+			*element_size_ = sizeof(O);
+			blocks_->push_back (frame_block {x.offsets(), (x.size() + 1) * sizeof(O)});
+			blocks_->push_back (frame_block {x.bytes(), x.byte_size()});
+		}
+
+		BOOST_UBLAS_INLINE
+		void operator () (const dictionary_column& x) const {
+			(*this)(x.dictionary());
+			*code_width_ = x.code_width();
+			x.with_codes ([this] (const auto* codes, const size_t n) {
+				blocks_->push_back (frame_block {codes, n * sizeof(*codes)});
+			});
+		}
+
+		BOOST_UBLAS_INLINE
+		void operator () (const bool_column& x) const {
+			blocks_->push_back (frame_block {x.words(), x.word_count() * sizeof(bitmap::word_type)});
+		}
+
+	private:
+		std::vector < frame_block >* blocks_;
+		std::deque < std::vector < char > >* scratch_;
+		std::uint16_t* element_size_;
+		std::uint32_t* code_width_;
+	};
+
+	/*! \brief Writes a data_frame in the native binary layout (see the top of the file).
+	 *  The blocks are written straight from the buffers of the columns.
+	 */
+	class frame_writer {
+	public:
+		BOOST_UBLAS_INLINE
+		explicit frame_writer (const data_frame& df):
+			df_ (df) {}
+
+		BOOST_UBLAS_INLINE
+		void write (std::ostream& out) {
+			const size_t ncol = df_.ncol();
+			std::vector < char > header;
+			put (header, frame_file_magic, sizeof(frame_file_magic));
+			put (header, frame_file_byte_order);
+			put (header, frame_file_version);
+			put (header, std::uint64_t (df_.nrow()));
+			put (header, std::uint64_t (ncol));
+			std::vector < std::vector < frame_block > > blocks (ncol);
+			std::vector < std::uint32_t > code_widths (ncol, 0);
+			std::deque < std::vector < char > > scratch;
+			for(size_t k = 0; k < ncol; ++k) {
+				const df_column& c = df_[k];
+				std::uint16_t element_size = 0;
+				c.apply_visitor (frame_block_visitor (blocks[k], scratch, element_size, code_widths[k]));
+				if (c.has_nulls()) {
+					const bitmap& bits = *c.validity().bits();
+					blocks[k].push_back (frame_block {bits.words(), bits.word_count() * sizeof(bitmap::word_type)});
+				}
+				const std::string& name = df_.headers()(k);
+				put (header, std::uint16_t (c.type()));
+				put (header, element_size);
+				put (header, std::uint32_t (name.size()));
+				put (header, name.data(), name.size());
+			}
+			pad (header);
+			out.write (header.data(), header.size());
+
+			std::vector < char > footer;
+			std::uint64_t offset = header.size();
+			const char zeros[column_alignment] = {};
+			for(size_t k = 0; k < ncol; ++k) {
+				put (footer, std::uint64_t (df_[k].null_count()));
+				put (footer, code_widths[k]);
+				put (footer, std::uint32_t (blocks[k].size()));
+				for(const frame_block& b : blocks[k]) {
+					put (footer, offset);
+					put (footer, std::uint64_t (b.size));
+					out.write (static_cast<const char*> (b.data), b.size);
+					const size_t padding = (column_alignment - b.size % column_alignment) % column_alignment;
+					out.write (zeros, padding);
+					offset += b.size + padding;
+				}
+			}
+			put (footer, offset);
+			put (footer, frame_file_magic, sizeof(frame_file_magic));
+			out.write (footer.data(), footer.size());
+			out.flush();
+		}
+
+	private:
+		const data_frame& df_;
+
+		template < class T >
+		BOOST_UBLAS_INLINE
+		static void put (std::vector < char >& out, const T x) {
+			put (out, &x, sizeof(x));
+		}
+
+		BOOST_UBLAS_INLINE
+		static void put (std::vector < char >& out, const void* p, const size_t n) {
+			out.insert (out.end(), static_cast<const char*> (p), static_cast<const char*> (p) + n);
+		}
+
+		BOOST_UBLAS_INLINE
+		static void pad (std::vector < char >& out) {
+			out.resize ((out.size() + column_alignment - 1) / column_alignment * column_alignment, 0);
+		}
+	};
+
+	/*! \brief Opens a data_frame file (see the top of the file), adopting its blocks as buffers of the columns.
+	 *  Every offset and size is checked against the file before use, a damaged file terminating
+	 *  with corrupt_file instead of reading out of the mapping.
+	 */
+	class frame_reader {
+	public:
+		BOOST_UBLAS_INLINE
+		explicit frame_reader (const std::string& path):
+			file_ (std::make_shared<mapped_file> (path, true)),
+			data_ (file_->data()),
+			size_ (file_->size()),
+			pos_ (0),
+			nrow_ (0) {}
+
+		BOOST_UBLAS_INLINE
+		data_frame read () {
+			try {
+				read_layout();
+				vector < std::string > headers (columns_.size());
+				vector < df_column > cols (columns_.size());
+				for(size_t k = 0; k < columns_.size(); ++k) {
+					headers(k) = columns_[k].name;
+					cols(k) = column (columns_[k]);
+				}
+				return data_frame (headers, std::move (cols));
+			}
+			catch (std::exception& e) {
+				std::terminate();
+			}
+		}
+
+	private:
+		struct column_info {
+			std::string name;
+			std::uint16_t type;
+			std::uint16_t element_size;
+			std::uint64_t null_count;
+			std::uint32_t code_width;
+			//! \brief Offset and size of the blocks.
+			std::vector < std::pair < std::uint64_t, std::uint64_t > > blocks;
+		};
+
+		std::shared_ptr < mapped_file > file_;
+		const char* data_;
+		size_t size_;
+		size_t pos_;
+		size_t nrow_;
+		std::vector < column_info > columns_;
+
+		//! \brief Reads a T at pos_, throws corrupt_file past the end of the file.
+		template < class T >
+		BOOST_UBLAS_INLINE
+		T get () {
+			T x;
+			std::memcpy (&x, bytes (sizeof(T)), sizeof(T));
+			return x;
+		}
+
+		//! \brief Returns the n bytes at pos_, throws corrupt_file past the end of the file.
+		BOOST_UBLAS_INLINE
+		const char* bytes (const size_t n) {
+			if (n > size_ - pos_) {
+				throw corrupt_file();
+			}
+			pos_ += n;
+			return data_ + pos_ - n;
+		}
+
+		//! \brief Returns the ith block of c, of the given number of bytes, throws corrupt_file if its size differs.
+		BOOST_UBLAS_INLINE
+		const char* block (const column_info& c, const size_t i, const size_t n) const {
+			if (c.blocks[i].second != n) {
+				throw corrupt_file();
+			}
+			return data_ + c.blocks[i].first;
+		}
+
+		//! \brief Reads the header, the footer and the trailer, checking the blocks fit in the file.
+		BOOST_UBLAS_INLINE
+		void read_layout () {
+			const size_t trailer = sizeof(std::uint64_t) + sizeof(frame_file_magic);
+			if (size_ < trailer || std::memcmp (bytes (sizeof(frame_file_magic)), frame_file_magic, sizeof(frame_file_magic)) != 0
+				|| std::memcmp (data_ + size_ - sizeof(frame_file_magic), frame_file_magic, sizeof(frame_file_magic)) != 0
+				|| get<std::uint32_t>() != frame_file_byte_order || get<std::uint32_t>() != frame_file_version) {
+				throw corrupt_file();
+			}
+			const std::uint64_t nrow = get<std::uint64_t>();
+			const std::uint64_t ncol = get<std::uint64_t>();
+			if (nrow > size_ * 8 || ncol > size_) {
+				throw corrupt_file();
+			}
+			nrow_ = nrow;
+			columns_.resize (ncol);
+			for(column_info& c : columns_) {
+				c.type = get<std::uint16_t>();
+				c.element_size = get<std::uint16_t>();
+				const std::uint32_t length = get<std::uint32_t>();
+				c.name.assign (bytes (length), length);
+			}
+			const size_t header_end = pos_;
+			pos_ = size_ - trailer;
+			const std::uint64_t footer = get<std::uint64_t>();
+			if (footer < header_end || footer > size_ - trailer) {
+				throw corrupt_file();
+			}
+			pos_ = footer;
+			for(column_info& c : columns_) {
+				c.null_count = get<std::uint64_t>();
+				c.code_width = get<std::uint32_t>();
+				const std::uint32_t nblocks = get<std::uint32_t>();
+				if (nblocks != block_count (c)) {
+					throw corrupt_file();
+				}
+				c.blocks.resize (nblocks);
+				for(auto& b : c.blocks) {
+					b.first = get<std::uint64_t>();
+					b.second = get<std::uint64_t>();
+					if (b.first % column_alignment != 0 || b.first < header_end || b.first > footer || b.second > footer - b.first) {
+						throw corrupt_file();
+					}
+				}
+			}
+		}
+
+		//! \brief Returns the number of blocks of c, throws corrupt_file if its type is unknown.
+		BOOST_UBLAS_INLINE
+		size_t block_count (const column_info& c) const {
+			if (c.null_count > nrow_) {
+				throw corrupt_file();
+			}
+			const size_t validity = (c.null_count != 0) ? 1 : 0;
+			switch (c.type) {
+				case column_traits<std::string>::type_id:
+				case column_traits<string_column>::type_id:
+				case column_traits<large_string_column>::type_id: return 2 + validity;
+				case column_traits<dictionary_column>::type_id: return 3 + validity;
+				case column_traits<std::string*>::type_id: throw corrupt_file();
+			}
+			if (c.type > column_traits<bool_column>::type_id) {
+				throw corrupt_file();
+			}
+			return 1 + validity;
+		}
+
+		//! \brief Returns the column described by c.
+		BOOST_UBLAS_INLINE
+		df_column column (const column_info& c) {
+			df_column col;
+			switch (c.type) {
+#define DF_FILE_COLUMN(r, data, i, T) case i: col = numbers < T > (c); break;
+				BOOST_PP_SEQ_FOR_EACH_I(DF_FILE_COLUMN, _, INNER_TYPE)
+#undef DF_FILE_COLUMN
+				case column_traits<string_column>::type_id: col = df_column (strings < std::uint32_t > (c, 0)); break;
+				case column_traits<large_string_column>::type_id: col = df_column (strings < std::uint64_t > (c, 0)); break;
+				case column_traits<dictionary_column>::type_id: col = df_column (dictionary (c)); break;
+				case column_traits<bool_column>::type_id: col = df_column (words (c, 0)); break;
+			}
+			if (c.null_count != 0) {
+				column_validity validity (words (c, c.blocks.size() - 1));
+				if (validity.null_count() != c.null_count) {
+					throw corrupt_file();
+				}
+				col.set_validity (std::move (validity));
+			}
+			return col;
+		}
+
+		//! \brief Returns the column of numbers (or std::string) of c, the numbers adopting their block.
+		template < class T >
+		BOOST_UBLAS_INLINE
+		df_column numbers (const column_info& c) {
+			if constexpr (std::is_arithmetic<T>::value) {
+				if (c.element_size != sizeof(T)) {
+					throw corrupt_file();
+				}
+				const char* b = block (c, 0, nrow_ * sizeof(T));
+				// a bool of another value than 0 or 1 is undefined behaviour
+				if (std::is_same<T, bool>::value && std::any_of (b, b + nrow_, [] (const char x) { return static_cast<unsigned char> (x) > 1; })) {
+					throw corrupt_file();
+				}
+				T* p = reinterpret_cast<T*> (const_cast<char*> (b));
+				column_vector<T> v;
+				column_array<T> a = adopt_array (p, nrow_, file_);
+				v.data().swap (a);
+				return df_column (std::move (v));
+			}
+			else if constexpr (std::is_same<T, std::string>::value) {
+				const large_string_column s = strings < std::uint64_t > (c, 0);
+				column_vector<T> v (nrow_);
+				for(size_t i = 0; i < nrow_; ++i) {
+					v(i).assign (s(i));
+				}
+				return df_column (std::move (v));
+			}
+			else {
+				throw corrupt_file();
+			}
+		}
+
+		//! \brief Returns the string column in the blocks first and first + 1 of c, copied.
+		template < class O >
+		BOOST_UBLAS_INLINE
+		basic_string_column<O> strings (const column_info& c, const size_t first, const size_t n) const {
+			if (c.element_size != sizeof(O)) {
+				throw corrupt_file();
+			}
+			basic_string_column<O> s;
+			s.offset_buffer().resize (n + 1);
+			std::memcpy (s.offset_buffer().data(), block (c, first, (n + 1) * sizeof(O)), (n + 1) * sizeof(O));
+			const O* offsets = s.offset_buffer().data();
+			for(size_t i = 0; i < n; ++i) {
+				if (offsets[i] > offsets[i + 1]) {
+					throw corrupt_file();
+				}
+			}
+			const size_t bytes = offsets[n];
+			if (offsets[0] != 0) {
+				throw corrupt_file();
+			}
+			const char* p = block (c, first + 1, bytes);
+			s.byte_buffer().assign (p, p + bytes);
+			return s;
+		}
+
+		template < class O >
+		BOOST_UBLAS_INLINE
+		basic_string_column<O> strings (const column_info& c, const size_t first) const {
+			return strings < O > (c, first, nrow_);
+		}
+
+		//! \brief Returns the dictionary_column of c, copied.
+		BOOST_UBLAS_INLINE
+		dictionary_column dictionary (const column_info& c) const {
+			const size_t offsets = c.blocks[0].second / sizeof(std::uint32_t);
+			if (offsets == 0) {
+				throw corrupt_file();
+			}
+			const string_column d = strings < std::uint32_t > (c, 0, offsets - 1);
+			switch (c.code_width) {
+				case 1: return dictionary (d, reinterpret_cast<const std::uint8_t*> (block (c, 2, nrow_)));
+				case 2: return dictionary (d, reinterpret_cast<const std::uint16_t*> (block (c, 2, 2 * nrow_)));
+				case 4: return dictionary (d, reinterpret_cast<const std::uint32_t*> (block (c, 2, 4 * nrow_)));
+			}
+			throw corrupt_file();
+		}
+
+		template < class T >
+		BOOST_UBLAS_INLINE
+		dictionary_column dictionary (const string_column& d, const T* codes) const {
+			for(size_t i = 0; i < nrow_; ++i) {
+				if (codes[i] >= d.size()) {
+					throw corrupt_file();
+				}
+			}
+			return dictionary_column (d, codes, nrow_);
+		}
+
+		//! \brief Returns the bitmap of nrow_ bits in the ith block of c, adopting the block.
+		BOOST_UBLAS_INLINE
+		bitmap words (const column_info& c, const size_t i) const {
+			const size_t n = bitmap::nwords (nrow_);
+			bitmap::word_type* p = reinterpret_cast<bitmap::word_type*> (const_cast<char*> (block (c, i, n * sizeof(bitmap::word_type))));
+			if (nrow_ % bitmap::word_bits != 0 && (p[n - 1] >> (nrow_ % bitmap::word_bits)) != 0) {
+				throw corrupt_file();
+			}
+			return bitmap (adopt_array (p, n, file_), nrow_);
+		}
+	};
+
+	//! \brief Writes df to out in the native binary layout (see the top of df_file.hpp).
+	BOOST_UBLAS_INLINE
+	void write_frame (const data_frame& df, std::ostream& out) {
+		frame_writer (df).write (out);
+	}
+
+	//! \brief Writes df to the file at path in the native binary layout, see write_frame(df, out).
+	BOOST_UBLAS_INLINE
+	void write_frame (const data_frame& df, const std::string& path) {
+		std::ofstream out (path, std::ios::binary | std::ios::trunc);
+		try {
+			if (!out) {
+				throw unwritable_file();
+			}
+			write_frame (df, static_cast<std::ostream&> (out));
+			if (!out) {
+				throw unwritable_file();
+			}
+		}
+		catch (std::exception& e) {
+			std::terminate();
+		}
+	}
+
+	/*! \brief Opens the data_frame file at path, written by write_frame.
+	 *  The numbers, bool_columns and validity bitmaps of the columns point into the file, mapped
+	 *  copy on write: they are read from the page cache, and modifying them never modifies the file.
+	 *  The mapping lives as long as any of them.
+	 */
+	BOOST_UBLAS_INLINE
+	data_frame open_mapped (const std::string& path) {
+		return frame_reader (path).read();
+	}
+
+}}}
+
+#endif
@@ -0,0 +1,374 @@
+//          Copyright(C) Rishabh Arora 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Element-wise kernels used by the df_column operators.
+// Kernels work on raw contiguous buffers and write into a caller-provided output,
+// they hold no state and can be called concurrently from any number of threads.
+// Operations with a vector equivalent run through the SIMD kernels of df_simd.hpp.
+
+#ifndef _BOOST_UBLAS_DF_KERNELS_
+#define _BOOST_UBLAS_DF_KERNELS_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include <boost/numeric/ublas/functional.hpp>
+#include "./df_simd.hpp"
+
+namespace boost { namespace numeric { namespace ublas {
+
+	/*! \brief \c true for the column types on which arithmetic is defined.
+	 *  All the arithmetic INNER_TYPEs except the character types.
+	 */
+	template < class T >
+	struct is_numeric_column : std::integral_constant < bool,
+		std::is_arithmetic<T>::value &&
+		!std::is_same<T, char>::value &&
+		!std::is_same<T, unsigned char>::value > {};
+
+	//! \brief Returns the smaller of t1 and t2.
+	template < class T1, class T2 >
+	struct scalar_min:
+		public scalar_binary_functor < T1, T2 > {
+		typedef typename scalar_binary_functor < T1, T2 >::argument1_type argument1_type;
+		typedef typename scalar_binary_functor < T1, T2 >::argument2_type argument2_type;
+		typedef typename scalar_binary_functor < T1, T2 >::result_type result_type;
+
+		static BOOST_UBLAS_INLINE
+		result_type apply (argument1_type t1, argument2_type t2) {
+			const result_type a = t1, b = t2;
+			return (b < a) ? b : a;
+		}
+	};
+
+	//! \brief Returns the larger of t1 and t2.
+	template < class T1, class T2 >
+	struct scalar_max:
+		public scalar_binary_functor < T1, T2 > {
+		typedef typename scalar_binary_functor < T1, T2 >::argument1_type argument1_type;
+		typedef typename scalar_binary_functor < T1, T2 >::argument2_type argument2_type;
+		typedef typename scalar_binary_functor < T1, T2 >::result_type result_type;
+
+		static BOOST_UBLAS_INLINE
+		result_type apply (argument1_type t1, argument2_type t2) {
+			const result_type a = t1, b = t2;
+			return (a < b) ? b : a;
+		}
+	};
+
+namespace kernel {
+
+	//! \brief SIMD operation computing the ublas functor F, void if there is none.
+	template < class F > struct simd_operation { typedef void type; };
+	template < class T > struct simd_operation < scalar_negate<T> > { typedef simd::negate type; };
+	template < class T1, class T2 > struct simd_operation < scalar_plus<T1, T2> > { typedef simd::plus type; };
+	template < class T1, class T2 > struct simd_operation < scalar_minus<T1, T2> > { typedef simd::minus type; };
+	template < class T1, class T2 > struct simd_operation < scalar_multiplies<T1, T2> > { typedef simd::multiplies type; };
+	template < class T1, class T2 > struct simd_operation < scalar_divides<T1, T2> > { typedef simd::divides type; };
+	template < class T1, class T2 > struct simd_operation < scalar_min<T1, T2> > { typedef simd::min type; };
+	template < class T1, class T2 > struct simd_operation < scalar_max<T1, T2> > { typedef simd::max type; };
+
+	//! \brief \c true if the operations are congruent modulo 2^bits, so they can be computed in a narrower integer.
+	template < class Op > struct is_modular : std::false_type {};
+	template <> struct is_modular < simd::negate > : std::true_type {};
+	template <> struct is_modular < simd::plus > : std::true_type {};
+	template <> struct is_modular < simd::minus > : std::true_type {};
+	template <> struct is_modular < simd::multiplies > : std::true_type {};
+
+	/*! \brief \c true if F on a buffer of T gives the same result through the SIMD kernels.
+	 *  Requires the computation in T to be exact: F computed in T itself, or in a wider integer for modular operations.
+	 */
+	template < class F, class T >
+	constexpr bool use_simd () {
+		typedef typename simd_operation<F>::type Op;
+		if constexpr (std::is_void<Op>::value) {
+			return false;
+		}
+		else {
+			typedef typename F::result_type R;
+			return simd::is_vectorizable<T>::value && Op::template supports<T>::value &&
+				(std::is_same<R, T>::value ||
+				 (is_modular<Op>::value && std::is_integral<T>::value && std::is_integral<R>::value));
+		}
+	}
+
+	//! \brief out(i) = F(x(i)) for i in [0, n).
+	template < class F, class T >
+	BOOST_UBLAS_INLINE
+	void apply_unary (const T* x, T* out, const size_t n) {
+		if constexpr (use_simd<F, T>()) {
+			simd::transform < typename simd_operation<F>::type > (x, out, n);
+		}
+		else {
+			for(size_t i = 0; i < n; ++i) {
+				out[i] = static_cast<T>(F::apply(x[i]));
+			}
+		}
+	}
+
+	//! \brief out(i) = F(x(i), y(i)) for i in [0, n).
+	template < class F, class T >
+	BOOST_UBLAS_INLINE
+	void apply_binary (const T* x, const T* y, T* out, const size_t n) {
+		if constexpr (use_simd<F, T>()) {
+			simd::transform < typename simd_operation<F>::type > (x, y, out, n);
+		}
+		else {
+			for(size_t i = 0; i < n; ++i) {
+				out[i] = static_cast<T>(F::apply(x[i], y[i]));
+			}
+		}
+	}
+
+	//! \brief out(i) = F(x(i), val) for i in [0, n).
+	template < class F, class T, class S >
+	BOOST_UBLAS_INLINE
+	void apply_scalar (const T* x, const S& val, T* out, const size_t n) {
+		if constexpr (use_simd<F, T>()) {
+			simd::transform_scalar < typename simd_operation<F>::type > (x, static_cast<T>(val), out, n);
+		}
+		else {
+			for(size_t i = 0; i < n; ++i) {
+				out[i] = static_cast<T>(F::apply(x[i], val));
+			}
+		}
+	}
+
+	//! \brief out = -x.
+	template < class T >
+	BOOST_UBLAS_INLINE
+	void negate (const T* x, T* out, const size_t n) {
+		apply_unary < scalar_negate<T> > (x, out, n);
+	}
+
+	//! \brief out = x + y.
+	template < class T >
+	BOOST_UBLAS_INLINE
+	void plus (const T* x, const T* y, T* out, const size_t n) {
+		apply_binary < scalar_plus<T, T> > (x, y, out, n);
+	}
+
+	//! \brief out = x - y.
+	template < class T >
+	BOOST_UBLAS_INLINE
+	void minus (const T* x, const T* y, T* out, const size_t n) {
+		apply_binary < scalar_minus<T, T> > (x, y, out, n);
+	}
+
+	//! \brief out = x + val.
+	template < class T, class S >
+	BOOST_UBLAS_INLINE
+	void plus_scalar (const T* x, const S& val, T* out, const size_t n) {
+		apply_scalar < scalar_plus<T, S> > (x, val, out, n);
+	}
+
+	//! \brief out = x - val.
+	template < class T, class S >
+	BOOST_UBLAS_INLINE
+	void minus_scalar (const T* x, const S& val, T* out, const size_t n) {
+		apply_scalar < scalar_minus<T, S> > (x, val, out, n);
+	}
+
+	//! \brief out = x * val.
+	template < class T, class S >
+	BOOST_UBLAS_INLINE
+	void multiplies_scalar (const T* x, const S& val, T* out, const size_t n) {
+		apply_scalar < scalar_multiplies<T, S> > (x, val, out, n);
+	}
+
+	//! \brief out = x / val.
+	template < class T, class S >
+	BOOST_UBLAS_INLINE
+	void divides_scalar (const T* x, const S& val, T* out, const size_t n) {
+		apply_scalar < scalar_divides<T, S> > (x, val, out, n);
+	}
+
+	//! \brief out = min(x, val).
+	template < class T, class S >
+	BOOST_UBLAS_INLINE
+	void min_scalar (const T* x, const S& val, T* out, const size_t n) {
+		apply_scalar < scalar_min<T, S> > (x, val, out, n);
+	}
+
+	//! \brief out = max(x, val).
+	template < class T, class S >
+	BOOST_UBLAS_INLINE
+	void max_scalar (const T* x, const S& val, T* out, const size_t n) {
+		apply_scalar < scalar_max<T, S> > (x, val, out, n);
+	}
+
+	/*! \brief out = min(max(x, lo), hi).
+	 *  Both bounds are converted to T once, outside of the loop.
+	 */
+	template < class T, class S >
+	BOOST_UBLAS_INLINE
+	void clamp_scalar (const T* x, const S& lo, const S& hi, T* out, const size_t n) {
+		const T l = static_cast<T>(lo), h = static_cast<T>(hi);
+		for(size_t i = 0; i < n; ++i) {
+			const T v = (x[i] < l) ? l : x[i];
+			out[i] = (h < v) ? h : v;
+		}
+	}
+
+	/*! \brief Sets the bits i of out to pred(i) for i in [0, n), out holding (n + 63) / 64 words.
+	 *  Builds a word at a time, for the comparisons without vector kernel (strings ...).
+	 */
+	template < class P >
+	BOOST_UBLAS_INLINE
+	void pack_bits (const size_t n, std::uint64_t* out, P pred) {
+		for(size_t i = 0; i < n; i += 64) {
+			const size_t m = (n - i < 64) ? n - i : 64;
+			std::uint64_t w = 0;
+			for(size_t j = 0; j < m; ++j) {
+				w |= std::uint64_t (pred (i + j) ? 1 : 0) << j;
+			}
+			out[i / 64] = w;
+		}
+	}
+
+	/*! \brief Converts val to T in v, returns \c false if T can't hold val exactly.
+	 *  Comparisons of a column with a constant then run in the type of the column.
+	 */
+	template < class T, class S >
+	BOOST_UBLAS_INLINE
+	bool exact_cast (const S& val, T& v) {
+		if constexpr (std::is_same<T, S>::value) {
+			v = val;
+			return true;
+		}
+		else {
+			// long double holds every 64 bit integer exactly, NaN fails both tests
+			const long double d = val;
+			if (!(d >= (long double) std::numeric_limits<T>::lowest() && d <= (long double) std::numeric_limits<T>::max())) {
+				return false;
+			}
+			v = static_cast<T>(val);
+			return static_cast<S>(v) == val;
+		}
+	}
+
+	/*! \brief Unsigned key of the width of T, whose order is the order of T, for radix sorts.
+	 *  Signed integers flip the sign bit. Floating points (IEEE 754) flip the sign bit of the positive
+	 *  values and all the bits of the negative ones, NaN sorting after +inf.
+	 *  \c value is \c false for the types without key (long double ...).
+	 */
+	template < class T, class Enable = void >
+	struct radix_key {
+		static constexpr bool value = false;
+	};
+
+	template < class T >
+	struct radix_key < T, typename std::enable_if < std::is_integral<T>::value && !std::is_same<T, bool>::value >::type > {
+		static constexpr bool value = true;
+		typedef typename std::make_unsigned<T>::type type;
+
+		static BOOST_UBLAS_INLINE
+		type apply (const T x) {
+			return std::is_signed<T>::value ? type (type (x) ^ (type (1) << (8 * sizeof(T) - 1))) : type (x);
+		}
+	};
+
+	template <>
+	struct radix_key < bool > {
+		static constexpr bool value = true;
+		typedef std::uint8_t type;
+
+		static BOOST_UBLAS_INLINE
+		type apply (const bool x) {
+			return x;
+		}
+	};
+
+	template < class T >
+	struct radix_key < T, typename std::enable_if < std::is_floating_point<T>::value && std::numeric_limits<T>::is_iec559 && 
+		(sizeof(T) == 4 || sizeof(T) == 8) >::type > {
+		static constexpr bool value = true;
+		typedef typename std::conditional < sizeof(T) == 4, std::uint32_t, std::uint64_t >::type type;
+
+		static BOOST_UBLAS_INLINE
+		type apply (const T x) {
+			type u;
+			std::memcpy (&u, &x, sizeof(T));
+			const type sign = type (1) << (8 * sizeof(T) - 1);
+			return (u & sign) ? type (~u) : type (u | sign);
+		}
+	};
+
+	/*! \brief Sorts keys(0) ... keys(n-1), moving idx along: LSD radix sort on 8 bit digits, stable.
+	 *  The histograms of all the digits are counted in one pass over the keys,
+	 *  the digits equal for all the keys are skipped.
+	 */
+	template < class K, class I >
+	BOOST_UBLAS_INLINE
+	void radix_sort (K* keys, I* idx, const size_t n) {
+		const size_t digits = sizeof(K);
+		if (n < 2) {
+			return;
+		}
+		std::vector < size_t > count (digits * 256, 0);
+		for(size_t i = 0; i < n; ++i) {
+			const std::uint64_t k = keys[i];
+			for(size_t d = 0; d < digits; ++d) {
+				++count[d * 256 + ((k >> (8 * d)) & 255)];
+			}
+		}
+		std::vector < K > key_buffer (n);
+		std::vector < I > idx_buffer (n);
+		K* ks = keys;
+		I* is = idx;
+		K* kd = key_buffer.data();
+		I* id = idx_buffer.data();
+		for(size_t d = 0; d < digits; ++d) {
+			size_t* c = count.data() + d * 256;
+			const size_t shift = 8 * d;
+			if (c[(std::uint64_t (ks[0]) >> shift) & 255] == n) {
+				continue;
+			}
+			size_t sum = 0;
+			for(size_t b = 0; b < 256; ++b) {
+				const size_t t = c[b];
+				c[b] = sum;
+				sum += t;
+			}
+			for(size_t i = 0; i < n; ++i) {
+				const size_t pos = c[(std::uint64_t (ks[i]) >> shift) & 255]++;
+				kd[pos] = ks[i];
+				id[pos] = is[i];
+			}
+			std::swap (ks, kd);
+			std::swap (is, id);
+		}
+		if (ks != keys) {
+			std::copy (ks, ks + n, keys);
+			std::copy (is, is + n, idx);
+		}
+	}
+
+	//! \brief Mixes the hash v of a key column into the hash h of a row.
+	BOOST_UBLAS_INLINE
+	std::uint64_t hash_combine (const std::uint64_t h, const std::uint64_t v) {
+		return (h ^ v) * 0x9e3779b97f4a7c15ULL;
+	}
+
+	/*! \brief Returns the final hash of a row (finalizer of MurmurHash3).
+	 *  std::hash is the identity on integers, the finalizer spreads them over the low bits used by the tables.
+	 */
+	BOOST_UBLAS_INLINE
+	std::uint64_t hash_finalize (std::uint64_t h) {
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdULL;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53ULL;
+		h ^= h >> 33;
+		return h;
+	}
+
+}}}}
+
+#endif
@@ -0,0 +1,1328 @@
+//          Copyright(C) Rishabh Arora 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Reading of Parquet files into data_frames, decoding only the columns asked for, without a Parquet library.
+// A file is "PAR1", the row groups, its metadata (a Thrift FileMetaData, see thrift_compact.hpp), its u32
+// length and "PAR1". A row group holds a chunk of pages per column: an optional dictionary page, then data
+// pages of definition levels (0 for a null, optional columns only) and values, PLAIN, dictionary encoded
+// (indices into the dictionary page) or, for booleans, RLE. Levels, indices and RLE booleans use the
+// RLE / bit-packing hybrid encoding.
+//
+// Columns (top level, not repeated) and Parquet types:
+//   BOOLEAN              bool_column
+//   INT32                int, or char, short, unsigned char, unsigned short, unsigned int for the converted
+//                        types (or logical Int types) INT_8, INT_16, UINT_8, UINT_16, UINT_32
+//   INT64                long long, unsigned long long for UINT_64
+//   FLOAT, DOUBLE        float, double
+//   BYTE_ARRAY           string_column (large_string_column past 4 GB), dictionary_column if asked
+// The other converted types (DATE, TIMESTAMP_*, DECIMAL...) are read as their physical type. INT96,
+// FIXED_LEN_BYTE_ARRAY, nested and repeated columns terminate with unsupported_file when asked for, and
+// are left out when all the columns are read. The null rows of the strings are empty strings.
+// Pages are uncompressed, Snappy (snappy.hpp) or, with BOOST_UBLAS_DF_ZSTD defined (link with -lzstd), Zstd.
+//
+// A row group is skipped, none of its pages read, when the min / max statistics of a column show no row
+// of it can satisfy a predicate on that column. The rows of the other row groups are not filtered.
+// These are decoded in parallel, a row group per task, then their chunks are copied into the columns.
+// Only the chunks of the columns and row groups read are prefetched from the mapping (see mapped_file::prefetch()).
+
+#ifndef _BOOST_UBLAS_DF_PARQUET_
+#define _BOOST_UBLAS_DF_PARQUET_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "./df.hpp"
+#include "./mapped_file.hpp"
+#include "./snappy.hpp"
+#include "./thrift_compact.hpp"
+#ifdef BOOST_UBLAS_DF_ZSTD
+#include <zstd.h>
+#endif
+
+namespace boost { namespace numeric { namespace ublas {
+
+	//! \brief Comparison of a column with a constant, pushed down to the row groups (see parquet_options).
+	struct parquet_predicate {
+		enum comparison {
+			less,
+			less_equal,
+			equal,
+			greater_equal,
+			greater
+		};
+
+		BOOST_UBLAS_INLINE
+		parquet_predicate (const std::string& column, const comparison op, const long double value):
+			column (column),
+			op (op),
+			number (value),
+			is_text (false) {}
+
+		BOOST_UBLAS_INLINE
+		parquet_predicate (const std::string& column, const comparison op, const std::string& value):
+			column (column),
+			op (op),
+			number (0),
+			text (value),
+			is_text (true) {}
+
+		std::string column;
+		comparison op;
+		long double number;
+		std::string text;
+		bool is_text;
+	};
+
+	struct parquet_options {
+		//! \brief Names of the columns read, in this order, all the columns if empty.
+		std::vector < std::string > columns;
+		/*! \brief Predicates on the columns (read or not) all the rows of interest satisfy.
+		 *  Only whole row groups are skipped, the rows read are not filtered.
+		 */
+		std::vector < parquet_predicate > predicates;
+		//! \brief \c true to read the strings as dictionary_columns.
+		bool dictionary_strings = false;
+		//! \brief Number of threads, 0 for std::thread::hardware_concurrency().
+		size_t threads = 0;
+	};
+
+	//! \brief Physical types of the Parquet columns (enum Type of parquet.thrift).
+	enum class parquet_type {
+		boolean = 0,
+		int32 = 1,
+		int64 = 2,
+		int96 = 3,
+		float32 = 4,
+		float64 = 5,
+		byte_array = 6,
+		fixed_len_byte_array = 7
+	};
+
+	/*! \brief Decodes n values of bit_width bits of the RLE / bit-packing hybrid encoding in the size bytes at p.
+	 *  A run is a varint header, then a value of (bit_width + 7) / 8 bytes repeated header / 2 times if the
+	 *  header is even, else header / 2 groups of 8 values bit-packed from the least significant bit.
+	 */
+	BOOST_UBLAS_INLINE
+	void parquet_rle_decode (const char* p, const size_t size, const unsigned bit_width, std::uint32_t* out, const size_t n) {
+		if (bit_width > 32) {
+			throw corrupt_file();
+		}
+		const size_t bytes = (bit_width + 7) / 8;
+		const std::uint64_t mask = (std::uint64_t (1) << bit_width) - 1;
+		size_t pos = 0;
+		size_t i = 0;
+		while (i < n) {
+			thrift_reader r (p + pos, size - pos);
+			const std::uint64_t header = r.read_varint();
+			const size_t at = pos + r.position();
+			const std::uint64_t count = header >> 1;
+			if (count == 0) {
+				throw corrupt_file();
+			}
+			size_t length = bytes;
+			if (header & 1) {
+				if (count > size) {
+					throw corrupt_file();
+				}
+				length = size_t (count) * bit_width;
+				if (length > size - at) {
+					throw corrupt_file();
+				}
+				const size_t m = std::min < size_t > (count * 8, n - i);
+				for(size_t j = 0; j < m; ++j) {
+					const size_t bit = j * bit_width;
+					std::uint64_t w = 0;
+					std::memcpy (&w, p + at + bit / 8, std::min < size_t > (sizeof(w), length - bit / 8));
+					out[i + j] = std::uint32_t ((w >> (bit % 8)) & mask);
+				}
+				i += m;
+			}
+			else {
+				if (length > size - at) {
+					throw corrupt_file();
+				}
+				std::uint32_t v = 0;
+				std::memcpy (&v, p + at, length);
+				if (v > mask) {
+					throw corrupt_file();
+				}
+				const size_t m = std::min < size_t > (count, n - i);
+				std::fill (out + i, out + i + m, v);
+				i += m;
+			}
+			pos = at + length;
+		}
+	}
+
+	/*! \brief Decoder of the values of a chunk of numbers T, stored as S (std::int32_t, std::int64_t, float or double).
+	 *  Every decoder is given the values of a page with the rows they go to, the rows of the nulls left out.
+	 */
+	template < class T, class S >
+	class parquet_numbers {
+	public:
+		BOOST_UBLAS_INLINE
+		explicit parquet_numbers (T* out):
+			out_ (out) {}
+
+		BOOST_UBLAS_INLINE
+		void dictionary (const char* p, const size_t size, const size_t n) {
+			if (n > size / sizeof(S)) {
+				throw corrupt_file();
+			}
+			dictionary_.resize (n);
+			for(size_t i = 0; i < n; ++i) {
+				dictionary_[i] = T (load (p + i * sizeof(S)));
+			}
+		}
+
+		BOOST_UBLAS_INLINE
+		void plain (const char* p, const size_t size, const std::vector < size_t >& rows) {
+			if (rows.size() > size / sizeof(S)) {
+				throw corrupt_file();
+			}
+			if (rows.empty()) {
+				return;
+			}
+			if (sizeof(T) == sizeof(S) && std::is_integral<T>::value == std::is_integral<S>::value && rows.back() - rows.front() + 1 == rows.size()) {
+				std::memcpy (out_ + rows.front(), p, rows.size() * sizeof(T));
+				return;
+			}
+			for(size_t k = 0; k < rows.size(); ++k) {
+				out_[rows[k]] = T (load (p + k * sizeof(S)));
+			}
+		}
+
+		BOOST_UBLAS_INLINE
+		void indices (const std::uint32_t* codes, const std::vector < size_t >& rows) {
+			for(size_t k = 0; k < rows.size(); ++k) {
+				if (codes[k] >= dictionary_.size()) {
+					throw corrupt_file();
+				}
+				out_[rows[k]] = dictionary_[codes[k]];
+			}
+		}
+
+		BOOST_UBLAS_INLINE
+		void rle (const char*, const size_t, const std::vector < size_t >&) {
+			throw unsupported_file();
+		}
+
+	private:
+		T* out_;
+		std::vector < T > dictionary_;
+
+		BOOST_UBLAS_INLINE
+		static S load (const char* p) {
+			S x;
+			std::memcpy (&x, p, sizeof(S));
+			return x;
+		}
+	};
+
+	//! \brief Decoder of the values of a chunk of booleans, see parquet_numbers.
+	class parquet_booleans {
+	public:
+		BOOST_UBLAS_INLINE
+		explicit parquet_booleans (bitmap& out):
+			out_ (&out) {}
+
+		BOOST_UBLAS_INLINE
+		void dictionary (const char*, const size_t, const size_t) {
+			throw unsupported_file();
+		}
+
+		//! \brief Sets the rows from the bits packed from the least significant one.
+		BOOST_UBLAS_INLINE
+		void plain (const char* p, const size_t size, const std::vector < size_t >& rows) {
+			if ((rows.size() + 7) / 8 > size) {
+				throw corrupt_file();
+			}
+			for(size_t k = 0; k < rows.size(); ++k) {
+				out_->set (rows[k], (p[k / 8] >> (k % 8)) & 1);
+			}
+		}
+
+		BOOST_UBLAS_INLINE
+		void indices (const std::uint32_t*, const std::vector < size_t >&) {
+			throw unsupported_file();
+		}
+
+		//! \brief Sets the rows from the u32 length prefixed RLE / bit-packing hybrid runs of bit width 1.
+		BOOST_UBLAS_INLINE
+		void rle (const char* p, const size_t size, const std::vector < size_t >& rows) {
+			std::uint32_t length;
+			if (size < sizeof(length)) {
+				throw corrupt_file();
+			}
+			std::memcpy (&length, p, sizeof(length));
+			if (length > size - sizeof(length)) {
+				throw corrupt_file();
+			}
+			values_.resize (rows.size());
+			parquet_rle_decode (p + sizeof(length), length, 1, values_.data(), rows.size());
+			for(size_t k = 0; k < rows.size(); ++k) {
+				out_->set (rows[k], values_[k] != 0);
+			}
+		}
+
+	private:
+		bitmap* out_;
+		std::vector < std::uint32_t > values_;
+	};
+
+	//! \brief Decoder of the values of a chunk of strings, appended in order, see parquet_numbers.
+	class parquet_strings {
+	public:
+		BOOST_UBLAS_INLINE
+		explicit parquet_strings (string_column& out):
+			out_ (&out),
+			next_ (0) {}
+
+		//! \brief Copies the n strings of the dictionary page, its buffer being reused by the data pages.
+		BOOST_UBLAS_INLINE
+		void dictionary (const char* p, const size_t size, const size_t n) {
+			dictionary_.clear();
+			size_t pos = 0;
+			for(size_t i = 0; i < n; ++i) {
+				dictionary_.push_back (value (p, size, pos));
+			}
+		}
+
+		//! \brief Appends the u32 length prefixed strings.
+		BOOST_UBLAS_INLINE
+		void plain (const char* p, const size_t size, const std::vector < size_t >& rows) {
+			size_t pos = 0;
+			for(size_t k = 0; k < rows.size(); ++k) {
+				fill (rows[k]);
+				out_->push_back (value (p, size, pos));
+				++next_;
+			}
+		}
+
+		BOOST_UBLAS_INLINE
+		void indices (const std::uint32_t* codes, const std::vector < size_t >& rows) {
+			for(size_t k = 0; k < rows.size(); ++k) {
+				if (codes[k] >= dictionary_.size()) {
+					throw corrupt_file();
+				}
+				fill (rows[k]);
+				out_->push_back (dictionary_(codes[k]));
+				++next_;
+			}
+		}
+
+		BOOST_UBLAS_INLINE
+		void rle (const char*, const size_t, const std::vector < size_t >&) {
+			throw unsupported_file();
+		}
+
+		//! \brief Appends empty strings up to row n, the null rows.
+		BOOST_UBLAS_INLINE
+		void fill (const size_t n) {
+			for(; next_ < n; ++next_) {
+				out_->push_back (std::string_view());
+			}
+		}
+
+	private:
+		string_column* out_;
+		string_column dictionary_;
+		size_t next_;
+
+		BOOST_UBLAS_INLINE
+		static std::string_view value (const char* p, const size_t size, size_t& pos) {
+			std::uint32_t length;
+			if (size - pos < sizeof(length)) {
+				throw corrupt_file();
+			}
+			std::memcpy (&length, p + pos, sizeof(length));
+			pos += sizeof(length);
+			if (length > size - pos) {
+				throw corrupt_file();
+			}
+			pos += length;
+			return std::string_view (p + pos - length, length);
+		}
+	};
+
+	//! \brief Reader of a Parquet file, see the top of df_parquet.hpp.
+	class parquet_reader {
+	public:
+		BOOST_UBLAS_INLINE
+		parquet_reader (const std::string& path, const parquet_options& options):
+			file_ (path),
+			data_ (file_.data()),
+			size_ (file_.size()),
+			options_ (options) {}
+
+		BOOST_UBLAS_INLINE
+		data_frame read () {
+			try {
+				read_metadata();
+				read_schema();
+				project();
+				select_row_groups();
+				prefetch();
+				decode();
+				return assemble();
+			}
+			catch (std::exception& e) {
+				std::terminate();
+			}
+		}
+
+	private:
+		//! \brief Encodings of the pages (enum Encoding of parquet.thrift).
+		enum encoding {
+			plain = 0,
+			plain_dictionary = 2,
+			rle = 3,
+			rle_dictionary = 8
+		};
+
+		//! \brief Types of the pages (enum PageType of parquet.thrift).
+		enum page_type {
+			data_page = 0,
+			dictionary_page = 2,
+			data_page_v2 = 3
+		};
+
+		//! \brief Compressions of the pages (enum CompressionCodec of parquet.thrift).
+		enum codec {
+			uncompressed = 0,
+			snappy = 1,
+			zstd = 6
+		};
+
+		//! \brief Element of the flattened schema tree, its root first, then the children of each node.
+		struct schema_element {
+			std::string name;
+			int type = -1;
+			int repetition = 0;
+			std::int64_t children = 0;
+			int converted = -1;
+			int bit_width = 0;
+			bool is_signed = true;
+		};
+
+		//! \brief Top level field of the schema.
+		struct field_info {
+			std::string name;
+			//! \brief Index of its column chunk in the row groups.
+			size_t leaf;
+			parquet_type type;
+			bool optional;
+			//! \brief \c false if nested, repeated or of an unsupported type.
+			bool supported;
+			//! \brief Bit width of the integers.
+			int bit_width;
+			bool is_signed;
+		};
+
+		struct statistics_info {
+			std::string min;
+			std::string max;
+			bool has_min = false;
+			bool has_max = false;
+			//! \brief \c true for the deprecated min and max.
+			bool legacy_min = false;
+			bool legacy_max = false;
+			std::int64_t null_count = -1;
+		};
+
+		//! \brief ColumnMetaData of a column chunk.
+		struct chunk_info {
+			int type = -1;
+			int codec = 0;
+			std::int64_t compressed_size = -1;
+			std::int64_t data_page_offset = -1;
+			std::int64_t dictionary_page_offset = -1;
+			statistics_info statistics;
+		};
+
+		struct row_group_info {
+			std::vector < chunk_info > chunks;
+			std::int64_t rows = -1;
+		};
+
+		struct page_header {
+			int type = -1;
+			std::int64_t uncompressed_size = -1;
+			std::int64_t compressed_size = -1;
+			std::int64_t values = -1;
+			int encoding = plain;
+			int level_encoding = rle;
+			std::int64_t level_length = 0;
+			std::int64_t repetition_length = 0;
+			bool compressed = true;
+		};
+
+		//! \brief Decoded column chunk: its numbers, booleans or strings, and its validity if it has nulls.
+		struct column_chunk {
+			std::vector < char > values;
+			bitmap bits;
+			string_column strings;
+			bitmap validity;
+			size_t nulls = 0;
+		};
+
+		mapped_file file_;
+		const char* data_;
+		size_t size_;
+		parquet_options options_;
+		std::vector < schema_element > schema_;
+		std::vector < field_info > fields_;
+		std::vector < row_group_info > row_groups_;
+		//! \brief Fields read, indices into fields_.
+		std::vector < size_t > columns_;
+		//! \brief Row groups read, indices into row_groups_.
+		std::vector < size_t > groups_;
+		//! \brief Chunks of the row groups read, by row group then column.
+		std::vector < std::vector < column_chunk > > chunks_;
+
+		BOOST_UBLAS_INLINE
+		static bool integer (const int type) {
+			return type == thrift_reader::byte || type == thrift_reader::i16 || type == thrift_reader::i32 || type == thrift_reader::i64;
+		}
+
+		BOOST_UBLAS_INLINE
+		static bool boolean (const int type) {
+			return type == thrift_reader::boolean_true || type == thrift_reader::boolean_false;
+		}
+
+		//! \brief Reads the FileMetaData: the schema (field 2), the number of rows (3) and the row groups (4).
+		BOOST_UBLAS_INLINE
+		void read_metadata () {
+			std::uint32_t length;
+			if (size_ < 12 || std::memcmp (data_, "PAR1", 4) != 0 || std::memcmp (data_ + size_ - 4, "PAR1", 4) != 0) {
+				throw corrupt_file();
+			}
+			std::memcpy (&length, data_ + size_ - 8, sizeof(length));
+			if (length > size_ - 12) {
+				throw corrupt_file();
+			}
+			thrift_reader r (data_ + size_ - 8 - length, length);
+			r.read_struct ([this, &r] (const std::int64_t id, const int type) {
+				if ((id != 2 && id != 4) || type != thrift_reader::list) {
+					return false;
+				}
+				int element;
+				const size_t n = r.read_list (element);
+				if (element != thrift_reader::structure) {
+					throw corrupt_file();
+				}
+				for(size_t i = 0; i < n; ++i) {
+					if (id == 2) {
+						schema_.push_back (read_schema_element (r));
+					}
+					else {
+						row_groups_.push_back (read_row_group (r));
+					}
+				}
+				return true;
+			});
+		}
+
+		BOOST_UBLAS_INLINE
+		static schema_element read_schema_element (thrift_reader& r) {
+			schema_element e;
+			r.read_struct ([&e, &r] (const std::int64_t id, const int type) {
+				if (id == 4 && type == thrift_reader::binary) {
+					e.name = std::string (r.read_binary());
+					return true;
+				}
+				if (id == 10 && type == thrift_reader::structure) {
+					// LogicalType, the union member 10 being IntType {1: i8 bitWidth, 2: bool isSigned}
+					r.read_struct ([&e, &r] (const std::int64_t member, const int t) {
+						if (member != 10 || t != thrift_reader::structure) {
+							return false;
+						}
+						r.read_struct ([&e, &r] (const std::int64_t f, const int u) {
+							if (f == 1 && integer (u)) {
+								e.bit_width = int (r.read_integer (u));
+								return true;
+							}
+							if (f == 2 && boolean (u)) {
+								e.is_signed = thrift_reader::value (u);
+								return true;
+							}
+							return false;
+						});
+						return true;
+					});
+					return true;
+				}
+				if (!integer (type)) {
+					return false;
+				}
+				switch (id) {
+					case 1: e.type = int (r.read_integer (type)); return true;
+					case 3: e.repetition = int (r.read_integer (type)); return true;
+					case 5: e.children = r.read_integer (type); return true;
+					case 6: e.converted = int (r.read_integer (type)); return true;
+				}
+				return false;
+			});
+			return e;
+		}
+
+		//! \brief Reads a RowGroup: its column chunks (field 1) and number of rows (3).
+		BOOST_UBLAS_INLINE
+		static row_group_info read_row_group (thrift_reader& r) {
+			row_group_info g;
+			r.read_struct ([&g, &r] (const std::int64_t id, const int type) {
+				if (id == 3 && integer (type)) {
+					g.rows = r.read_integer (type);
+					return true;
+				}
+				if (id != 1 || type != thrift_reader::list) {
+					return false;
+				}
+				int element;
+				const size_t n = r.read_list (element);
+				if (element != thrift_reader::structure) {
+					throw corrupt_file();
+				}
+				for(size_t i = 0; i < n; ++i) {
+					g.chunks.push_back (read_column_chunk (r));
+				}
+				return true;
+			});
+			if (g.rows < 0) {
+				throw corrupt_file();
+			}
+			return g;
+		}
+
+		//! \brief Reads the ColumnMetaData (field 3) of a ColumnChunk, one stored in another file (1) being unsupported.
+		BOOST_UBLAS_INLINE
+		static chunk_info read_column_chunk (thrift_reader& r) {
+			chunk_info c;
+			r.read_struct ([&c, &r] (const std::int64_t id, const int type) {
+				if (id == 1 && type == thrift_reader::binary) {
+					throw unsupported_file();
+				}
+				if (id != 3 || type != thrift_reader::structure) {
+					return false;
+				}
+				r.read_struct ([&c, &r] (const std::int64_t f, const int t) {
+					if (f == 12 && t == thrift_reader::structure) {
+						c.statistics = read_statistics (r);
+						return true;
+					}
+					if (!integer (t)) {
+						return false;
+					}
+					switch (f) {
+						case 1: c.type = int (r.read_integer (t)); return true;
+						case 4: c.codec = int (r.read_integer (t)); return true;
+						case 7: c.compressed_size = r.read_integer (t); return true;
+						case 9: c.data_page_offset = r.read_integer (t); return true;
+						case 11: c.dictionary_page_offset = r.read_integer (t); return true;
+					}
+					return false;
+				});
+				return true;
+			});
+			return c;
+		}
+
+		/*! \brief Reads the Statistics of a column chunk.
+		 *  The min_value (6) and max_value (5) are taken over the deprecated min (2) and max (1), ordered as
+		 *  signed numbers, see may_match().
+		 */
+		BOOST_UBLAS_INLINE
+		static statistics_info read_statistics (thrift_reader& r) {
+			statistics_info s;
+			r.read_struct ([&s, &r] (const std::int64_t id, const int type) {
+				if (id == 3 && integer (type)) {
+					s.null_count = r.read_integer (type);
+					return true;
+				}
+				if (type != thrift_reader::binary) {
+					return false;
+				}
+				const std::string_view x = r.read_binary();
+				if (id == 6 || (id == 2 && !s.has_min)) {
+					s.min = std::string (x);
+					s.has_min = true;
+					s.legacy_min = id == 2;
+				}
+				if (id == 5 || (id == 1 && !s.has_max)) {
+					s.max = std::string (x);
+					s.has_max = true;
+					s.legacy_max = id == 1;
+				}
+				return true;
+			});
+			return s;
+		}
+
+		//! \brief Reads a PageHeader, with its DataPageHeader (5), DictionaryPageHeader (7) or DataPageHeaderV2 (8).
+		BOOST_UBLAS_INLINE
+		static page_header read_page_header (thrift_reader& r) {
+			page_header h;
+			r.read_struct ([&h, &r] (const std::int64_t id, const int type) {
+				if (integer (type)) {
+					switch (id) {
+						case 1: h.type = int (r.read_integer (type)); return true;
+						case 2: h.uncompressed_size = r.read_integer (type); return true;
+						case 3: h.compressed_size = r.read_integer (type); return true;
+					}
+					return false;
+				}
+				if (type != thrift_reader::structure || (id != 5 && id != 7 && id != 8)) {
+					return false;
+				}
+				r.read_struct ([&h, &r, id] (const std::int64_t f, const int t) {
+					if (id == 8 && f == 7 && boolean (t)) {
+						h.compressed = thrift_reader::value (t);
+						return true;
+					}
+					if (!integer (t)) {
+						return false;
+					}
+					if (f == 1) {
+						h.values = r.read_integer (t);
+					}
+					else if ((f == 2 && id != 8) || (f == 4 && id == 8)) {
+						h.encoding = int (r.read_integer (t));
+					}
+					else if (f == 3 && id == 5) {
+						h.level_encoding = int (r.read_integer (t));
+					}
+					else if (f == 5 && id == 8) {
+						h.level_length = r.read_integer (t);
+					}
+					else if (f == 6 && id == 8) {
+						h.repetition_length = r.read_integer (t);
+					}
+					else {
+						return false;
+					}
+					return true;
+				});
+				return true;
+			});
+			return h;
+		}
+
+		//! \brief Returns the number of leaves of the schema subtree at i, moving i past it.
+		BOOST_UBLAS_INLINE
+		size_t leaves (size_t& i, const size_t depth) const {
+			if (i >= schema_.size() || depth > thrift_reader::max_depth) {
+				throw corrupt_file();
+			}
+			const std::int64_t children = schema_[i++].children;
+			if (children <= 0) {
+				return 1;
+			}
+			size_t n = 0;
+			for(std::int64_t c = 0; c < children; ++c) {
+				n += leaves (i, depth + 1);
+			}
+			return n;
+		}
+
+		//! \brief Builds the top level fields from the schema, checking the row groups have a chunk per leaf.
+		BOOST_UBLAS_INLINE
+		void read_schema () {
+			if (schema_.empty()) {
+				throw corrupt_file();
+			}
+			size_t i = 1;
+			size_t leaf = 0;
+			for(std::int64_t c = 0; c < schema_[0].children; ++c) {
+				if (i >= schema_.size()) {
+					throw corrupt_file();
+				}
+				const schema_element& e = schema_[i];
+				field_info f;
+				f.name = e.name;
+				f.leaf = leaf;
+				f.type = parquet_type (e.type);
+				f.optional = e.repetition == 1;
+				f.bit_width = f.type == parquet_type::int64 ? 64 : 32;
+				f.is_signed = true;
+				// converted types UINT_8, UINT_16, UINT_32, UINT_64, INT_8, INT_16
+				switch (e.converted) {
+					case 11: f.bit_width = 8; f.is_signed = false; break;
+					case 12: f.bit_width = 16; f.is_signed = false; break;
+					case 13: f.bit_width = 32; f.is_signed = false; break;
+					case 14: f.bit_width = 64; f.is_signed = false; break;
+					case 15: f.bit_width = 8; break;
+					case 16: f.bit_width = 16; break;
+				}
+				if (e.bit_width != 0) {
+					f.bit_width = e.bit_width;
+					f.is_signed = e.is_signed;
+				}
+				f.supported = e.children <= 0 && e.repetition != 2;
+				switch (f.type) {
+					case parquet_type::boolean:
+					case parquet_type::float32:
+					case parquet_type::float64:
+					case parquet_type::byte_array:
+						break;
+					case parquet_type::int32:
+						f.supported = f.supported && (f.bit_width == 8 || f.bit_width == 16 || f.bit_width == 32);
+						break;
+					case parquet_type::int64:
+						f.supported = f.supported && f.bit_width == 64;
+						break;
+					default:
+						f.supported = false;
+				}
+				leaf += leaves (i, 0);
+				fields_.push_back (f);
+			}
+			for(const row_group_info& g : row_groups_) {
+				if (g.chunks.size() != leaf) {
+					throw corrupt_file();
+				}
+			}
+		}
+
+		//! \brief Returns the index of the field name, terminates with undefined_column_header if there is none.
+		BOOST_UBLAS_INLINE
+		size_t field (const std::string& name) const {
+			for(size_t k = 0; k < fields_.size(); ++k) {
+				if (fields_[k].name == name) {
+					return k;
+				}
+			}
+			throw undefined_column_header();
+		}
+
+		BOOST_UBLAS_INLINE
+		void project () {
+			if (options_.columns.empty()) {
+				for(size_t k = 0; k < fields_.size(); ++k) {
+					if (fields_[k].supported) {
+						columns_.push_back (k);
+					}
+				}
+				return;
+			}
+			for(const std::string& name : options_.columns) {
+				const size_t k = field (name);
+				if (!fields_[k].supported) {
+					throw unsupported_file();
+				}
+				columns_.push_back (k);
+			}
+		}
+
+		BOOST_UBLAS_INLINE
+		void select_row_groups () {
+			std::vector < size_t > predicated;
+			for(const parquet_predicate& p : options_.predicates) {
+				predicated.push_back (field (p.column));
+			}
+			for(size_t g = 0; g < row_groups_.size(); ++g) {
+				bool keep = true;
+				for(size_t i = 0; keep && i < predicated.size(); ++i) {
+					const field_info& f = fields_[predicated[i]];
+					keep = may_match (options_.predicates[i], f, row_groups_[g].chunks[f.leaf].statistics, row_groups_[g].rows);
+				}
+				if (keep) {
+					groups_.push_back (g);
+				}
+			}
+		}
+
+		//! \brief Asks for the chunks of the columns and row groups read to be prefetched, and for them only.
+		BOOST_UBLAS_INLINE
+		void prefetch () const {
+			for(const size_t g : groups_) {
+				for(const size_t k : columns_) {
+					const chunk_info& c = row_groups_[g].chunks[fields_[k].leaf];
+					const std::int64_t start = chunk_start (c);
+					if (start >= 0 && c.compressed_size > 0) {
+						file_.prefetch (size_t (start), size_t (c.compressed_size));
+					}
+				}
+			}
+		}
+
+		//! \brief Returns the offset of the first page of the chunk c, its dictionary page if it has one.
+		BOOST_UBLAS_INLINE
+		static std::int64_t chunk_start (const chunk_info& c) {
+			if (c.dictionary_page_offset > 0 && c.dictionary_page_offset < c.data_page_offset) {
+				return c.dictionary_page_offset;
+			}
+			return c.data_page_offset;
+		}
+
+		/*! \brief Returns \c false if the statistics of a chunk of the field f show none of its rows satisfies p.
+		 *  A chunk of nulls only satisfies no predicate. The deprecated min and max, ordered as signed numbers,
+		 *  are ignored for the unsigned integers and the strings, a NaN or a constant of another type keeps the chunk.
+		 */
+		BOOST_UBLAS_INLINE
+		static bool may_match (const parquet_predicate& p, const field_info& f, const statistics_info& s, const std::int64_t rows) {
+			if (s.null_count == rows) {
+				return false;
+			}
+			const bool legacy = f.type != parquet_type::byte_array && f.is_signed;
+			if (!f.supported || !s.has_min || !s.has_max || ((s.legacy_min || s.legacy_max) && !legacy)) {
+				return true;
+			}
+			// signs of min - p and max - p
+			int below;
+			int above;
+			if (p.is_text) {
+				if (f.type != parquet_type::byte_array) {
+					return true;
+				}
+				below = s.min.compare (p.text);
+				above = s.max.compare (p.text);
+			}
+			else {
+				long double min;
+				long double max;
+				if (!number (f, s.min, min) || !number (f, s.max, max) || p.number != p.number) {
+					return true;
+				}
+				below = (min > p.number) - (min < p.number);
+				above = (max > p.number) - (max < p.number);
+			}
+			switch (p.op) {
+				case parquet_predicate::less: return below < 0;
+				case parquet_predicate::less_equal: return below <= 0;
+				case parquet_predicate::equal: return below <= 0 && above >= 0;
+				case parquet_predicate::greater_equal: return above >= 0;
+				case parquet_predicate::greater: return above > 0;
+			}
+			return true;
+		}
+
+		//! \brief Reads the statistic s of a numeric field into x, returns \c false if it can't (or is a NaN).
+		BOOST_UBLAS_INLINE
+		static bool number (const field_info& f, const std::string& s, long double& x) {
+			switch (f.type) {
+				case parquet_type::boolean:
+					if (s.size() < 1) {
+						return false;
+					}
+					x = s[0] != 0;
+					return true;
+				case parquet_type::int32:
+					if (s.size() < 4) {
+						return false;
+					}
+					x = f.is_signed ? static_cast<long double> (load < std::int32_t > (s.data())) : static_cast<long double> (load < std::uint32_t > (s.data()));
+					return true;
+				case parquet_type::int64:
+					if (s.size() < 8) {
+						return false;
+					}
+					x = f.is_signed ? static_cast<long double> (load < std::int64_t > (s.data())) : static_cast<long double> (load < std::uint64_t > (s.data()));
+					return true;
+				case parquet_type::float32:
+					if (s.size() < 4) {
+						return false;
+					}
+					x = load < float > (s.data());
+					return x == x;
+				case parquet_type::float64:
+					if (s.size() < 8) {
+						return false;
+					}
+					x = load < double > (s.data());
+					return x == x;
+				default:
+					return false;
+			}
+		}
+
+		template < class T >
+		BOOST_UBLAS_INLINE
+		static T load (const char* p) {
+			T x;
+			std::memcpy (&x, p, sizeof(T));
+			return x;
+		}
+
+		//! \brief Calls fn (T(), S()) for the type T of the numbers of the field f, stored as S.
+		template < class F >
+		BOOST_UBLAS_INLINE
+		static void numbers (const field_info& f, F fn) {
+			switch (f.type) {
+				case parquet_type::int32:
+					switch (f.bit_width) {
+						case 8: return f.is_signed ? fn (char(), std::int32_t()) : fn ((unsigned char)(0), std::int32_t());
+						case 16: return f.is_signed ? fn (short(), std::int32_t()) : fn ((unsigned short)(0), std::int32_t());
+					}
+					return f.is_signed ? fn (int(), std::int32_t()) : fn ((unsigned int)(0), std::int32_t());
+				case parquet_type::int64:
+					return f.is_signed ? fn ((long long)(0), std::int64_t()) : fn ((unsigned long long)(0), std::int64_t());
+				case parquet_type::float32:
+					return fn (float(), float());
+				default:
+					return fn (double(), double());
+			}
+		}
+
+		//! \brief Returns the number of rows of the row groups read.
+		BOOST_UBLAS_INLINE
+		size_t rows () const {
+			size_t n = 0;
+			for(const size_t g : groups_) {
+				n += size_t (row_groups_[g].rows);
+			}
+			return n;
+		}
+
+		//! \brief Decodes the chunks of the row groups read, a block of row groups per thread.
+		BOOST_UBLAS_INLINE
+		void decode () {
+			chunks_.assign (groups_.size(), std::vector < column_chunk > (columns_.size()));
+			if (groups_.empty()) {
+				return;
+			}
+			const size_t threads = std::min (worker_threads (rows(), options_.threads), groups_.size());
+			parallel_blocks (groups_.size(), threads, [this] (size_t, const size_t first, const size_t last) {
+				try {
+					std::vector < char > buffer;
+					for(size_t g = first; g < last; ++g) {
+						for(size_t k = 0; k < columns_.size(); ++k) {
+							decode_chunk (g, k, buffer);
+						}
+					}
+				}
+				catch (std::exception& e) {
+					std::terminate();
+				}
+			});
+		}
+
+		//! \brief Decodes the chunk of column k in row group g, buffer holding the uncompressed pages.
+		BOOST_UBLAS_INLINE
+		void decode_chunk (const size_t g, const size_t k, std::vector < char >& buffer) {
+			const field_info& f = fields_[columns_[k]];
+			const row_group_info& group = row_groups_[groups_[g]];
+			const chunk_info& c = group.chunks[f.leaf];
+			column_chunk& out = chunks_[g][k];
+			const size_t n = size_t (group.rows);
+			if (c.type != int (f.type)) {
+				throw corrupt_file();
+			}
+			if (f.optional) {
+				out.validity = bitmap (n, true);
+			}
+			switch (f.type) {
+				case parquet_type::boolean: {
+					out.bits = bitmap (n);
+					parquet_booleans d (out.bits);
+					pages (f, c, n, d, out, buffer);
+					break;
+				}
+				case parquet_type::byte_array: {
+					parquet_strings d (out.strings);
+					pages (f, c, n, d, out, buffer);
+					d.fill (n);
+					break;
+				}
+				default:
+					numbers (f, [&] (auto t, auto s) {
+						typedef decltype(t) T;
+						typedef decltype(s) S;
+						out.values.assign (n * sizeof(T), 0);
+						parquet_numbers < T, S > d (reinterpret_cast<T*> (out.values.data()));
+						pages (f, c, n, d, out, buffer);
+					});
+			}
+		}
+
+		//! \brief Decodes the pages of the chunk c, of n rows, into the decoder d and the validity of out.
+		template < class D >
+		BOOST_UBLAS_INLINE
+		void pages (const field_info& f, const chunk_info& c, const size_t n, D& d, column_chunk& out, std::vector < char >& buffer) const {
+			const std::int64_t start = chunk_start (c);
+			if (start < 4 || c.compressed_size < 0 || std::uint64_t (start) > size_ || std::uint64_t (c.compressed_size) > size_ - start) {
+				throw corrupt_file();
+			}
+			size_t pos = size_t (start);
+			const size_t end = pos + size_t (c.compressed_size);
+			std::vector < std::uint32_t > levels;
+			std::vector < std::uint32_t > codes;
+			std::vector < size_t > at;
+			size_t row = 0;
+			while (row < n) {
+				if (pos >= end) {
+					throw corrupt_file();
+				}
+				thrift_reader r (data_ + pos, end - pos);
+				const page_header h = read_page_header (r);
+				pos += r.position();
+				if (h.compressed_size < 0 || h.uncompressed_size < 0 || std::uint64_t (h.compressed_size) > end - pos) {
+					throw corrupt_file();
+				}
+				const char* page = data_ + pos;
+				const size_t length = size_t (h.compressed_size);
+				pos += length;
+				if (h.type == dictionary_page) {
+					if ((h.encoding != plain && h.encoding != plain_dictionary) || h.values < 0) {
+						throw unsupported_file();
+					}
+					d.dictionary (uncompress (c.codec, page, length, size_t (h.uncompressed_size), buffer), size_t (h.uncompressed_size), size_t (h.values));
+					continue;
+				}
+				if (h.type != data_page && h.type != data_page_v2) {
+					continue;
+				}
+				if (h.values < 0 || std::uint64_t (h.values) > n - row) {
+					throw corrupt_file();
+				}
+				const size_t values = size_t (h.values);
+				const char* p;
+				size_t size;
+				const char* definitions = 0;
+				size_t definitions_size = 0;
+				if (h.type == data_page) {
+					size = size_t (h.uncompressed_size);
+					p = uncompress (c.codec, page, length, size, buffer);
+					if (f.optional) {
+						// u32 length prefixed definition levels
+						std::uint32_t l;
+						if (h.level_encoding != rle) {
+							throw unsupported_file();
+						}
+						if (size < sizeof(l)) {
+							throw corrupt_file();
+						}
+						std::memcpy (&l, p, sizeof(l));
+						if (l > size - sizeof(l)) {
+							throw corrupt_file();
+						}
+						definitions = p + sizeof(l);
+						definitions_size = l;
+						p += sizeof(l) + l;
+						size -= sizeof(l) + l;
+					}
+				}
+				else {
+					// the levels come first, never compressed
+					if (h.repetition_length != 0 || h.level_length < 0 || h.level_length > h.compressed_size || h.level_length > h.uncompressed_size) {
+						throw corrupt_file();
+					}
+					const size_t skip = size_t (h.level_length);
+					definitions = page;
+					definitions_size = skip;
+					size = size_t (h.uncompressed_size) - skip;
+					if (h.compressed) {
+						p = uncompress (c.codec, page + skip, length - skip, size, buffer);
+					}
+					else if (length - skip == size) {
+						p = page + skip;
+					}
+					else {
+						throw corrupt_file();
+					}
+				}
+				at.clear();
+				if (f.optional) {
+					levels.resize (values);
+					parquet_rle_decode (definitions, definitions_size, 1, levels.data(), values);
+					for(size_t i = 0; i < values; ++i) {
+						if (levels[i] != 0) {
+							at.push_back (row + i);
+						}
+						else {
+							out.validity.set (row + i, false);
+							++out.nulls;
+						}
+					}
+				}
+				else {
+					for(size_t i = 0; i < values; ++i) {
+						at.push_back (row + i);
+					}
+				}
+				decode_values (h.encoding, p, size, at, d, codes);
+				row += values;
+			}
+		}
+
+		//! \brief Decodes the values of a page, of the given encoding, into the rows at.
+		template < class D >
+		BOOST_UBLAS_INLINE
+		static void decode_values (const int encoding, const char* p, const size_t size, const std::vector < size_t >& at, D& d, std::vector < std::uint32_t >& codes) {
+			switch (encoding) {
+				case plain:
+					d.plain (p, size, at);
+					return;
+				case plain_dictionary:
+				case rle_dictionary:
+					// the bit width of the indices, then their runs
+					if (at.empty()) {
+						return;
+					}
+					if (size < 1) {
+						throw corrupt_file();
+					}
+					codes.resize (at.size());
+					parquet_rle_decode (p + 1, size - 1, static_cast<std::uint8_t> (p[0]), codes.data(), at.size());
+					d.indices (codes.data(), at);
+					return;
+				case rle:
+					d.rle (p, size, at);
+					return;
+			}
+			throw unsupported_file();
+		}
+
+		//! \brief Returns the n bytes at p uncompressed into size bytes, in buffer unless they are not compressed.
+		BOOST_UBLAS_INLINE
+		static const char* uncompress (const int compression, const char* p, const size_t n, const size_t size, std::vector < char >& buffer) {
+			switch (compression) {
+				case uncompressed:
+					if (n != size) {
+						throw corrupt_file();
+					}
+					return p;
+				case snappy:
+					buffer.resize (size);
+					snappy_uncompress (p, n, buffer.data(), size);
+					return buffer.data();
+				case zstd: {
+#ifdef BOOST_UBLAS_DF_ZSTD
+					buffer.resize (size);
+					const size_t m = ZSTD_decompress (buffer.data(), size, p, n);
+					if (ZSTD_isError (m) || m != size) {
+						throw corrupt_file();
+					}
+					return buffer.data();
+#else
+					throw unsupported_file();
+#endif
+				}
+			}
+			throw unsupported_file();
+		}
+
+		BOOST_UBLAS_INLINE
+		data_frame assemble () {
+			vector < std::string > headers (columns_.size());
+			vector < df_column > cols (columns_.size());
+			for(size_t k = 0; k < columns_.size(); ++k) {
+				headers(k) = fields_[columns_[k]].name;
+				cols(k) = column (k);
+			}
+			return data_frame (headers, std::move (cols));
+		}
+
+		//! \brief Returns column k, its chunks copied one after the other.
+		BOOST_UBLAS_INLINE
+		df_column column (const size_t k) {
+			const field_info& f = fields_[columns_[k]];
+			const size_t n = rows();
+			df_column col;
+			switch (f.type) {
+				case parquet_type::boolean: {
+					bitmap b (n);
+					size_t row = 0;
+					for(size_t g = 0; g < groups_.size(); ++g) {
+						copy_bits (chunks_[g][k].bits.words(), chunks_[g][k].bits.size(), b.words(), row);
+						row += chunks_[g][k].bits.size();
+					}
+					col = df_column (std::move (b));
+					break;
+				}
+				case parquet_type::byte_array:
+					col = strings (k);
+					break;
+				default:
+					numbers (f, [&] (auto t, auto) {
+						typedef decltype(t) T;
+						column_vector<T> v;
+						v.resize (n, false);
+						size_t row = 0;
+						for(size_t g = 0; g < groups_.size(); ++g) {
+							const std::vector < char >& values = chunks_[g][k].values;
+							std::memcpy (v.data().begin() + row, values.data(), values.size());
+							row += values.size() / sizeof(T);
+						}
+						col = df_column (std::move (v));
+					});
+			}
+			size_t nulls = 0;
+			for(size_t g = 0; g < groups_.size(); ++g) {
+				nulls += chunks_[g][k].nulls;
+			}
+			if (nulls != 0) {
+				bitmap validity (n, true);
+				size_t row = 0;
+				for(size_t g = 0; g < groups_.size(); ++g) {
+					const column_chunk& c = chunks_[g][k];
+					if (c.nulls != 0) {
+						copy_bits (c.validity.words(), c.validity.size(), validity.words(), row);
+					}
+					row += size_t (row_groups_[groups_[g]].rows);
+				}
+				col.set_validity (column_validity (std::move (validity)));
+			}
+			return col;
+		}
+
+		//! \brief Returns the strings of column k, taken as they are from a single row group.
+		BOOST_UBLAS_INLINE
+		df_column strings (const size_t k) {
+			if (options_.dictionary_strings) {
+				dictionary_column x;
+				x.reserve (rows());
+				for(size_t g = 0; g < groups_.size(); ++g) {
+					const string_column& s = chunks_[g][k].strings;
+					for(size_t i = 0; i < s.size(); ++i) {
+						x.push_back (s(i));
+					}
+				}
+				return df_column (std::move (x));
+			}
+			if (groups_.size() == 1) {
+				return df_column (std::move (chunks_[0][k].strings));
+			}
+			size_t bytes = 0;
+			for(size_t g = 0; g < groups_.size(); ++g) {
+				bytes += chunks_[g][k].strings.byte_size();
+			}
+			if (bytes <= std::numeric_limits < std::uint32_t >::max()) {
+				return df_column (concatenate < string_column > (k, bytes));
+			}
+			return df_column (concatenate < large_string_column > (k, bytes));
+		}
+
+		template < class S >
+		BOOST_UBLAS_INLINE
+		S concatenate (const size_t k, const size_t bytes) const {
+			S s;
+			s.reserve (rows(), bytes);
+			for(size_t g = 0; g < groups_.size(); ++g) {
+				const string_column& x = chunks_[g][k].strings;
+				for(size_t i = 0; i < x.size(); ++i) {
+					s.push_back (x(i));
+				}
+			}
+			return s;
+		}
+	};
+
+	/*! \brief Reads the columns of the Parquet file at path, see the top of df_parquet.hpp.
+	 *  Terminates with undefined_column_header on a column (read or in a predicate) the file hasn't.
+	 */
+	BOOST_UBLAS_INLINE
+	data_frame read_parquet (const std::string& path, const parquet_options& options = parquet_options()) {
+		return parquet_reader (path, options).read();
+	}
+
+}}}
+
+#endif
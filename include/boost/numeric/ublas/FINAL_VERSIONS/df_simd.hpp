@@ -0,0 +1,761 @@
+//          Copyright(C) Rishabh Arora 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// SIMD kernels for the numeric df_column types.
+// Every kernel is compiled for SSE4.2, AVX2 and AVX-512 through function target attributes,
+// the widest instruction set supported by the host (CPUID) is selected on first use.
+// A scalar fallback is used on other compilers / architectures, for bool and long double,
+// and when BOOST_UBLAS_DF_NO_SIMD is defined.
+
+#ifndef _BOOST_UBLAS_DF_SIMD_
+#define _BOOST_UBLAS_DF_SIMD_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <boost/numeric/ublas/detail/config.hpp>
+
+#if !defined(BOOST_UBLAS_DF_NO_SIMD) && defined(__GNUC__) && !defined(__clang__) && (__GNUC__ >= 9) \
+	&& (defined(__x86_64__) || defined(__i386__))
+#define BOOST_UBLAS_DF_SIMD
+#define BOOST_UBLAS_DF_SIMD_INLINE inline __attribute__ ((always_inline))
+#define BOOST_UBLAS_DF_TARGET_SSE42 __attribute__ ((target ("sse4.2")))
+#define BOOST_UBLAS_DF_TARGET_AVX2 __attribute__ ((target ("avx2")))
+#define BOOST_UBLAS_DF_TARGET_AVX512 __attribute__ ((target ("avx512f,avx512bw,avx512dq,avx512vl")))
+#endif
+
+namespace boost { namespace numeric { namespace ublas { namespace simd {
+
+	//! \brief Instruction sets the kernels are compiled for, in increasing vector width.
+	enum isa {
+		scalar = 0,
+		sse42 = 1,
+		avx2 = 2,
+		avx512 = 3
+	};
+
+	//! \brief Returns the widest instruction set supported by the host cpu.
+	BOOST_UBLAS_INLINE
+	isa detect_isa () {
+#ifdef BOOST_UBLAS_DF_SIMD
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+			__builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl")) {
+			return avx512;
+		}
+		if (__builtin_cpu_supports("avx2")) {
+			return avx2;
+		}
+		if (__builtin_cpu_supports("sse4.2")) {
+			return sse42;
+		}
+#endif
+		return scalar;
+	}
+
+	//! \brief Stores the instruction set used by the kernels, detected once.
+	BOOST_UBLAS_INLINE
+	std::atomic<int>& selected_isa () {
+		static std::atomic<int> selected (detect_isa());
+		return selected;
+	}
+
+	//! \brief Returns the instruction set used by the kernels.
+	BOOST_UBLAS_INLINE
+	isa active_isa () {
+		return static_cast<isa>(selected_isa().load(std::memory_order_relaxed));
+	}
+
+	/*! \brief Restricts the kernels to an instruction set (e.g. for benchmarks and tests).
+	 *  Can't select an instruction set wider than the detected one.
+	 *  \return the instruction set actually selected.
+	 */
+	BOOST_UBLAS_INLINE
+	isa set_isa (isa i) {
+		const isa widest = detect_isa();
+		if (i > widest) {
+			i = widest;
+		}
+		selected_isa().store(i, std::memory_order_relaxed);
+		return i;
+	}
+
+	//! \brief \c true for the element types the vector kernels are defined on.
+	template < class T >
+	struct is_vectorizable : std::integral_constant < bool,
+		std::is_arithmetic<T>::value &&
+		!std::is_same<T, bool>::value &&
+		!std::is_same<T, long double>::value > {};
+
+	// ----------
+	// Operations
+	// ----------
+	// Work on scalars and on vectors alike.
+
+	struct negate {
+		template < class T > struct supports : std::true_type {};
+		template < class V >
+		static BOOST_UBLAS_INLINE void apply (V& r, const V& a) { r = -a; }
+	};
+
+	struct plus {
+		template < class T > struct supports : std::true_type {};
+		template < class V >
+		static BOOST_UBLAS_INLINE void apply (V& r, const V& a, const V& b) { r = a + b; }
+	};
+
+	struct minus {
+		template < class T > struct supports : std::true_type {};
+		template < class V >
+		static BOOST_UBLAS_INLINE void apply (V& r, const V& a, const V& b) { r = a - b; }
+	};
+
+	struct multiplies {
+		template < class T > struct supports : std::true_type {};
+		template < class V >
+		static BOOST_UBLAS_INLINE void apply (V& r, const V& a, const V& b) { r = a * b; }
+	};
+
+	//! \brief No integer division instruction, integer columns use the scalar loop.
+	struct divides {
+		template < class T > struct supports : std::is_floating_point<T> {};
+		template < class V >
+		static BOOST_UBLAS_INLINE void apply (V& r, const V& a, const V& b) { r = a / b; }
+	};
+
+	struct min {
+		template < class T > struct supports : std::true_type {};
+		template < class V >
+		static BOOST_UBLAS_INLINE void apply (V& r, const V& a, const V& b) { r = (b < a) ? b : a; }
+	};
+
+	struct max {
+		template < class T > struct supports : std::true_type {};
+		template < class V >
+		static BOOST_UBLAS_INLINE void apply (V& r, const V& a, const V& b) { r = (a < b) ? b : a; }
+	};
+
+	//! \brief Bitwise operations, on the words of the bitmaps.
+	struct bit_and {
+		template < class T > struct supports : std::is_integral<T> {};
+		template < class V >
+		static BOOST_UBLAS_INLINE void apply (V& r, const V& a, const V& b) { r = a & b; }
+	};
+
+	struct bit_or {
+		template < class T > struct supports : std::is_integral<T> {};
+		template < class V >
+		static BOOST_UBLAS_INLINE void apply (V& r, const V& a, const V& b) { r = a | b; }
+	};
+
+	struct bit_xor {
+		template < class T > struct supports : std::is_integral<T> {};
+		template < class V >
+		static BOOST_UBLAS_INLINE void apply (V& r, const V& a, const V& b) { r = a ^ b; }
+	};
+
+	struct bit_not {
+		template < class T > struct supports : std::is_integral<T> {};
+		template < class V >
+		static BOOST_UBLAS_INLINE void apply (V& r, const V& a) { r = ~a; }
+	};
+
+	// -----------
+	// Comparisons
+	// -----------
+	// apply returns a bool on scalars, mask writes a lane mask (0 or -1 per lane) on vectors.
+
+	struct less {
+		template < class A, class B >
+		static BOOST_UBLAS_INLINE auto apply (const A& a, const B& b) -> decltype (a < b) { return a < b; }
+		template < class M, class V >
+		static BOOST_UBLAS_INLINE void mask (M& r, const V& a, const V& b) { r = a < b; }
+	};
+
+	struct less_equal {
+		template < class A, class B >
+		static BOOST_UBLAS_INLINE auto apply (const A& a, const B& b) -> decltype (a <= b) { return a <= b; }
+		template < class M, class V >
+		static BOOST_UBLAS_INLINE void mask (M& r, const V& a, const V& b) { r = a <= b; }
+	};
+
+	struct greater {
+		template < class A, class B >
+		static BOOST_UBLAS_INLINE auto apply (const A& a, const B& b) -> decltype (a > b) { return a > b; }
+		template < class M, class V >
+		static BOOST_UBLAS_INLINE void mask (M& r, const V& a, const V& b) { r = a > b; }
+	};
+
+	struct greater_equal {
+		template < class A, class B >
+		static BOOST_UBLAS_INLINE auto apply (const A& a, const B& b) -> decltype (a >= b) { return a >= b; }
+		template < class M, class V >
+		static BOOST_UBLAS_INLINE void mask (M& r, const V& a, const V& b) { r = a >= b; }
+	};
+
+	struct equal_to {
+		template < class A, class B >
+		static BOOST_UBLAS_INLINE auto apply (const A& a, const B& b) -> decltype (a == b) { return a == b; }
+		template < class M, class V >
+		static BOOST_UBLAS_INLINE void mask (M& r, const V& a, const V& b) { r = a == b; }
+	};
+
+	struct not_equal_to {
+		template < class A, class B >
+		static BOOST_UBLAS_INLINE auto apply (const A& a, const B& b) -> decltype (a != b) { return a != b; }
+		template < class M, class V >
+		static BOOST_UBLAS_INLINE void mask (M& r, const V& a, const V& b) { r = a != b; }
+	};
+
+	//! \brief \c true for the equality comparisons, which only need to know if two values are the same.
+	template < class Op > struct is_equality : std::false_type {};
+	template <> struct is_equality < equal_to > : std::true_type {};
+	template <> struct is_equality < not_equal_to > : std::true_type {};
+
+	//! \brief \c true if Op compares an A with a B.
+	template < class Op, class A, class B, class = void >
+	struct is_comparable : std::false_type {};
+
+	template < class Op, class A, class B >
+	struct is_comparable < Op, A, B, decltype ((void) Op::apply (std::declval<const A&>(), std::declval<const B&>())) > : std::true_type {};
+
+	// -------
+	// Kernels
+	// -------
+	// run<W> processes W bytes per vector, W == 0 is the scalar loop.
+
+#ifdef BOOST_UBLAS_DF_SIMD
+	//! \brief GCC vector of W bytes of T.
+	template < class T, size_t W >
+	struct vec {
+		typedef T type __attribute__ ((vector_size (W)));
+	};
+#else
+#define BOOST_UBLAS_DF_SIMD_INLINE BOOST_UBLAS_INLINE
+#endif
+
+	//! \brief out = Op(x).
+	template < class Op >
+	struct unary_kernel {
+		template < size_t W, class T >
+		static BOOST_UBLAS_DF_SIMD_INLINE
+		void run (const T* x, T* out, const size_t n) {
+			size_t i = 0;
+#ifdef BOOST_UBLAS_DF_SIMD
+			if constexpr (W != 0) {
+				typedef typename vec<T, W>::type V;
+				const size_t L = sizeof(V) / sizeof(T);
+				for(; i + L <= n; i += L) {
+					V a, r;
+					std::memcpy (&a, x + i, sizeof(V));
+					Op::apply (r, a);
+					std::memcpy (out + i, &r, sizeof(V));
+				}
+			}
+#endif
+			for(; i < n; ++i) {
+				Op::apply (out[i], x[i]);
+			}
+		}
+	};
+
+	//! \brief out = Op(x, y).
+	template < class Op >
+	struct binary_kernel {
+		template < size_t W, class T >
+		static BOOST_UBLAS_DF_SIMD_INLINE
+		void run (const T* x, const T* y, T* out, const size_t n) {
+			size_t i = 0;
+#ifdef BOOST_UBLAS_DF_SIMD
+			if constexpr (W != 0) {
+				typedef typename vec<T, W>::type V;
+				const size_t L = sizeof(V) / sizeof(T);
+				for(; i + L <= n; i += L) {
+					V a, b, r;
+					std::memcpy (&a, x + i, sizeof(V));
+					std::memcpy (&b, y + i, sizeof(V));
+					Op::apply (r, a, b);
+					std::memcpy (out + i, &r, sizeof(V));
+				}
+			}
+#endif
+			for(; i < n; ++i) {
+				Op::apply (out[i], x[i], y[i]);
+			}
+		}
+	};
+
+	//! \brief out = Op(x, val).
+	template < class Op >
+	struct scalar_kernel {
+		template < size_t W, class T >
+		static BOOST_UBLAS_DF_SIMD_INLINE
+		void run (const T* x, const T val, T* out, const size_t n) {
+			size_t i = 0;
+#ifdef BOOST_UBLAS_DF_SIMD
+			if constexpr (W != 0) {
+				typedef typename vec<T, W>::type V;
+				const size_t L = sizeof(V) / sizeof(T);
+				T lanes [L];
+				for(size_t l = 0; l < L; ++l) {
+					lanes [l] = val;
+				}
+				V b;
+				std::memcpy (&b, lanes, sizeof(V));
+				for(; i + L <= n; i += L) {
+					V a, r;
+					std::memcpy (&a, x + i, sizeof(V));
+					Op::apply (r, a, b);
+					std::memcpy (out + i, &r, sizeof(V));
+				}
+			}
+#endif
+			for(; i < n; ++i) {
+				Op::apply (out[i], x[i], val);
+			}
+		}
+	};
+
+	//! \brief Returns Op(x(0), ... x(n-1)), n > 0.
+	template < class Op >
+	struct fold_kernel {
+		template < size_t W, class T >
+		static BOOST_UBLAS_DF_SIMD_INLINE
+		T run (const T* x, const size_t n) {
+			T result = x[0];
+			size_t i = 0;
+#ifdef BOOST_UBLAS_DF_SIMD
+			if constexpr (W != 0) {
+				typedef typename vec<T, W>::type V;
+				const size_t L = sizeof(V) / sizeof(T);
+				if (n >= 2 * L) {
+					V acc0, acc1;
+					std::memcpy (&acc0, x, sizeof(V));
+					std::memcpy (&acc1, x + L, sizeof(V));
+					for(i = 2 * L; i + 2 * L <= n; i += 2 * L) {
+						V a, b;
+						std::memcpy (&a, x + i, sizeof(V));
+						std::memcpy (&b, x + i + L, sizeof(V));
+						Op::apply (acc0, acc0, a);
+						Op::apply (acc1, acc1, b);
+					}
+					Op::apply (acc0, acc0, acc1);
+					T lanes [L];
+					std::memcpy (lanes, &acc0, sizeof(V));
+					result = lanes [0];
+					for(size_t l = 1; l < L; ++l) {
+						Op::apply (result, result, lanes [l]);
+					}
+				}
+			}
+#endif
+			for(; i < n; ++i) {
+				Op::apply (result, result, x[i]);
+			}
+			return result;
+		}
+	};
+
+	//! \brief Returns the sum of x(0) ... x(n-1) accumulated in R.
+	template < class R >
+	struct sum_kernel {
+		template < size_t W, class T >
+		static BOOST_UBLAS_DF_SIMD_INLINE
+		R run (const T* x, const size_t n) {
+			R result = R();
+			size_t i = 0;
+#ifdef BOOST_UBLAS_DF_SIMD
+			if constexpr (W != 0) {
+				typedef typename vec<R, W>::type VR;
+				const size_t L = sizeof(VR) / sizeof(R);
+				typedef typename vec<T, L * sizeof(T)>::type VT;
+				VR acc [4] = {};
+				for(; i + 4 * L <= n; i += 4 * L) {
+					for(size_t k = 0; k < 4; ++k) {
+						VT a;
+						std::memcpy (&a, x + i + k * L, sizeof(VT));
+						acc [k] += __builtin_convertvector (a, VR);
+					}
+				}
+				for(; i + L <= n; i += L) {
+					VT a;
+					std::memcpy (&a, x + i, sizeof(VT));
+					acc [0] += __builtin_convertvector (a, VR);
+				}
+				acc [0] = (acc [0] + acc [1]) + (acc [2] + acc [3]);
+				R lanes [L];
+				std::memcpy (lanes, &acc [0], sizeof(VR));
+				for(size_t l = 0; l < L; ++l) {
+					result += lanes [l];
+				}
+			}
+#endif
+			for(; i < n; ++i) {
+				result += static_cast<R>(x[i]);
+			}
+			return result;
+		}
+	};
+
+	//! \brief Returns the sum of (x(i) - mean)^2 for i in [0, n), accumulated in R.
+	template < class R >
+	struct squared_deviation_kernel {
+		template < size_t W, class T >
+		static BOOST_UBLAS_DF_SIMD_INLINE
+		R run (const T* x, const size_t n, const R mean) {
+			R result = R();
+			size_t i = 0;
+#ifdef BOOST_UBLAS_DF_SIMD
+			if constexpr (W != 0) {
+				typedef typename vec<R, W>::type VR;
+				const size_t L = sizeof(VR) / sizeof(R);
+				typedef typename vec<T, L * sizeof(T)>::type VT;
+				R lanes [L];
+				for(size_t l = 0; l < L; ++l) {
+					lanes [l] = mean;
+				}
+				VR m, acc [2] = {};
+				std::memcpy (&m, lanes, sizeof(VR));
+				for(; i + 2 * L <= n; i += 2 * L) {
+					for(size_t k = 0; k < 2; ++k) {
+						VT a;
+						std::memcpy (&a, x + i + k * L, sizeof(VT));
+						const VR d = __builtin_convertvector (a, VR) - m;
+						acc [k] += d * d;
+					}
+				}
+				acc [0] += acc [1];
+				std::memcpy (lanes, &acc [0], sizeof(VR));
+				for(size_t l = 0; l < L; ++l) {
+					result += lanes [l];
+				}
+			}
+#endif
+			for(; i < n; ++i) {
+				const R d = static_cast<R>(x[i]) - mean;
+				result += d * d;
+			}
+			return result;
+		}
+	};
+
+	/*! \brief Packs 64 comparison results, bytes 0 or -1, into a word: byte i gives bit i.
+	 *  8 bytes at a time, the multiplication gathers the low bit of every byte into the top byte.
+	 */
+	BOOST_UBLAS_INLINE
+	std::uint64_t pack_bytes (const signed char* b) {
+		std::uint64_t r = 0;
+		for(size_t k = 0; k < 8; ++k) {
+			std::uint64_t c;
+			std::memcpy (&c, b + 8 * k, sizeof(c));
+			r |= (((c & 0x0101010101010101ull) * 0x0102040810204080ull) >> 56) << (8 * k);
+		}
+		return r;
+	}
+
+	/*! \brief Sets the bits i of out to Op(x(i), y(i)), out holding (n + 63) / 64 words.
+	 *  A vector compare gives a lane mask, narrowed to bytes and packed 64 at a time.
+	 */
+	template < class Op >
+	struct compare_kernel {
+		template < size_t W, class T >
+		static BOOST_UBLAS_DF_SIMD_INLINE
+		void run (const T* x, const T* y, std::uint64_t* out, const size_t n) {
+			size_t i = 0;
+#ifdef BOOST_UBLAS_DF_SIMD
+			if constexpr (W != 0) {
+				typedef typename vec<T, W>::type V;
+				const size_t L = sizeof(V) / sizeof(T);
+				// lane masks, vectors of signed integers as wide as T
+				typedef decltype (std::declval<V>() < std::declval<V>()) M;
+				typedef typename vec<signed char, L>::type VB;
+				for(; i + 64 <= n; i += 64) {
+					signed char b [64];
+					for(size_t j = 0; j < 64; j += L) {
+						V a, c;
+						std::memcpy (&a, x + i + j, sizeof(V));
+						std::memcpy (&c, y + i + j, sizeof(V));
+						M r;
+						Op::mask (r, a, c);
+						const VB m = __builtin_convertvector (r, VB);
+						std::memcpy (b + j, &m, L);
+					}
+					out[i / 64] = pack_bytes (b);
+				}
+			}
+#endif
+			for(; i < n; i += 64) {
+				const size_t m = (n - i < 64) ? n - i : 64;
+				std::uint64_t w = 0;
+				for(size_t j = 0; j < m; ++j) {
+					w |= std::uint64_t (Op::apply (x[i + j], y[i + j])) << j;
+				}
+				out[i / 64] = w;
+			}
+		}
+	};
+
+	//! \brief Sets the bits i of out to Op(x(i), val), out holding (n + 63) / 64 words.
+	template < class Op >
+	struct compare_scalar_kernel {
+		template < size_t W, class T >
+		static BOOST_UBLAS_DF_SIMD_INLINE
+		void run (const T* x, const T val, std::uint64_t* out, const size_t n) {
+			size_t i = 0;
+#ifdef BOOST_UBLAS_DF_SIMD
+			if constexpr (W != 0) {
+				typedef typename vec<T, W>::type V;
+				const size_t L = sizeof(V) / sizeof(T);
+				// lane masks, vectors of signed integers as wide as T
+				typedef decltype (std::declval<V>() < std::declval<V>()) M;
+				typedef typename vec<signed char, L>::type VB;
+				T lanes [L];
+				for(size_t l = 0; l < L; ++l) {
+					lanes [l] = val;
+				}
+				V c;
+				std::memcpy (&c, lanes, sizeof(V));
+				for(; i + 64 <= n; i += 64) {
+					signed char b [64];
+					for(size_t j = 0; j < 64; j += L) {
+						V a;
+						std::memcpy (&a, x + i + j, sizeof(V));
+						M r;
+						Op::mask (r, a, c);
+						const VB m = __builtin_convertvector (r, VB);
+						std::memcpy (b + j, &m, L);
+					}
+					out[i / 64] = pack_bytes (b);
+				}
+			}
+#endif
+			for(; i < n; i += 64) {
+				const size_t m = (n - i < 64) ? n - i : 64;
+				std::uint64_t w = 0;
+				for(size_t j = 0; j < m; ++j) {
+					w |= std::uint64_t (Op::apply (x[i + j], val)) << j;
+				}
+				out[i / 64] = w;
+			}
+		}
+	};
+
+	/*! \brief Returns the number of set bits in the words x(0) ... x(n-1).
+	 *  No vector popcount in the supported instruction sets, but compiled for one of them
+	 *  the builtin is a single popcnt instruction instead of a library call.
+	 */
+	struct popcount_kernel {
+		template < size_t W >
+		static BOOST_UBLAS_DF_SIMD_INLINE
+		size_t run (const std::uint64_t* x, const size_t n) {
+			size_t c0 = 0, c1 = 0;
+			size_t i = 0;
+			for(; i + 2 <= n; i += 2) {
+				c0 += __builtin_popcountll (x[i]);
+				c1 += __builtin_popcountll (x[i + 1]);
+			}
+			if (i < n) {
+				c0 += __builtin_popcountll (x[i]);
+			}
+			return c0 + c1;
+		}
+	};
+
+	/*! \brief Sets the bits i of out to 1 if x(i) is one of the bytes a, b or c, out holding (n + 63) / 64 words.
+	 *  Used to find the delimiters, quotes and line ends of delimited text without looking at the other bytes.
+	 */
+	struct match_bytes_kernel {
+		template < size_t W >
+		static BOOST_UBLAS_DF_SIMD_INLINE
+		void run (const char* x, const char a, const char b, const char c, std::uint64_t* out, const size_t n) {
+			size_t i = 0;
+#ifdef BOOST_UBLAS_DF_SIMD
+			if constexpr (W != 0) {
+				typedef typename vec<signed char, W>::type V;
+				V va, vb, vc;
+				std::memset (&va, a, sizeof(V));
+				std::memset (&vb, b, sizeof(V));
+				std::memset (&vc, c, sizeof(V));
+				for(; i + 64 <= n; i += 64) {
+					signed char m [64];
+					for(size_t j = 0; j < 64; j += sizeof(V)) {
+						V v;
+						std::memcpy (&v, x + i + j, sizeof(V));
+						const V r = (v == va) | (v == vb) | (v == vc);
+						std::memcpy (m + j, &r, sizeof(V));
+					}
+					out[i / 64] = pack_bytes (m);
+				}
+			}
+#endif
+			for(; i < n; i += 64) {
+				const size_t m = (n - i < 64) ? n - i : 64;
+				std::uint64_t w = 0;
+				for(size_t j = 0; j < m; ++j) {
+					const char y = x[i + j];
+					w |= std::uint64_t (y == a || y == b || y == c) << j;
+				}
+				out[i / 64] = w;
+			}
+		}
+	};
+
+	// --------
+	// Dispatch
+	// --------
+
+#ifdef BOOST_UBLAS_DF_SIMD
+	template < class K, class... Args >
+	BOOST_UBLAS_DF_TARGET_SSE42
+	auto run_sse42 (Args... args) {
+		return K::template run<16> (args...);
+	}
+
+	template < class K, class... Args >
+	BOOST_UBLAS_DF_TARGET_AVX2
+	auto run_avx2 (Args... args) {
+		return K::template run<32> (args...);
+	}
+
+	template < class K, class... Args >
+	BOOST_UBLAS_DF_TARGET_AVX512
+	auto run_avx512 (Args... args) {
+		return K::template run<64> (args...);
+	}
+#endif
+
+	//! \brief Runs kernel K with the active instruction set.
+	template < class K, class... Args >
+	BOOST_UBLAS_INLINE
+	auto dispatch (Args... args) {
+#ifdef BOOST_UBLAS_DF_SIMD
+		switch (active_isa()) {
+			case avx512:
+				return run_avx512 <K> (args...);
+			case avx2:
+				return run_avx2 <K> (args...);
+			case sse42:
+				return run_sse42 <K> (args...);
+			default:
+				break;
+		}
+#endif
+		return K::template run<0> (args...);
+	}
+
+	//! \brief out = Op(x), T must be vectorizable.
+	template < class Op, class T >
+	BOOST_UBLAS_INLINE
+	void transform (const T* x, T* out, const size_t n) {
+		dispatch < unary_kernel<Op> > (x, out, n);
+	}
+
+	//! \brief out = Op(x, y), T must be vectorizable.
+	template < class Op, class T >
+	BOOST_UBLAS_INLINE
+	void transform (const T* x, const T* y, T* out, const size_t n) {
+		dispatch < binary_kernel<Op> > (x, y, out, n);
+	}
+
+	//! \brief out = Op(x, val), T must be vectorizable.
+	template < class Op, class T >
+	BOOST_UBLAS_INLINE
+	void transform_scalar (const T* x, const T val, T* out, const size_t n) {
+		dispatch < scalar_kernel<Op> > (x, val, out, n);
+	}
+
+	//! \brief Sets the bits i of out to Op(x(i), y(i)) for i in [0, n).
+	template < class Op, class T >
+	BOOST_UBLAS_INLINE
+	void compare (const T* x, const T* y, std::uint64_t* out, const size_t n) {
+		if constexpr (is_vectorizable<T>::value) {
+			dispatch < compare_kernel<Op> > (x, y, out, n);
+		}
+		else {
+			compare_kernel<Op>::template run<0> (x, y, out, n);
+		}
+	}
+
+	//! \brief Sets the bits i of out to Op(x(i), val) for i in [0, n).
+	template < class Op, class T >
+	BOOST_UBLAS_INLINE
+	void compare_scalar (const T* x, const T val, std::uint64_t* out, const size_t n) {
+		if constexpr (is_vectorizable<T>::value) {
+			dispatch < compare_scalar_kernel<Op> > (x, val, out, n);
+		}
+		else {
+			compare_scalar_kernel<Op>::template run<0> (x, val, out, n);
+		}
+	}
+
+	//! \brief Returns the number of set bits in the words x(0) ... x(n-1).
+	BOOST_UBLAS_INLINE
+	size_t reduce_popcount (const std::uint64_t* x, const size_t n) {
+		return dispatch < popcount_kernel > (x, n);
+	}
+
+	//! \brief Sets the bits i of out to 1 if x(i) is a, b or c, for i in [0, n).
+	BOOST_UBLAS_INLINE
+	void match_bytes (const char* x, const char a, const char b, const char c, std::uint64_t* out, const size_t n) {
+		dispatch < match_bytes_kernel > (x, a, b, c, out, n);
+	}
+
+	//! \brief Returns the minimum of x(0) ... x(n-1), n > 0.
+	template < class T >
+	BOOST_UBLAS_INLINE
+	T reduce_min (const T* x, const size_t n) {
+		if constexpr (is_vectorizable<T>::value) {
+			return dispatch < fold_kernel<min> > (x, n);
+		}
+		else {
+			return fold_kernel<min>::template run<0> (x, n);
+		}
+	}
+
+	//! \brief Returns the maximum of x(0) ... x(n-1), n > 0.
+	template < class T >
+	BOOST_UBLAS_INLINE
+	T reduce_max (const T* x, const size_t n) {
+		if constexpr (is_vectorizable<T>::value) {
+			return dispatch < fold_kernel<max> > (x, n);
+		}
+		else {
+			return fold_kernel<max>::template run<0> (x, n);
+		}
+	}
+
+	/*! \brief Returns the sum of x(0) ... x(n-1) accumulated in R.
+	 *  The vector kernels add in a different order than the scalar loop,
+	 *  floating point sums may differ in the last bits between instruction sets.
+	 */
+	template < class R, class T >
+	BOOST_UBLAS_INLINE
+	R reduce_sum (const T* x, const size_t n) {
+		if constexpr (is_vectorizable<T>::value && is_vectorizable<R>::value) {
+			return dispatch < sum_kernel<R> > (x, n);
+		}
+		else {
+			return sum_kernel<R>::template run<0> (x, n);
+		}
+	}
+
+	//! \brief Returns the sum of (x(i) - mean)^2 for i in [0, n), accumulated in R.
+	template < class R, class T >
+	BOOST_UBLAS_INLINE
+	R reduce_squared_deviation (const T* x, const size_t n, const R mean) {
+		if constexpr (is_vectorizable<T>::value && is_vectorizable<R>::value && std::is_floating_point<R>::value) {
+			return dispatch < squared_deviation_kernel<R> > (x, n, mean);
+		}
+		else {
+			return squared_deviation_kernel<R>::template run<0> (x, n, mean);
+		}
+	}
+
+}}}}
+
+#endif
@@ -0,0 +1,389 @@
+//          Copyright(C) Rishabh Arora 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Statistical summaries of the df_column buffers.
+
+#ifndef _BOOST_UBLAS_DF_STATISTICS_
+#define _BOOST_UBLAS_DF_STATISTICS_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <limits>
+#include <vector>
+#include <boost/math/constants/constants.hpp>
+#include "./df_simd.hpp"
+
+namespace boost { namespace numeric { namespace ublas {
+
+	/*! \brief Single pass summary of a column: count, min, max, sum, mean and variance.
+	 *  Uses Welford's update for single values and Chan's formula to merge partial summaries,
+	 *  so a column can be summarised in chunks or by several threads and the results merged.
+	 *  T is the type of the statistics (double, long double ...).
+	 */
+	template < class T >
+	struct column_summary {
+		//! \brief Number of values.
+		size_t count;
+		//! \brief Minimum value, undefined if \c count == 0.
+		T min;
+		//! \brief Maximum value, undefined if \c count == 0.
+		T max;
+		//! \brief Sum of the values.
+		T sum;
+		//! \brief Mean of the values.
+		T mean;
+		//! \brief Sum of squared deviations from the mean.
+		T m2;
+
+		//! \brief Summary of no values.
+		BOOST_UBLAS_INLINE
+		column_summary ():
+			count (0),
+			min (),
+			max (),
+			sum (),
+			mean (),
+			m2 () {}
+
+		//! \brief Adds a value (Welford's update).
+		template < class V >
+		BOOST_UBLAS_INLINE
+		column_summary& push (const V& value) {
+			const T x = static_cast<T>(value);
+			if (count == 0 || x < min) {
+				min = x;
+			}
+			if (count == 0 || max < x) {
+				max = x;
+			}
+			++count;
+			sum += x;
+			const T delta = x - mean;
+			mean += delta / count;
+			m2 += delta * (x - mean);
+			return *this;
+		}
+
+		/*! \brief Adds n contiguous values.
+		 *  The buffer is read once, block by block: min, max, sum and squared deviations
+		 *  of a block are computed by the SIMD kernels while the block is in cache,
+		 *  then the block is merged.
+		 */
+		template < class V >
+		BOOST_UBLAS_INLINE
+		column_summary& push (const V* x, const size_t n) {
+			const size_t block = 4096;
+			for(size_t i = 0; i < n; i += block) {
+				const size_t k = (n - i < block) ? (n - i) : block;
+				column_summary b;
+				b.count = k;
+				b.min = static_cast<T>(simd::reduce_min (x + i, k));
+				b.max = static_cast<T>(simd::reduce_max (x + i, k));
+				b.sum = simd::reduce_sum <T> (x + i, k);
+				b.mean = b.sum / k;
+				b.m2 = simd::reduce_squared_deviation <T> (x + i, k, b.mean);
+				merge (b);
+			}
+			return *this;
+		}
+
+		//! \brief Merges the summary of other values (Chan's formula).
+		BOOST_UBLAS_INLINE
+		column_summary& merge (const column_summary& other) {
+			if (other.count == 0) {
+				return *this;
+			}
+			if (count == 0) {
+				return *this = other;
+			}
+			const size_t n = count + other.count;
+			const T delta = other.mean - mean;
+			min = (other.min < min) ? other.min : min;
+			max = (max < other.max) ? other.max : max;
+			sum += other.sum;
+			mean += delta * other.count / n;
+			m2 += other.m2 + delta * delta * ((T) count * other.count / n);
+			count = n;
+			return *this;
+		}
+
+		//! \brief Returns the sample variance (divided by \c count - 1).
+		BOOST_UBLAS_INLINE
+		T variance () const {
+			return (count > 1) ? m2 / (count - 1) : T();
+		}
+
+		//! \brief Returns the sample standard deviation.
+		BOOST_UBLAS_INLINE
+		T stddev () const {
+			using std::sqrt;
+			return sqrt (variance());
+		}
+	};
+
+	//! \brief Prints Minimum, Maximum, Mean, Standard deviation and Count of a summary.
+	template < class T >
+	std::ostream& operator << (std::ostream& os, const column_summary<T>& s) {
+		os << "Min. : " << s.min << ", ";
+		os << "Max. : " << s.max << ", ";
+		os << "Mean : " << s.mean << ", ";
+		os << "Std. Dev. : " << s.stddev() << ", ";
+		os << "Count : " << s.count;
+		return os;
+	}
+
+	// ---------
+	// Quantiles
+	// ---------
+
+	/*! \brief Partially sorts [first, last) so that first[r] is in its sorted position for every rank r.
+	 *  Ranks must be sorted, unique and smaller than last - first.
+	 *  Each nth_element call splits both the range and the set of ranks, so k ranks cost
+	 *  O(n log k) instead of a full O(n log n) sort.
+	 */
+	template < class T >
+	BOOST_UBLAS_INLINE
+	void multi_select (T* first, T* last, const size_t* rank_first, const size_t* rank_last, T* base) {
+		while (rank_first != rank_last && last - first > 1) {
+			const size_t* mid = rank_first + (rank_last - rank_first) / 2;
+			T* nth = base + *mid;
+			std::nth_element (first, nth, last);
+			multi_select (first, nth, rank_first, mid, base);
+			first = nth + 1;
+			rank_first = mid + 1;
+		}
+	}
+
+	/*! \brief Returns the quantiles qs of the n values in x, x is reordered.
+	 *  Quantiles are interpolated between the order statistics of rank floor((n-1)q) and
+	 *  floor((n-1)q) + 1 (type 7 of R, the median of an even number of values is the mean
+	 *  of the 2 middle values). All the ranks are selected in one multi_select pass.
+	 */
+	template < class R, class T >
+	BOOST_UBLAS_INLINE
+	std::vector<R> select_quantiles (T* x, const size_t n, const std::vector<double>& qs) {
+		std::vector<size_t> ranks;
+		ranks.reserve (2 * qs.size());
+		for(size_t i = 0; i < qs.size(); ++i) {
+			const size_t lo = (size_t) std::floor ((n - 1) * qs[i]);
+			ranks.push_back (lo);
+			if (lo + 1 < n) {
+				ranks.push_back (lo + 1);
+			}
+		}
+		std::sort (ranks.begin(), ranks.end());
+		ranks.erase (std::unique (ranks.begin(), ranks.end()), ranks.end());
+		multi_select (x, x + n, ranks.data(), ranks.data() + ranks.size(), x);
+
+		std::vector<R> result (qs.size());
+		for(size_t i = 0; i < qs.size(); ++i) {
+			const double h = (n - 1) * qs[i];
+			const size_t lo = (size_t) std::floor (h);
+			const R a = static_cast<R>(x[lo]);
+			if (lo + 1 < n && h > lo) {
+				const R b = static_cast<R>(x[lo + 1]);
+				result[i] = a + static_cast<R>(h - lo) * (b - a);
+			}
+			else {
+				result[i] = a;
+			}
+		}
+		return result;
+	}
+
+	/*! \brief Streaming quantile sketch with bounded memory (merging t-digest, Dunning 2019).
+	 *  Values are buffered and merged into at most about \c compression centroids whose size is
+	 *  bounded by the arcsine scale function, small near the tails, so extreme quantiles stay accurate.
+	 *  Digests built on chunks or threads can be merged.
+	 */
+	class tdigest {
+	public:
+		//! \brief A cluster of values represented by their mean.
+		struct centroid {
+			double mean;
+			double weight;
+			bool operator < (const centroid& c) const { return mean < c.mean; }
+		};
+
+		/*! \brief Constructor of tdigest.
+		 *  \param compression: accuracy / memory trade-off, about \c compression centroids are kept.
+		 */
+		BOOST_UBLAS_INLINE
+		explicit tdigest (const double compression = 100):
+			compression_ (compression),
+			weight_ (0),
+			min_ (std::numeric_limits<double>::infinity()),
+			max_ (-std::numeric_limits<double>::infinity()) {
+			buffer_.reserve (buffer_size());
+		}
+
+		//! \brief Adds a value.
+		BOOST_UBLAS_INLINE
+		tdigest& push (const double x, const double w = 1) {
+			if (x != x) {
+				return *this;
+			}
+			min_ = std::min (min_, x);
+			max_ = std::max (max_, x);
+			buffer_.push_back (centroid {x, w});
+			if (buffer_.size() >= buffer_size()) {
+				compress();
+			}
+			return *this;
+		}
+
+		//! \brief Adds n contiguous values.
+		template < class T >
+		BOOST_UBLAS_INLINE
+		tdigest& push (const T* x, const size_t n) {
+			for(size_t i = 0; i < n; ++i) {
+				push (static_cast<double>(x[i]));
+			}
+			return *this;
+		}
+
+		//! \brief Merges the values of another digest.
+		BOOST_UBLAS_INLINE
+		tdigest& merge (const tdigest& other) {
+			if (&other == this) {
+				return merge (tdigest (other));
+			}
+			for(const centroid& c: other.centroids_) {
+				push (c.mean, c.weight);
+			}
+			for(const centroid& c: other.buffer_) {
+				push (c.mean, c.weight);
+			}
+			min_ = std::min (min_, other.min_);
+			max_ = std::max (max_, other.max_);
+			return *this;
+		}
+
+		//! \brief Returns the number of values added.
+		BOOST_UBLAS_INLINE
+		double count () const {
+			double w = weight_;
+			for(const centroid& c: buffer_) {
+				w += c.weight;
+			}
+			return w;
+		}
+
+		//! \brief Returns the number of centroids after merging the buffered values.
+		BOOST_UBLAS_INLINE
+		size_t size () {
+			compress();
+			return centroids_.size();
+		}
+
+		//! \brief Returns the estimated q-quantile, NaN if no value was added.
+		BOOST_UBLAS_INLINE
+		double quantile (const double q) {
+			compress();
+			if (centroids_.empty()) {
+				return std::numeric_limits<double>::quiet_NaN();
+			}
+			const size_t m = centroids_.size();
+			const double t = q * weight_;
+			if (t <= 0) {
+				return min_;
+			}
+			if (t >= weight_) {
+				return max_;
+			}
+			if (m == 1) {
+				return centroids_[0].mean;
+			}
+			// centroid i is centered at cumulative weight c(i) = w(0) + ... + w(i-1) + w(i) / 2
+			double left = centroids_[0].weight / 2;
+			if (t < left) {
+				return min_ + (centroids_[0].mean - min_) * t / left;
+			}
+			for(size_t i = 0; i + 1 < m; ++i) {
+				const double right = left + (centroids_[i].weight + centroids_[i + 1].weight) / 2;
+				if (t < right) {
+					return centroids_[i].mean + (centroids_[i + 1].mean - centroids_[i].mean) * (t - left) / (right - left);
+				}
+				left = right;
+			}
+			return centroids_[m - 1].mean + (max_ - centroids_[m - 1].mean) * (t - left) / (weight_ - left);
+		}
+
+		//! \brief Returns the centroids after merging the buffered values.
+		BOOST_UBLAS_INLINE
+		const std::vector<centroid>& centroids () {
+			compress();
+			return centroids_;
+		}
+
+	private:
+		//! \brief Accuracy parameter.
+		double compression_;
+		//! \brief Total weight of the centroids.
+		double weight_;
+		//! \brief Exact extremes.
+		double min_, max_;
+		//! \brief Merged centroids, sorted by mean.
+		std::vector<centroid> centroids_;
+		//! \brief Values not merged yet.
+		std::vector<centroid> buffer_;
+
+		BOOST_UBLAS_INLINE
+		size_t buffer_size () const {
+			return (size_t) (5 * compression_) + 16;
+		}
+
+		//! \brief Scale function k1(q) = compression / (2 pi) * asin(2q - 1).
+		BOOST_UBLAS_INLINE
+		double scale (const double q) const {
+			return compression_ / (2 * boost::math::constants::pi<double>()) * std::asin (2 * q - 1);
+		}
+
+		//! \brief Inverse of the scale function, k is clamped to the scale of q = 1.
+		BOOST_UBLAS_INLINE
+		double inverse_scale (double k) const {
+			k = std::min (k, compression_ / 4);
+			return (std::sin (k * 2 * boost::math::constants::pi<double>() / compression_) + 1) / 2;
+		}
+
+		//! \brief Merges the buffered values into the centroids.
+		BOOST_UBLAS_INLINE
+		void compress () {
+			if (buffer_.empty()) {
+				return;
+			}
+			for(const centroid& c: buffer_) {
+				weight_ += c.weight;
+			}
+			buffer_.insert (buffer_.end(), centroids_.begin(), centroids_.end());
+			std::sort (buffer_.begin(), buffer_.end());
+			centroids_.clear();
+
+			double so_far = 0;
+			centroid current = buffer_[0];
+			double limit = weight_ * inverse_scale (scale (0) + 1);
+			for(size_t i = 1; i < buffer_.size(); ++i) {
+				const centroid& c = buffer_[i];
+				if (so_far + current.weight + c.weight <= limit) {
+					current.weight += c.weight;
+					current.mean += (c.mean - current.mean) * c.weight / current.weight;
+				}
+				else {
+					so_far += current.weight;
+					centroids_.push_back (current);
+					limit = weight_ * inverse_scale (scale (so_far / weight_) + 1);
+					current = c;
+				}
+			}
+			centroids_.push_back (current);
+			buffer_.clear();
+		}
+	};
+
+}}}
+
+#endif
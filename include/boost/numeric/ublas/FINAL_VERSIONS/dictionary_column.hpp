@@ -0,0 +1,414 @@
+//          Copyright(C) Rishabh Arora 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Dictionary encoded (categorical) string column: every distinct string is stored once in a dictionary,
+// the column holds the integer codes of its strings in the dictionary.
+// Codes are 8, 16 or 32 bit wide, the narrowest holding the cardinality of the column.
+
+#ifndef _BOOST_UBLAS_DF_DICTIONARY_COLUMN_
+#define _BOOST_UBLAS_DF_DICTIONARY_COLUMN_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <boost/numeric/ublas/vector.hpp>
+#include "./column_allocator.hpp"
+#include "./column_index.hpp"
+#include "./df_bitmap.hpp"
+#include "./string_column.hpp"
+
+namespace boost { namespace numeric { namespace ublas {
+
+	/*! \brief Column of strings stored as codes into a dictionary of the distinct strings.
+	 *  Code c is the string \c dictionary()(c), codes are given in order of first appearance.
+	 *  The dictionary is shared between copies of the column, columns sharing a dictionary
+	 *  are compared on their codes only.
+	 *  Equality, grouping and sorting work on the codes: the strings are read once per
+	 *  distinct value, not once per element.
+	 */
+	class dictionary_column {
+	public:
+		typedef std::string_view value_type;
+		typedef std::string_view const_reference;
+		typedef size_t size_type;
+		typedef std::uint32_t code_type;
+
+		//! \brief Code of a string not in the dictionary.
+		static constexpr code_type npos = code_type(-1);
+
+		BOOST_UBLAS_INLINE
+		dictionary_column ():
+			dictionary_ (std::make_shared<entries>()),
+			width_ (1),
+			size_ (0) {}
+
+		//! \brief Column holding the strings of v.
+		template < class A >
+		BOOST_UBLAS_INLINE
+		explicit dictionary_column (const vector < std::string, A >& v):
+			dictionary_column () {
+			reserve (v.size());
+			for(size_t i = 0; i < v.size(); ++i) {
+				push_back (v(i));
+			}
+		}
+
+		//! \brief Column holding the strings of c.
+		template < class O >
+		BOOST_UBLAS_INLINE
+		explicit dictionary_column (const basic_string_column < O >& c):
+			dictionary_column () {
+			reserve (c.size());
+			for(size_t i = 0; i < c.size(); ++i) {
+				push_back (c(i));
+			}
+		}
+
+		/*! \brief Column of the codes codes(0) ... codes(n-1) into dictionary, which holds distinct strings.
+		 *  T is the type of the codes, std::uint8_t, std::uint16_t or std::uint32_t.
+		 */
+		template < class T >
+		BOOST_UBLAS_INLINE
+		dictionary_column (const string_column& dictionary, const T* codes, const size_t n):
+			dictionary_ (std::make_shared<entries>()),
+			width_ (sizeof(T)),
+			size_ (n) {
+			dictionary_->values = dictionary;
+			for(size_t c = 0; c < dictionary.size(); ++c) {
+				dictionary_->index.insert (dictionary(c), c);
+			}
+			if constexpr (sizeof(T) == 1) {
+				codes8_.assign (codes, codes + n);
+			}
+			else if constexpr (sizeof(T) == 2) {
+				codes16_.assign (codes, codes + n);
+			}
+			else {
+				codes32_.assign (codes, codes + n);
+			}
+		}
+
+		BOOST_UBLAS_INLINE
+		dictionary_column (std::initializer_list < std::string_view > l):
+			dictionary_column () {
+			for(std::string_view s: l) {
+				push_back (s);
+			}
+		}
+
+		//! \brief Returns the number of elements.
+		BOOST_UBLAS_INLINE
+		size_t size() const {
+			return size_;
+		}
+
+		BOOST_UBLAS_INLINE
+		bool empty() const {
+			return size_ == 0;
+		}
+
+		//! \brief Returns the number of distinct strings.
+		BOOST_UBLAS_INLINE
+		size_t cardinality() const {
+			return dictionary_->values.size();
+		}
+
+		//! \brief Returns the size of a code in bytes: 1, 2 or 4.
+		BOOST_UBLAS_INLINE
+		size_t code_width() const {
+			return width_;
+		}
+
+		//! \brief Returns the distinct strings, indexed by code.
+		BOOST_UBLAS_INLINE
+		const string_column& dictionary() const {
+			return dictionary_->values;
+		}
+
+		//! \brief Returns the code of the element i.
+		BOOST_UBLAS_INLINE
+		code_type code (const size_t i) const {
+			switch (width_) {
+				case 1: return codes8_[i];
+				case 2: return codes16_[i];
+				default: return codes32_[i];
+			}
+		}
+
+		//! \brief Returns the element i.
+		BOOST_UBLAS_INLINE
+		std::string_view operator () (const size_t i) const {
+			return dictionary_->values (code (i));
+		}
+
+		//! \brief Returns the element i.
+		BOOST_UBLAS_INLINE
+		std::string_view operator [] (const size_t i) const {
+			return (*this)(i);
+		}
+
+		//! \brief Returns the code of s, npos if s is not in the dictionary.
+		BOOST_UBLAS_INLINE
+		code_type find (const std::string_view s) const {
+			const size_t c = dictionary_->index.find (s, dictionary_->values);
+			return c == column_index::npos ? npos : code_type (c);
+		}
+
+		/*! \brief Appends a string.
+		 *  A new string is added to the dictionary (copied first if shared) and
+		 *  the codes are widened when the cardinality outgrows them.
+		 */
+		BOOST_UBLAS_INLINE
+		void push_back (const std::string_view s) {
+			code_type c = find (s);
+			if (c == npos) {
+				if (dictionary_.use_count() > 1) {
+					dictionary_ = std::make_shared<entries> (*dictionary_);
+				}
+				c = code_type (dictionary_->values.size());
+				dictionary_->values.push_back (s);
+				dictionary_->index.insert (s, c);
+				widen (c);
+			}
+			switch (width_) {
+				case 1: codes8_.push_back (std::uint8_t (c)); break;
+				case 2: codes16_.push_back (std::uint16_t (c)); break;
+				default: codes32_.push_back (c);
+			}
+			++size_;
+		}
+
+		//! \brief Reserves space for n elements.
+		BOOST_UBLAS_INLINE
+		void reserve (const size_t n) {
+			switch (width_) {
+				case 1: codes8_.reserve (n); break;
+				case 2: codes16_.reserve (n); break;
+				default: codes32_.reserve (n);
+			}
+		}
+
+		/*! \brief Calls fn(codes, n) with a pointer to the codes, of type
+		 *  const std::uint8_t*, const std::uint16_t* or const std::uint32_t* depending on \c code_width().
+		 *  Kernels dispatch on the width once and loop over the codes of their exact type.
+		 */
+		template < class F >
+		BOOST_UBLAS_INLINE
+		void with_codes (F fn) const {
+			switch (width_) {
+				case 1: fn (codes8_.data(), size_); break;
+				case 2: fn (codes16_.data(), size_); break;
+				default: fn (codes32_.data(), size_);
+			}
+		}
+
+		/*! \brief Returns a bitmap with the elements equal to s set.
+		 *  s is looked up once, then only the codes are compared.
+		 */
+		BOOST_UBLAS_INLINE
+		bitmap matches (const std::string_view s) const {
+			bitmap b (size_);
+			const code_type c = find (s);
+			if (c == npos) {
+				return b;
+			}
+			bitmap::word_type* w = b.words();
+			with_codes ([c, w] (const auto* x, const size_t n) {
+				for(size_t k = 0; k < n; k += bitmap::word_bits) {
+					const size_t m = std::min (n - k, bitmap::word_bits);
+					bitmap::word_type word = 0;
+					for(size_t j = 0; j < m; ++j) {
+						word |= bitmap::word_type (x[k + j] == c) << j;
+					}
+					w[k / bitmap::word_bits] = word;
+				}
+			});
+			return b;
+		}
+
+		//! \brief Returns the number of elements of each code, the sizes of the groups of equal strings.
+		BOOST_UBLAS_INLINE
+		std::vector < size_t > counts () const {
+			std::vector < size_t > r (cardinality(), 0);
+			with_codes ([&r] (const auto* x, const size_t n) {
+				for(size_t i = 0; i < n; ++i) {
+					++r[x[i]];
+				}
+			});
+			return r;
+		}
+
+		/*! \brief Returns the rank of each code in the lexicographic order of the dictionary.
+		 *  Sorting the column is sorting its codes by rank.
+		 */
+		BOOST_UBLAS_INLINE
+		std::vector < code_type > ranks () const {
+			const string_column& d = dictionary_->values;
+			std::vector < code_type > order (d.size());
+			for(size_t i = 0; i < order.size(); ++i) {
+				order[i] = code_type (i);
+			}
+			std::sort (order.begin(), order.end(), [&d] (const code_type a, const code_type b) {
+				return d(a) < d(b);
+			});
+			std::vector < code_type > r (d.size());
+			for(size_t i = 0; i < order.size(); ++i) {
+				r[order[i]] = code_type (i);
+			}
+			return r;
+		}
+
+		/*! \brief Returns the permutation sorting the column, equal strings keeping their order.
+		 *  Counting sort on the ranks of the codes: O(n + k log k) for k distinct strings.
+		 */
+		BOOST_UBLAS_INLINE
+		std::vector < size_t > argsort () const {
+			const std::vector < code_type > rank = ranks();
+			const std::vector < size_t > count = counts();
+			std::vector < size_t > start (rank.size() + 1, 0);
+			for(size_t c = 0; c < rank.size(); ++c) {
+				start[rank[c] + 1] = count[c];
+			}
+			for(size_t r = 1; r < start.size(); ++r) {
+				start[r] += start[r - 1];
+			}
+			std::vector < size_t > p (size_);
+			with_codes ([&] (const auto* x, const size_t n) {
+				for(size_t i = 0; i < n; ++i) {
+					p[start[rank[x[i]]]++] = i;
+				}
+			});
+			return p;
+		}
+
+		/*! \brief Returns the code in the dictionary of target of each code of the column, npos if absent.
+		 *  Translates the codes of a column to those of another: joins and comparisons
+		 *  between columns with different dictionaries then work on the codes.
+		 */
+		BOOST_UBLAS_INLINE
+		std::vector < code_type > recode (const dictionary_column& target) const {
+			const string_column& d = dictionary_->values;
+			std::vector < code_type > r (d.size());
+			for(size_t c = 0; c < d.size(); ++c) {
+				r[c] = (dictionary_ == target.dictionary_) ? code_type (c) : target.find (d(c));
+			}
+			return r;
+		}
+
+		/*! \brief Returns the elements at the positions sel(0) ... sel(n-1).
+		 *  Only the codes are gathered, the result shares the dictionary.
+		 */
+		BOOST_UBLAS_INLINE
+		dictionary_column select (const size_t* sel, const size_t n) const {
+			dictionary_column r;
+			r.dictionary_ = dictionary_;
+			r.width_ = width_;
+			r.size_ = n;
+			switch (width_) {
+				case 1: gather (codes8_, sel, n, r.codes8_); break;
+				case 2: gather (codes16_, sel, n, r.codes16_); break;
+				default: gather (codes32_, sel, n, r.codes32_);
+			}
+			return r;
+		}
+
+		BOOST_UBLAS_INLINE
+		void swap (dictionary_column& c) {
+			dictionary_.swap (c.dictionary_);
+			codes8_.swap (c.codes8_);
+			codes16_.swap (c.codes16_);
+			codes32_.swap (c.codes32_);
+			std::swap (width_, c.width_);
+			std::swap (size_, c.size_);
+		}
+
+		/*! \brief Returns \c true if both columns hold the same strings.
+		 *  A memcmp of the codes if the dictionary is shared, otherwise the codes of c are
+		 *  translated to the dictionary of self (one lookup per distinct string) and compared.
+		 */
+		BOOST_UBLAS_INLINE
+		bool operator == (const dictionary_column& c) const {
+			if (size_ != c.size_) {
+				return false;
+			}
+			if (dictionary_ == c.dictionary_ && width_ == c.width_) {
+				return std::memcmp (code_data(), c.code_data(), size_ * width_) == 0;
+			}
+			const std::vector < code_type > r = c.recode (*this);
+			for(size_t i = 0; i < size_; ++i) {
+				if (r[c.code (i)] != code (i)) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		BOOST_UBLAS_INLINE
+		bool operator != (const dictionary_column& c) const {
+			return !(*this == c);
+		}
+
+	private:
+		//! \brief Distinct strings and their index, shared between copies.
+		struct entries {
+			string_column values;
+			column_index index;
+		};
+
+		template < class T >
+		using code_array = std::vector < T, cache_aligned_allocator<T> >;
+
+		std::shared_ptr < entries > dictionary_;
+		//! \brief Codes, only the array of width \c width_ is used.
+		code_array < std::uint8_t > codes8_;
+		code_array < std::uint16_t > codes16_;
+		code_array < std::uint32_t > codes32_;
+		//! \brief Size of a code in bytes.
+		size_t width_;
+		size_t size_;
+
+		BOOST_UBLAS_INLINE
+		const void* code_data () const {
+			switch (width_) {
+				case 1: return codes8_.data();
+				case 2: return codes16_.data();
+				default: return codes32_.data();
+			}
+		}
+
+		template < class T >
+		static BOOST_UBLAS_INLINE
+		void gather (const code_array<T>& x, const size_t* sel, const size_t n, code_array<T>& out) {
+			out.resize (n);
+			for(size_t k = 0; k < n; ++k) {
+				out[k] = x[sel[k]];
+			}
+		}
+
+		//! \brief Widens the codes if they can't hold the code c.
+		BOOST_UBLAS_INLINE
+		void widen (const code_type c) {
+			if (width_ == 1 && c > 0xff) {
+				codes16_.assign (codes8_.begin(), codes8_.end());
+				code_array < std::uint8_t > ().swap (codes8_);
+				width_ = 2;
+			}
+			if (width_ == 2 && c > 0xffff) {
+				codes32_.assign (codes16_.begin(), codes16_.end());
+				code_array < std::uint16_t > ().swap (codes16_);
+				width_ = 4;
+			}
+		}
+	};
+
+}}}
+
+#endif
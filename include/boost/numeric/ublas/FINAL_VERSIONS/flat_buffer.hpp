@@ -0,0 +1,367 @@
+//          Copyright(C) Rishabh Arora 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Minimal reader and writer of FlatBuffers, the encoding of the metadata of the Arrow files.
+// A buffer starts with the u32 offset of its root table. A table starts with the i32 distance back
+// to its vtable: u16 size of the vtable, u16 size of the table, then the u16 offset of each field
+// in the table (0 if absent, the field then having its default value). Tables, vectors and strings
+// are referenced by u32 offsets, relative to where they are stored, to a later position. A vector is
+// a u32 length followed by its elements, a string a u32 length followed by its bytes and a '\0'.
+// Every scalar is aligned on its size from the start of the buffer, which is assumed aligned on 8.
+
+#ifndef _BOOST_UBLAS_DF_FLAT_BUFFER_
+#define _BOOST_UBLAS_DF_FLAT_BUFFER_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <string_view>
+#include <vector>
+#include <boost/numeric/ublas/detail/config.hpp>
+#include "./data_frame_exceptions.hpp"
+
+namespace boost { namespace numeric { namespace ublas {
+
+	class flat_vector;
+
+	/*! \brief Table of a FlatBuffer, read in place.
+	 *  Every read is checked against the size of the buffer and throws corrupt_file past it.
+	 */
+	class flat_table {
+	public:
+		BOOST_UBLAS_INLINE
+		flat_table ():
+			data_ (0),
+			size_ (0),
+			pos_ (0),
+			vtable_ (0),
+			vtable_size_ (0),
+			table_size_ (0) {}
+
+		//! \brief Table at pos in the size bytes at data.
+		BOOST_UBLAS_INLINE
+		flat_table (const char* data, const size_t size, const size_t pos):
+			data_ (data),
+			size_ (size),
+			pos_ (pos) {
+			const std::int64_t vtable = std::int64_t (pos) - read < std::int32_t > (data, size, pos);
+			if (vtable < 0 || std::uint64_t (vtable) > size) {
+				throw corrupt_file();
+			}
+			vtable_ = size_t (vtable);
+			vtable_size_ = read < std::uint16_t > (data, size, vtable_);
+			table_size_ = read < std::uint16_t > (data, size, vtable_ + 2);
+			if (vtable_size_ < 4 || vtable_size_ % 2 != 0 || vtable_size_ > size - vtable_ || table_size_ > size - pos_) {
+				throw corrupt_file();
+			}
+		}
+
+		//! \brief Returns the root table of the size bytes at data.
+		BOOST_UBLAS_INLINE
+		static flat_table root (const char* data, const size_t size) {
+			return flat_table (data, size, read < std::uint32_t > (data, size, 0));
+		}
+
+		//! \brief Returns \c false for a table absent from its parent.
+		BOOST_UBLAS_INLINE
+		bool valid () const {
+			return data_ != 0;
+		}
+
+		//! \brief Returns \c true if the field in slot is present.
+		BOOST_UBLAS_INLINE
+		bool has (const size_t slot) const {
+			return field (slot) != 0;
+		}
+
+		//! \brief Returns the scalar in slot, value if absent.
+		template < class T >
+		BOOST_UBLAS_INLINE
+		T scalar (const size_t slot, const T value) const {
+			const size_t o = field (slot);
+			if (o == 0) {
+				return value;
+			}
+			if (o + sizeof(T) > table_size_) {
+				throw corrupt_file();
+			}
+			return read < T > (data_, size_, pos_ + o);
+		}
+
+		//! \brief Returns the table in slot, an invalid table if absent.
+		BOOST_UBLAS_INLINE
+		flat_table table (const size_t slot) const {
+			const size_t p = target (slot);
+			return (p == 0) ? flat_table() : flat_table (data_, size_, p);
+		}
+
+		//! \brief Returns the string in slot, empty if absent.
+		BOOST_UBLAS_INLINE
+		std::string_view string (const size_t slot) const {
+			const size_t p = target (slot);
+			if (p == 0) {
+				return std::string_view();
+			}
+			const std::uint32_t n = read < std::uint32_t > (data_, size_, p);
+			if (n >= size_ - p - 4) {
+				throw corrupt_file();
+			}
+			return std::string_view (data_ + p + 4, n);
+		}
+
+		//! \brief Returns the vector in slot, of elements of stride bytes, empty if absent.
+		BOOST_UBLAS_INLINE
+		flat_vector vector (const size_t slot, const size_t stride) const;
+
+		//! \brief Reads a T at pos in the size bytes at data, throws corrupt_file past them.
+		template < class T >
+		BOOST_UBLAS_INLINE
+		static T read (const char* data, const size_t size, const size_t pos) {
+			if (pos > size || sizeof(T) > size - pos) {
+				throw corrupt_file();
+			}
+			T x;
+			std::memcpy (&x, data + pos, sizeof(T));
+			return x;
+		}
+
+	private:
+		const char* data_;
+		size_t size_;
+		size_t pos_;
+		size_t vtable_;
+		size_t vtable_size_;
+		size_t table_size_;
+
+		//! \brief Returns the offset of the field in slot from the table, 0 if absent.
+		BOOST_UBLAS_INLINE
+		size_t field (const size_t slot) const {
+			if (data_ == 0 || 4 + 2 * slot >= vtable_size_) {
+				return 0;
+			}
+			return read < std::uint16_t > (data_, size_, vtable_ + 4 + 2 * slot);
+		}
+
+		//! \brief Returns the position referenced by the offset in slot, 0 if absent.
+		BOOST_UBLAS_INLINE
+		size_t target (const size_t slot) const {
+			const size_t o = scalar < std::uint32_t > (slot, 0);
+			if (o == 0) {
+				return 0;
+			}
+			const size_t at = pos_ + field (slot);
+			if (o > size_ - at) {
+				throw corrupt_file();
+			}
+			return at + o;
+		}
+	};
+
+	//! \brief Vector of a FlatBuffer, of scalars, structs or tables, read in place.
+	class flat_vector {
+	public:
+		BOOST_UBLAS_INLINE
+		flat_vector ():
+			data_ (0),
+			size_ (0),
+			pos_ (0),
+			count_ (0),
+			stride_ (0) {}
+
+		//! \brief Vector at pos in the size bytes at data, of elements of stride bytes.
+		BOOST_UBLAS_INLINE
+		flat_vector (const char* data, const size_t size, const size_t pos, const size_t stride):
+			data_ (data),
+			size_ (size),
+			pos_ (pos + 4),
+			count_ (flat_table::read < std::uint32_t > (data, size, pos)),
+			stride_ (stride) {
+			if (count_ > (size - pos_) / stride) {
+				throw corrupt_file();
+			}
+		}
+
+		//! \brief Returns the number of elements.
+		BOOST_UBLAS_INLINE
+		size_t size () const {
+			return count_;
+		}
+
+		//! \brief Returns the T at offset in the ith element.
+		template < class T >
+		BOOST_UBLAS_INLINE
+		T get (const size_t i, const size_t offset = 0) const {
+			if (i >= count_ || offset + sizeof(T) > stride_) {
+				throw corrupt_file();
+			}
+			return flat_table::read < T > (data_, size_, pos_ + i * stride_ + offset);
+		}
+
+		//! \brief Returns the ith table, of a vector of tables.
+		BOOST_UBLAS_INLINE
+		flat_table table (const size_t i) const {
+			const size_t o = get < std::uint32_t > (i);
+			const size_t at = pos_ + i * stride_;
+			if (o == 0 || o > size_ - at) {
+				throw corrupt_file();
+			}
+			return flat_table (data_, size_, at + o);
+		}
+
+	private:
+		const char* data_;
+		size_t size_;
+		size_t pos_;
+		size_t count_;
+		size_t stride_;
+	};
+
+	BOOST_UBLAS_INLINE
+	flat_vector flat_table::vector (const size_t slot, const size_t stride) const {
+		const size_t p = target (slot);
+		return (p == 0) ? flat_vector() : flat_vector (data_, size_, p, stride);
+	}
+
+	//! \brief Field of a table written by flat_builder: a scalar, or an offset linked later.
+	struct flat_field {
+		size_t slot;
+		size_t size;
+		std::uint64_t value;
+	};
+
+	//! \brief Returns the field of a scalar x in slot.
+	template < class T >
+	BOOST_UBLAS_INLINE
+	flat_field flat_scalar (const size_t slot, const T x) {
+		flat_field f = {slot, sizeof(T), 0};
+		std::memcpy (&f.value, &x, sizeof(T));
+		return f;
+	}
+
+	//! \brief Returns the field of an offset in slot, see flat_builder::link().
+	BOOST_UBLAS_INLINE
+	flat_field flat_offset (const size_t slot) {
+		return flat_field {slot, sizeof(std::uint32_t), 0};
+	}
+
+	/*! \brief Writes a FlatBuffer front to back.
+	 *  Every object is written before the objects it references, its offsets being set by link()
+	 *  once they are written, so that the offsets point forward as FlatBuffers requires.
+	 *  A table is written after its vtable, its fields by decreasing size to keep them aligned.
+	 */
+	class flat_builder {
+	public:
+		BOOST_UBLAS_INLINE
+		flat_builder ():
+			buffer_ (sizeof(std::uint32_t), 0) {}
+
+		//! \brief Writes a table of fields, returns the positions of its fields by slot (0 if absent) and of the table last.
+		BOOST_UBLAS_INLINE
+		std::vector < size_t > table (std::initializer_list < flat_field > fields) {
+			size_t slots = 0;
+			size_t table_size = sizeof(std::int32_t);
+			for(const flat_field& f : fields) {
+				slots = std::max (slots, f.slot + 1);
+				table_size += f.size;
+			}
+			align (2, 0);
+			const size_t vtable = buffer_.size();
+			put (std::uint16_t (4 + 2 * slots));
+			put (std::uint16_t (table_size));
+			const size_t offsets = buffer_.size();
+			buffer_.resize (offsets + 2 * slots, 0);
+			align (8, 4);
+			const size_t table = buffer_.size();
+			put (std::int32_t (table - vtable));
+			std::vector < size_t > r (slots + 1, 0);
+			r[slots] = table;
+			for(size_t size = 8; size != 0; size /= 2) {
+				for(const flat_field& f : fields) {
+					if (f.size == size) {
+						const std::uint16_t o = std::uint16_t (buffer_.size() - table);
+						std::memcpy (&buffer_[offsets + 2 * f.slot], &o, sizeof(o));
+						r[f.slot] = buffer_.size();
+						buffer_.insert (buffer_.end(), reinterpret_cast<const char*> (&f.value), reinterpret_cast<const char*> (&f.value) + size);
+					}
+				}
+			}
+			return r;
+		}
+
+		//! \brief Writes a vector of count structs of size bytes, aligned on 8, returns its position.
+		BOOST_UBLAS_INLINE
+		size_t structs (const void* p, const size_t count, const size_t size) {
+			align (8, 4);
+			const size_t pos = buffer_.size();
+			put (std::uint32_t (count));
+			buffer_.insert (buffer_.end(), static_cast<const char*> (p), static_cast<const char*> (p) + count * size);
+			return pos;
+		}
+
+		//! \brief Writes a vector of count offsets, to link(), returns its position.
+		BOOST_UBLAS_INLINE
+		size_t offsets (const size_t count) {
+			align (4, 0);
+			const size_t pos = buffer_.size();
+			put (std::uint32_t (count));
+			buffer_.resize (buffer_.size() + 4 * count, 0);
+			return pos;
+		}
+
+		//! \brief Returns the position of the ith offset of the vector at pos.
+		BOOST_UBLAS_INLINE
+		static size_t element (const size_t pos, const size_t i) {
+			return pos + 4 + 4 * i;
+		}
+
+		//! \brief Writes a string, returns its position.
+		BOOST_UBLAS_INLINE
+		size_t string (const std::string_view s) {
+			align (4, 0);
+			const size_t pos = buffer_.size();
+			put (std::uint32_t (s.size()));
+			buffer_.insert (buffer_.end(), s.begin(), s.end());
+			buffer_.push_back ('\0');
+			return pos;
+		}
+
+		//! \brief Sets the offset at position at (a field or a vector element) to the object at target, written after it.
+		BOOST_UBLAS_INLINE
+		void link (const size_t at, const size_t target) {
+			const std::uint32_t o = std::uint32_t (target - at);
+			std::memcpy (&buffer_[at], &o, sizeof(o));
+		}
+
+		//! \brief Returns the buffer, the root being the table at root, padded to 8 bytes.
+		BOOST_UBLAS_INLINE
+		const std::vector < char >& finish (const size_t root) {
+			link (0, root);
+			align (8, 0);
+			return buffer_;
+		}
+
+	private:
+		std::vector < char > buffer_;
+
+		//! \brief Pads with zeros up to a position equal to r modulo a.
+		BOOST_UBLAS_INLINE
+		void align (const size_t a, const size_t r) {
+			while (buffer_.size() % a != r) {
+				buffer_.push_back (0);
+			}
+		}
+
+		template < class T >
+		BOOST_UBLAS_INLINE
+		void put (const T x) {
+			buffer_.insert (buffer_.end(), reinterpret_cast<const char*> (&x), reinterpret_cast<const char*> (&x) + sizeof(T));
+		}
+	};
+
+}}}
+
+#endif
@@ -0,0 +1,160 @@
+//          Copyright(C) Rishabh Arora 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Hash table from the rows of a data_frame to the ids of their groups, used by group_by and join.
+
+#ifndef _BOOST_UBLAS_DF_GROUP_TABLE_
+#define _BOOST_UBLAS_DF_GROUP_TABLE_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <boost/numeric/ublas/detail/config.hpp>
+
+namespace boost { namespace numeric { namespace ublas {
+
+	/*! \brief Open addressing hash table from rows to group ids.
+	 *  Linear probing over a power of two number of slots, kept at most half full.
+	 *  The keys are never copied: a group is represented by the first row inserted for it,
+	 *  a slot holds the hash of the row and the group id, and rows are compared through
+	 *  the predicate passed to \c insert(), which reads the key columns in place.
+	 *  Group ids are consecutive, in the order of the first row of each group.
+	 */
+	class group_table {
+	public:
+		//! \brief Group id of the empty slots.
+		static constexpr size_t npos = size_t(-1);
+
+		BOOST_UBLAS_INLINE
+		group_table () {}
+
+		//! \brief Returns the number of groups.
+		BOOST_UBLAS_INLINE
+		size_t size () const {
+			return rows_.size();
+		}
+
+		//! \brief Returns the first row of group g.
+		BOOST_UBLAS_INLINE
+		size_t row (const size_t g) const {
+			return rows_[g];
+		}
+
+		//! \brief Returns the hash of the rows of group g.
+		BOOST_UBLAS_INLINE
+		size_t hash (const size_t g) const {
+			return hashes_[g];
+		}
+
+		//! \brief Returns the first rows of the groups, by group id.
+		BOOST_UBLAS_INLINE
+		const std::vector < size_t >& rows () const {
+			return rows_;
+		}
+
+		//! \brief Reserves space for n groups.
+		BOOST_UBLAS_INLINE
+		void reserve (const size_t n) {
+			rows_.reserve (n);
+			hashes_.reserve (n);
+			if (2 * n > slots_.size()) {
+				size_t capacity = 16;
+				while (capacity < 2 * n) {
+					capacity *= 2;
+				}
+				grow (capacity);
+			}
+		}
+
+		/*! \brief Returns the group of row, h being its hash, creating the group if needed.
+		 *  equal(r1, r2) returns \c true if rows r1 and r2 have the same key.
+		 */
+		template < class E >
+		BOOST_UBLAS_INLINE
+		size_t insert (const size_t h, const size_t row, E equal) {
+			if (2 * (size() + 1) > slots_.size()) {
+				grow (slots_.empty() ? 16 : 2 * slots_.size());
+			}
+			const size_t mask = slots_.size() - 1;
+			size_t i = h & mask;
+			for(; slots_[i].group != npos; i = (i + 1) & mask) {
+				if (slots_[i].hash == h && equal (rows_[slots_[i].group], row)) {
+					return slots_[i].group;
+				}
+			}
+			slots_[i].hash = h;
+			slots_[i].group = size();
+			rows_.push_back (row);
+			hashes_.push_back (h);
+			return slots_[i].group;
+		}
+
+		/*! \brief Returns the group of the key hashed to h, npos if there is none.
+		 *  equal(r) returns \c true if row r, the first row of a group, has the searched key.
+		 */
+		template < class E >
+		BOOST_UBLAS_INLINE
+		size_t find (const size_t h, E equal) const {
+			if (slots_.empty()) {
+				return npos;
+			}
+			const size_t mask = slots_.size() - 1;
+			for(size_t i = h & mask; slots_[i].group != npos; i = (i + 1) & mask) {
+				if (slots_[i].hash == h && equal (rows_[slots_[i].group])) {
+					return slots_[i].group;
+				}
+			}
+			return npos;
+		}
+
+		//! \brief Removes all the groups.
+		BOOST_UBLAS_INLINE
+		void clear () {
+			slots_.clear();
+			rows_.clear();
+			hashes_.clear();
+		}
+
+		BOOST_UBLAS_INLINE
+		void swap (group_table& t) {
+			slots_.swap (t.slots_);
+			rows_.swap (t.rows_);
+			hashes_.swap (t.hashes_);
+		}
+
+	private:
+		struct slot {
+			slot ():
+				hash (0),
+				group (npos) {}
+			size_t hash;
+			size_t group;
+		};
+
+		//! \brief Slots of the table, empty if \c group == npos.
+		std::vector < slot > slots_;
+		//! \brief First row of each group.
+		std::vector < size_t > rows_;
+		//! \brief Hash of each group.
+		std::vector < size_t > hashes_;
+
+		BOOST_UBLAS_INLINE
+		void grow (const size_t capacity) {
+			slots_.assign (capacity, slot());
+			const size_t mask = capacity - 1;
+			for(size_t g = 0; g < hashes_.size(); ++g) {
+				size_t i = hashes_[g] & mask;
+				while (slots_[i].group != npos) {
+					i = (i + 1) & mask;
+				}
+				slots_[i].hash = hashes_[g];
+				slots_[i].group = g;
+			}
+		}
+	};
+
+}}}
+
+#endif
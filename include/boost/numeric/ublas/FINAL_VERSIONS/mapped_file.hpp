@@ -0,0 +1,177 @@
+//          Copyright(C) Rishabh Arora 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Read only view of a whole file, memory mapped on POSIX systems and read into memory elsewhere.
+// The bytes are aligned on column_alignment (the page size when mapped).
+
+#ifndef _BOOST_UBLAS_DF_MAPPED_FILE_
+#define _BOOST_UBLAS_DF_MAPPED_FILE_
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <boost/numeric/ublas/detail/config.hpp>
+#include "./column_allocator.hpp"
+#include "./data_frame_exceptions.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BOOST_UBLAS_DF_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace boost { namespace numeric { namespace ublas {
+
+	/*! \brief Bytes of a file, mapped read only.
+	 *  The pages are loaded by the kernel on first access, so threads reading distinct parts
+	 *  of the file load them in parallel and nothing is copied.
+	 *  Without mmap the file is read into a buffer.
+	 *  A copy on write mapping can be written to: the pages written are copied, the file is never modified.
+	 *  A reader going through the whole file (e.g. read_csv) can ask for it to be prefetched at once,
+	 *  one reading parts of it (e.g. the Parquet reader) for these parts only, see prefetch().
+	 */
+	class mapped_file {
+	public:
+		BOOST_UBLAS_INLINE
+		mapped_file ():
+			data_ (0),
+			size_ (0),
+			mapped_ (false) {}
+
+		/*! \brief Maps the file at path, copy on write if \c copy_on_write, terminates if it can't be opened.
+		 *  If \c prefetch the kernel is asked to read the whole file ahead of the first accesses.
+		 */
+		BOOST_UBLAS_INLINE
+		explicit mapped_file (const std::string& path, const bool copy_on_write = false, const bool prefetch = false):
+			mapped_file () {
+			open (path, copy_on_write, prefetch);
+		}
+
+		mapped_file (const mapped_file&) = delete;
+		mapped_file& operator = (const mapped_file&) = delete;
+
+		BOOST_UBLAS_INLINE
+		~mapped_file () {
+			close();
+		}
+
+		//! \brief Returns the bytes of the file.
+		BOOST_UBLAS_INLINE
+		const char* data () const {
+			return data_;
+		}
+
+		//! \brief Returns the number of bytes of the file.
+		BOOST_UBLAS_INLINE
+		size_t size () const {
+			return size_;
+		}
+
+		//! \brief Maps the file at path, copy on write if \c copy_on_write, prefetched if \c prefetch, terminates if it can't be opened.
+		BOOST_UBLAS_INLINE
+		void open (const std::string& path, const bool copy_on_write = false, const bool prefetch = false) {
+			close();
+			try {
+				if (!map (path, copy_on_write, prefetch) && !read (path)) {
+					throw unreadable_file();
+				}
+			}
+			catch (std::exception& e) {
+				std::terminate();
+			}
+		}
+
+		//! \brief Asks the kernel to read the length bytes at offset ahead of their first access, if the file is mapped.
+		BOOST_UBLAS_INLINE
+		void prefetch (const size_t offset, const size_t length) const {
+#ifdef BOOST_UBLAS_DF_MMAP
+			if (mapped_ && offset < size_ && length != 0) {
+				const size_t page = size_t (::sysconf (_SC_PAGESIZE));
+				const size_t first = offset / page * page;
+				::madvise (const_cast<char*> (data_) + first, std::min (offset + length, size_) - first, MADV_WILLNEED);
+			}
+#endif
+		}
+
+		//! \brief Unmaps the file.
+		BOOST_UBLAS_INLINE
+		void close () {
+#ifdef BOOST_UBLAS_DF_MMAP
+			if (mapped_) {
+				::munmap (const_cast<char*> (data_), size_);
+			}
+#endif
+			std::vector < char, cache_aligned_allocator<char> > ().swap (buffer_);
+			data_ = 0;
+			size_ = 0;
+			mapped_ = false;
+		}
+
+	private:
+		const char* data_;
+		size_t size_;
+		//! \brief \c true if data_ is a mapping, else it points into buffer_.
+		bool mapped_;
+		std::vector < char, cache_aligned_allocator<char> > buffer_;
+
+		//! \brief Maps the file, returns \c false if it can't be mapped.
+		BOOST_UBLAS_INLINE
+		bool map (const std::string& path, const bool copy_on_write, const bool prefetch) {
+#ifdef BOOST_UBLAS_DF_MMAP
+			const int fd = ::open (path.c_str(), O_RDONLY);
+			if (fd < 0) {
+				return false;
+			}
+			struct stat st;
+			if (::fstat (fd, &st) != 0 || !S_ISREG (st.st_mode)) {
+				::close (fd);
+				return false;
+			}
+			size_ = st.st_size;
+			if (size_ != 0) {
+				void* p = ::mmap (0, size_, copy_on_write ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, fd, 0);
+				if (p == MAP_FAILED) {
+					::close (fd);
+					size_ = 0;
+					return false;
+				}
+				if (prefetch) {
+					::madvise (p, size_, MADV_WILLNEED);
+				}
+				data_ = static_cast<const char*> (p);
+				mapped_ = true;
+			}
+			::close (fd);
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		//! \brief Reads the file into buffer_, returns \c false if it can't be read.
+		BOOST_UBLAS_INLINE
+		bool read (const std::string& path) {
+			std::ifstream in (path, std::ios::binary | std::ios::ate);
+			if (!in) {
+				return false;
+			}
+			buffer_.resize (static_cast<size_t> (in.tellg()));
+			in.seekg (0);
+			if (!in.read (buffer_.data(), buffer_.size())) {
+				return false;
+			}
+			data_ = buffer_.data();
+			size_ = buffer_.size();
+			return true;
+		}
+	};
+
+}}}
+
+#endif
@@ -0,0 +1,119 @@
+//          Copyright(C) Rishabh Arora 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Decompressor of the Snappy format, the default compression of the Parquet pages.
+// The uncompressed length comes first as a varint, then the elements, the low 2 bits of their tag
+// giving their kind: a literal (0) of up to 60 bytes, or whose length - 1 follows in 1 to 4 bytes,
+// or a copy of earlier output, of 4 to 11 bytes at an 11 bit offset (1), of up to 64 bytes at a
+// 16 bit offset (2) or at a 32 bit offset (3).
+
+#ifndef _BOOST_UBLAS_DF_SNAPPY_
+#define _BOOST_UBLAS_DF_SNAPPY_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <boost/numeric/ublas/detail/config.hpp>
+#include "./data_frame_exceptions.hpp"
+
+namespace boost { namespace numeric { namespace ublas {
+
+	//! \brief Returns the uncompressed length of the n Snappy bytes at in, throws corrupt_file if they are damaged.
+	BOOST_UBLAS_INLINE
+	size_t snappy_length (const char* in, const size_t n) {
+		std::uint64_t x = 0;
+		for(size_t i = 0; i < n && i < 5; ++i) {
+			x |= std::uint64_t (static_cast<std::uint8_t> (in[i]) & 0x7f) << (7 * i);
+			if ((static_cast<std::uint8_t> (in[i]) & 0x80) == 0) {
+				return size_t (x);
+			}
+		}
+		throw corrupt_file();
+	}
+
+	/*! \brief Decompresses the n Snappy bytes at in into the size bytes at out.
+	 *  Throws corrupt_file unless they hold exactly size bytes.
+	 */
+	BOOST_UBLAS_INLINE
+	void snappy_uncompress (const char* in, const size_t n, char* out, const size_t size) {
+		if (snappy_length (in, n) != size) {
+			throw corrupt_file();
+		}
+		const std::uint8_t* p = reinterpret_cast<const std::uint8_t*> (in);
+		const std::uint8_t* end = p + n;
+		while (*p++ & 0x80) {}
+		size_t o = 0;
+		while (p < end) {
+			const std::uint8_t tag = *p++;
+			size_t length;
+			size_t offset;
+			switch (tag & 3) {
+				case 0: {
+					length = (tag >> 2) + 1;
+					if (length > 60) {
+						const size_t bytes = length - 60;
+						if (size_t (end - p) < bytes) {
+							throw corrupt_file();
+						}
+						length = 0;
+						for(size_t i = 0; i < bytes; ++i) {
+							length |= size_t (p[i]) << (8 * i);
+						}
+						length += 1;
+						p += bytes;
+					}
+					if (size_t (end - p) < length || size - o < length) {
+						throw corrupt_file();
+					}
+					std::memcpy (out + o, p, length);
+					p += length;
+					o += length;
+					continue;
+				}
+				case 1:
+					if (end - p < 1) {
+						throw corrupt_file();
+					}
+					length = ((tag >> 2) & 7) + 4;
+					offset = (size_t (tag >> 5) << 8) | p[0];
+					p += 1;
+					break;
+				case 2:
+					if (end - p < 2) {
+						throw corrupt_file();
+					}
+					length = (tag >> 2) + 1;
+					offset = size_t (p[0]) | (size_t (p[1]) << 8);
+					p += 2;
+					break;
+				default:
+					if (end - p < 4) {
+						throw corrupt_file();
+					}
+					length = (tag >> 2) + 1;
+					offset = size_t (p[0]) | (size_t (p[1]) << 8) | (size_t (p[2]) << 16) | (size_t (p[3]) << 24);
+					p += 4;
+			}
+			if (offset == 0 || offset > o || size - o < length) {
+				throw corrupt_file();
+			}
+			if (offset >= length) {
+				std::memcpy (out + o, out + o - offset, length);
+				o += length;
+				continue;
+			}
+			// the copy overlaps its own output (a repeated pattern), hence byte by byte
+			for(size_t i = 0; i < length; ++i, ++o) {
+				out[o] = out[o - offset];
+			}
+		}
+		if (o != size) {
+			throw corrupt_file();
+		}
+	}
+
+}}}
+
+#endif
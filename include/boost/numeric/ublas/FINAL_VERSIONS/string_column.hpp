@@ -0,0 +1,237 @@
+//          Copyright(C) Rishabh Arora 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// String column in the layout of Apache Arrow: the bytes of all the strings in a single
+// contiguous buffer and an array of n + 1 offsets, string i being bytes [offsets(i), offsets(i+1)).
+
+#ifndef _BOOST_UBLAS_DF_STRING_COLUMN_
+#define _BOOST_UBLAS_DF_STRING_COLUMN_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <boost/numeric/ublas/vector.hpp>
+#include "./column_allocator.hpp"
+#include "./data_frame_exceptions.hpp"
+
+namespace boost { namespace numeric { namespace ublas {
+
+	/*! \brief Column of strings stored as offsets and one contiguous byte buffer.
+	 *  O is the type of the offsets: std::uint32_t (string_column, up to 4 GB of characters)
+	 *  or std::uint64_t (large_string_column).
+	 *  Elements are accessed as std::string_view, valid until the column is modified.
+	 */
+	template < class O >
+	class basic_string_column {
+	public:
+		typedef O offset_type;
+		typedef std::string_view value_type;
+		typedef std::string_view const_reference;
+		typedef size_t size_type;
+		typedef std::vector < O, cache_aligned_allocator<O> > offset_array;
+		typedef std::vector < char, cache_aligned_allocator<char> > byte_array;
+
+		//! \brief Empty column.
+		BOOST_UBLAS_INLINE
+		basic_string_column ():
+			offsets_ (1, 0) {}
+
+		//! \brief Column of n empty strings.
+		BOOST_UBLAS_INLINE
+		explicit basic_string_column (const size_t n):
+			offsets_ (n + 1, 0) {}
+
+		//! \brief Column holding a copy of the strings of v.
+		template < class A >
+		BOOST_UBLAS_INLINE
+		explicit basic_string_column (const vector < std::string, A >& v):
+			offsets_ (1, 0) {
+			size_t bytes = 0;
+			for(size_t i = 0; i < v.size(); ++i) {
+				bytes += v(i).size();
+			}
+			reserve (v.size(), bytes);
+			for(size_t i = 0; i < v.size(); ++i) {
+				push_back (v(i));
+			}
+		}
+
+		BOOST_UBLAS_INLINE
+		basic_string_column (std::initializer_list < std::string_view > l):
+			offsets_ (1, 0) {
+			for(std::string_view s: l) {
+				push_back (s);
+			}
+		}
+
+		//! \brief Returns the number of strings.
+		BOOST_UBLAS_INLINE
+		size_t size() const {
+			return offsets_.size() - 1;
+		}
+
+		BOOST_UBLAS_INLINE
+		bool empty() const {
+			return size() == 0;
+		}
+
+		//! \brief Returns the total number of characters.
+		BOOST_UBLAS_INLINE
+		size_t byte_size() const {
+			return offsets_.back();
+		}
+
+		//! \brief Returns the length of the string i.
+		BOOST_UBLAS_INLINE
+		size_t length (const size_t i) const {
+			return offsets_[i + 1] - offsets_[i];
+		}
+
+		//! \brief Returns the string i.
+		BOOST_UBLAS_INLINE
+		std::string_view operator () (const size_t i) const {
+			return std::string_view (bytes_.data() + offsets_[i], offsets_[i + 1] - offsets_[i]);
+		}
+
+		//! \brief Returns the string i.
+		BOOST_UBLAS_INLINE
+		std::string_view operator [] (const size_t i) const {
+			return (*this)(i);
+		}
+
+		//! \brief Appends a string, amortized O(length of s).
+		BOOST_UBLAS_INLINE
+		void push_back (const std::string_view s) {
+			try {
+				if (s.size() > size_t(std::numeric_limits<O>::max() - offsets_.back())) {
+					throw offset_overflow();
+				}
+			}
+			catch (std::exception& e) {
+				std::terminate();
+			}
+			bytes_.insert (bytes_.end(), s.begin(), s.end());
+			offsets_.push_back (static_cast<O> (offsets_.back() + s.size()));
+		}
+
+		//! \brief Reserves space for n strings of \c bytes characters in total.
+		BOOST_UBLAS_INLINE
+		void reserve (const size_t n, const size_t bytes) {
+			offsets_.reserve (n + 1);
+			bytes_.reserve (bytes);
+		}
+
+		//! \brief Removes all the strings.
+		BOOST_UBLAS_INLINE
+		void clear () {
+			offsets_.assign (1, 0);
+			bytes_.clear();
+		}
+
+		//! \brief Returns \c true if the string i is s.
+		BOOST_UBLAS_INLINE
+		bool equals (const size_t i, const std::string_view s) const {
+			return length (i) == s.size() && std::memcmp (bytes_.data() + offsets_[i], s.data(), s.size()) == 0;
+		}
+
+		//! \brief Returns \c true if the string i starts with prefix.
+		BOOST_UBLAS_INLINE
+		bool starts_with (const size_t i, const std::string_view prefix) const {
+			return length (i) >= prefix.size() && std::memcmp (bytes_.data() + offsets_[i], prefix.data(), prefix.size()) == 0;
+		}
+
+		//! \brief Returns the hash of the string i, same as std::hash < std::string_view >.
+		BOOST_UBLAS_INLINE
+		size_t hash (const size_t i) const {
+			return std::hash < std::string_view > () ((*this)(i));
+		}
+
+		//! \brief Returns the n + 1 offsets.
+		BOOST_UBLAS_INLINE
+		const O* offsets() const {
+			return offsets_.data();
+		}
+
+		//! \brief Returns the characters of all the strings.
+		BOOST_UBLAS_INLINE
+		const char* bytes() const {
+			return bytes_.data();
+		}
+
+		/*! \brief Returns the offsets, to fill the column in bulk.
+		 *  Must hold \c size() + 1 non-decreasing offsets, the first one being 0
+		 *  and the last one the size of the byte buffer.
+		 */
+		BOOST_UBLAS_INLINE
+		offset_array& offset_buffer() {
+			return offsets_;
+		}
+
+		//! \brief Returns the characters, to fill the column in bulk.
+		BOOST_UBLAS_INLINE
+		byte_array& byte_buffer() {
+			return bytes_;
+		}
+
+		//! \brief Returns the strings at the positions sel(0) ... sel(n-1).
+		BOOST_UBLAS_INLINE
+		basic_string_column select (const size_t* sel, const size_t n) const {
+			size_t bytes = 0;
+			for(size_t k = 0; k < n; ++k) {
+				bytes += length (sel[k]);
+			}
+			basic_string_column r;
+			r.reserve (n, bytes);
+			for(size_t k = 0; k < n; ++k) {
+				const char* s = bytes_.data() + offsets_[sel[k]];
+				r.bytes_.insert (r.bytes_.end(), s, s + length (sel[k]));
+				r.offsets_.push_back (static_cast<O> (r.bytes_.size()));
+			}
+			return r;
+		}
+
+		BOOST_UBLAS_INLINE
+		void swap (basic_string_column& c) {
+			offsets_.swap (c.offsets_);
+			bytes_.swap (c.bytes_);
+		}
+
+		/*! \brief Returns \c true if both columns hold the same strings.
+		 *  Two memcmp: equal strings means equal offsets and equal bytes.
+		 */
+		BOOST_UBLAS_INLINE
+		bool operator == (const basic_string_column& c) const {
+			return offsets_.size() == c.offsets_.size() &&
+				std::memcmp (offsets_.data(), c.offsets_.data(), offsets_.size() * sizeof(O)) == 0 &&
+				std::memcmp (bytes_.data(), c.bytes_.data(), byte_size()) == 0;
+		}
+
+		BOOST_UBLAS_INLINE
+		bool operator != (const basic_string_column& c) const {
+			return !(*this == c);
+		}
+
+	private:
+		//! \brief size() + 1 offsets into bytes_.
+		offset_array offsets_;
+		//! \brief Characters of all the strings, one after the other.
+		byte_array bytes_;
+	};
+
+	//! \brief String column with 32 bit offsets.
+	typedef basic_string_column < std::uint32_t > string_column;
+
+	//! \brief String column with 64 bit offsets, for more than 4 GB of characters.
+	typedef basic_string_column < std::uint64_t > large_string_column;
+
+}}}
+
+#endif
@@ -0,0 +1,227 @@
+//          Copyright(C) Rishabh Arora 2017.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Reader of the Thrift compact protocol, the encoding of the metadata of the Parquet files.
+// A struct is a sequence of fields ended by a 0 byte. A field starts with a byte holding the
+// difference of its id with the previous one (high 4 bits, 0 if the id follows as a zigzag varint)
+// and its type (low 4 bits), the value of a bool field being its type. Integers are zigzag varints
+// (i8 a single byte), binaries a varint length and the bytes, doubles 8 little endian bytes.
+// A list starts with a byte holding its size (high 4 bits, 15 if a varint follows) and the type of
+// its elements, a map with the varint size and, if not empty, a byte of the key and value types.
+
+#ifndef _BOOST_UBLAS_DF_THRIFT_COMPACT_
+#define _BOOST_UBLAS_DF_THRIFT_COMPACT_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <boost/numeric/ublas/detail/config.hpp>
+#include "./data_frame_exceptions.hpp"
+
+namespace boost { namespace numeric { namespace ublas {
+
+	/*! \brief Reads values of the Thrift compact protocol in place.
+	 *  Every read is checked against the end of the bytes and throws corrupt_file past it.
+	 */
+	class thrift_reader {
+	public:
+		//! \brief Types of the fields and elements.
+		enum field_type {
+			stop = 0,
+			boolean_true = 1,
+			boolean_false = 2,
+			byte = 3,
+			i16 = 4,
+			i32 = 5,
+			i64 = 6,
+			real = 7,
+			binary = 8,
+			list = 9,
+			set = 10,
+			map = 11,
+			structure = 12
+		};
+
+		//! \brief Maximum nesting of the structs and containers skipped.
+		static constexpr size_t max_depth = 64;
+
+		BOOST_UBLAS_INLINE
+		thrift_reader (const char* data, const size_t size):
+			begin_ (data),
+			p_ (data),
+			end_ (data + size) {}
+
+		//! \brief Returns the number of bytes read.
+		BOOST_UBLAS_INLINE
+		size_t position () const {
+			return p_ - begin_;
+		}
+
+		BOOST_UBLAS_INLINE
+		std::uint8_t read_byte () {
+			if (p_ == end_) {
+				throw corrupt_file();
+			}
+			return static_cast<std::uint8_t> (*p_++);
+		}
+
+		BOOST_UBLAS_INLINE
+		std::uint64_t read_varint () {
+			std::uint64_t x = 0;
+			for(unsigned shift = 0; shift < 64; shift += 7) {
+				const std::uint8_t b = read_byte();
+				x |= std::uint64_t (b & 0x7f) << shift;
+				if ((b & 0x80) == 0) {
+					return x;
+				}
+			}
+			throw corrupt_file();
+		}
+
+		//! \brief Reads an integer of the given type (i8, i16, i32 or i64).
+		BOOST_UBLAS_INLINE
+		std::int64_t read_integer (const int type) {
+			if (type == byte) {
+				return static_cast<std::int8_t> (read_byte());
+			}
+			const std::uint64_t x = read_varint();
+			return std::int64_t (x >> 1) ^ -std::int64_t (x & 1);
+		}
+
+		BOOST_UBLAS_INLINE
+		double read_real () {
+			if (end_ - p_ < 8) {
+				throw corrupt_file();
+			}
+			double x;
+			std::memcpy (&x, p_, sizeof(x));
+			p_ += sizeof(x);
+			return x;
+		}
+
+		BOOST_UBLAS_INLINE
+		std::string_view read_binary () {
+			const std::uint64_t n = read_varint();
+			if (n > std::uint64_t (end_ - p_)) {
+				throw corrupt_file();
+			}
+			p_ += n;
+			return std::string_view (p_ - n, n);
+		}
+
+		//! \brief Reads the header of a list or a set, returns its size and sets the type of its elements.
+		BOOST_UBLAS_INLINE
+		size_t read_list (int& type) {
+			const std::uint8_t b = read_byte();
+			type = b & 0x0f;
+			const size_t n = (b >> 4) == 15 ? read_varint() : (b >> 4);
+			if (n > size_t (end_ - p_)) {
+				throw corrupt_file();
+			}
+			return n;
+		}
+
+		/*! \brief Reads the fields of a struct, calling fn(id, type) for each of them.
+		 *  fn reads the value of the field and returns \c true, or returns \c false to skip it.
+		 *  The value of a bool field is its type, see value().
+		 */
+		template < class F >
+		BOOST_UBLAS_INLINE
+		void read_struct (F fn) {
+			std::int64_t id = 0;
+			for(;;) {
+				const std::uint8_t b = read_byte();
+				if (b == stop) {
+					return;
+				}
+				const int type = b & 0x0f;
+				id = (b >> 4) != 0 ? id + (b >> 4) : read_integer (i16);
+				if (!fn (id, type)) {
+					skip (type);
+				}
+			}
+		}
+
+		//! \brief Returns the value of a bool field of the given type.
+		BOOST_UBLAS_INLINE
+		static bool value (const int type) {
+			return type == boolean_true;
+		}
+
+		//! \brief Skips a value of the given type.
+		BOOST_UBLAS_INLINE
+		void skip (const int type, const size_t depth = 0) {
+			if (depth > max_depth) {
+				throw corrupt_file();
+			}
+			switch (type) {
+				case boolean_true:
+				case boolean_false:
+					return;
+				case byte:
+					read_byte();
+					return;
+				case i16:
+				case i32:
+				case i64:
+					read_varint();
+					return;
+				case real:
+					read_real();
+					return;
+				case binary:
+					read_binary();
+					return;
+				case list:
+				case set: {
+					int element;
+					const size_t n = read_list (element);
+					for(size_t i = 0; i < n; ++i) {
+						skip_element (element, depth + 1);
+					}
+					return;
+				}
+				case map: {
+					const size_t n = read_varint();
+					if (n != 0) {
+						const std::uint8_t types = read_byte();
+						for(size_t i = 0; i < n; ++i) {
+							skip_element (types >> 4, depth + 1);
+							skip_element (types & 0x0f, depth + 1);
+						}
+					}
+					return;
+				}
+				case structure:
+					read_struct ([this, depth] (std::int64_t, const int t) {
+						skip (t, depth + 1);
+						return true;
+					});
+					return;
+			}
+			throw corrupt_file();
+		}
+
+	private:
+		const char* begin_;
+		const char* p_;
+		const char* end_;
+
+		//! \brief Skips an element of a container, the bools of which are a byte each.
+		BOOST_UBLAS_INLINE
+		void skip_element (const int type, const size_t depth) {
+			if (type == boolean_true || type == boolean_false) {
+				read_byte();
+			}
+			else {
+				skip (type, depth);
+			}
+		}
+	};
+
+}}}
+
+#endif
@@ -11,10 +11,36 @@
 #define BOOST_TEST_MODULE  DATA_FRAME
 
 #include <boost/test/unit_test.hpp>
+#include <thread>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
 #include "../include/boost/numeric/ublas/FINAL_VERSIONS/df.hpp"
+#include "../include/boost/numeric/ublas/FINAL_VERSIONS/df_csv.hpp"
+#include "../include/boost/numeric/ublas/FINAL_VERSIONS/df_file.hpp"
+#include "../include/boost/numeric/ublas/FINAL_VERSIONS/df_arrow.hpp"
+#include "../include/boost/numeric/ublas/FINAL_VERSIONS/df_parquet.hpp"
 using namespace boost::numeric::ublas; 
 
 
+//! Returns true if fn() terminates the process, running it in a child process.
+template < class F >
+bool terminates(F fn) {
+	std::cout.flush();
+	const pid_t pid = fork();
+	if (pid == 0) {
+		std::signal(SIGABRT, SIG_DFL);
+		fn();
+		_exit(0);
+	}
+	int status = 0;
+	waitpid(pid, &status, 0);
+	return !(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
 BOOST_AUTO_TEST_CASE (df_column_constructors) {
 	//  default constructor
 	df_column c1;
@@ -61,6 +87,122 @@ BOOST_AUTO_TEST_CASE (df_column_assignment) {
 	}
 }
 
+BOOST_AUTO_TEST_CASE (df_column_Move_Semantics) {
+	vector < int > x(100);
+	for(size_t i = 0; i < 100; ++i) x(i) = i;
+	df_column A(x);
+	const int* buffer = &A.get<int>()(0);
+
+	// moves hand the buffer over
+	df_column B(std::move(A));
+	BOOST_CHECK(B.size() == 100 && A.size() == 0);
+	BOOST_CHECK(&B.get<int>()(0) == buffer);
+	df_column C;
+	C = std::move(B);
+	BOOST_CHECK(C.size() == 100 && &C.get<int>()(0) == buffer);
+
+	// a moved vector<T> sets the size of the column
+	df_column D(vector < double > (7, 1.5));
+	BOOST_CHECK(D.size() == 7 && D.get<double>()(6) == 1.5);
+	D = vector < double > (3, 2.5);
+	BOOST_CHECK(D.size() == 3 && D.get<double>()(2) == 2.5);
+
+	// release and adopt exchange buffers without copy
+	column_vector < int > v;
+	C.release(v);
+	BOOST_CHECK(C.size() == 0 && v.size() == 100);
+	BOOST_CHECK(&v(0) == buffer && v(42) == 42);
+	df_column E;
+	E.adopt(v);
+	BOOST_CHECK(E.size() == 100 && v.size() == 0);
+	BOOST_CHECK(&E.get<int>()(0) == buffer);
+	df_column F(std::move(E.get<int>()));
+	BOOST_CHECK(F.size() == 100 && &F.get<int>()(0) == buffer);
+
+	// frames take their columns without copy
+	vector < std::string > headers(2);
+	headers(0) = "a", headers(1) = "b";
+	vector < df_column > cols(2);
+	cols(0).adopt(column_vector < int > (10));
+	cols(1).adopt(column_vector < int > (10));
+	const int* a = &cols(0).get<int>()(0);
+	data_frame df(headers, std::move(cols));
+	BOOST_CHECK(df.ncol() == 2 && df.nrow() == 10);
+	BOOST_CHECK(&df["a"].get<int>()(0) == a);
+	data_frame df2(std::move(df));
+	BOOST_CHECK(df2.ncol() == 2 && df.ncol() == 0);
+	BOOST_CHECK(&df2["a"].get<int>()(0) == a);
+	df2.set_col_header("a", "c");
+	BOOST_CHECK(&df2["c"].get<int>()(0) == a);
+}
+
+BOOST_AUTO_TEST_CASE (df_column_Copy_On_Write) {
+	vector < int > x(100);
+	for(size_t i = 0; i < 100; ++i) x(i) = i;
+	df_column A(x);
+	df_column B(A), C;
+	C = A;
+	const df_column& a = A;
+	const df_column& b = B;
+	const df_column& c = C;
+	// copies share the buffer until written
+	BOOST_CHECK(&a.get<int>()(0) == &b.get<int>()(0));
+	BOOST_CHECK(&a.get<int>()(0) == &c.get<int>()(0));
+	BOOST_CHECK(!A.data().unique());
+
+	// a write gives the column its own buffer
+	B.get<int>()(0) = 42;
+	BOOST_CHECK(a.get<int>()(0) == 0 && c.get<int>()(0) == 0 && b.get<int>()(0) == 42);
+	BOOST_CHECK(&a.get<int>()(0) != &b.get<int>()(0));
+	BOOST_CHECK(B.data().unique());
+
+	// in place operations on a shared buffer leave the other copies untouched
+	C += 1;
+	for(size_t i = 0; i < 100; ++i) {
+		BOOST_CHECK(a.get<int>()(i) == (int)i && c.get<int>()(i) == (int)i + 1);
+	}
+	BOOST_CHECK(A.data().unique());
+	const int* buffer = &a.get<int>()(0);
+	A *= 2;
+	BOOST_CHECK(&a.get<int>()(0) == buffer && a.get<int>()(99) == 198);
+
+	// copies written in place on two threads, the kernel of one reading the storage the other then owns alone
+	for(size_t k = 0; k < 20; ++k) {
+		vector < int > big(100000, 1);
+		df_column A1(big);
+		df_column A2 = A1;
+		std::thread t ([&A1] () { A1 *= 2; });
+		A2 *= 3;
+		A2 += 1;
+		t.join();
+		const df_column& a1 = A1;
+		const df_column& a2 = A2;
+		BOOST_CHECK(a1.get<int>()(0) == 2 && a1.get<int>()(99999) == 2);
+		BOOST_CHECK(a2.get<int>()(0) == 4 && a2.get<int>()(99999) == 4);
+	}
+
+	// frame copies and proxies share the column buffers
+	vector < std::string > headers(2);
+	headers(0) = "a", headers(1) = "b";
+	vector < df_column > cols(2);
+	cols(0) = x, cols(1) = x;
+	data_frame df(headers, cols);
+	const data_frame& cdf = df;
+	data_frame df2(df);
+	const data_frame& cdf2 = df2;
+	BOOST_CHECK(&cdf["a"].get<int>()(0) == &cdf2["a"].get<int>()(0));
+	BOOST_CHECK(&cdf[1].get<int>()(0) == &cdf2[1].get<int>()(0));
+	data_frame df3 = data_frame_range(&df, range(1, 2)).DataFrame();
+	const data_frame& cdf3 = df3;
+	BOOST_CHECK(&cdf["b"].get<int>()(0) == &cdf3["b"].get<int>()(0));
+	df2["a"].get<int>()(5) = -1;
+	BOOST_CHECK(cdf["a"].get<int>()(5) == 5 && cdf2["a"].get<int>()(5) == -1);
+	BOOST_CHECK(&cdf["b"].get<int>()(0) == &cdf2["b"].get<int>()(0));
+	// reading rows does not copy
+	df2(3);
+	BOOST_CHECK(&cdf["b"].get<int>()(0) == &cdf2["b"].get<int>()(0));
+}
+
 BOOST_AUTO_TEST_CASE (df_column_Equality_Check_Operators) {
 	vector < double > a(3);
 	a(0) = 1.1;
@@ -152,6 +294,143 @@ BOOST_AUTO_TEST_CASE (df_column_Binary_Operators) {
 	}
 }
 
+BOOST_AUTO_TEST_CASE (df_column_Kernel_Operations) {
+	vector < double > a(100), b(100);
+	for(size_t i = 0; i < 100; ++i) a(i) = i * 0.5, b(i) = 100.0 - i;
+	df_column A(a), B(b);
+
+	// output buffer provided by the caller is reused
+	df_column out(a);
+	const double* buffer = &out.get<double>()(0);
+	column_add(A, B, out);
+	BOOST_CHECK(&out.get<double>()(0) == buffer);
+	for(size_t i = 0; i < 100; ++i) {
+		BOOST_CHECK(out.get<double>()(i) == a(i) + b(i));
+	}
+	column_subtract(A, B, out);
+	for(size_t i = 0; i < 100; ++i) {
+		BOOST_CHECK(out.get<double>()(i) == a(i) - b(i));
+	}
+	column_multiply(A, 3, out);
+	for(size_t i = 0; i < 100; ++i) {
+		BOOST_CHECK(out.get<double>()(i) == 3 * a(i));
+	}
+	column_negate(A, out);
+	BOOST_CHECK(&out.get<double>()(0) == buffer);
+	for(size_t i = 0; i < 100; ++i) {
+		BOOST_CHECK(out.get<double>()(i) == -a(i));
+	}
+
+	// output of a different type is retyped
+	vector < int > z(3);
+	z(0) = 1, z(1) = 2, z(2) = 3;
+	df_column Z(z);
+	column_add(Z, 2, out);
+	BOOST_CHECK(out.size() == 3 && out.type() == Z.type());
+	for(size_t i = 0; i < 3; ++i) {
+		BOOST_CHECK(out.get<int>()(i) == z(i) + 2);
+	}
+
+	// concurrent operations on columns of the same type
+	std::vector < df_column > results(4);
+	std::vector < std::thread > workers;
+	for(size_t t = 0; t < results.size(); ++t) {
+		workers.emplace_back([&, t]() {
+			for(int k = 0; k < 50; ++k) {
+				results[t] = A * (double)t + B;
+			}
+		});
+	}
+	for(auto& w: workers) w.join();
+	for(size_t t = 0; t < results.size(); ++t) {
+		for(size_t i = 0; i < 100; ++i) {
+			BOOST_CHECK(results[t].get<double>()(i) == a(i) * t + b(i));
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE (df_column_Scalar_Broadcast_Operators) {
+	vector < int > z(6);
+	z(0) = -7, z(1) = 12, z(2) = 3, z(3) = 40, z(4) = 0, z(5) = 25;
+	df_column Z(z);
+
+	df_column Q = Z / 2;
+	for(size_t i = 0; i < Z.size(); ++i) {
+		BOOST_CHECK(Q.get<int>()(i) == z(i) / 2);
+	}
+	df_column R = Z / 2.0;
+	BOOST_CHECK(R.type() == Z.type());
+	for(size_t i = 0; i < Z.size(); ++i) {
+		BOOST_CHECK(R.get<int>()(i) == (int)(z(i) / 2.0));
+	}
+
+	df_column L = pmin(Z, 10), H = pmax(Z, 10), C = clamp(Z, 0, 20);
+	for(size_t i = 0; i < Z.size(); ++i) {
+		BOOST_CHECK(L.get<int>()(i) == std::min(z(i), 10));
+		BOOST_CHECK(H.get<int>()(i) == std::max(z(i), 10));
+		BOOST_CHECK(C.get<int>()(i) == std::min(std::max(z(i), 0), 20));
+	}
+
+	vector < double > d(3);
+	d(0) = 1.5, d(1) = -2.5, d(2) = 9.0;
+	df_column D(d);
+	D /= 0.5;
+	for(size_t i = 0; i < D.size(); ++i) {
+		BOOST_CHECK(D.get<double>()(i) == d(i) * 2);
+	}
+	df_column E = Z - 3;
+	for(size_t i = 0; i < Z.size(); ++i) {
+		BOOST_CHECK(E.get<int>()(i) == z(i) - 3);
+	}
+}
+
+template < class T >
+void check_simd_kernels(const size_t n) {
+	vector < T > x(n), y(n);
+	for(size_t i = 0; i < n; ++i) {
+		x(i) = (T)((i * 7) % 23);
+		y(i) = (T)((i * 5) % 11 + 1);
+	}
+	x(n / 2) = (T)100;
+	y(n / 3) = (T)0;
+	df_column X(x), Y(y);
+	for(int isa = simd::scalar; isa <= simd::avx512; ++isa) {
+		simd::set_isa((simd::isa)isa);
+		df_column S = X + Y, D = X - Y, M = X * 3, N = -X, L = pmin(X, (T)5);
+		for(size_t i = 0; i < n; ++i) {
+			BOOST_CHECK(S.get<T>()(i) == (T)(x(i) + y(i)));
+			BOOST_CHECK(D.get<T>()(i) == (T)(x(i) - y(i)));
+			BOOST_CHECK(M.get<T>()(i) == (T)(x(i) * 3));
+			BOOST_CHECK(N.get<T>()(i) == (T)(-x(i)));
+			BOOST_CHECK(L.get<T>()(i) == std::min(x(i), (T)5));
+		}
+		BOOST_CHECK((X.Max<T, T>()) == (T)100);
+		BOOST_CHECK((Y.Min<T, T>()) == (T)0);
+		long double sum = 0;
+		for(size_t i = 0; i < n; ++i) sum += x(i);
+		BOOST_CHECK(fabs((X.Sum<T, double>()) - (double)sum) < 1e-6);
+		BOOST_CHECK(fabs((X.Mean<T, double>()) - (double)(sum / n)) < 1e-9);
+	}
+	simd::set_isa(simd::avx512);
+}
+
+BOOST_AUTO_TEST_CASE (df_column_SIMD_Kernels) {
+	BOOST_CHECK(simd::set_isa(simd::avx512) == simd::detect_isa());
+	BOOST_CHECK(simd::active_isa() == simd::detect_isa());
+	check_simd_kernels < short > (1003);
+	check_simd_kernels < unsigned short > (1003);
+	check_simd_kernels < int > (1003);
+	check_simd_kernels < unsigned int > (1003);
+	check_simd_kernels < long > (1003);
+	check_simd_kernels < unsigned long > (1003);
+	check_simd_kernels < long long > (1003);
+	check_simd_kernels < unsigned long long > (1003);
+	check_simd_kernels < float > (1003);
+	check_simd_kernels < double > (1003);
+	check_simd_kernels < long double > (1003);
+	check_simd_kernels < double > (7);
+}
+
 // No static_assert checking. Manual looking shows that results are perfect. :-)
 BOOST_AUTO_TEST_CASE (df_column_Printing) {
 	vector < int > z(3);
@@ -161,7 +440,7 @@ BOOST_AUTO_TEST_CASE (df_column_Printing) {
 	df_column Z(z);
 	df_column Y(2*Z);
 	Z.print();
-	Y.summary < int, double> ();
+	std::cout << Y.summary < int, double> () << std::endl;
 }
 
 BOOST_AUTO_TEST_CASE (df_column_Statistical_Summaries) {
@@ -199,6 +478,489 @@ BOOST_AUTO_TEST_CASE (df_column_Statistical_Summaries) {
 	BOOST_CHECK(mn == MIN);	
 }
 
+BOOST_AUTO_TEST_CASE (df_column_Single_Pass_Summary) {
+	const size_t n = 10007;
+	vector < double > v(n);
+	for(size_t i = 0; i < n; ++i) v(i) = 1e9 + (double)((i * 37) % 101) / 7.0;
+	df_column V(v);
+
+	long double sum = 0, mn = v(0), mx = v(0);
+	for(size_t i = 0; i < n; ++i) {
+		sum += v(i);
+		mn = std::min<long double>(mn, v(i));
+		mx = std::max<long double>(mx, v(i));
+	}
+	long double mean = sum / n, ss = 0;
+	for(size_t i = 0; i < n; ++i) ss += (v(i) - mean) * (v(i) - mean);
+	long double var = ss / (n - 1);
+
+	column_summary < double > s = V.summary < double, double > ();
+	BOOST_CHECK(s.count == n);
+	BOOST_CHECK(s.min == mn && s.max == mx);
+	BOOST_CHECK(fabs(s.mean - mean) < 1e-6);
+	BOOST_CHECK(fabs(s.sum - sum) / sum < 1e-12);
+	BOOST_CHECK(fabs(s.variance() - var) / var < 1e-6);
+	BOOST_CHECK(fabs(s.stddev() - std::sqrt(var)) < 1e-6);
+
+	// value by value and merged chunks agree with the single pass
+	column_summary < double > w, a, b;
+	for(size_t i = 0; i < n; ++i) w.push(v(i));
+	a.push(&v(0), n / 3);
+	b.push(&v(n / 3), n - n / 3);
+	a.merge(b);
+	BOOST_CHECK(w.count == n && a.count == n);
+	BOOST_CHECK(fabs(w.mean - s.mean) < 1e-6 && fabs(a.mean - s.mean) < 1e-6);
+	BOOST_CHECK(fabs(w.variance() - var) / var < 1e-6);
+	BOOST_CHECK(fabs(a.variance() - var) / var < 1e-6);
+	BOOST_CHECK(a.min == s.min && a.max == s.max);
+
+	vector < int > z(3);
+	z(0) = 15, z(1) = 12, z(2) = 13;
+	column_summary < long double > zs = df_column(z).summary < int, long double > ();
+	BOOST_CHECK(zs.count == 3 && zs.min == 12 && zs.max == 15 && zs.sum == 40);
+	BOOST_CHECK(fabs(zs.variance() - 7.0L / 3.0L) < 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE (df_column_Quantiles) {
+	const size_t n = 5001;
+	vector < int > v(n);
+	for(size_t i = 0; i < n; ++i) v(i) = (int)((i * 7919) % n);
+	df_column V(v);
+	// v is a permutation of 0 .. n-1
+	BOOST_CHECK((V.quantile<int, double>(0)) == 0);
+	BOOST_CHECK((V.quantile<int, double>(1)) == n - 1);
+	BOOST_CHECK((V.Median<int, double>()) == 2500);
+	BOOST_CHECK(fabs((V.quantile<int, double>(0.1234)) - 0.1234 * (n - 1)) < 1e-9);
+
+	std::vector < double > qs = {0.99, 0.01, 0.25, 0.5, 0.75, 0.3333};
+	vector < double > q = V.quantiles<int, double>(qs);
+	BOOST_CHECK(q.size() == qs.size());
+	for(size_t i = 0; i < qs.size(); ++i) {
+		BOOST_CHECK(fabs(q(i) - qs[i] * (n - 1)) < 1e-9);
+	}
+	// the column itself is not reordered
+	for(size_t i = 0; i < n; ++i) {
+		BOOST_CHECK(V.get<int>()(i) == v(i));
+	}
+
+	vector < double > e(4);
+	e(0) = 4, e(1) = 1, e(2) = 3, e(3) = 2;
+	df_column E(e);
+	BOOST_CHECK(fabs((E.Median<double, double>()) - 2.5) < 1e-12);
+	BOOST_CHECK(fabs((E.quantile<double, double>(0.25)) - 1.75) < 1e-12);
+
+	// approximate quantiles in bounded memory
+	tdigest d = V.digest<int>(100);
+	BOOST_CHECK(d.count() == n);
+	BOOST_CHECK(d.size() <= 100);
+	BOOST_CHECK(d.quantile(0) == 0 && d.quantile(1) == n - 1);
+	for(double p: {0.001, 0.01, 0.1, 0.5, 0.9, 0.99, 0.999}) {
+		BOOST_CHECK(fabs(d.quantile(p) - p * (n - 1)) < 0.01 * n);
+	}
+	tdigest a = V.digest<int>(), b = V.digest<int>();
+	a.merge(b);
+	BOOST_CHECK(a.count() == 2 * n);
+	BOOST_CHECK(fabs(a.quantile(0.5) - 2500) < 0.01 * n);
+
+	// the extremes are exact, even once merged into a single centroid
+	tdigest one(1);
+	one.push(1.0).push(2.0).push(6.0);
+	BOOST_CHECK(one.size() == 1 && one.quantile(0.5) == 3);
+	BOOST_CHECK(one.quantile(0) == 1 && one.quantile(1) == 6);
+}
+
+BOOST_AUTO_TEST_CASE (df_column_Aligned_Storage) {
+	// every buffer starts on a cache line, whatever its type and size
+	for(size_t n: {1, 3, 17, 100, 1000}) {
+		vector < char > c(n, 'a');
+		vector < double > d(n, 1.5);
+		vector < std::string > s(n, "x");
+		df_column C(c), D(d), S(s);
+		BOOST_CHECK((size_t)(&C.get<char>()(0)) % column_alignment == 0);
+		BOOST_CHECK((size_t)(&D.get<double>()(0)) % column_alignment == 0);
+		BOOST_CHECK((size_t)(&S.get<std::string>()(0)) % column_alignment == 0);
+		df_column E = D * 2.0;
+		BOOST_CHECK((size_t)(&E.get<double>()(0)) % column_alignment == 0);
+	}
+	BOOST_CHECK(cache_aligned_allocator<double>::padded_size(1) == column_alignment);
+	BOOST_CHECK(cache_aligned_allocator<double>::padded_size(9) == 2 * column_alignment);
+
+	// a lent buffer holds its owner, which follows it through swaps and is released by a resize
+	std::shared_ptr < column_array<double> > region = std::make_shared < column_array<double> >(8, 2.5);
+	{
+		column_vector<double> a;
+		column_array<double> lent = adopt_array(&(*region)[0], 8, region);
+		a.data().swap(lent);
+		BOOST_CHECK(a.data().lent() && !lent.lent() && region.use_count() == 2 && a(7) == 2.5);
+		column_vector<double> b(a);
+		BOOST_CHECK(!b.data().lent() && region.use_count() == 2 && b(7) == 2.5);
+		b.swap(a);
+		BOOST_CHECK(b.data().lent() && !a.data().lent() && region.use_count() == 2);
+		b.resize(16, true);
+		BOOST_CHECK(!b.data().lent() && region.use_count() == 1 && b(7) == 2.5 && b(15) == 0.0);
+		// an assignment of equal size copies into an allocated buffer, never into the lent one
+		column_vector<double> e;
+		column_array<double> lent_e = adopt_array(&(*region)[0], 8, region);
+		e.data().swap(lent_e);
+		e = b;
+		BOOST_CHECK(!e.data().lent() && region.use_count() == 1 && e(15) == 0.0);
+		e.resize(8, true);
+		e.data() = adopt_array(&(*region)[0], 8, region);
+		e.data() = column_vector<double>(8, 1.0).data();
+		BOOST_CHECK(!e.data().lent() && region.use_count() == 1 && (*region)[0] == 2.5 && e(0) == 1.0);
+		column_array<double> d = adopt_array(&(*region)[0], 8, region);
+		BOOST_CHECK(region.use_count() == 2);
+	}
+	BOOST_CHECK(region.use_count() == 1);
+
+	// type tags follow INNER_TYPE
+	vector < float > f(10);
+	for(size_t i = 0; i < 10; ++i) f(i) = i * 0.5f;
+	df_column F(f);
+	BOOST_CHECK(F.type() == column_traits<float>::type_id);
+	BOOST_CHECK(F.type() == 11);
+	BOOST_CHECK(F.data().holds<float>() && !F.data().holds<double>());
+	BOOST_CHECK(F.data().size() == 10);
+
+	// typed views share the buffer of the column
+	column_view<float> v = F.view<float>();
+	BOOST_CHECK(v.size() == 10 && v.data() == &F.get<float>()(0));
+	v[3] = 42;
+	BOOST_CHECK(F.get<float>()(3) == 42);
+	const df_column& G = F;
+	float sum = 0;
+	for(float x: G.view<float>()) sum += x;
+	BOOST_CHECK(sum == 42 + 22.5f - 1.5f);
+
+	// copies own their buffer
+	df_column H(F);
+	BOOST_CHECK(&H.get<float>()(0) != &F.get<float>()(0));
+	H.get<float>()(0) = 7;
+	BOOST_CHECK(F.get<float>()(0) == 0);
+}
+
+BOOST_AUTO_TEST_CASE (df_column_Missing_Values) {
+	const size_t n = 200;
+	vector < int > x(n);
+	for(size_t i = 0; i < n; ++i) x(i) = i;
+	df_column X(x);
+	BOOST_CHECK(!X.has_nulls() && X.validity().bits() == 0);
+
+	// every 3rd element and a large value are missing
+	for(size_t i = 0; i < n; i += 3) X.set_null(i);
+	X.get<int>()(100) = 1000000;
+	X.set_null(100);
+	const size_t nulls = (n + 2) / 3 + 1;
+	BOOST_CHECK(X.null_count() == nulls && X.is_null(0) && !X.is_null(1) && X.is_null(100));
+	BOOST_CHECK(X.validity().bits()->count() == n - nulls);
+
+	int sum = 0, mn = n, mx = 0;
+	std::vector < int > valid;
+	for(size_t i = 0; i < n; ++i) {
+		if (i % 3 != 0 && i != 100) {
+			sum += i, mn = std::min(mn, (int)i), mx = std::max(mx, (int)i);
+			valid.push_back(i);
+		}
+	}
+	BOOST_CHECK((X.Sum<int, long>()) == sum);
+	BOOST_CHECK((X.Min<int, int>()) == mn && (X.Max<int, int>()) == mx);
+	BOOST_CHECK(fabs((X.Mean<int, double>()) - (double)sum / valid.size()) < 1e-9);
+	BOOST_CHECK((X.Median<int, double>()) == (valid[valid.size() / 2 - 1] + valid[valid.size() / 2]) / 2.0);
+	column_summary < double > s = X.summary<int, double>();
+	BOOST_CHECK(s.count == n - nulls && s.max == mx);
+	BOOST_CHECK(X.digest<int>().count() == n - nulls);
+
+	// nulls propagate through the kernels
+	df_column Y = X * 2 + 1;
+	BOOST_CHECK(Y.null_count() == nulls);
+	BOOST_CHECK(Y.validity().bits() == X.validity().bits());
+	for(size_t i = 0; i < n; ++i) {
+		BOOST_CHECK(Y.is_null(i) == X.is_null(i));
+		if (!Y.is_null(i)) BOOST_CHECK(Y.get<int>()(i) == 2 * (int)i + 1);
+	}
+	df_column Z(x);
+	Z.set_null(1);
+	df_column W = X + Z;
+	BOOST_CHECK(W.null_count() == nulls + 1 && W.is_null(1) && W.is_null(3) && !W.is_null(2));
+	BOOST_CHECK(Z.null_count() == 1 && X.null_count() == nulls);
+	Z += X;
+	BOOST_CHECK(Z.validity() == W.validity());
+
+	// equality ignores the values under the nulls
+	df_column V(X);
+	V.get<int>()(0) = -5;
+	BOOST_CHECK(V == X);
+	V.set_null(0, false);
+	BOOST_CHECK(V.null_count() == nulls - 1 && V != X && X.is_null(0));
+	BOOST_CHECK(!(df_column(x) == X));
+
+	// assigning data clears the nulls
+	X = x;
+	BOOST_CHECK(!X.has_nulls());
+	BOOST_CHECK((X.Sum<int, long>()) == (long)(n * (n - 1) / 2));
+
+	// runs of valid elements
+	bitmap b(130, true);
+	b.set(0, false), b.set(64, false), b.set(65, false), b.set(129, false);
+	std::vector < std::pair < size_t, size_t > > runs;
+	for_each_set_run(&b, b.size(), [&](size_t i, size_t k) { runs.push_back({i, k}); });
+	BOOST_CHECK(runs.size() == 2);
+	BOOST_CHECK(runs[0].first == 1 && runs[0].second == 63);
+	BOOST_CHECK(runs[1].first == 66 && runs[1].second == 63);
+	BOOST_CHECK(b.count() == 126);
+	b.resize(200, true);
+	BOOST_CHECK(b.count() == 196 && b.test(130) && !b.test(129));
+}
+
+BOOST_AUTO_TEST_CASE (df_column_String_Column) {
+	vector < std::string > s(4);
+	s(0) = "alpha", s(1) = "", s(2) = "beta", s(3) = "alphabet";
+	string_column c(s);
+	BOOST_CHECK(c.size() == 4 && c.byte_size() == 17);
+	BOOST_CHECK(c.offsets()[0] == 0 && c.offsets()[4] == 17);
+	BOOST_CHECK((size_t)c.bytes() % column_alignment == 0);
+	for(size_t i = 0; i < s.size(); ++i) {
+		BOOST_CHECK(c(i) == s(i) && c.length(i) == s(i).size());
+		BOOST_CHECK(c.equals(i, s(i)));
+		BOOST_CHECK(c.hash(i) == std::hash < std::string_view > ()(s(i)));
+	}
+	BOOST_CHECK(c.starts_with(3, "alpha") && c.starts_with(0, "alpha") && !c.starts_with(2, "alpha"));
+	BOOST_CHECK(!c.starts_with(1, "a") && c.starts_with(1, ""));
+	BOOST_CHECK(!c.equals(0, "alphabet") && !c.equals(3, "alpha"));
+
+	large_string_column l { "x", "yz" };
+	l.push_back("");
+	BOOST_CHECK(l.size() == 3 && l(1) == "yz" && l(2).empty());
+
+	// in a df_column: copy-on-write storage, equality and row access
+	df_column X(c);
+	BOOST_CHECK(X.type() == column_traits<string_column>::type_id && X.size() == 4);
+	BOOST_CHECK(X.eval<string_column>(2) == "beta");
+	df_column Y(X);
+	BOOST_CHECK(Y == X && &Y.data().get<string_column>() == &X.data().get<string_column>());
+	string_column d(c);
+	d.push_back("gamma");
+	Y = std::move(d);
+	BOOST_CHECK(Y.size() == 5 && Y != X && X.size() == 4 && d.empty());
+	X.set_null(1);
+	BOOST_CHECK(X.is_null(1) && X != df_column(c));
+
+	vector < std::string > h(2);
+	h(0) = "name", h(1) = "id";
+	vector < int > id(4);
+	for(size_t i = 0; i < 4; ++i) id(i) = i;
+	vector < df_column > cols(2);
+	cols(0) = c, cols(1) = id;
+	data_frame df(h, cols);
+	BOOST_CHECK(boost::get<std::string>(df(3)(0)) == "alphabet");
+	BOOST_CHECK(df.cursor(2).get<string_column>(0) == "beta");
+}
+
+BOOST_AUTO_TEST_CASE (df_column_Dictionary_Column) {
+	const char* countries[] = { "FR", "US", "DE", "US", "FR", "US" };
+	vector < std::string > s(6);
+	for(size_t i = 0; i < 6; ++i) s(i) = countries[i];
+	dictionary_column d(s);
+	BOOST_CHECK(d.size() == 6 && d.cardinality() == 3 && d.code_width() == 1);
+	for(size_t i = 0; i < 6; ++i) BOOST_CHECK(d(i) == s(i));
+	BOOST_CHECK(d.code(0) == 0 && d.code(1) == 1 && d.code(3) == 1 && d.find("DE") == 2);
+	BOOST_CHECK(d.find("IT") == dictionary_column::npos);
+
+	// equality, grouping and sorting on the codes
+	bitmap us = d.matches("US");
+	BOOST_CHECK(us.count() == 3 && us.test(1) && us.test(3) && us.test(5) && !us.test(0));
+	BOOST_CHECK(d.matches("IT").count() == 0);
+	std::vector < size_t > counts = d.counts();
+	BOOST_CHECK(counts[0] == 2 && counts[1] == 3 && counts[2] == 1);
+	std::vector < size_t > p = d.argsort();
+	const size_t sorted[] = { 2, 0, 4, 1, 3, 5 };
+	BOOST_CHECK(std::equal(p.begin(), p.end(), sorted));
+
+	// columns with other dictionaries compare on translated codes
+	dictionary_column e { "US", "DE" };
+	for(size_t i = 0; i < 6; ++i) e.push_back(countries[i]);
+	dictionary_column f { "FR", "US", "DE", "US", "FR", "US" };
+	BOOST_CHECK(f == d && e != d);
+	std::vector < dictionary_column::code_type > r = e.recode(d);
+	BOOST_CHECK(r[0] == 1 && r[1] == 2 && r[2] == 0);
+
+	// copies share the dictionary, codes widen with the cardinality
+	dictionary_column g(d);
+	BOOST_CHECK(&g.dictionary() == &d.dictionary() && g == d);
+	for(size_t i = 0; i < 300; ++i) g.push_back(std::to_string(i));
+	BOOST_CHECK(g.code_width() == 2 && g.cardinality() == 303 && d.cardinality() == 3);
+	BOOST_CHECK(g(5) == "US" && g(6) == "0" && g(305) == "299" && g.code(305) == 302);
+
+	df_column X(d), Y(f);
+	BOOST_CHECK(X.type() == column_traits<dictionary_column>::type_id && X.size() == 6);
+	BOOST_CHECK(X == Y && X.eval<dictionary_column>(2) == "DE");
+	X.set_null(2);
+	Y.set_null(2);
+	BOOST_CHECK(X == Y);
+	Y = dictionary_column { "FR", "US", "IT", "US", "FR", "US" };
+	Y.set_null(2);
+	BOOST_CHECK(X == Y);
+}
+
+BOOST_AUTO_TEST_CASE (df_column_Bool_Column) {
+	const size_t n = 1000;
+	bool_column a(n), b(n);
+	for(size_t i = 0; i < n; ++i) {
+		a.set(i, i % 2 == 0);
+		b.set(i, i % 3 == 0);
+	}
+	BOOST_CHECK(a.count() == 500 && b.count() == 334 && a.word_count() == 16);
+	BOOST_CHECK((a & b).count() == 167 && (a | b).count() == 667 && (a ^ b).count() == 500);
+	BOOST_CHECK((~a).count() == 500 && (~a).size() == n && !(~a)(0) && (~a)(999));
+	BOOST_CHECK(a.any() && !a.all() && bool_column(70, true).all());
+
+	// push_back grows by whole words, counts ignore the spare ones
+	bool_column c;
+	for(size_t i = 0; i < 130; ++i) c.push_back(i < 65);
+	BOOST_CHECK(c.size() == 130 && c.count() == 65 && c(64) && !c(65));
+	c.resize(200, true);
+	BOOST_CHECK(c.count() == 135 && c(199) && !c(129));
+	c.flip();
+	BOOST_CHECK(c.count() == 65 && c(100) && !c(0));
+
+	// df_column operators, 1 bit per element
+	df_column A(a), B(b);
+	BOOST_CHECK(A.type() == column_traits<bool_column>::type_id && A.size() == n);
+	df_column C = A & B;
+	BOOST_CHECK(C.get<bool_column>() == (a & b));
+	BOOST_CHECK(C.eval<bool_column>(6) && !C.eval<bool_column>(4));
+	BOOST_CHECK((~(A | B)).get<bool_column>().count() == n - 667);
+	const bool_column* buffer = &C.data().get<bool_column>();
+	C ^= A;
+	BOOST_CHECK(&C.data().get<bool_column>() == buffer);
+	BOOST_CHECK(C.get<bool_column>() == ((a & b) ^ a));
+	C |= B;
+	BOOST_CHECK(C == (A | B));
+
+	// nulls propagate
+	B.set_null(3);
+	df_column D = A & B;
+	BOOST_CHECK(D.is_null(3) && D.null_count() == 1);
+	df_column E(a & b);
+	E.set_null(3);
+	BOOST_CHECK(D == E && df_column(a) == A);
+}
+
+BOOST_AUTO_TEST_CASE (df_column_Comparisons) {
+	const size_t n = 1000;
+	vector < int > x(n), y(n);
+	vector < double > d(n);
+	for(size_t i = 0; i < n; ++i) {
+		x(i) = int(i % 10);
+		y(i) = 5;
+		d(i) = i * 0.5;
+	}
+	df_column X(x), Y(y), D(d);
+
+	// the scalar operators only take numbers and strings, other types find no overload
+	BOOST_CHECK(is_comparison_scalar<int>::value && is_comparison_scalar<double>::value && is_comparison_scalar<bool>::value);
+	BOOST_CHECK(is_comparison_scalar<std::string>::value && is_comparison_scalar<const char*>::value && is_comparison_scalar<std::string_view>::value);
+	BOOST_CHECK(!is_comparison_scalar<df_column>::value && !is_comparison_scalar< std::vector < int > >::value);
+
+	// column vs scalar, through the SIMD kernels
+	df_column M = X < 3;
+	BOOST_CHECK(M.type() == column_traits<bool_column>::type_id && M.size() == n);
+	BOOST_CHECK(M.get<bool_column>().count() == 300 && M.eval<bool_column>(2) && !M.eval<bool_column>(3));
+	BOOST_CHECK((X <= 3).get<bool_column>().count() == 400 && (X > 3).get<bool_column>().count() == 600);
+	BOOST_CHECK((X >= 9).get<bool_column>().count() == 100 && (X == 0).get<bool_column>().count() == 100);
+	BOOST_CHECK((X != 0).get<bool_column>().count() == 900 && (3 > X).get<bool_column>() == M.get<bool_column>());
+	// a scalar the column type cannot hold is compared exactly
+	BOOST_CHECK((X < 2.5).get<bool_column>().count() == 300 && (X == 2.5).get<bool_column>().count() == 0);
+	BOOST_CHECK((X < 1e12).get<bool_column>().count() == n && (X > -1e12).get<bool_column>().count() == n);
+	BOOST_CHECK((D >= 250).get<bool_column>().count() == 500 && (D == 0.5).get<bool_column>().count() == 1);
+
+	// column vs column
+	BOOST_CHECK((X < Y).get<bool_column>().count() == 500 && (X >= Y).get<bool_column>().count() == 500);
+	BOOST_CHECK(equal(X, Y).get<bool_column>().count() == 100 && not_equal(X, Y).get<bool_column>().count() == 900);
+	BOOST_CHECK(((X > 2) & (X < Y)).get<bool_column>().count() == 200);
+
+	// strings and dictionaries
+	df_column S(string_column({"ab", "b", "abc", "c", "b"}));
+	df_column C(dictionary_column({"ab", "b", "abc", "c", "b"}));
+	BOOST_CHECK((S == "b").get<bool_column>().count() == 2 && (S < "b").get<bool_column>().count() == 2);
+	BOOST_CHECK((C == "b").get<bool_column>() == (S == "b").get<bool_column>());
+	BOOST_CHECK((C >= "b").get<bool_column>() == (S >= "b").get<bool_column>());
+	BOOST_CHECK((C == "z").get<bool_column>().count() == 0);
+	df_column C2(dictionary_column({"c", "b", "abc", "ab", "b"}));
+	BOOST_CHECK(equal(C, C2).get<bool_column>().count() == 3 && (C < C2).get<bool_column>().count() == 1);
+
+	// the mask written over an input
+	df_column A(x), B(y);
+	column_compare<simd::less>(A, 3, A);
+	BOOST_CHECK(A.type() == column_traits<bool_column>::type_id && A.get<bool_column>() == M.get<bool_column>());
+	A = x;
+	column_compare<simd::less>(A, B, A);
+	BOOST_CHECK(A.get<bool_column>().count() == 500);
+	A = x;
+	column_compare<simd::greater_equal>(A, B, B);
+	BOOST_CHECK(B.get<bool_column>().count() == 500 && B.get<bool_column>() == (X >= Y).get<bool_column>());
+	df_column S2(string_column({"ab", "b", "abc", "c", "b"})), C3(dictionary_column({"ab", "b", "abc", "c", "b"}));
+	column_compare<simd::equal_to>(S2, std::string_view("b"), S2);
+	column_compare<simd::equal_to>(C3, std::string_view("b"), C3);
+	BOOST_CHECK(S2.get<bool_column>() == (S == "b").get<bool_column>() && C3.get<bool_column>() == S2.get<bool_column>());
+
+	// nulls propagate to the mask
+	X.set_null(0);
+	df_column N = X == 0;
+	BOOST_CHECK(N.is_null(0) && N.null_count() == 1 && N.get<bool_column>().count() == 100);
+}
+
+BOOST_AUTO_TEST_CASE (df_column_Argsort) {
+	// radix sort of signed integers, stable
+	vector < int > x(6);
+	const int xv[] = {3, -1, 3, -70000, 0, -1};
+	for(size_t i = 0; i < 6; ++i) x(i) = xv[i];
+	df_column X(x);
+	const std::vector < size_t > asc = X.argsort();
+	const size_t asc_ok[] = {3, 1, 5, 4, 0, 2};
+	BOOST_CHECK(std::equal(asc.begin(), asc.end(), asc_ok));
+	const std::vector < size_t > desc = X.argsort(sort_order::desc);
+	const size_t desc_ok[] = {0, 2, 4, 1, 5, 3};
+	BOOST_CHECK(std::equal(desc.begin(), desc.end(), desc_ok));
+
+	// floating points, nulls last
+	vector < double > d(5);
+	const double dv[] = {0.5, -2.25, 1e300, -0.0, -1e-300};
+	for(size_t i = 0; i < 5; ++i) d(i) = dv[i];
+	df_column D(d);
+	D.set_null(2);
+	const std::vector < size_t > dp = D.argsort();
+	const size_t dp_ok[] = {1, 4, 3, 0, 2};
+	BOOST_CHECK(std::equal(dp.begin(), dp.end(), dp_ok));
+	BOOST_CHECK(D.argsort(sort_order::desc)[0] == 0 && D.argsort(sort_order::desc)[4] == 2);
+
+	// strings, dictionaries and bools
+	df_column S(string_column({"pear", "apple", "fig", "apple"}));
+	df_column C(dictionary_column({"pear", "apple", "fig", "apple"}));
+	const size_t sp_ok[] = {1, 3, 2, 0};
+	const std::vector < size_t > sp = S.argsort(sort_order::asc, true), cp = C.argsort();
+	BOOST_CHECK(std::equal(sp.begin(), sp.end(), sp_ok) && std::equal(cp.begin(), cp.end(), sp_ok));
+	BOOST_CHECK(C.argsort(sort_order::desc)[0] == 0 && S.argsort(sort_order::desc, true)[3] == 3);
+	bool_column b(5);
+	b.set(1, true);
+	b.set(3, true);
+	const std::vector < size_t > bp = df_column(b).argsort(sort_order::desc);
+	BOOST_CHECK(bp[0] == 1 && bp[1] == 3 && bp[2] == 0 && bp[4] == 4);
+
+	// large columns against std::stable_sort
+	const size_t n = 50000;
+	vector < long long > y(n);
+	unsigned long long r = 88172645463325252ULL;
+	for(size_t i = 0; i < n; ++i) {
+		r ^= r << 13; r ^= r >> 7; r ^= r << 17;
+		y(i) = (long long) (r % 2001) - 1000;
+	}
+	std::vector < size_t > ref(n);
+	for(size_t i = 0; i < n; ++i) ref[i] = i;
+	std::stable_sort(ref.begin(), ref.end(), [&y](size_t a, size_t b) { return y(a) < y(b); });
+	BOOST_CHECK(df_column(y).argsort() == ref);
+}
+
 BOOST_AUTO_TEST_CASE (data_frame_Constructors) {
 	// default constructor
 	data_frame df1;
@@ -334,6 +1096,376 @@ BOOST_AUTO_TEST_CASE (data_frame_Column_Accessors_Manipulators) {
 	df.print();
  }
 
+BOOST_AUTO_TEST_CASE (data_frame_Indexed_Columns) {
+	// a wide frame, columns accessed by position, header and handle
+	const size_t ncol = 2000;
+	vector < std::string > headers(ncol);
+	vector < df_column > cols(ncol);
+	for(size_t j = 0; j < ncol; ++j) {
+		headers(j) = "c" + boost::lexical_cast<std::string>(j);
+		cols(j) = vector < int > (3, (int)j);
+	}
+	data_frame df(headers, std::move(cols));
+	for(size_t j = 0; j < ncol; ++j) {
+		BOOST_CHECK(df[j].get<int>()(0) == (int)j);
+		BOOST_CHECK(df[headers(j)].get<int>()(2) == (int)j);
+		BOOST_CHECK(&df[j] == &df[headers(j)]);
+	}
+
+	column_handle h = df.handle("c1234");
+	BOOST_CHECK(h.index() == 1234 && h.generation() == df.generation());
+	BOOST_CHECK(&df[h] == &df[1234]);
+	const data_frame& cdf = df;
+	BOOST_CHECK(cdf[h].get<int>()(1) == 1234);
+
+	// a handle is stale in any other frame, copies included: stale_column_handle terminates
+	const data_frame copy(df);
+	data_frame other(headers, vector < df_column > (ncol));
+	BOOST_CHECK(h.generation() != copy.generation() && h.generation() != other.generation());
+	BOOST_CHECK(copy.handle("c1234").generation() != h.generation());
+	BOOST_CHECK(column_handle().generation() != data_frame().generation());
+	BOOST_CHECK(!terminates([&] { cdf[h]; }) && terminates([&] { copy[h]; }) && terminates([&] { other[h]; }));
+
+	// erasing shifts the positions, the index follows and the handles are invalidated
+	df.erase_column("c0");
+	BOOST_CHECK(df.ncol() == ncol - 1);
+	BOOST_CHECK(h.generation() != df.generation());
+	h = df.handle("c1234");
+	BOOST_CHECK(h.index() == 1233 && df[h].get<int>()(0) == 1234);
+	BOOST_CHECK(df["c1"].get<int>()(0) == 1 && df[0].get<int>()(0) == 1);
+
+	// renaming keeps the position
+	df.set_col_header("c5", "five");
+	BOOST_CHECK(df.colname(4) == "five" && df["five"].get<int>()(0) == 5);
+	df.set_col_header(4, "c5");
+	BOOST_CHECK(df.handle("c5").index() == 4);
+
+	// new columns go at the end
+	df["new"] = vector < int > (3, -1);
+	BOOST_CHECK(df.ncol() == ncol && df.colname(ncol - 1) == "new");
+	BOOST_CHECK(df.handle("new").index() == ncol - 1);
+	df.add_column("added", vector < int > (3, -2));
+	BOOST_CHECK(df[ncol].get<int>()(0) == -2);
+}
+
+BOOST_AUTO_TEST_CASE (data_frame_Row_Iteration) {
+	const size_t n = 1000;
+	vector < std::string > headers(3);
+	headers(0) = "i", headers(1) = "d", headers(2) = "s";
+	vector < int > x(n);
+	vector < double > y(n);
+	vector < std::string > z(n);
+	for(size_t i = 0; i < n; ++i) {
+		x(i) = i;
+		y(i) = i * 0.5;
+		z(i) = boost::lexical_cast<std::string>(i);
+	}
+	vector < df_column > cols(3);
+	cols(0) = x, cols(1) = y, cols(2) = z;
+	data_frame df(headers, std::move(cols));
+
+	// cursor gives references into the buffers
+	row_cursor r = df.cursor(10);
+	BOOST_CHECK(r.get<int>(0) == 10 && r.get<double>(1) == 5 && r.get<std::string>(2) == "10");
+	const data_frame& cdf = df;
+	BOOST_CHECK(&r.get<std::string>(2) == &cdf["s"].get<std::string>()(10));
+	++r;
+	column_handle h = df.handle("d");
+	BOOST_CHECK(r.row() == 11 && r.get<double>(h) == 5.5);
+	r.seek(999);
+	BOOST_CHECK(r.get<int>(0) == 999);
+
+	// typed iteration, by header and by position
+	size_t rows = 0;
+	double sum = 0;
+	df.for_each_row < int, double, std::string > ({"i", "d", "s"},
+		[&](const int& a, const double& b, const std::string& c) {
+			BOOST_CHECK(c == z(a));
+			sum += a + b;
+			++rows;
+		});
+	BOOST_CHECK(rows == n && sum == 1.5 * n * (n - 1) / 2);
+	size_t k = 0;
+	df.for_each_row < std::string, int > ({2, 0}, [&](const std::string& c, int a) {
+		BOOST_CHECK(a == (int)k && c == z(k));
+		++k;
+	});
+	BOOST_CHECK(k == n);
+
+	// batches of rows
+	size_t batches = 0, total = 0;
+	df.for_each_batch < int, double > ({"i", "d"}, 64,
+		[&](column_view<const int> a, column_view<const double> b) {
+			BOOST_CHECK(a.size() == b.size() && a.size() <= 64);
+			BOOST_CHECK(a[0] == (int)total && b[0] == total * 0.5);
+			total += a.size();
+			++batches;
+		});
+	BOOST_CHECK(total == n && batches == (n + 63) / 64);
+}
+
+BOOST_AUTO_TEST_CASE (data_frame_Filter) {
+	const size_t n = 100;
+	vector < std::string > names(4);
+	names(0) = "a";
+	names(1) = "b";
+	names(2) = "s";
+	names(3) = "c";
+	vector < int > a(n);
+	vector < double > b(n);
+	vector < std::string > s(n);
+	for(size_t i = 0; i < n; ++i) {
+		a(i) = int(i);
+		b(i) = i * 2.0;
+		s(i) = std::to_string(i % 3);
+	}
+	vector < df_column > cols(4);
+	cols(0) = a;
+	cols(1) = b;
+	cols(2) = string_column(s);
+	cols(3) = dictionary_column(s);
+	cols(1).set_null(19);
+	data_frame df(names, cols);
+
+	data_frame f = df.filter((df["a"] >= 10) & (df["s"] == "1"));
+	BOOST_CHECK(f.ncol() == 4 && f.nrow() == 30);
+	BOOST_CHECK(f["a"].eval<int>(0) == 10 && f["a"].eval<int>(29) == 97);
+	BOOST_CHECK(f["b"].eval<double>(1) == 26.0 && f["b"].is_null(3) && f["b"].null_count() == 1);
+	BOOST_CHECK(f["s"].eval<string_column>(2) == "1" && f["c"].eval<dictionary_column>(29) == "1");
+	BOOST_CHECK(f["c"].get<dictionary_column>().cardinality() == 3);
+
+	// null elements of the mask are not selected
+	data_frame g = df.filter(df["b"] < 50);
+	BOOST_CHECK(g.nrow() == 24 && g["a"].eval<int>(20) == 21);
+	BOOST_CHECK(df.filter(df["a"] > 1000).nrow() == 0 && df.filter(df["a"] >= 0).nrow() == n);
+}
+
+BOOST_AUTO_TEST_CASE (data_frame_Group_By) {
+	vector < std::string > names(4);
+	names(0) = "k";
+	names(1) = "s";
+	names(2) = "x";
+	names(3) = "y";
+	vector < int > k(8), x(8);
+	vector < double > y(8);
+	vector < std::string > s(8);
+	const int kv[] = {2, 1, 2, 3, 1, 2, 3, 3};
+	const char* sv[] = {"a", "b", "a", "a", "b", "c", "a", "a"};
+	for(size_t i = 0; i < 8; ++i) {
+		k(i) = kv[i];
+		s(i) = sv[i];
+		x(i) = int(i);
+		y(i) = i * 0.5;
+	}
+	vector < df_column > cols(4);
+	cols(0) = k;
+	cols(1) = dictionary_column(s);
+	cols(2) = x;
+	cols(3) = y;
+	cols(2).set_null(6);
+	data_frame df(names, cols);
+
+	// groups in the order of their first row: 2, 1, 3
+	data_frame g = df.group_by({"k"}).agg({{"x", aggregation::sum}, {"x", aggregation::count},
+		{"y", aggregation::mean}, {"x", aggregation::max}, {"s", aggregation::count}});
+	BOOST_CHECK(g.nrow() == 3 && g.ncol() == 6 && g.colname(1) == "x_sum" && g.colname(5) == "s_count");
+	BOOST_CHECK(g["k"].eval<int>(0) == 2 && g["k"].eval<int>(1) == 1 && g["k"].eval<int>(2) == 3);
+	BOOST_CHECK(g["x_sum"].eval<long long>(0) == 7 && g["x_sum"].eval<long long>(1) == 5 && g["x_sum"].eval<long long>(2) == 10);
+	BOOST_CHECK(g["x_count"].eval<unsigned long>(2) == 2 && g["s_count"].eval<unsigned long>(2) == 3);
+	BOOST_CHECK(g["y_mean"].eval<double>(1) == 1.25 && g["x_max"].eval<int>(2) == 7);
+
+	// multi-column keys, dictionary keys are gathered with their dictionary
+	data_frame h = df.group_by({"s", "k"}).agg({{"y", aggregation::min}, {"x", aggregation::variance}});
+	BOOST_CHECK(h.nrow() == 4 && h["s"].eval<dictionary_column>(3) == "c" && h["k"].eval<int>(2) == 3);
+	BOOST_CHECK(h["y_min"].eval<double>(2) == 1.5 && h["x_variance"].eval<double>(0) == 2);
+	BOOST_CHECK(h["x_variance"].is_null(3) && h["x_variance"].null_count() == 1);
+
+	// partial tables of several threads merge to the same result
+	const size_t n = 200000;
+	vector < long > a(n), b(n);
+	for(size_t i = 0; i < n; ++i) {
+		a(i) = long((i * 7919) % 1013);
+		b(i) = long(i % 17);
+	}
+	vector < std::string > nb(2);
+	nb(0) = "a";
+	nb(1) = "b";
+	vector < df_column > cb(2);
+	cb(0) = a;
+	cb(1) = b;
+	data_frame big(nb, cb);
+	data_frame r1 = big.group_by({"a"}).agg({{"b", aggregation::sum}, {"b", aggregation::stddev}}, 1);
+	data_frame r4 = big.group_by({"a"}).agg({{"b", aggregation::sum}, {"b", aggregation::stddev}}, 4);
+	BOOST_CHECK(r1.nrow() == 1013 && r4.nrow() == 1013);
+	BOOST_CHECK(r1["a"] == r4["a"] && r1["b_sum"] == r4["b_sum"]);
+	double total = 0;
+	for(size_t i = 0; i < r4.nrow(); ++i) {
+		total += r4["b_sum"].eval<long long>(i);
+		BOOST_CHECK(std::abs(r4["b_stddev"].eval<double>(i) - r1["b_stddev"].eval<double>(i)) < 1e-9);
+	}
+	BOOST_CHECK(total == 1599970);
+
+	// min and max in the type of the column, sums of integers exact past 2^53
+	vector < std::string > nw(3);
+	nw(0) = "k";
+	nw(1) = "w";
+	nw(2) = "u";
+	vector < int > kw(3);
+	vector < long long > w(3);
+	vector < unsigned long long > u(3);
+	const long long big_w = (1LL << 60) + 1;
+	for(size_t i = 0; i < 3; ++i) {
+		kw(i) = 1;
+		w(i) = big_w + 2 * (long long) i;
+		u(i) = ~0ULL - i;
+	}
+	vector < df_column > cw(3);
+	cw(0) = kw;
+	cw(1) = w;
+	cw(2) = u;
+	data_frame wide(nw, cw);
+	data_frame q = wide.group_by({"k"}).agg({{"w", aggregation::max}, {"w", aggregation::min}, {"w", aggregation::sum},
+		{"u", aggregation::min}, {"w", aggregation::mean}});
+	BOOST_CHECK(q["w_max"].type() == column_traits<long long>::type_id && q["w_max"].eval<long long>(0) == big_w + 4);
+	BOOST_CHECK(q["w_min"].eval<long long>(0) == big_w && q["w_sum"].eval<long long>(0) == 3 * big_w + 6);
+	BOOST_CHECK(q["u_min"].eval<unsigned long long>(0) == ~0ULL - 2);
+	BOOST_CHECK(q["w_mean"].type() == column_traits<double>::type_id);
+}
+
+BOOST_AUTO_TEST_CASE (data_frame_Join) {
+	// left: id, x ; right: id, name, x
+	vector < std::string > ln(2), rn(3);
+	ln(0) = "id";
+	ln(1) = "x";
+	rn(0) = "id";
+	rn(1) = "name";
+	rn(2) = "x";
+	vector < int > lid(5), lx(5), rid(4);
+	vector < double > rx(4);
+	vector < std::string > names(4);
+	const int li[] = {1, 2, 3, 2, 5};
+	const int ri[] = {2, 1, 2, 4};
+	const char* rs[] = {"b", "a", "bb", "d"};
+	for(size_t i = 0; i < 5; ++i) {
+		lid(i) = li[i];
+		lx(i) = int(10 * i);
+	}
+	for(size_t i = 0; i < 4; ++i) {
+		rid(i) = ri[i];
+		rx(i) = i + 0.5;
+		names(i) = rs[i];
+	}
+	vector < df_column > lc(2), rc(3);
+	lc(0) = lid;
+	lc(1) = lx;
+	rc(0) = rid;
+	rc(1) = dictionary_column(names);
+	rc(2) = rx;
+	lc(0).set_null(4);
+	data_frame l(ln, lc), r(rn, rc);
+
+	// inner: left order, then right order for a key with several matches
+	data_frame in = l.join(r, {"id"});
+	BOOST_CHECK(in.nrow() == 5 && in.ncol() == 4 && in.colname(2) == "name" && in.colname(3) == "x_right");
+	const int in_id[] = {1, 2, 2, 2, 2};
+	const char* in_name[] = {"a", "b", "bb", "b", "bb"};
+	for(size_t i = 0; i < 5; ++i) {
+		BOOST_CHECK(in["id"].eval<int>(i) == in_id[i] && in["name"].eval<dictionary_column>(i) == in_name[i]);
+	}
+	BOOST_CHECK(in["x"].eval<int>(4) == 30 && in["x_right"].eval<double>(2) == 2.5);
+
+	// left: rows without match keep null right columns, null keys never match
+	data_frame lj = l.join(r, {"id"}, join_type::left);
+	BOOST_CHECK(lj.nrow() == 7 && lj["x_right"].null_count() == 2 && lj["name"].null_count() == 2);
+	BOOST_CHECK(lj["x"].eval<int>(3) == 20 && lj["name"].is_null(3) && lj["x_right"].is_null(6) && lj["id"].is_null(6));
+	BOOST_CHECK(lj["x_right"].get<double>()(3) == 0 && lj["x_right"].get<double>()(6) == 0);
+
+	// a suffixed header already taken on the left gets suffixed again
+	vector < std::string > ln3(3);
+	ln3(0) = "id";
+	ln3(1) = "x";
+	ln3(2) = "x_right";
+	vector < df_column > lc3(3);
+	lc3(0) = lid;
+	lc3(1) = lx;
+	lc3(2) = lx;
+	data_frame l3(ln3, lc3);
+	data_frame in3 = l3.join(r, {"id"});
+	BOOST_CHECK(in3.ncol() == 5 && in3.colname(2) == "x_right" && in3.colname(4) == "x_right_right");
+	BOOST_CHECK(in3["x_right"].eval<int>(4) == 30 && in3["x_right_right"].eval<double>(2) == 2.5);
+
+	// semi and anti
+	data_frame se = l.join(r, {"id"}, join_type::semi);
+	data_frame an = l.join(r, {"id"}, join_type::anti);
+	BOOST_CHECK(se.nrow() == 3 && se.ncol() == 2 && se["x"].eval<int>(2) == 30);
+	BOOST_CHECK(an.nrow() == 2 && an["x"].eval<int>(0) == 20 && an["id"].is_null(1));
+
+	// different key names, empty right side
+	data_frame rr(rn, rc);
+	rr.set_col_header("id", "key");
+	BOOST_CHECK(l.join(rr, {"id"}, {"key"}).nrow() == 5);
+	data_frame e = l.join(r.filter(r["id"] > 10), {"id"}, join_type::left);
+	BOOST_CHECK(e.nrow() == 5 && e["name"].null_count() == 5 && e["x_right"].null_count() == 5);
+	for(size_t i = 0; i < 5; ++i) {
+		BOOST_CHECK(e["x_right"].get<double>()(i) == 0);
+	}
+
+	// parallel probe gives the rows in the same order
+	const size_t n = 100000;
+	vector < long > a(n), b(1000);
+	for(size_t i = 0; i < n; ++i) {
+		a(i) = long((i * 7) % 1500);
+	}
+	for(size_t i = 0; i < 1000; ++i) {
+		b(i) = long(i);
+	}
+	vector < std::string > na(1), nb(2);
+	na(0) = "k";
+	nb(0) = "k";
+	nb(1) = "v";
+	vector < df_column > ca(1), cb(2);
+	ca(0) = a;
+	cb(0) = b;
+	cb(1) = b;
+	data_frame big(na, ca), small(nb, cb);
+	data_frame j1 = big.join(small, {"k"}, join_type::inner, 1);
+	data_frame j3 = big.join(small, {"k"}, join_type::inner, 3);
+	BOOST_CHECK(j1.nrow() == j3.nrow() && j1["k"] == j3["k"] && j3["k"] == j3["v"]);
+	BOOST_CHECK(j1.nrow() + big.join(small, {"k"}, join_type::anti, 3).nrow() == n);
+}
+
+BOOST_AUTO_TEST_CASE (data_frame_Sort_By) {
+	vector < std::string > names(3);
+	names(0) = "a";
+	names(1) = "b";
+	names(2) = "s";
+	vector < int > a(6);
+	vector < double > b(6);
+	vector < std::string > s(6);
+	const int av[] = {2, 1, 2, 1, 2, 1};
+	const double bv[] = {0.5, 1.5, 2.5, 0.5, 0.5, 3.5};
+	const char* sv[] = {"u", "v", "w", "x", "y", "z"};
+	for(size_t i = 0; i < 6; ++i) {
+		a(i) = av[i];
+		b(i) = bv[i];
+		s(i) = sv[i];
+	}
+	vector < df_column > cols(3);
+	cols(0) = a;
+	cols(1) = b;
+	cols(2) = string_column(s);
+	cols(1).set_null(5);
+	data_frame df(names, cols);
+
+	data_frame t = df.sort_by({{"a"}, {"b", sort_order::desc}});
+	const char* t_ok[] = {"v", "x", "z", "w", "u", "y"};
+	for(size_t i = 0; i < 6; ++i) {
+		BOOST_CHECK(t["s"].eval<string_column>(i) == t_ok[i]);
+	}
+	BOOST_CHECK(t["b"].is_null(2) && t["b"].null_count() == 1 && t["a"].eval<int>(3) == 2);
+	BOOST_CHECK(df.argsort({{"s", sort_order::desc}}, true)[0] == 5);
+}
+
 BOOST_AUTO_TEST_CASE (data_frame_Equality_Check_Operators) {
 	// Column Retrieval
 	vector < std::string > names(3);
@@ -671,3 +1803,690 @@ BOOST_AUTO_TEST_CASE (data_frame_proxies) {
 	}
 }	
 
+
+BOOST_AUTO_TEST_CASE (data_frame_proxies_resolved_columns) {
+	const size_t n = 100000;
+	vector < std::string > names(3);
+	names(0) = "a";
+	names(1) = "b";
+	names(2) = "c";
+	vector < int > a(n);
+	vector < double > b(n);
+	vector < long > c(n);
+	for(size_t i = 0; i < n; ++i) {
+		a(i) = int(i % 100);
+		b(i) = i * 0.25;
+		c(i) = long(i);
+	}
+	vector < df_column > cols(3);
+	cols(0) = a;
+	cols(1) = b;
+	cols(2) = c;
+	data_frame df(names, cols);
+
+	// the columns are updated in place, several at a time
+	data_frame_range r(&df, range(0, 3));
+	r.set_threads(3);
+	const int* buffer = &df[0].get<int>()(0);
+	(r *= 2) += 1;
+	BOOST_CHECK(&df[0].get<int>()(0) == buffer);
+	BOOST_CHECK(df[0].get<int>()(99) == 199 && df[1].get<double>()(4) == 3.0 && df[2].get<long>()(n - 1) == long(2 * n - 1));
+	data_frame_slice s(&df, slice(0, 2, 2));
+	s -= 1;
+	BOOST_CHECK(df[0].get<int>()(99) == 198 && df[2].get<long>()(1) == 2 && df[1].get<double>()(4) == 3.0);
+
+	// adding columns moves them: the proxies resolve them again
+	vector < int > d(n, 0);
+	df.add_column("d", df_column(d));
+	indirect_array <> ia(2);
+	ia(0) = 3;
+	ia(1) = 1;
+	data_frame_indirect ind(&df, ia);
+	df.add_column("e", df_column(d));
+	r *= 2;
+	ind += 1;
+	BOOST_CHECK(df[0].get<int>()(99) == 396 && r[1].get<double>()(4) == 7.0 && ind[0].get<int>()(5) == 1);
+}
+
+BOOST_AUTO_TEST_CASE (data_frame_row_views) {
+	vector < std::string > names(3);
+	names(0) = "x";
+	names(1) = "y";
+	names(2) = "s";
+	vector < int > x(10);
+	vector < double > y(10);
+	vector < std::string > s(10);
+	for(size_t i = 0; i < 10; ++i) {
+		x(i) = int(i);
+		y(i) = i * 0.5;
+		s(i) = std::to_string(i);
+	}
+	vector < df_column > cols(3);
+	cols(0) = x;
+	cols(1) = y;
+	cols(2) = string_column(s);
+	cols(1).set_null(3);
+	const data_frame df(names, cols);
+
+	// ranges: head and tail read the columns in place
+	data_frame_row_range h = df.head(3);
+	BOOST_CHECK(h.nrow() == 3 && h.ncol() == 3 && h.column<int>("x")(2) == 2);
+	BOOST_CHECK(&h.column<int>("x")(1) == &df["x"].get<int>()(1));
+	BOOST_CHECK(sum(h.column<int>("x")) == 3 && df.tail(4).column<int>(0)(0) == 6 && df.tail(100).nrow() == 10);
+	const column_summary<double> r = df.rows(2, 6).summary<double, double>("y");
+	BOOST_CHECK(r.count == 3 && r.sum == 5.5 && r.min == 1.0);
+
+	// slices and index lists
+	data_frame_row_slice odd = df.rows(1, 2, 4);
+	BOOST_CHECK(odd.nrow() == 4 && sum(odd.column<int>("x")) == 16 && odd.row(3) == 7);
+	BOOST_CHECK((odd.summary<double, double>("y").count == 3) && odd.is_null(odd.handle("y"), 1));
+	// the header resolved once, the rows then read by position
+	const column_handle hy = odd.handle("y");
+	size_t nulls = 0;
+	double total = 0;
+	for(size_t k = 0; k < odd.nrow(); ++k) {
+		if (odd.is_null(hy, k)) {
+			++nulls;
+		}
+		else {
+			total += odd.eval<double>(hy, k);
+		}
+	}
+	BOOST_CHECK(nulls == 1 && (total == odd.summary<double, double>("y").sum));
+	std::vector < size_t > idx = {9, 0, 4};
+	data_frame_row_indirect pick = df.rows(idx);
+	BOOST_CHECK((pick.eval<string_column>(pick.handle("s"), 0) == "9") && inner_prod(pick.column<int>("x"), pick.column<int>("x")) == 97);
+	data_frame c = pick.DataFrame();
+	BOOST_CHECK(c.nrow() == 3 && c["x"].eval<int>(0) == 9 && c["s"].eval<string_column>(2) == "4");
+}
+
+BOOST_AUTO_TEST_CASE (data_frame_Read_CSV) {
+	// types, quotes, nulls, line ends
+	const std::string text =
+		"id,price,flag,name,empty\r\n"
+		"1,2.5,true,plain,\r\n"
+		"\n"
+		"-2,3,FALSE,\"with, comma\",\r\n"
+		"3,NA,,\"say \"\"hi\"\"\",\n"
+		"+4,1e3,True,\"two\nlines\"\n"
+		"5,-0.5,false,\"\"";
+	data_frame df = parse_csv(text);
+	BOOST_CHECK(df.nrow() == 5 && df.ncol() == 5);
+	BOOST_CHECK(df.headers()(0) == "id" && df.headers()(4) == "empty");
+	BOOST_CHECK(df["id"].type() == column_traits<long long>::type_id);
+	BOOST_CHECK(df["price"].type() == column_traits<double>::type_id);
+	BOOST_CHECK(df["flag"].type() == column_traits<bool_column>::type_id);
+	BOOST_CHECK(df["name"].type() == column_traits<string_column>::type_id);
+	BOOST_CHECK(df["empty"].type() == column_traits<double>::type_id && df["empty"].null_count() == 5);
+	BOOST_CHECK(df["id"].get<long long>()(1) == -2 && df["id"].get<long long>()(3) == 4);
+	BOOST_CHECK(df["price"].get<double>()(3) == 1000 && df["price"].is_null(2) && df["price"].null_count() == 1);
+	BOOST_CHECK(df["flag"].eval<bool_column>(0) && !df["flag"].eval<bool_column>(1) && df["flag"].is_null(2));
+	BOOST_CHECK(df["name"].eval<string_column>(1) == "with, comma");
+	BOOST_CHECK(df["name"].eval<string_column>(2) == "say \"hi\"");
+	BOOST_CHECK(df["name"].eval<string_column>(3) == "two\nlines");
+	BOOST_CHECK(df["name"].eval<string_column>(4) == "" && !df["name"].is_null(4));
+
+	// tab separated, no header, dictionary encoded strings
+	csv_options tsv;
+	tsv.delimiter = '\t';
+	tsv.header = false;
+	tsv.dictionary_strings = true;
+	data_frame t = parse_csv("a\t1\nb\t2\na\t3\n", tsv);
+	BOOST_CHECK(t.nrow() == 3 && t.headers()(0) == "0" && t.headers()(1) == "1");
+	BOOST_CHECK(t["0"].type() == column_traits<dictionary_column>::type_id && t["0"].eval<dictionary_column>(2) == "a");
+
+	// chunks split at line ends outside quotes, types widened after the sample
+	std::string big = "k,v,s\n";
+	const size_t n = 20000;
+	for(size_t i = 0; i < n; ++i) {
+		big += std::to_string(i) + ",";
+		big += (i == 15000) ? "2.5" : std::to_string(i % 7);
+		big += (i % 3 == 0) ? ",\"x,\ny\"\n" : ",z\n";
+	}
+	csv_options one;
+	one.threads = 1;
+	one.sample_rows = 10;
+	csv_options many = one;
+	many.threads = 4;
+	many.min_chunk_bytes = 256;
+	data_frame a = parse_csv(big, one), b = parse_csv(big, many);
+	BOOST_CHECK(a.nrow() == n && b.nrow() == n);
+	BOOST_CHECK(b["v"].type() == column_traits<double>::type_id && b["v"].get<double>()(15000) == 2.5);
+	BOOST_CHECK(a == b);
+	BOOST_CHECK(b["k"].get<long long>()(n - 1) == static_cast<long long>(n - 1));
+	BOOST_CHECK(b["s"].eval<string_column>(9999) == "x,\ny" && b["s"].eval<string_column>(10000) == "z");
+
+	// a quote inside an unquoted field is an ordinary byte, also for the split points
+	std::string odd = "k,v,s\n0,5'10\",z\n";
+	for(size_t i = 1; i < n; ++i) {
+		odd += std::to_string(i) + ",\"p\nq\",w\n";
+	}
+	data_frame c = parse_csv(odd, one), d = parse_csv(odd, many);
+	BOOST_CHECK(c.nrow() == n && d.nrow() == n && c == d);
+	BOOST_CHECK(d["v"].eval<string_column>(0) == "5'10\"" && d["v"].eval<string_column>(n - 1) == "p\nq");
+
+	// from a file
+	const std::string path = "df_read_csv_test.csv";
+	{
+		std::ofstream out(path, std::ios::binary);
+		out << big;
+	}
+	data_frame f = read_csv(path, many);
+	std::remove(path.c_str());
+	BOOST_CHECK(f == a);
+}
+
+BOOST_AUTO_TEST_CASE (data_frame_Write_CSV) {
+	vector < std::string > names(4);
+	names(0) = "id";
+	names(1) = "x";
+	names(2) = "s";
+	names(3) = "b";
+	vector < int > id(4);
+	vector < double > x(4);
+	for(size_t i = 0; i < 4; ++i) {
+		id(i) = int(i) - 1;
+		x(i) = 0.1 * i;
+	}
+	vector < df_column > cols(4);
+	cols(0) = id;
+	cols(1) = x;
+	cols(2) = string_column { "a,b", "say \"hi\"", "", "NA" };
+	cols(3) = bool_column (4, true);
+	data_frame df(names, cols);
+	df["x"].set_null(2);
+	df["b"].set_null(0);
+
+	std::ostringstream out;
+	write_csv(df, out);
+	BOOST_CHECK(out.str() ==
+		"id,x,s,b\n"
+		"-1,0,\"a,b\",\n"
+		"0,0.1,\"say \"\"hi\"\"\",true\n"
+		"1,,\"\",true\n"
+		"2,0.30000000000000004,\"NA\",true\n");
+
+	// read back: same values, nulls and empty strings
+	data_frame r = parse_csv(out.str());
+	BOOST_CHECK(r.nrow() == 4 && r["id"].get<long long>()(0) == -1);
+	BOOST_CHECK(r["x"].get<double>()(3) == x(3) && r["x"].is_null(2) && r["x"].null_count() == 1);
+	BOOST_CHECK(r["s"] == df["s"]);
+	BOOST_CHECK(r["b"] == df["b"]);
+
+	// several blocks on several threads give the same text
+	csv_options tsv;
+	tsv.delimiter = '\t';
+	tsv.header = false;
+	const size_t n = 10000;
+	vector < long > v(n);
+	for(size_t i = 0; i < n; ++i) {
+		v(i) = long(i) * 1000003;
+	}
+	vector < std::string > h(1);
+	h(0) = "v";
+	vector < df_column > c(1);
+	c(0) = v;
+	data_frame big(h, c);
+	std::ostringstream one, many;
+	tsv.threads = 1;
+	write_csv(big, one, tsv);
+	tsv.threads = 3;
+	tsv.block_rows = 100;
+	write_csv(big, many, tsv);
+	BOOST_CHECK(one.str() == many.str());
+	data_frame back = parse_csv(many.str(), tsv);
+	BOOST_CHECK(back.nrow() == n && back["0"].get<long long>()(n - 1) == (long long)(n - 1) * 1000003);
+
+	// print to any stream
+	std::ostringstream p;
+	df.print(p);
+	BOOST_CHECK(p.str().find("[s]: a,b say \"hi\"  NA \n") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE (data_frame_Open_Mapped) {
+	const size_t n = 1000;
+	vector < std::string > names(6);
+	names(0) = "id";
+	names(1) = "x";
+	names(2) = "s";
+	names(3) = "d";
+	names(4) = "b";
+	names(5) = "t";
+	vector < int > id(n);
+	vector < double > x(n);
+	vector < std::string > t(n);
+	string_column s;
+	dictionary_column d;
+	bool_column b(n);
+	for(size_t i = 0; i < n; ++i) {
+		id(i) = int(i) - 7;
+		x(i) = 0.5 * i;
+		t(i) = std::string(i % 5, 'a' + i % 26);
+		s.push_back(std::to_string(i));
+		d.push_back(i % 3 == 0 ? "red" : "blue");
+		b.set(i, i % 7 == 0);
+	}
+	vector < df_column > cols(6);
+	cols(0) = id;
+	cols(1) = x;
+	cols(2) = s;
+	cols(3) = d;
+	cols(4) = b;
+	cols(5) = t;
+	data_frame df(names, cols);
+	df["x"].set_null(3);
+	df["s"].set_null(999);
+	df["b"].set_null(0);
+
+	const std::string path = "df_open_mapped_test.df";
+	write_frame(df, path);
+	{
+		data_frame m = open_mapped(path);
+		// the numbers, booleans and validity bitmaps are lent by the mapping
+		BOOST_CHECK(m["id"].get<int>().data().lent() && m["x"].get<double>().data().lent());
+		BOOST_CHECK(!m["t"].get<std::string>().data().lent());
+		BOOST_CHECK(m == df);
+		BOOST_CHECK(m["id"].type() == df["id"].type() && m["d"].type() == df["d"].type());
+		BOOST_CHECK(m["x"].is_null(3) && m["x"].null_count() == 1 && m["s"].is_null(999));
+		BOOST_CHECK(m["t"].get<std::string>()(n - 1) == t(n - 1));
+		BOOST_CHECK(reinterpret_cast<std::uintptr_t>(&m["x"].get<double>()(0)) % column_alignment == 0);
+
+		// writes go to private pages, never to the file
+		m["id"].get<int>()(0) = 42;
+		m["b"].set_null(1);
+		BOOST_CHECK(open_mapped(path)["id"].get<int>()(0) == -7);
+		BOOST_CHECK(!open_mapped(path)["b"].is_null(1));
+
+		// the columns outlive the frame they were opened in
+		df_column c = m["id"];
+		m = data_frame();
+		BOOST_CHECK(c.get<int>().data().lent());
+		BOOST_CHECK(c.get<int>()(0) == 42 && c.get<int>()(n - 1) == int(n) - 8);
+	}
+	std::remove(path.c_str());
+
+	// a block of bools holding a byte other than 0 or 1 is rejected, never adopted
+	vector < std::string > flag_names(1);
+	flag_names(0) = "flag";
+	vector < bool > flags(64);
+	for(size_t i = 0; i < 64; ++i) {
+		flags(i) = (i * 7) % 3 == 0;
+	}
+	vector < df_column > flag_cols(1);
+	flag_cols(0) = flags;
+	write_frame(data_frame(flag_names, flag_cols), path);
+	BOOST_CHECK(open_mapped(path)["flag"].get<bool>().data().lent() && open_mapped(path)["flag"] == flag_cols(0));
+	std::string bytes;
+	{
+		std::ifstream in(path, std::ios::binary);
+		bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	}
+	const std::string block(reinterpret_cast<const char*>(&flag_cols(0).get<bool>()(0)), 64);
+	const size_t at = bytes.find(block);
+	BOOST_CHECK(at != std::string::npos);
+	bytes[at + 5] = 2;
+	{
+		std::ofstream out(path, std::ios::binary);
+		out << bytes;
+	}
+	BOOST_CHECK(terminates([&] { open_mapped(path); }));
+	std::remove(path.c_str());
+
+	// an empty frame
+	write_frame(data_frame(), path);
+	BOOST_CHECK(open_mapped(path).ncol() == 0);
+	std::remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_CASE (data_frame_Arrow) {
+	const size_t n = 300;
+	vector < std::string > names(7);
+	names(0) = "id";
+	names(1) = "x";
+	names(2) = "s";
+	names(3) = "d";
+	names(4) = "b";
+	names(5) = "u";
+	names(6) = "t";
+	vector < int > id(n);
+	vector < double > x(n);
+	vector < unsigned short > u(n);
+	vector < std::string > t(n);
+	large_string_column s;
+	dictionary_column d;
+	bool_column b(n);
+	for(size_t i = 0; i < n; ++i) {
+		id(i) = int(i) * 3 - 100;
+		x(i) = 0.25 * i;
+		u(i) = (unsigned short)(i * 200);
+		t(i) = std::string(i % 4, 'a' + i % 26);
+		s.push_back("row " + std::to_string(i));
+		d.push_back(i % 3 == 0 ? "red" : (i % 3 == 1 ? "green" : "blue"));
+		b.set(i, i % 5 == 0);
+	}
+	vector < df_column > cols(7);
+	cols(0) = id;
+	cols(1) = x;
+	cols(2) = s;
+	cols(3) = d;
+	cols(4) = b;
+	cols(5) = u;
+	cols(6) = t;
+	data_frame df(names, cols);
+	df["x"].set_null(7);
+	df["d"].set_null(0);
+	df["b"].set_null(299);
+
+	// file (Feather v2) and stream, read back with the same types but std::string read as string_column
+	const std::string path = "df_arrow_test.arrow";
+	for(const arrow_format format : {arrow_format::file, arrow_format::stream}) {
+		write_arrow(df, path, format);
+		{
+			data_frame r = read_arrow(path);
+			BOOST_CHECK(r["x"].get<double>().data().lent());
+			BOOST_CHECK(r.nrow() == n && r.ncol() == 7);
+			for(size_t k = 0; k < 6; ++k) {
+				BOOST_CHECK(r[k] == df[k]);
+			}
+			BOOST_CHECK(r["t"].type() == column_traits<string_column>::type_id);
+			BOOST_CHECK(r["t"].get<string_column>()(n - 1) == t(n - 1) && r["t"].get<string_column>()(0) == "");
+			BOOST_CHECK(r["d"].is_null(0) && r["x"].null_count() == 1 && r["b"].is_null(299));
+		}
+	}
+
+	std::ostringstream file, stream;
+	write_arrow(df, file);
+	write_arrow(df, stream, arrow_format::stream);
+	const std::string f = file.str(), st = stream.str();
+	BOOST_CHECK(f.compare(0, 8, std::string("ARROW1\0\0", 8)) == 0 && f.compare(f.size() - 6, 6, "ARROW1") == 0);
+	BOOST_CHECK(st.compare(st.size() - 8, 8, std::string("\xff\xff\xff\xff\0\0\0\0", 8)) == 0);
+
+	// the bodies aligned on 8 bytes only, as from other writers: the buffers are copied
+	std::int32_t st_schema;
+	std::memcpy(&st_schema, st.data() + 4, 4);
+	const std::int32_t shifted = st_schema + 8;
+	std::ofstream misaligned(path, std::ios::binary);
+	misaligned << st.substr(0, 4);
+	misaligned.write(reinterpret_cast<const char*>(&shifted), 4);
+	misaligned << st.substr(8, st_schema) << std::string(8, '\0') << st.substr(8 + st_schema);
+	misaligned.close();
+	{
+		data_frame r = read_arrow(path);
+		BOOST_CHECK(!r["id"].get<int>().data().lent() && !r["x"].get<double>().data().lent());
+		for(size_t k = 0; k < 6; ++k) {
+			BOOST_CHECK(r[k] == df[k]);
+		}
+	}
+
+	// a stream of two record batches: copied and concatenated
+	vector < df_column > few(3);
+	few(0) = id;
+	few(1) = x;
+	few(2) = b;
+	vector < std::string > few_names(3);
+	few_names(0) = "id";
+	few_names(1) = "x";
+	few_names(2) = "b";
+	data_frame one(few_names, few);
+	one["x"].set_null(1);
+	std::ostringstream out;
+	write_arrow(one, out, arrow_format::stream);
+	const std::string bytes = out.str();
+	std::int32_t schema_length;
+	std::memcpy(&schema_length, bytes.data() + 4, 4);
+	const size_t schema_end = 8 + schema_length;
+	std::ofstream twice(path, std::ios::binary);
+	twice << bytes.substr(0, bytes.size() - 8) << bytes.substr(schema_end);
+	twice.close();
+	data_frame both = read_arrow(path);
+	BOOST_CHECK(both.nrow() == 2 * n);
+	BOOST_CHECK(both["id"].get<int>()(n + 5) == id(5) && both["x"].is_null(n + 1) && both["x"].null_count() == 2);
+	BOOST_CHECK(both["b"].get<bool_column>()(n + 10) && !both["b"].get<bool_column>()(n + 11));
+	std::remove(path.c_str());
+}
+
+// Writer of the Thrift compact protocol, building the Parquet files of data_frame_Read_Parquet.
+struct thrift_out {
+	std::string s;
+	std::vector < int > last = std::vector < int > (1, 0);
+	void varint(std::uint64_t x) {
+		for(; x >= 0x80; x >>= 7) {
+			s += char(x | 0x80);
+		}
+		s += char(x);
+	}
+	void field(const int id, const int type) {
+		s += char(((id - last.back()) << 4) | type);
+		last.back() = id;
+	}
+	void integer(const int id, const std::int64_t x, const int type = thrift_reader::i32) {
+		field(id, type);
+		varint((std::uint64_t(x) << 1) ^ std::uint64_t(x >> 63));
+	}
+	void binary(const int id, const std::string& x) {
+		field(id, thrift_reader::binary);
+		varint(x.size());
+		s += x;
+	}
+	void list(const int id, const size_t n, const int type = thrift_reader::structure) {
+		field(id, thrift_reader::list);
+		s += char((n << 4) | type);
+	}
+	void begin(const int id = 0) {
+		if (id != 0) {
+			field(id, thrift_reader::structure);
+		}
+		last.push_back(0);
+	}
+	void end() {
+		s += char(0);
+		last.pop_back();
+	}
+};
+
+template < class T >
+std::string parquet_bytes(const T& x) {
+	return std::string(reinterpret_cast<const char*>(&x), sizeof(T));
+}
+
+// a page of the given type (0 data, 2 dictionary, 3 data v2), its body stored as is or compressed
+std::string parquet_page(const int type, const std::string& body, const std::string& stored, const int values, const int encoding, const int levels = 0) {
+	thrift_out h;
+	h.integer(1, type);
+	h.integer(2, body.size());
+	h.integer(3, stored.size());
+	h.begin(type == 0 ? 5 : (type == 2 ? 7 : 8));
+	h.integer(1, values);
+	if (type == 3) {
+		h.integer(2, 0);
+		h.integer(3, values);
+		h.integer(4, encoding);
+		h.integer(5, levels);
+		h.integer(6, 0);
+	}
+	else {
+		h.integer(2, encoding);
+		if (type == 0) {
+			h.integer(3, 3);
+		}
+	}
+	h.end();
+	h.end();
+	return h.s + stored;
+}
+
+BOOST_AUTO_TEST_CASE (data_frame_Read_Parquet) {
+	// snappy: a literal, then an overlapping copy
+	const std::string abc("\x0c\x08" "abc" "\x15\x03", 7);
+	char out[12];
+	snappy_uncompress(abc.data(), abc.size(), out, sizeof(out));
+	BOOST_CHECK(std::string(out, sizeof(out)) == "abcabcabcabc");
+
+	// two row groups of 5 rows, the columns id (INT32), x (optional DOUBLE, snappy), s (strings, dictionary encoded),
+	// nested (a group, left out), b (BOOLEAN, RLE then PLAIN), u (INT32 of logical type UINT_16)
+	struct chunk { int type; int codec; size_t start; size_t offset; size_t dictionary; size_t size; std::string statistics; };
+	std::string file = "PAR1";
+	std::vector < std::vector < chunk > > groups(2);
+	for(int g = 0; g < 2; ++g) {
+		std::vector < chunk >& c = groups[g];
+		const auto column = [&c, &file] (const int type, const int codec, const std::string& statistics, const std::vector < std::string >& pages) {
+			c.push_back(chunk {type, codec, file.size(), file.size(), 0, 0, statistics});
+			if (pages.size() == 2) {
+				c.back().dictionary = file.size();
+				c.back().offset = file.size() + pages[0].size();
+			}
+			for(const std::string& p : pages) {
+				file += p;
+			}
+			c.back().size = file.size() - c.back().start;
+		};
+		std::string id, x, u;
+		for(int j = 0; j < 5; ++j) {
+			const int i = 5 * g + j;
+			id += parquet_bytes(std::int32_t(i * 10));
+			u += parquet_bytes(std::int32_t(i * 1000));
+			if (j != 2) {
+				x += parquet_bytes(0.5 * i);
+			}
+		}
+		thrift_out stats;
+		stats.begin();
+		stats.binary(5, parquet_bytes(std::int32_t(g * 50 + 40)));
+		stats.binary(6, parquet_bytes(std::int32_t(g * 50)));
+		stats.end();
+		column(1, 0, stats.s, {parquet_page(0, id, id, 5, 0)});
+
+		// nulls at row 2 of the groups, their levels bit-packed then as runs
+		const std::string levels = g == 0 ? std::string("\x03\x1b", 2) : std::string("\x04\x01\x02\x00\x04\x01", 6);
+		const std::string body = parquet_bytes(std::uint32_t(levels.size())) + levels + x;
+		const std::string snappy = std::string(1, char(body.size())) + char((body.size() - 1) << 2) + body;
+		column(5, 1, std::string(), {parquet_page(0, body, snappy, 5, 0)});
+
+		const std::string dictionary = parquet_bytes(std::uint32_t(3)) + "red" + parquet_bytes(std::uint32_t(5)) + "green";
+		const std::string codes = std::string("\x01\x03", 2) + (g == 0 ? "\x0a" : "\x15");
+		thrift_out text;
+		text.begin();
+		text.binary(5, "red");
+		text.binary(6, "green");
+		text.end();
+		column(6, 0, text.s, {parquet_page(2, dictionary, dictionary, 2, 0), parquet_page(g == 0 ? 0 : 3, codes, codes, 5, 8)});
+
+		// the leaf of nested, never read
+		c.push_back(chunk {2, 0, 4, 4, 0, 0, std::string()});
+
+		const std::string b = g == 0 ? parquet_bytes(std::uint32_t(2)) + "\x03\x09" : std::string("\x12");
+		column(0, 0, std::string(), {parquet_page(0, b, b, 5, g == 0 ? 3 : 0)});
+
+		// deprecated statistics, ignored for the unsigned columns
+		thrift_out legacy;
+		legacy.begin();
+		legacy.binary(1, parquet_bytes(std::int32_t(g * 5000 + 4000)));
+		legacy.binary(2, parquet_bytes(std::int32_t(g * 5000)));
+		legacy.end();
+		column(1, 0, legacy.s, {parquet_page(0, u, u, 5, 0)});
+	}
+
+	thrift_out m;
+	m.begin();
+	m.integer(1, 2);
+	m.list(2, 8);
+	const auto element = [&m] (const std::string& name, const int type, const int repetition, const int children) {
+		m.begin();
+		if (type >= 0) {
+			m.integer(1, type);
+		}
+		m.integer(3, repetition);
+		m.binary(4, name);
+		if (children != 0) {
+			m.integer(5, children);
+		}
+	};
+	element("schema", -1, 0, 6);
+	m.end();
+	element("id", 1, 0, 0);
+	m.end();
+	element("x", 5, 1, 0);
+	m.end();
+	element("s", 6, 0, 0);
+	m.integer(6, 0);
+	m.end();
+	element("nested", -1, 0, 1);
+	m.end();
+	element("v", 2, 0, 0);
+	m.end();
+	element("b", 0, 0, 0);
+	m.end();
+	element("u", 1, 0, 0);
+	m.begin(10);
+	m.begin(10);
+	m.field(1, thrift_reader::byte);
+	m.s += char(16);
+	m.field(2, thrift_reader::boolean_false);
+	m.end();
+	m.end();
+	m.end();
+	m.integer(3, 10, thrift_reader::i64);
+	m.list(4, 2);
+	for(const std::vector < chunk >& c : groups) {
+		m.begin();
+		m.list(1, c.size());
+		for(const chunk& k : c) {
+			m.begin();
+			m.integer(2, k.start, thrift_reader::i64);
+			m.begin(3);
+			m.integer(1, k.type);
+			m.list(2, 1, thrift_reader::i32);
+			m.varint(0);
+			m.integer(4, k.codec);
+			m.integer(5, 5, thrift_reader::i64);
+			m.integer(7, k.size, thrift_reader::i64);
+			m.integer(9, k.offset, thrift_reader::i64);
+			if (k.dictionary != 0) {
+				m.integer(11, k.dictionary, thrift_reader::i64);
+			}
+			if (!k.statistics.empty()) {
+				m.field(12, thrift_reader::structure);
+				m.s += k.statistics;
+			}
+			m.end();
+			m.end();
+		}
+		m.integer(3, 5, thrift_reader::i64);
+		m.end();
+	}
+	m.binary(6, "test");
+	m.end();
+	file += m.s + parquet_bytes(std::uint32_t(m.s.size())) + "PAR1";
+	const std::string path = "df_parquet_test.parquet";
+	std::ofstream(path, std::ios::binary) << file;
+
+	data_frame all = read_parquet(path);
+	BOOST_CHECK(all.nrow() == 10 && all.ncol() == 5);
+	BOOST_CHECK(all.headers()(2) == "s" && all.headers()(3) == "b");
+	BOOST_CHECK(all["u"].type() == column_traits<unsigned short>::type_id && all["s"].type() == column_traits<string_column>::type_id);
+	BOOST_CHECK(all["x"].null_count() == 2 && all["x"].is_null(2) && all["x"].is_null(7));
+	for(size_t i = 0; i < 10; ++i) {
+		BOOST_CHECK(all["id"].get<int>()(i) == int(i) * 10);
+		BOOST_CHECK(all["u"].get<unsigned short>()(i) == i * 1000);
+		BOOST_CHECK(all["s"].get<string_column>()(i) == (i % 2 ? "green" : "red"));
+		BOOST_CHECK(all["b"].get<bool_column>()(i) == (i % 3 == 0));
+		BOOST_CHECK(all["x"].is_null(i) || all["x"].get<double>()(i) == 0.5 * i);
+	}
+
+	// projection, predicates skipping row groups
+	parquet_options options;
+	options.columns = {"u", "s", "id"};
+	options.dictionary_strings = true;
+	options.predicates.push_back(parquet_predicate("id", parquet_predicate::greater_equal, 50));
+	data_frame upper = read_parquet(path, options);
+	BOOST_CHECK(upper.nrow() == 5 && upper.ncol() == 3 && upper.headers()(0) == "u");
+	BOOST_CHECK(upper["id"].get<int>()(0) == 50 && upper["u"].get<unsigned short>()(4) == 9000);
+	BOOST_CHECK(upper["s"].type() == column_traits<dictionary_column>::type_id && upper["s"].get<dictionary_column>()(0) == "green");
+	options.predicates[0] = parquet_predicate("id", parquet_predicate::less, 50);
+	BOOST_CHECK(read_parquet(path, options)["id"].get<int>()(4) == 40);
+	options.predicates[0] = parquet_predicate("s", parquet_predicate::equal, std::string("blue"));
+	BOOST_CHECK(read_parquet(path, options).nrow() == 0);
+	options.predicates[0] = parquet_predicate("u", parquet_predicate::less, -1);
+	BOOST_CHECK(read_parquet(path, options).nrow() == 10);
+	std::remove(path.c_str());
+}